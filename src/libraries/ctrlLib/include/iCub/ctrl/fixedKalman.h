@@ -0,0 +1,1182 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+/**
+ * @ingroup Kalman
+ *
+ * Kalman estimators whose sizes are fixed at compile time: all
+ * the storage is preallocated, so that predict() and correct()
+ * never allocate memory. They are meant for the many small
+ * filters running per joint or per sensor axis; the generic
+ * Kalman class stays the choice when the sizes are known only at
+ * run time.
+ */
+
+#ifndef __FIXEDKALMAN_H__
+#define __FIXEDKALMAN_H__
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+
+namespace iCub
+{
+
+namespace ctrl
+{
+
+/**
+* \ingroup Kalman
+*
+* Linear Kalman estimator with N states, M outputs and U inputs.
+*
+* Vectors are exchanged as plain arrays of doubles (e.g.
+* yarp::sig::Vector::data()), whereas the yarp::sig::Matrix
+* interface is retained for the configuration methods, which are
+* not supposed to be called within the control loop.
+*
+* The gain can be frozen to its steady-state value by means of
+* computeSteadyState(): afterwards the covariance is no longer
+* propagated and each step costs just a couple of matrix-vector
+* products.
+*/
+template<unsigned int N, unsigned int M, unsigned int U=1>
+class FixedKalman
+{
+protected:
+    double A[N][N];
+    double B[N][U];
+    double H[M][N];
+    double Q[N][N];
+    double R[M][M];
+
+    double x[N];
+    double P[N][N];
+    double K[N][M];
+    double S[M][M];
+    double invS[M][M];
+    double e[M];
+    double validationGate;
+    bool steadyState;
+
+    // scratch storage
+    double PHt[N][M];
+    double tmpNN[N][N];
+
+    /**********************************************************************/
+    static bool fromMatrix(const yarp::sig::Matrix &in, double *out,
+                           const int rows, const int cols)
+    {
+        if ((in.rows()!=rows) || (in.cols()!=cols))
+            return false;
+
+        for (int r=0; r<rows; r++)
+            for (int c=0; c<cols; c++)
+                out[r*cols+c]=in(r,c);
+
+        return true;
+    }
+
+    /**********************************************************************/
+    static yarp::sig::Matrix toMatrix(const double *in, const int rows,
+                                      const int cols)
+    {
+        yarp::sig::Matrix out(rows,cols);
+        for (int r=0; r<rows; r++)
+            for (int c=0; c<cols; c++)
+                out(r,c)=in[r*cols+c];
+
+        return out;
+    }
+
+    /**********************************************************************/
+    static bool invert(const double (&in)[M][M], double (&out)[M][M])
+    {
+        if (M==1)
+        {
+            if (in[0][0]==0.0)
+                return false;
+
+            out[0][0]=1.0/in[0][0];
+            return true;
+        }
+
+        // Gauss-Jordan elimination with partial pivoting
+        double W[M][M];
+        memcpy(W,in,sizeof(W));
+        for (unsigned int r=0; r<M; r++)
+            for (unsigned int c=0; c<M; c++)
+                out[r][c]=(r==c)?1.0:0.0;
+
+        for (unsigned int p=0; p<M; p++)
+        {
+            unsigned int piv=p;
+            for (unsigned int r=p+1; r<M; r++)
+                if (fabs(W[r][p])>fabs(W[piv][p]))
+                    piv=r;
+
+            if (W[piv][p]==0.0)
+                return false;
+
+            if (piv!=p)
+            {
+                for (unsigned int c=0; c<M; c++)
+                {
+                    double tmp=W[p][c]; W[p][c]=W[piv][c]; W[piv][c]=tmp;
+                    tmp=out[p][c]; out[p][c]=out[piv][c]; out[piv][c]=tmp;
+                }
+            }
+
+            double k=1.0/W[p][p];
+            for (unsigned int c=0; c<M; c++)
+            {
+                W[p][c]*=k;
+                out[p][c]*=k;
+            }
+
+            for (unsigned int r=0; r<M; r++)
+            {
+                if (r==p)
+                    continue;
+
+                double f=W[r][p];
+                for (unsigned int c=0; c<M; c++)
+                {
+                    W[r][c]-=f*W[p][c];
+                    out[r][c]-=f*out[p][c];
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**********************************************************************/
+    void propagateCovariance()
+    {
+        // P=A*P*A'+Q
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int j=0; j<N; j++)
+            {
+                double sum=0.0;
+                for (unsigned int l=0; l<N; l++)
+                    sum+=A[i][l]*P[l][j];
+                tmpNN[i][j]=sum;
+            }
+
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int j=0; j<N; j++)
+            {
+                double sum=Q[i][j];
+                for (unsigned int l=0; l<N; l++)
+                    sum+=tmpNN[i][l]*A[j][l];
+                P[i][j]=sum;
+            }
+    }
+
+    /**********************************************************************/
+    void computeInnovationCovariance()
+    {
+        // PHt=P*H', S=H*P*H'+R
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int r=0; r<M; r++)
+            {
+                double sum=0.0;
+                for (unsigned int j=0; j<N; j++)
+                    sum+=P[i][j]*H[r][j];
+                PHt[i][r]=sum;
+            }
+
+        for (unsigned int r=0; r<M; r++)
+            for (unsigned int c=0; c<M; c++)
+            {
+                double sum=R[r][c];
+                for (unsigned int j=0; j<N; j++)
+                    sum+=H[r][j]*PHt[j][c];
+                S[r][c]=sum;
+            }
+    }
+
+    /**********************************************************************/
+    bool computeGain()
+    {
+        // K=P*H'*inv(S), relying on computeInnovationCovariance()
+        if (!invert(S,invS))
+            return false;
+
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int r=0; r<M; r++)
+            {
+                double sum=0.0;
+                for (unsigned int c=0; c<M; c++)
+                    sum+=PHt[i][c]*invS[c][r];
+                K[i][r]=sum;
+            }
+
+        return true;
+    }
+
+    /**********************************************************************/
+    void updateCovariance()
+    {
+        // P=(I-K*H)*P=P-K*(P*H')'
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int j=0; j<N; j++)
+            {
+                double sum=0.0;
+                for (unsigned int r=0; r<M; r++)
+                    sum+=K[i][r]*PHt[j][r];
+                P[i][j]-=sum;
+            }
+    }
+
+    /**********************************************************************/
+    void updateState()
+    {
+        // x+=K*e, with the innovation e already in place
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int r=0; r<M; r++)
+                x[i]+=K[i][r]*e[r];
+
+        validationGate=0.0;
+        for (unsigned int r=0; r<M; r++)
+            for (unsigned int c=0; c<M; c++)
+                validationGate+=e[r]*invS[r][c]*e[c];
+    }
+
+public:
+    /**
+     * Default constructor: all the matrices are zero, except for
+     * the state transition matrix and the measurement noise
+     * covariance that are identities.
+     */
+    FixedKalman()
+    {
+        memset(A,0,sizeof(A)); memset(B,0,sizeof(B));
+        memset(H,0,sizeof(H)); memset(Q,0,sizeof(Q));
+        memset(R,0,sizeof(R)); memset(x,0,sizeof(x));
+        memset(P,0,sizeof(P)); memset(K,0,sizeof(K));
+        memset(S,0,sizeof(S)); memset(invS,0,sizeof(invS));
+        memset(e,0,sizeof(e));
+
+        for (unsigned int i=0; i<N; i++)
+            A[i][i]=1.0;
+        for (unsigned int i=0; i<M; i++)
+            R[i][i]=1.0;
+
+        validationGate=0.0;
+        steadyState=false;
+    }
+
+    /**
+     * Set initial state and error covariance.
+     *
+     * @param _x0 Initial condition for estimated state (N
+     *            elements).
+     * @param _P0 Initial condition for estimated error covariance.
+     *            If in steady-state mode, the covariance is kept
+     *            to its steady-state value.
+     * @return true/false on success/failure.
+     */
+    bool init(const yarp::sig::Vector &_x0, const yarp::sig::Matrix &_P0)
+    {
+        if ((_x0.length()!=N) || (_P0.rows()!=(int)N) || (_P0.cols()!=(int)N))
+            return false;
+
+        for (unsigned int i=0; i<N; i++)
+            x[i]=_x0[i];
+
+        if (!steadyState)
+            fromMatrix(_P0,&P[0][0],N,N);
+
+        return true;
+    }
+
+    /**
+     * Predicts the next state vector given the current input.
+     *
+     * @param u Current input (U elements); NULL stands for zero
+     *          input.
+     * @return Estimated state vector (N elements).
+     */
+    const double *predict(const double *u=NULL)
+    {
+        double xn[N];
+        for (unsigned int i=0; i<N; i++)
+        {
+            double sum=0.0;
+            for (unsigned int j=0; j<N; j++)
+                sum+=A[i][j]*x[j];
+            if (u!=NULL)
+                for (unsigned int j=0; j<U; j++)
+                    sum+=B[i][j]*u[j];
+            xn[i]=sum;
+        }
+        memcpy(x,xn,sizeof(x));
+
+        if (!steadyState)
+        {
+            propagateCovariance();
+            computeInnovationCovariance();
+        }
+
+        validationGate=0.0;
+        return x;
+    }
+
+    /**
+     * Corrects the current estimation of the state vector given the
+     * current measurement.
+     *
+     * @param z Current measurement (M elements).
+     * @return true/false on success/failure, which is due to a
+     *         singular innovation covariance; in that case the
+     *         estimate is left unchanged.
+     */
+    bool correct(const double *z)
+    {
+        if (!steadyState)
+        {
+            if (!computeGain())
+                return false;
+            updateCovariance();
+        }
+
+        for (unsigned int r=0; r<M; r++)
+        {
+            double y=0.0;
+            for (unsigned int j=0; j<N; j++)
+                y+=H[r][j]*x[j];
+            e[r]=z[r]-y;
+        }
+
+        updateState();
+        return true;
+    }
+
+    /**
+     * Performs a prediction with the current input and then
+     * corrects the result with the current measurement.
+     *
+     * @param u Current input (U elements).
+     * @param z Current measurement (M elements).
+     * @return Estimated state vector (N elements).
+     */
+    const double *filt(const double *u, const double *z)
+    {
+        predict(u);
+        correct(z);
+        return x;
+    }
+
+    /**
+     * Performs a prediction with zero input and then corrects the
+     * result with the current measurement.
+     *
+     * @param z Current measurement (M elements).
+     * @return Estimated state vector (N elements).
+     */
+    const double *filt(const double *z)
+    {
+        return filt(NULL,z);
+    }
+
+    /**
+     * Iterates the Riccati equation starting from the current error
+     * covariance until the Kalman gain settles down, and then
+     * freezes the gain to the value found.
+     *
+     * @param maxIter the maximum number of iterations.
+     * @param tol the tolerance on the change of the gain elements.
+     * @return true if the gain converged; in case of failure the
+     *         estimator is left unchanged.
+     * @note The filter stays in steady-state mode until
+     *       setSteadyState(false) is called.
+     */
+    bool computeSteadyState(const int maxIter=10000, const double tol=1e-9)
+    {
+        double P0[N][N],K0[N][M],S0[M][M],invS0[M][M],PHt0[N][M];
+        double Kold[N][M];
+        memcpy(P0,P,sizeof(P));         memcpy(K0,K,sizeof(K));
+        memcpy(S0,S,sizeof(S));         memcpy(invS0,invS,sizeof(invS));
+        memcpy(PHt0,PHt,sizeof(PHt));
+
+        for (int iter=0; iter<maxIter; iter++)
+        {
+            memcpy(Kold,K,sizeof(K));
+            propagateCovariance();
+            computeInnovationCovariance();
+            if (!computeGain())
+                break;
+            updateCovariance();
+
+            double delta=0.0;
+            for (unsigned int i=0; i<N; i++)
+                for (unsigned int r=0; r<M; r++)
+                    delta=std::max(delta,fabs(K[i][r]-Kold[i][r]));
+
+            if ((iter>0) && (delta<tol))
+            {
+                // keep the prior covariance of the steady state
+                propagateCovariance();
+                computeInnovationCovariance();
+                steadyState=true;
+                return true;
+            }
+        }
+
+        memcpy(P,P0,sizeof(P));         memcpy(K,K0,sizeof(K));
+        memcpy(S,S0,sizeof(S));         memcpy(invS,invS0,sizeof(invS));
+        memcpy(PHt,PHt0,sizeof(PHt));
+        return false;
+    }
+
+    /**
+     * Enables or disables the steady-state mode.
+     *
+     * @param sw true to freeze the current gain, false to resume
+     *           the propagation of the covariance.
+     */
+    void setSteadyState(const bool sw) { steadyState=sw; }
+
+    /**
+     * Returns true if in steady-state mode.
+     */
+    bool isSteadyState() const { return steadyState; }
+
+    /**
+     * Returns the estimated state (N elements).
+     */
+    const double *get_x() const { return x; }
+
+    /**
+     * Returns the estimated output.
+     *
+     * @param y the array of M elements filled with the output.
+     */
+    void get_y(double *y) const
+    {
+        for (unsigned int r=0; r<M; r++)
+        {
+            y[r]=0.0;
+            for (unsigned int j=0; j<N; j++)
+                y[r]+=H[r][j]*x[j];
+        }
+    }
+
+    /**
+     * Returns the validation gate.
+     * @note The validation gate is meaningful only after
+     *       correction.
+     */
+    double get_ValidationGate() const { return validationGate; }
+
+    yarp::sig::Matrix get_P() const { return toMatrix(&P[0][0],N,N); }
+    yarp::sig::Matrix get_S() const { return toMatrix(&S[0][0],M,M); }
+    yarp::sig::Matrix get_K() const { return toMatrix(&K[0][0],N,M); }
+    yarp::sig::Matrix get_A() const { return toMatrix(&A[0][0],N,N); }
+    yarp::sig::Matrix get_B() const { return toMatrix(&B[0][0],N,U); }
+    yarp::sig::Matrix get_H() const { return toMatrix(&H[0][0],M,N); }
+    yarp::sig::Matrix get_Q() const { return toMatrix(&Q[0][0],N,N); }
+    yarp::sig::Matrix get_R() const { return toMatrix(&R[0][0],M,M); }
+
+    /**
+     * Sets the state transition matrix (NxN).
+     * @return true/false on success/failure.
+     */
+    bool set_A(const yarp::sig::Matrix &_A) { return fromMatrix(_A,&A[0][0],N,N); }
+
+    /**
+     * Sets the input matrix (NxU).
+     * @return true/false on success/failure.
+     */
+    bool set_B(const yarp::sig::Matrix &_B) { return fromMatrix(_B,&B[0][0],N,U); }
+
+    /**
+     * Sets the measurement matrix (MxN).
+     * @return true/false on success/failure.
+     */
+    bool set_H(const yarp::sig::Matrix &_H) { return fromMatrix(_H,&H[0][0],M,N); }
+
+    /**
+     * Sets the process noise covariance matrix (NxN).
+     * @return true/false on success/failure.
+     */
+    bool set_Q(const yarp::sig::Matrix &_Q) { return fromMatrix(_Q,&Q[0][0],N,N); }
+
+    /**
+     * Sets the measurement noise covariance matrix (MxM).
+     * @return true/false on success/failure.
+     */
+    bool set_R(const yarp::sig::Matrix &_R) { return fromMatrix(_R,&R[0][0],M,M); }
+
+    /**
+     * Destructor.
+     */
+    virtual ~FixedKalman() { }
+};
+
+
+/**
+* \ingroup Kalman
+*
+* Extended Kalman estimator with N states, M outputs and U
+* inputs.
+*
+* The process and measurement models are given by overriding
+* f(), h() and their Jacobians, which are evaluated at the
+* current estimate before each prediction and correction.
+*
+* @note The steady-state mode does not apply to this estimator.
+*/
+template<unsigned int N, unsigned int M, unsigned int U=1>
+class FixedExtendedKalman : public FixedKalman<N,M,U>
+{
+protected:
+    /**
+     * The process model.
+     * @param x the current state (N elements).
+     * @param u the current input (U elements).
+     * @param fx the next state (N elements).
+     */
+    virtual void f(const double *x, const double *u, double *fx) = 0;
+
+    /**
+     * The Jacobian of the process model.
+     * @param x the current state (N elements).
+     * @param u the current input (U elements).
+     * @param F the NxN Jacobian.
+     */
+    virtual void jacobian_f(const double *x, const double *u, double (&F)[N][N]) = 0;
+
+    /**
+     * The measurement model.
+     * @param x the current state (N elements).
+     * @param hx the expected measurement (M elements).
+     */
+    virtual void h(const double *x, double *hx) = 0;
+
+    /**
+     * The Jacobian of the measurement model.
+     * @param x the current state (N elements).
+     * @param Hx the MxN Jacobian.
+     */
+    virtual void jacobian_h(const double *x, double (&Hx)[M][N]) = 0;
+
+public:
+    /**
+     * Predicts the next state vector given the current input.
+     *
+     * @param u Current input (U elements); NULL stands for zero
+     *          input.
+     * @return Estimated state vector (N elements).
+     */
+    const double *predict(const double *u=NULL)
+    {
+        double zero[U];
+        if (u==NULL)
+        {
+            memset(zero,0,sizeof(zero));
+            u=zero;
+        }
+
+        double xn[N];
+        jacobian_f(this->x,u,this->A);
+        f(this->x,u,xn);
+        memcpy(this->x,xn,sizeof(xn));
+
+        this->propagateCovariance();
+        this->validationGate=0.0;
+        return this->x;
+    }
+
+    /**
+     * Corrects the current estimation of the state vector given the
+     * current measurement.
+     *
+     * @param z Current measurement (M elements).
+     * @return true/false on success/failure.
+     */
+    bool correct(const double *z)
+    {
+        double y[M];
+        jacobian_h(this->x,this->H);
+        h(this->x,y);
+
+        this->computeInnovationCovariance();
+        if (!this->computeGain())
+            return false;
+        this->updateCovariance();
+
+        for (unsigned int r=0; r<M; r++)
+            this->e[r]=z[r]-y[r];
+
+        this->updateState();
+        return true;
+    }
+
+    /**
+     * Performs a prediction with the current input and then
+     * corrects the result with the current measurement.
+     *
+     * @param u Current input (U elements).
+     * @param z Current measurement (M elements).
+     * @return Estimated state vector (N elements).
+     */
+    const double *filt(const double *u, const double *z)
+    {
+        predict(u);
+        correct(z);
+        return this->x;
+    }
+
+    /**
+     * Performs a prediction with zero input and then corrects the
+     * result with the current measurement.
+     *
+     * @param z Current measurement (M elements).
+     * @return Estimated state vector (N elements).
+     */
+    const double *filt(const double *z)
+    {
+        return filt(NULL,z);
+    }
+
+    /**
+     * Returns the estimated output.
+     *
+     * @param y the array of M elements filled with the output.
+     */
+    void get_y(double *y) { h(this->x,y); }
+};
+
+
+/**
+* \ingroup Kalman
+*
+* A bank of L linear Kalman estimators sharing the same model
+* structure (A, B and H) but with their own state, covariances
+* and noise levels, e.g. one estimator per joint.
+*
+* The bank is stored in structure-of-arrays form: the element
+* (i,j) of a given quantity is kept as a contiguous array of L
+* values, one per estimator, so that all the estimators are
+* advanced together by loops whose innermost index runs over the
+* bank on contiguous memory.
+*
+* Inputs and measurements are exchanged in the same layout: the
+* j-th component of the k-th estimator is found at index j*L+k.
+*
+* @note The measurement noise covariances must be positive
+*       definite, as the innovation covariances are inverted
+*       without pivoting.
+*/
+template<unsigned int N, unsigned int M, unsigned int U=1>
+class FixedKalmanBank
+{
+protected:
+    double A[N][N];
+    double B[N][U];
+    double H[M][N];
+    size_t L;
+
+    std::vector<double> x, P, Q, R;
+    std::vector<double> S, invS, K, PHt, gate;
+    std::vector<double> tmpN, tmpNN, tmpMM, tmpM;
+    std::vector<double> piv, fac;
+
+    // pointer to the values of the element i of a quantity
+    double *at(std::vector<double> &v, const size_t i) { return &v[i*L]; }
+    const double *at(const std::vector<double> &v, const size_t i) const { return &v[i*L]; }
+
+    /**********************************************************************/
+    bool setBank(std::vector<double> &v, const yarp::sig::Matrix &in,
+                 const unsigned int rows, const unsigned int cols,
+                 const size_t first, const size_t last)
+    {
+        if ((in.rows()!=(int)rows) || (in.cols()!=(int)cols) || (last>L))
+            return false;
+
+        for (unsigned int r=0; r<rows; r++)
+            for (unsigned int c=0; c<cols; c++)
+            {
+                double *p=at(v,r*cols+c);
+                for (size_t k=first; k<last; k++)
+                    p[k]=in(r,c);
+            }
+
+        return true;
+    }
+
+    /**********************************************************************/
+    yarp::sig::Matrix getBank(const std::vector<double> &v, const unsigned int rows,
+                              const unsigned int cols, const size_t k) const
+    {
+        yarp::sig::Matrix out(rows,cols);
+        for (unsigned int r=0; r<rows; r++)
+            for (unsigned int c=0; c<cols; c++)
+                out(r,c)=at(v,r*cols+c)[k];
+
+        return out;
+    }
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param num the number of estimators of the bank.
+     * @note The matrices are initialized as in FixedKalman.
+     */
+    FixedKalmanBank(const size_t num) : L(num)
+    {
+        memset(A,0,sizeof(A)); memset(B,0,sizeof(B));
+        memset(H,0,sizeof(H));
+        for (unsigned int i=0; i<N; i++)
+            A[i][i]=1.0;
+
+        x.assign(N*L,0.0);     P.assign(N*N*L,0.0);
+        Q.assign(N*N*L,0.0);   R.assign(M*M*L,0.0);
+        S.assign(M*M*L,0.0);   invS.assign(M*M*L,0.0);
+        K.assign(N*M*L,0.0);   PHt.assign(N*M*L,0.0);
+        gate.assign(L,0.0);
+        tmpN.assign(N*L,0.0);  tmpNN.assign(N*N*L,0.0);
+        tmpMM.assign(M*M*L,0.0); tmpM.assign(M*L,0.0);
+        piv.assign(L,0.0);     fac.assign(L,0.0);
+
+        for (unsigned int i=0; i<M; i++)
+        {
+            double *p=at(R,i*M+i);
+            for (size_t k=0; k<L; k++)
+                p[k]=1.0;
+        }
+    }
+
+    /**
+     * Returns the number of estimators of the bank.
+     */
+    size_t size() const { return L; }
+
+    /**
+     * Set initial state and error covariance of all the estimators.
+     * @return true/false on success/failure.
+     */
+    bool init(const yarp::sig::Vector &_x0, const yarp::sig::Matrix &_P0)
+    {
+        if ((_x0.length()!=N) || !setBank(P,_P0,N,N,0,L))
+            return false;
+
+        for (unsigned int i=0; i<N; i++)
+        {
+            double *p=at(x,i);
+            for (size_t k=0; k<L; k++)
+                p[k]=_x0[i];
+        }
+
+        return true;
+    }
+
+    /**
+     * Set initial state and error covariance of the estimator k.
+     * @return true/false on success/failure.
+     */
+    bool init(const size_t k, const yarp::sig::Vector &_x0, const yarp::sig::Matrix &_P0)
+    {
+        if ((_x0.length()!=N) || (k>=L) || !setBank(P,_P0,N,N,k,k+1))
+            return false;
+
+        for (unsigned int i=0; i<N; i++)
+            at(x,i)[k]=_x0[i];
+
+        return true;
+    }
+
+    /**
+     * Predicts the next states given the current inputs.
+     *
+     * @param u Current inputs (U*L elements); NULL stands for zero
+     *          inputs.
+     */
+    void predict(const double *u=NULL)
+    {
+        // x=A*x+B*u
+        for (unsigned int i=0; i<N; i++)
+        {
+            double *xn=at(tmpN,i);
+            for (size_t k=0; k<L; k++)
+                xn[k]=0.0;
+
+            for (unsigned int j=0; j<N; j++)
+            {
+                const double a=A[i][j];
+                const double *xj=at(x,j);
+                for (size_t k=0; k<L; k++)
+                    xn[k]+=a*xj[k];
+            }
+
+            if (u!=NULL)
+            {
+                for (unsigned int j=0; j<U; j++)
+                {
+                    const double b=B[i][j];
+                    const double *uj=u+j*L;
+                    for (size_t k=0; k<L; k++)
+                        xn[k]+=b*uj[k];
+                }
+            }
+        }
+        x.swap(tmpN);
+
+        // P=A*P*A'+Q
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int j=0; j<N; j++)
+            {
+                double *t=at(tmpNN,i*N+j);
+                for (size_t k=0; k<L; k++)
+                    t[k]=0.0;
+
+                for (unsigned int l=0; l<N; l++)
+                {
+                    const double a=A[i][l];
+                    const double *p=at(P,l*N+j);
+                    for (size_t k=0; k<L; k++)
+                        t[k]+=a*p[k];
+                }
+            }
+
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int j=0; j<N; j++)
+            {
+                double *p=at(P,i*N+j);
+                const double *q=at(Q,i*N+j);
+                for (size_t k=0; k<L; k++)
+                    p[k]=q[k];
+
+                for (unsigned int l=0; l<N; l++)
+                {
+                    const double a=A[j][l];
+                    const double *t=at(tmpNN,i*N+l);
+                    for (size_t k=0; k<L; k++)
+                        p[k]+=a*t[k];
+                }
+            }
+
+        for (size_t k=0; k<L; k++)
+            gate[k]=0.0;
+    }
+
+    /**
+     * Corrects the current estimations given the current
+     * measurements.
+     *
+     * @param z Current measurements (M*L elements).
+     */
+    void correct(const double *z)
+    {
+        // PHt=P*H'
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int r=0; r<M; r++)
+            {
+                double *t=at(PHt,i*M+r);
+                for (size_t k=0; k<L; k++)
+                    t[k]=0.0;
+
+                for (unsigned int j=0; j<N; j++)
+                {
+                    const double h=H[r][j];
+                    const double *p=at(P,i*N+j);
+                    for (size_t k=0; k<L; k++)
+                        t[k]+=h*p[k];
+                }
+            }
+
+        // S=H*P*H'+R, then inverted in tmpMM by Gauss-Jordan elimination
+        for (unsigned int r=0; r<M; r++)
+            for (unsigned int c=0; c<M; c++)
+            {
+                double *s=at(S,r*M+c);
+                double *w=at(tmpMM,r*M+c);
+                double *is=at(invS,r*M+c);
+                const double *rr=at(R,r*M+c);
+                for (size_t k=0; k<L; k++)
+                    s[k]=rr[k];
+
+                for (unsigned int j=0; j<N; j++)
+                {
+                    const double h=H[r][j];
+                    const double *t=at(PHt,j*M+c);
+                    for (size_t k=0; k<L; k++)
+                        s[k]+=h*t[k];
+                }
+
+                const double id=(r==c)?1.0:0.0;
+                for (size_t k=0; k<L; k++)
+                {
+                    w[k]=s[k];
+                    is[k]=id;
+                }
+            }
+
+        for (unsigned int p=0; p<M; p++)
+        {
+            const double *wpp=at(tmpMM,p*M+p);
+            for (size_t k=0; k<L; k++)
+                piv[k]=1.0/wpp[k];
+
+            for (unsigned int c=0; c<M; c++)
+            {
+                double *w=at(tmpMM,p*M+c);
+                double *is=at(invS,p*M+c);
+                for (size_t k=0; k<L; k++)
+                {
+                    w[k]*=piv[k];
+                    is[k]*=piv[k];
+                }
+            }
+
+            for (unsigned int r=0; r<M; r++)
+            {
+                if (r==p)
+                    continue;
+
+                // the factors are saved since the column p gets modified
+                const double *wrp=at(tmpMM,r*M+p);
+                for (size_t k=0; k<L; k++)
+                    fac[k]=wrp[k];
+
+                for (unsigned int c=0; c<M; c++)
+                {
+                    double *w=at(tmpMM,r*M+c);
+                    double *is=at(invS,r*M+c);
+                    const double *wp=at(tmpMM,p*M+c);
+                    const double *isp=at(invS,p*M+c);
+                    for (size_t k=0; k<L; k++)
+                    {
+                        w[k]-=fac[k]*wp[k];
+                        is[k]-=fac[k]*isp[k];
+                    }
+                }
+            }
+        }
+
+        // K=P*H'*inv(S)
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int r=0; r<M; r++)
+            {
+                double *kk=at(K,i*M+r);
+                for (size_t k=0; k<L; k++)
+                    kk[k]=0.0;
+
+                for (unsigned int c=0; c<M; c++)
+                {
+                    const double *t=at(PHt,i*M+c);
+                    const double *is=at(invS,c*M+r);
+                    for (size_t k=0; k<L; k++)
+                        kk[k]+=t[k]*is[k];
+                }
+            }
+
+        // P=P-K*(P*H')'
+        for (unsigned int i=0; i<N; i++)
+            for (unsigned int j=0; j<N; j++)
+            {
+                double *p=at(P,i*N+j);
+                for (unsigned int r=0; r<M; r++)
+                {
+                    const double *kk=at(K,i*M+r);
+                    const double *t=at(PHt,j*M+r);
+                    for (size_t k=0; k<L; k++)
+                        p[k]-=kk[k]*t[k];
+                }
+            }
+
+        // e=z-H*x
+        for (unsigned int r=0; r<M; r++)
+        {
+            double *e=at(tmpM,r);
+            const double *zr=z+r*L;
+            for (size_t k=0; k<L; k++)
+                e[k]=zr[k];
+
+            for (unsigned int j=0; j<N; j++)
+            {
+                const double h=H[r][j];
+                const double *xj=at(x,j);
+                for (size_t k=0; k<L; k++)
+                    e[k]-=h*xj[k];
+            }
+        }
+
+        // x+=K*e
+        for (unsigned int i=0; i<N; i++)
+        {
+            double *xi=at(x,i);
+            for (unsigned int r=0; r<M; r++)
+            {
+                const double *kk=at(K,i*M+r);
+                const double *e=at(tmpM,r);
+                for (size_t k=0; k<L; k++)
+                    xi[k]+=kk[k]*e[k];
+            }
+        }
+
+        // validation gate e'*inv(S)*e
+        for (size_t k=0; k<L; k++)
+            gate[k]=0.0;
+
+        for (unsigned int r=0; r<M; r++)
+            for (unsigned int c=0; c<M; c++)
+            {
+                const double *er=at(tmpM,r);
+                const double *ec=at(tmpM,c);
+                const double *is=at(invS,r*M+c);
+                for (size_t k=0; k<L; k++)
+                    gate[k]+=er[k]*is[k]*ec[k];
+            }
+    }
+
+    /**
+     * Performs a prediction with the current inputs and then
+     * corrects the result with the current measurements.
+     *
+     * @param u Current inputs (U*L elements).
+     * @param z Current measurements (M*L elements).
+     */
+    void filt(const double *u, const double *z)
+    {
+        predict(u);
+        correct(z);
+    }
+
+    /**
+     * Returns the estimated states (N*L elements).
+     */
+    const double *get_x() const { return &x[0]; }
+
+    /**
+     * Returns the estimated state of the estimator k.
+     */
+    yarp::sig::Vector get_x(const size_t k) const
+    {
+        yarp::sig::Vector out(N);
+        for (unsigned int i=0; i<N; i++)
+            out[i]=at(x,i)[k];
+
+        return out;
+    }
+
+    /**
+     * Returns the estimated state covariance of the estimator k.
+     */
+    yarp::sig::Matrix get_P(const size_t k) const { return getBank(P,N,N,k); }
+
+    /**
+     * Returns the Kalman gain of the estimator k.
+     */
+    yarp::sig::Matrix get_K(const size_t k) const { return getBank(K,N,M,k); }
+
+    /**
+     * Returns the validation gates (L elements).
+     */
+    const double *get_ValidationGate() const { return &gate[0]; }
+
+    /**
+     * Sets the state transition matrix (NxN) shared by the bank.
+     * @return true/false on success/failure.
+     */
+    bool set_A(const yarp::sig::Matrix &_A)
+    {
+        if ((_A.rows()!=(int)N) || (_A.cols()!=(int)N))
+            return false;
+
+        for (unsigned int r=0; r<N; r++)
+            for (unsigned int c=0; c<N; c++)
+                A[r][c]=_A(r,c);
+
+        return true;
+    }
+
+    /**
+     * Sets the input matrix (NxU) shared by the bank.
+     * @return true/false on success/failure.
+     */
+    bool set_B(const yarp::sig::Matrix &_B)
+    {
+        if ((_B.rows()!=(int)N) || (_B.cols()!=(int)U))
+            return false;
+
+        for (unsigned int r=0; r<N; r++)
+            for (unsigned int c=0; c<U; c++)
+                B[r][c]=_B(r,c);
+
+        return true;
+    }
+
+    /**
+     * Sets the measurement matrix (MxN) shared by the bank.
+     * @return true/false on success/failure.
+     */
+    bool set_H(const yarp::sig::Matrix &_H)
+    {
+        if ((_H.rows()!=(int)M) || (_H.cols()!=(int)N))
+            return false;
+
+        for (unsigned int r=0; r<M; r++)
+            for (unsigned int c=0; c<N; c++)
+                H[r][c]=_H(r,c);
+
+        return true;
+    }
+
+    /**
+     * Sets the process noise covariance matrix (NxN) of all the
+     * estimators.
+     * @return true/false on success/failure.
+     */
+    bool set_Q(const yarp::sig::Matrix &_Q) { return setBank(Q,_Q,N,N,0,L); }
+
+    /**
+     * Sets the process noise covariance matrix (NxN) of the
+     * estimator k.
+     * @return true/false on success/failure.
+     */
+    bool set_Q(const size_t k, const yarp::sig::Matrix &_Q) { return setBank(Q,_Q,N,N,k,k+1); }
+
+    /**
+     * Sets the measurement noise covariance matrix (MxM) of all the
+     * estimators.
+     * @return true/false on success/failure.
+     */
+    bool set_R(const yarp::sig::Matrix &_R) { return setBank(R,_R,M,M,0,L); }
+
+    /**
+     * Sets the measurement noise covariance matrix (MxM) of the
+     * estimator k.
+     * @return true/false on success/failure.
+     */
+    bool set_R(const size_t k, const yarp::sig::Matrix &_R) { return setBank(R,_R,M,M,k,k+1); }
+};
+
+}
+
+}
+
+#endif
+
+
@@ -35,6 +35,7 @@
 #include <iCub/ctrl/math.h>
 #include <iCub/ctrl/pids.h>
 #include <iCub/ctrl/kalman.h>
+#include <iCub/ctrl/fixedKalman.h>
 #include <iCub/ctrl/filters.h>
 #include <iCub/ctrl/minJerkCtrl.h>
 #include <iCub/ctrl/adaptWinPolyEstimator.h>
@@ -64,18 +65,28 @@ namespace ctrl
 class OnlineDCMotorEstimator
 {
 protected:
-    yarp::sig::Matrix A;
-    yarp::sig::Matrix F;
-    yarp::sig::Vector B;
-    yarp::sig::Matrix C;
-    yarp::sig::Matrix Ct;
-    yarp::sig::Matrix Q;
-    yarp::sig::Matrix P;
-    yarp::sig::Vector x;
+    /**
+    * EKF on the state made of position, velocity, 
+    * \f$ 1/\tau \f$ and \f$ K/\tau. \f$
+    */
+    class EKF : public FixedExtendedKalman<4,1,1>
+    {
+    protected:
+        void f(const double *x, const double *u, double *fx);
+        void jacobian_f(const double *x, const double *u, double (&F)[4][4]);
+        void h(const double *x, double *hx);
+        void jacobian_h(const double *x, double (&Hx)[1][4]);
+
+    public:
+        double Ts;
+        void init(const double q, const double r, const double P0,
+                  const yarp::sig::Vector &x0);
+        void init(const double P0, const yarp::sig::Vector &x0);
+    };
+
+    EKF ekf;
     yarp::sig::Vector _x;
     double uOld;
-    double Ts;
-    double R;
 
 public:
     /**
@@ -134,7 +145,7 @@ public:
      * 
      * @return Estimated error covariance.
      */
-    yarp::sig::Matrix get_P() const { return P; }
+    yarp::sig::Matrix get_P() const { return ekf.get_P(); }
 
     /**
      * Return the system parameters.
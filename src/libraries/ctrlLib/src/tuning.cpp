@@ -33,6 +33,89 @@ using namespace yarp::math;
 using namespace iCub::ctrl;
 
 
+/**********************************************************************/
+void OnlineDCMotorEstimator::EKF::f(const double *x, const double *u,
+                                    double *fx)
+{
+    double _exp=exp(-Ts*x[2]);
+    double _exp_1=1.0-_exp;
+    double _tmp_1=(Ts*x[2]-_exp_1)/(x[2]*x[2]);
+
+    fx[0]=x[0]+(_exp_1/x[2])*x[1]+x[3]*_tmp_1*u[0];
+    fx[1]=_exp*x[1]+x[3]*(_exp_1/x[2])*u[0];
+    fx[2]=x[2];
+    fx[3]=x[3];
+}
+
+
+/**********************************************************************/
+void OnlineDCMotorEstimator::EKF::jacobian_f(const double *x, const double *u,
+                                             double (&F)[4][4])
+{
+    const double &x2=x[1];
+    const double &x3=x[2];
+    const double &x4=x[3];
+    const double &uOld=u[0];
+
+    double _exp=exp(-Ts*x3);
+    double _exp_1=1.0-_exp;
+    double _x3_2=x3*x3;
+    double _tmp_1=(Ts*x3-_exp_1)/_x3_2;
+    double B0=x4*_tmp_1;
+
+    memset(F,0,sizeof(F));
+    F[0][0]=F[2][2]=F[3][3]=1.0;
+
+    F[0][1]=_exp_1/x3;
+    F[1][1]=_exp;
+
+    F[0][2]=-(x2*_exp_1)/_x3_2      + (uOld*x4*Ts*_exp_1)/_x3_2 - (2.0*uOld*B0)/x3 + (Ts*x2*_exp)/x3;
+    F[1][2]=-(uOld*x4*_exp_1)/_x3_2 - Ts*x2*_exp                + (uOld*x4*Ts*_exp)/x3;
+
+    F[0][3]=uOld*_tmp_1;
+    F[1][3]=uOld*F[0][1];
+}
+
+
+/**********************************************************************/
+void OnlineDCMotorEstimator::EKF::h(const double *x, double *hx)
+{
+    hx[0]=x[0];
+}
+
+
+/**********************************************************************/
+void OnlineDCMotorEstimator::EKF::jacobian_h(const double *x,
+                                             double (&Hx)[1][4])
+{
+    Hx[0][0]=1.0;
+    Hx[0][1]=Hx[0][2]=Hx[0][3]=0.0;
+}
+
+
+/**********************************************************************/
+void OnlineDCMotorEstimator::EKF::init(const double q, const double r,
+                                       const double P0, const Vector &x0)
+{
+    Matrix _R(1,1); _R(0,0)=r;
+    set_Q(q*eye(4,4));
+    set_R(_R);
+    init(P0,x0);
+}
+
+
+/**********************************************************************/
+void OnlineDCMotorEstimator::EKF::init(const double P0, const Vector &x0)
+{
+    // the filter works with 1/tau and K/tau
+    Vector _x0=x0.subVector(0,3);
+    _x0[2]=1.0/x0[2];
+    _x0[3]=x0[3]/x0[2];
+
+    FixedExtendedKalman<4,1,1>::init(_x0,P0*eye(4,4));
+}
+
+
 /**********************************************************************/
 OnlineDCMotorEstimator::OnlineDCMotorEstimator()
 {
@@ -50,20 +133,9 @@ bool OnlineDCMotorEstimator::init(const double Ts, const double Q,
     if (x0.length()<4)
         return false;
 
-    A=F=eye(4,4);
-    B.resize(4,0.0);
-    C.resize(1,4); C(0,0)=1.0;
-    Ct=C.transposed();
-
-    P=P0*eye(4,4);
-    this->Q=Q*eye(4,4);
-    this->R=R;
-
-    this->Ts=Ts;
-    x=_x=x0.subVector(0,3);
-    x[2]=1.0/_x[2];
-    x[3]=_x[3]/_x[2];
-
+    ekf.Ts=Ts;
+    ekf.init(Q,R,P0,x0);
+    _x=x0.subVector(0,3);
     uOld=0.0;
 
     return true;
@@ -76,11 +148,8 @@ bool OnlineDCMotorEstimator::init(const double P0, const Vector &x0)
     if (x0.length()<4)
         return false;
 
-    P=P0*eye(4,4);
-    x=_x=x0.subVector(0,3);
-    x[2]=1.0/_x[2];
-    x[3]=_x[3]/_x[2];
-
+    ekf.init(P0,x0);
+    _x=x0.subVector(0,3);
     uOld=0.0;
 
     return true;
@@ -90,42 +159,7 @@ bool OnlineDCMotorEstimator::init(const double P0, const Vector &x0)
 /**********************************************************************/
 Vector OnlineDCMotorEstimator::estimate(const double u, const double y)
 {
-    double &x1=x[0];
-    double &x2=x[1];
-    double &x3=x[2];
-    double &x4=x[3];
-
-    double _exp=exp(-Ts*x3);
-    double _exp_1=1.0-_exp;
-    double _x3_2=x3*x3;
-    double _tmp_1=(Ts*x3-_exp_1)/_x3_2;
-
-    A(0,1)=_exp_1/x3;
-    A(1,1)=_exp;
-
-    B[0]=x4*_tmp_1;
-    B[1]=x4*A(0,1);
-
-    F(0,1)=A(0,1);
-    F(1,1)=A(1,1);
-
-    F(0,2)=-(x2*_exp_1)/_x3_2      + (uOld*x4*Ts*_exp_1)/_x3_2 - (2.0*uOld*B[0])/x3 + (Ts*x2*_exp)/x3;
-    F(1,2)=-(uOld*x4*_exp_1)/_x3_2 - Ts*x2*_exp                + (uOld*x4*Ts*_exp)/x3;
-
-    F(0,3)=uOld*_tmp_1;
-    F(1,3)=uOld*A(0,1);
-
-    // prediction
-    x=A*x+B*uOld;
-    P=F*P*F.transposed()+Q;
-
-    // Kalman gain
-    Matrix tmpMat=C*P*Ct;
-    Matrix K=P*Ct/(tmpMat(0,0)+R);
-
-    // correction
-    x+=K*(y-C*x);
-    P=(eye(4,4)-K*C)*P;
+    const double *x=ekf.filt(&uOld,&y);
 
     _x[0]=x[0];
     _x[1]=x[1];
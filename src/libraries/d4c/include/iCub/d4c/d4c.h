@@ -95,6 +95,10 @@ public:
     * \b offline: example (offline), lets the client/server start in 
     *    offline mode.
     *  
+    * \b threads <int>: example (threads 4), specifies the number of
+    *    threads used to simulate trajectories in batch (see
+    *    getTrajectories()).
+    *  
     * \b verbosity <int>: example (verbosity 3), specifies the 
     *    verbosity level of print-outs messages.
     *  
@@ -435,6 +439,31 @@ public:
                                const unsigned int maxIterations=D4C_DEFAULT_MAXITERATIONS,
                                const double Ts=D4C_DEFAULT_TS_DISABLED) = 0;
 
+    /**
+    * Retrieve the simulated trajectories as evolved from a batch of
+    * initial conditions, all sharing the current field. 
+    * @param x0 the list of initial states, each given as a 7-d
+    *           vector of position and orientation (axis/angle).
+    * @param xdot0 the list of initial velocities, each given as a
+    *           7-d vector; if empty, the initial velocities are
+    *           zero.
+    * @param trajPos the list of trajectories (position), one for
+    *            each initial condition.
+    * @param trajOrien the list of trajectories (orientation), one
+    *            for each initial condition.
+    * @param maxIterations maximum number of iterations performed to reach 
+    *            the target.
+    * @param Ts integration period [s]. If Ts<=0.0 then the 
+    *           configuration option "period" is used.
+    * @return true/false if successful/failed.
+    */
+    virtual bool getTrajectories(const std::deque<yarp::sig::Vector> &x0,
+                                 const std::deque<yarp::sig::Vector> &xdot0,
+                                 std::deque<std::deque<yarp::sig::Vector> > &trajPos,
+                                 std::deque<std::deque<yarp::sig::Vector> > &trajOrien,
+                                 const unsigned int maxIterations=D4C_DEFAULT_MAXITERATIONS,
+                                 const double Ts=D4C_DEFAULT_TS_DISABLED) = 0;
+
     /**
     * Execute the simulated trajectory provided by the user.
     * @param trajPos a list containing the whole trajectory of 
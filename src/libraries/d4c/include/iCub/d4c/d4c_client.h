@@ -91,6 +91,12 @@ public:
                        std::deque<yarp::sig::Vector> &trajOrien,
                        const unsigned int maxIterations=D4C_DEFAULT_MAXITERATIONS,
                        const double Ts=D4C_DEFAULT_TS_DISABLED);
+    bool getTrajectories(const std::deque<yarp::sig::Vector> &x0,
+                         const std::deque<yarp::sig::Vector> &xdot0,
+                         std::deque<std::deque<yarp::sig::Vector> > &trajPos,
+                         std::deque<std::deque<yarp::sig::Vector> > &trajOrien,
+                         const unsigned int maxIterations=D4C_DEFAULT_MAXITERATIONS,
+                         const double Ts=D4C_DEFAULT_TS_DISABLED);
     bool executeTrajectory(const std::deque<yarp::sig::Vector> &trajPos,
                            const std::deque<yarp::sig::Vector> &trajOrien,
                            const double trajTime);
@@ -22,6 +22,7 @@
 #include <string>
 #include <map>
 #include <deque>
+#include <vector>
 #include <yarp/os/RateThread.h>
 #include <yarp/os/PortReader.h>
 #include <yarp/os/Port.h>
@@ -41,6 +42,40 @@ namespace iCub
 namespace d4c
 {
 
+// items flattened into contiguous per-type arrays that are evaluated
+// with plain loops; being a plain value
+// type, a copy is a snapshot of the field which can be simulated
+// regardless of the changes occurring meanwhile to the items table
+class FieldEngine
+{
+protected:
+    // targets
+    std::vector<double> tcx,tcy,tcz;
+    std::vector<double> tK,tD;
+
+    // obstacles: center, transposed rotation matrix,
+    // reciprocal of the squared radii, gain and tails mask
+    std::vector<double> ocx,ocy,ocz;
+    std::vector<double> or00,or01,or02;
+    std::vector<double> or10,or11,or12;
+    std::vector<double> or20,or21,or22;
+    std::vector<double> oi0,oi1,oi2;
+    std::vector<double> oG,ocut;
+
+public:
+    void   clear();
+    void   addTarget(const yarp::sig::Vector &center, const double K, const double D);
+    void   addObstacle(const yarp::sig::Vector &center, const yarp::sig::Vector &orientation,
+                       const yarp::sig::Vector &radius, const double G, const bool cut_tails);
+    size_t size() const { return tK.size()+oG.size(); }
+    void   evaluate(const double *x, const double *xdot, double *field) const;
+    void   simulate(const yarp::sig::Vector &x0, const yarp::sig::Vector &xdot0,
+                    const unsigned int maxIterations, const double Ts,
+                    std::deque<yarp::sig::Vector> &trajPos,
+                    std::deque<yarp::sig::Vector> &trajOrien) const;
+};
+
+
 // ancestral class
 class Item
 {
@@ -59,6 +94,7 @@ public:
     virtual yarp::os::Property toProperty() const;
     virtual yarp::sig::Vector getField(const yarp::sig::Vector &x,
                                        const yarp::sig::Vector &xdot)=0;
+    virtual void flatten(FieldEngine &engine) const=0;
     virtual ~Item() { }
 };
 
@@ -75,6 +111,7 @@ public:
     yarp::os::Property toProperty() const;
     yarp::sig::Vector getField(const yarp::sig::Vector &x,
                                const yarp::sig::Vector &xdot);
+    void flatten(FieldEngine &engine) const;
 };
 
 
@@ -90,10 +127,12 @@ public:
     yarp::os::Property toProperty() const;
     yarp::sig::Vector getField(const yarp::sig::Vector &x,
                                const yarp::sig::Vector &xdot);
+    void flatten(FieldEngine &engine) const;
 };
 
 
-class D4CServer;    // forward declaration
+class D4CServer;           // forward declaration
+class TrajectoryWorker;    // forward declaration
 class GuiReporter : public yarp::os::PortReport
 {
 private:
@@ -119,8 +158,10 @@ protected:
     bool offlineMode;
     bool initIntegration;
     bool doInitGuiTrajectory;
+    bool engineUpToDate;
     int  verbosity;
     int  period;
+    int  numThreads;
 
     std::string device;
     std::string name;
@@ -144,7 +185,11 @@ protected:
     iCub::ctrl::Integrator If;
     iCub::ctrl::Integrator Iv;
 
+    FieldEngine engine;
+    std::vector<TrajectoryWorker*> workers;
+
     yarp::os::Mutex               mutex;
+    yarp::os::Mutex               batchMutex;
     yarp::dev::PolyDriver         dCtrlLeft;
     yarp::dev::ICartesianControl *iCtrlLeft;
     yarp::dev::PolyDriver         dCtrlRight;
@@ -202,6 +247,8 @@ protected:
     void  pushUpdateGuiItem(std::map<int,Item*>::iterator &it);
     void  pushEraseGuiItem(std::map<int,Item*>::iterator &it);
     void  handleGuiQueue();    
+    void  updateEngine();
+    void  computeField(yarp::sig::Vector &field);
     void  run();
 
     yarp::os::Property prepareData();
@@ -247,6 +294,12 @@ public:
                        std::deque<yarp::sig::Vector> &trajOrien,
                        const unsigned int maxIterations=D4C_DEFAULT_MAXITERATIONS,
                        const double Ts=D4C_DEFAULT_TS_DISABLED);
+    bool getTrajectories(const std::deque<yarp::sig::Vector> &x0,
+                         const std::deque<yarp::sig::Vector> &xdot0,
+                         std::deque<std::deque<yarp::sig::Vector> > &trajPos,
+                         std::deque<std::deque<yarp::sig::Vector> > &trajOrien,
+                         const unsigned int maxIterations=D4C_DEFAULT_MAXITERATIONS,
+                         const double Ts=D4C_DEFAULT_TS_DISABLED);
     bool executeTrajectory(const std::deque<yarp::sig::Vector> &trajPos,
                            const std::deque<yarp::sig::Vector> &trajOrien,
                            const double trajTime);
@@ -44,6 +44,7 @@
 #define D4C_VOCAB_CMD_SETACTIF             VOCAB4('s','a','i','f')
 #define D4C_VOCAB_CMD_GETACTIF             VOCAB4('g','a','i','f')
 #define D4C_VOCAB_CMD_GETTRAJ              VOCAB4('g','t','r','j')
+#define D4C_VOCAB_CMD_GETTRAJS             VOCAB4('g','t','r','s')
 #define D4C_VOCAB_CMD_EXECTRAJ             VOCAB4('e','t','r','j')
 #define D4C_VOCAB_CMD_SETSTATETOTOOL       VOCAB4('s','s','t','t')
 #define D4C_VOCAB_CMD_SETSTATE             VOCAB4('s','s','t','a')
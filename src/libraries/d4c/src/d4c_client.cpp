@@ -1372,6 +1372,111 @@ bool D4CClient::getTrajectory(deque<Vector> &trajPos, deque<Vector> &trajOrien,
 }
 
 
+/************************************************************************/
+bool D4CClient::getTrajectories(const deque<Vector> &x0, const deque<Vector> &xdot0,
+                                deque<deque<Vector> > &trajPos,
+                                deque<deque<Vector> > &trajOrien,
+                                const unsigned int maxIterations, const double Ts)
+{
+    if (isOpen)
+    {
+        printMessage(2,"request to retrieve a batch of %d trajectories\n",(int)x0.size());
+
+        Bottle cmd,reply;
+        cmd.addVocab(D4C_VOCAB_CMD_GETTRAJS);
+
+        Bottle &options=cmd.addList();
+
+        Bottle &bMaxIterations=options.addList();
+        bMaxIterations.addString("maxIterations");
+        bMaxIterations.addInt((int)maxIterations);
+
+        Bottle &bTs=options.addList();
+        bTs.addString("Ts");
+        bTs.addDouble(Ts);
+
+        const char *keys[]={"x0","xdot0"};
+        const deque<Vector> *conds[]={&x0,&xdot0};
+        for (int k=0; k<2; k++)
+        {
+            Bottle &bCond=options.addList();
+            bCond.addString(keys[k]);
+            Bottle &bPoints=bCond.addList();
+            for (size_t i=0; i<conds[k]->size(); i++)
+            {
+                Bottle &point=bPoints.addList();
+                for (size_t j=0; j<(*conds[k])[i].length(); j++)
+                    point.addDouble((*conds[k])[i][j]);
+            }
+        }
+
+        if (rpc.write(cmd,reply))
+        {
+            if (reply.get(0).asVocab()==D4C_VOCAB_CMD_ACK)
+            {
+                trajPos.clear();
+                trajOrien.clear();
+
+                bool ok=(reply.size()-1==(int)x0.size());
+                for (int n=1; ok && (n<reply.size()); n++)
+                {
+                    ok=false;
+                    if (Bottle *bTraj=reply.get(n).asList())
+                    {
+                        Bottle *BtrajPos=bTraj->get(0).asList();
+                        Bottle *BtrajOrien=bTraj->get(1).asList();
+                        if ((BtrajPos!=NULL) && (BtrajOrien!=NULL) &&
+                            (BtrajPos->get(0).asString()=="trajPos") &&
+                            (BtrajOrien->get(0).asString()=="trajOrien"))
+                        {
+                            Bottle *Btraj[]={BtrajPos,BtrajOrien};
+                            deque<Vector> traj[2];
+                            for (int k=0; k<2; k++)
+                            {
+                                for (int i=1; i<Btraj[k]->size(); i++)
+                                {
+                                    if (Bottle *point=Btraj[k]->get(i).asList())
+                                    {
+                                        Vector v(point->size());
+                                        for (int j=0; j<point->size(); j++)
+                                            v[j]=point->get(j).asDouble();
+
+                                        traj[k].push_back(v);
+                                    }
+                                }
+                            }
+
+                            trajPos.push_back(traj[0]);
+                            trajOrien.push_back(traj[1]);
+                            ok=true;
+                        }
+                    }
+                }
+
+                if (ok)
+                {
+                    printMessage(1,"batch of trajectories has been computed\n");
+                    return true;
+                }
+            }
+
+            printMessage(1,"something went wrong: request rejected\n");
+            return false;
+        }
+        else
+        {
+            printMessage(1,"unable to get reply from the server %s!\n",remote.c_str());
+            return false;
+        }
+    }
+    else
+    {
+        printMessage(1,"client is not open\n");
+        return false;
+    }
+}
+
+
 /************************************************************************/
 bool D4CClient::executeTrajectory(const deque<Vector> &trajPos, const deque<Vector> &trajOrien,
                                   const double trajTime)
@@ -23,6 +23,8 @@
 
 #include <yarp/os/PortInfo.h>
 #include <yarp/os/Time.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
 #include <yarp/math/Math.h>
 #include <iCub/ctrl/math.h>
 #include <iCub/d4c/d4c_server.h>
@@ -37,6 +39,221 @@ using namespace iCub::ctrl;
 using namespace iCub::d4c;
 
 
+/************************************************************************/
+void FieldEngine::clear()
+{
+    tcx.clear(); tcy.clear(); tcz.clear();
+    tK.clear();  tD.clear();
+
+    ocx.clear();  ocy.clear();  ocz.clear();
+    or00.clear(); or01.clear(); or02.clear();
+    or10.clear(); or11.clear(); or12.clear();
+    or20.clear(); or21.clear(); or22.clear();
+    oi0.clear();  oi1.clear();  oi2.clear();
+    oG.clear();   ocut.clear();
+}
+
+
+/************************************************************************/
+void FieldEngine::addTarget(const Vector &center, const double K, const double D)
+{
+    tcx.push_back(center[0]);
+    tcy.push_back(center[1]);
+    tcz.push_back(center[2]);
+    tK.push_back(K);
+    tD.push_back(D);
+}
+
+
+/************************************************************************/
+void FieldEngine::addObstacle(const Vector &center, const Vector &orientation,
+                              const Vector &radius, const double G, const bool cut_tails)
+{
+    // the obstacle frame is rotated by R: x_o=R'*(x-center)
+    Matrix R=axis2dcm(orientation);
+
+    ocx.push_back(center[0]);
+    ocy.push_back(center[1]);
+    ocz.push_back(center[2]);
+
+    or00.push_back(R(0,0)); or01.push_back(R(1,0)); or02.push_back(R(2,0));
+    or10.push_back(R(0,1)); or11.push_back(R(1,1)); or12.push_back(R(2,1));
+    or20.push_back(R(0,2)); or21.push_back(R(1,2)); or22.push_back(R(2,2));
+
+    oi0.push_back(1.0/(radius[0]*radius[0]));
+    oi1.push_back(1.0/(radius[1]*radius[1]));
+    oi2.push_back(1.0/(radius[2]*radius[2]));
+
+    oG.push_back(G);
+    ocut.push_back(cut_tails?1.0:0.0);
+}
+
+
+/************************************************************************/
+void FieldEngine::evaluate(const double *x, const double *xdot, double *field) const
+{
+    double fx=0.0;
+    double fy=0.0;
+    double fz=0.0;
+
+    // targets: same as Target_MSD::getField()
+    const size_t nt=tK.size();
+    for (size_t i=0; i<nt; i++)
+    {
+        fx+=tK[i]*(tcx[i]-x[0])-tD[i]*xdot[0];
+        fy+=tK[i]*(tcy[i]-x[1])-tD[i]*xdot[1];
+        fz+=tK[i]*(tcz[i]-x[2])-tD[i]*xdot[2];
+    }
+
+    // obstacles: same as Obstacle_Gaussian::getField(),
+    // where the cut tails are masked out instead of skipped
+    const size_t no=oG.size();
+    for (size_t i=0; i<no; i++)
+    {
+        double dx=x[0]-ocx[i];
+        double dy=x[1]-ocy[i];
+        double dz=x[2]-ocz[i];
+
+        double xo0=or00[i]*dx+or01[i]*dy+or02[i]*dz;
+        double xo1=or10[i]*dx+or11[i]*dy+or12[i]*dz;
+        double xo2=or20[i]*dx+or21[i]*dy+or22[i]*dz;
+
+        double dist=xo0*xo0*oi0[i]+xo1*xo1*oi1[i]+xo2*xo2*oi2[i];
+        double mask=1.0-ocut[i]*(dist>1.0?1.0:0.0);
+        double g=mask*oG[i]*exp(-dist)/sqrt(dx*dx+dy*dy+dz*dz);
+
+        fx+=g*dx;
+        fy+=g*dy;
+        fz+=g*dz;
+    }
+
+    field[0]=fx;
+    field[1]=fy;
+    field[2]=fz;
+    field[3]=field[4]=field[5]=field[6]=0.0;
+}
+
+
+/************************************************************************/
+void FieldEngine::simulate(const Vector &x0, const Vector &xdot0,
+                           const unsigned int maxIterations, const double Ts,
+                           deque<Vector> &trajPos, deque<Vector> &trajOrien) const
+{
+    double x[7],xdot[7],field[7];
+    double xdot_old[7],field_old[7];
+    for (int i=0; i<7; i++)
+    {
+        x[i]=x0[i];
+        xdot[i]=xdot0[i];
+        xdot_old[i]=field_old[i]=0.0;
+    }
+
+    Vector pos(3),orien(4);
+    for (unsigned int iteration=0; iteration<maxIterations; iteration++)
+    {
+        evaluate(x,xdot,field);
+
+        // Tustin formula, as in iCub::ctrl::Integrator
+        for (int i=0; i<7; i++)
+        {
+            xdot[i]+=(field[i]+field_old[i])*(Ts/2.0);
+            field_old[i]=field[i];
+        }
+
+        for (int i=0; i<7; i++)
+        {
+            x[i]+=(xdot[i]+xdot_old[i])*(Ts/2.0);
+            xdot_old[i]=xdot[i];
+        }
+
+        pos[0]=x[0];   pos[1]=x[1];   pos[2]=x[2];
+        orien[0]=x[3]; orien[1]=x[4]; orien[2]=x[5]; orien[3]=x[6];
+
+        trajPos.push_back(pos);
+        trajOrien.push_back(orien);
+    }
+}
+
+
+namespace iCub
+{
+
+namespace d4c
+{
+
+// simulate a range of the initial conditions of a batch
+class TrajectoryWorker : public Thread
+{
+    Semaphore go;
+    Semaphore done;
+
+    const FieldEngine *engine;
+    const deque<Vector> *x0;
+    const deque<Vector> *xdot0;
+    deque<deque<Vector> > *trajPos;
+    deque<deque<Vector> > *trajOrien;
+    unsigned int maxIterations;
+    double Ts;
+    size_t first,last;
+
+public:
+    TrajectoryWorker() : go(0), done(0), first(0), last(0) { }
+
+    static void process(const FieldEngine &engine, const deque<Vector> &x0,
+                        const deque<Vector> &xdot0, deque<deque<Vector> > &trajPos,
+                        deque<deque<Vector> > &trajOrien, const unsigned int maxIterations,
+                        const double Ts, const size_t first, const size_t last)
+    {
+        for (size_t i=first; i<last; i++)
+            engine.simulate(x0[i],xdot0[i],maxIterations,Ts,trajPos[i],trajOrien[i]);
+    }
+
+    void post(const FieldEngine *engine, const deque<Vector> *x0,
+              const deque<Vector> *xdot0, deque<deque<Vector> > *trajPos,
+              deque<deque<Vector> > *trajOrien, const unsigned int maxIterations,
+              const double Ts, const size_t first, const size_t last)
+    {
+        this->engine=engine;
+        this->x0=x0;
+        this->xdot0=xdot0;
+        this->trajPos=trajPos;
+        this->trajOrien=trajOrien;
+        this->maxIterations=maxIterations;
+        this->Ts=Ts;
+        this->first=first;
+        this->last=last;
+        go.post();
+    }
+
+    void wait()
+    {
+        done.wait();
+    }
+
+    void run()
+    {
+        while (!isStopping())
+        {
+            go.wait();
+            if (isStopping())
+                break;
+
+            process(*engine,*x0,*xdot0,*trajPos,*trajOrien,maxIterations,Ts,first,last);
+            done.post();
+        }
+    }
+
+    void onStop()
+    {
+        go.post();
+    }
+};
+
+}
+
+}
+
+
 /************************************************************************/
 Item::Item()
 {
@@ -157,6 +374,14 @@ Vector Target_MSD::getField(const Vector &x, const Vector &xdot)
 }
 
 
+/************************************************************************/
+void Target_MSD::flatten(FieldEngine &engine) const
+{
+    if (active)
+        engine.addTarget(center,K,D);
+}
+
+
 /************************************************************************/
 Obstacle_Gaussian::Obstacle_Gaussian() : G(0.0), cut_tails(false)
 {
@@ -235,6 +460,14 @@ Vector Obstacle_Gaussian::getField(const Vector &x, const Vector &xdot)
 }
 
 
+/************************************************************************/
+void Obstacle_Gaussian::flatten(FieldEngine &engine) const
+{
+    if (active)
+        engine.addObstacle(center,orientation,radius,G,cut_tails);
+}
+
+
 /************************************************************************/
 GuiReporter::GuiReporter()
 {
@@ -268,7 +501,9 @@ D4CServer::D4CServer() : RateThread(20), If(0.0,Vector(7)), Iv(0.0,Vector(7))
     doInitGuiTrajectory=false;
     offlineMode=false;
     initIntegration=true;
+    engineUpToDate=true;
     verbosity=0;
+    numThreads=1;
     name="";
     activeIF="";
     iCtrlRight=NULL;
@@ -329,6 +564,7 @@ bool D4CServer::open(const Property &options)
     }
 
     period=opt.check("period",Value(20)).asInt();
+    numThreads=std::max(opt.check("threads",Value(1)).asInt(),1);
 
     double Ts=(double)period/1000.0;
 
@@ -393,6 +629,14 @@ bool D4CServer::open(const Property &options)
         t0=Time::now();
     }
 
+    // the caller thread takes care of the first range of a batch
+    for (int i=1; i<numThreads; i++)
+    {
+        TrajectoryWorker *worker=new TrajectoryWorker;
+        worker->start();
+        workers.push_back(worker);
+    }
+
     // request high resolution scheduling straightaway
     Time::turboBoost();
     
@@ -417,6 +661,15 @@ void D4CServer::close()
         if (isRunning())
             stop();
 
+        batchMutex.lock();
+        for (size_t i=0; i<workers.size(); i++)
+        {
+            workers[i]->stop();
+            delete workers[i];
+        }
+        workers.clear();
+        batchMutex.unlock();
+
         if (!offlineMode)
         {
             if ((part=="right_arm") || (part=="both_arms"))
@@ -441,6 +694,8 @@ void D4CServer::close()
         }
 
         table.clear();
+        engine.clear();
+        engineUpToDate=true;
 
         eraseGuiTrajectory();
 
@@ -503,6 +758,7 @@ bool D4CServer::addItem(const Property &options, int &item)
             // configure item
             pItem->fromProperty(options);
             table[item=itCnt++]=pItem;
+            engineUpToDate=false;
             map<int,Item*>::iterator it=table.find(item);
             pushUpdateGuiItem(it);
 
@@ -539,6 +795,7 @@ bool D4CServer::eraseItem(const int item)
 
             delete it->second;
             table.erase(it);
+            engineUpToDate=false;
 
             printMessage(1,"item %d scheduled for erasing\n",item);
             ret=true;
@@ -570,6 +827,7 @@ bool D4CServer::clearItems()
         }
 
         table.clear();
+        engineUpToDate=false;
         printMessage(1,"all items have been scheduled for erasing\n");
 
         mutex.unlock();
@@ -621,6 +879,7 @@ bool D4CServer::setProperty(const int item, const Property &options)
         if (it!=table.end())
         {
             it->second->fromProperty(options);
+            engineUpToDate=false;
             pushUpdateGuiItem(it);
 
             printMessage(1,"item %d property successfully updated: %s\n",
@@ -1233,16 +1492,26 @@ bool D4CServer::getPointState(Vector &x, Vector &o, Vector &xdot, Vector &odot)
 }
 
 
+/************************************************************************/
+void D4CServer::computeField(Vector &field)
+{
+    updateEngine();
+    field.resize(x.length());
+    engine.evaluate(x.data(),xdot.data(),field.data());
+
+    printMessage(1,"field = %s\n",field.toString().c_str());
+}
+
+
 /************************************************************************/
 bool D4CServer::getField(Vector &field)
 {
     if (isOpen)
     {
-        field.resize(x.length(),0.0);
-        for (map<int,Item*>::const_iterator it=table.begin(); it!=table.end(); it++) 
-            field=field+it->second->getField(x,xdot);
+        mutex.lock();
+        computeField(field);
+        mutex.unlock();
 
-        printMessage(1,"field = %s\n",field.toString().c_str());
         return true;
     }
     else
@@ -1607,6 +1876,74 @@ bool D4CServer::read(ConnectionReader &connection)
              break;
          }
 
+         //-----------------
+         case D4C_VOCAB_CMD_GETTRAJS:
+         {
+             Property options=extractProperty(cmd.get(1));
+             if (options.isNull())
+                 reply.addVocab(D4C_VOCAB_CMD_NACK);
+             else
+             {
+                 int maxIterations=options.find("maxIterations").asInt();
+                 double Ts=options.find("Ts").asDouble();
+
+                 deque<Vector> x0,xdot0;
+                 const char *keys[]={"x0","xdot0"};
+                 deque<Vector> *conds[]={&x0,&xdot0};
+                 for (int k=0; k<2; k++)
+                 {
+                     if (Bottle *b=options.find(keys[k]).asList())
+                     {
+                         for (int i=0; i<b->size(); i++)
+                         {
+                             if (Bottle *point=b->get(i).asList())
+                             {
+                                 Vector v(point->size());
+                                 for (int j=0; j<point->size(); j++)
+                                     v[j]=point->get(j).asDouble();
+
+                                 conds[k]->push_back(v);
+                             }
+                         }
+                     }
+                 }
+
+                 deque<deque<Vector> > trajPos;
+                 deque<deque<Vector> > trajOrien;
+                 if (getTrajectories(x0,xdot0,trajPos,trajOrien,maxIterations,Ts))
+                 {
+                     reply.addVocab(D4C_VOCAB_CMD_ACK);
+
+                     for (unsigned int n=0; n<trajPos.size(); n++)
+                     {
+                         Bottle &bTraj=reply.addList();
+
+                         Bottle &bPos=bTraj.addList();
+                         bPos.addString("trajPos");
+                         for (unsigned int i=0; i<trajPos[n].size(); i++)
+                         {
+                             Bottle &point=bPos.addList();
+                             for (size_t j=0; j<trajPos[n][i].length(); j++)
+                                point.addDouble(trajPos[n][i][j]);
+                         }
+
+                         Bottle &bOrien=bTraj.addList();
+                         bOrien.addString("trajOrien");
+                         for (unsigned int i=0; i<trajOrien[n].size(); i++)
+                         {
+                             Bottle &point=bOrien.addList();
+                             for (size_t j=0; j<trajOrien[n][i].length(); j++)
+                                point.addDouble(trajOrien[n][i][j]);
+                         }
+                     }
+                 }
+                 else
+                     reply.addVocab(D4C_VOCAB_CMD_NACK);
+             }
+
+             break;
+         }
+
          //-----------------
          case D4C_VOCAB_CMD_EXECTRAJ:
          {
@@ -1869,7 +2206,7 @@ bool D4CServer::read(ConnectionReader &connection)
 Property D4CServer::prepareData()
 {
     Vector field;
-    getField(field);
+    computeField(field);
 
     Value val_field; val_field.fromString(("("+string(field.toString().c_str())+")").c_str());
     Value val_xdot;  val_xdot.fromString(("("+string(xdot.toString().c_str())+")").c_str());  
@@ -2168,36 +2505,110 @@ void D4CServer::handleGuiQueue()
 }
 
 
+/************************************************************************/
+void D4CServer::updateEngine()
+{
+    if (!engineUpToDate)
+    {
+        engine.clear();
+        for (map<int,Item*>::const_iterator it=table.begin(); it!=table.end(); it++)
+            it->second->flatten(engine);
+
+        printMessage(4,"field engine updated with %d active items\n",(int)engine.size());
+        engineUpToDate=true;
+    }
+}
+
+
 /************************************************************************/
 bool D4CServer::getTrajectory(deque<Vector> &trajPos, deque<Vector> &trajOrien,
                               const unsigned int maxIterations, const double Ts)
 {
     if (isOpen)
     {
+        // take a snapshot of the field and release the
+        // main run straightaway
         mutex.lock();
         printMessage(1,"request for trajectory simulation\n");
+        updateEngine();
+        FieldEngine snapshot=engine;
         Vector xdotOffline=xdot;
         Vector xOffline=x;
-
         double _Ts=(Ts<=D4C_DEFAULT_TS_DISABLED)?(double)period/1000.0:Ts;
-        Integrator IfOffline(_Ts,xdotOffline);
-        Integrator IvOffline(_Ts,xOffline);
+        mutex.unlock();
+
+        snapshot.simulate(xOffline,xdotOffline,maxIterations,_Ts,trajPos,trajOrien);
+        return true;
+    }
+    else
+    {
+        printMessage(1,"server is not open\n");
+        return false;
+    }
+}
+
 
-        unsigned int iteration=0;
-        while (iteration++<maxIterations)
+/************************************************************************/
+bool D4CServer::getTrajectories(const deque<Vector> &x0, const deque<Vector> &xdot0,
+                                deque<deque<Vector> > &trajPos,
+                                deque<deque<Vector> > &trajOrien,
+                                const unsigned int maxIterations, const double Ts)
+{
+    if (isOpen)
+    {
+        printMessage(1,"request for batch simulation of %d trajectories\n",(int)x0.size());
+
+        if (!xdot0.empty() && (xdot0.size()!=x0.size()))
         {
-            Vector field(x.length(),0.0);
-            for (map<int,Item*>::const_iterator it=table.begin(); it!=table.end(); it++) 
-                field=field+it->second->getField(xOffline,xdotOffline);
+            printMessage(1,"initial states and velocities have different size!\n");
+            return false;
+        }
 
-            xdotOffline=IfOffline.integrate(field);
-            xOffline=IvOffline.integrate(xdotOffline);
+        for (size_t i=0; i<x0.size(); i++)
+        {
+            if ((x0[i].length()!=7) || (!xdot0.empty() && (xdot0[i].length()!=7)))
+            {
+                printMessage(1,"initial condition %d has wrong size!\n",(int)i);
+                return false;
+            }
+        }
 
-            trajPos.push_back(getVectorPos(xOffline));
-            trajOrien.push_back(getVectorOrien(xOffline));
-        }       
+        deque<Vector> _xdot0=xdot0;
+        if (_xdot0.empty())
+            _xdot0.assign(x0.size(),Vector(7,0.0));
 
+        // take a snapshot of the field and release the
+        // main run straightaway
+        mutex.lock();
+        updateEngine();
+        FieldEngine snapshot=engine;
+        double _Ts=(Ts<=D4C_DEFAULT_TS_DISABLED)?(double)period/1000.0:Ts;
         mutex.unlock();
+
+        batchMutex.lock();
+
+        trajPos.assign(x0.size(),deque<Vector>());
+        trajOrien.assign(x0.size(),deque<Vector>());
+
+        // split the initial conditions in as many
+        // contiguous ranges as the threads
+        size_t rangeSize=x0.size()/(workers.size()+1);
+        size_t firstSize=x0.size()-rangeSize*workers.size();
+
+        for (size_t i=0; i<workers.size(); i++)
+        {
+            size_t first=firstSize+i*rangeSize;
+            workers[i]->post(&snapshot,&x0,&_xdot0,&trajPos,&trajOrien,
+                             maxIterations,_Ts,first,first+rangeSize);
+        }
+
+        TrajectoryWorker::process(snapshot,x0,_xdot0,trajPos,trajOrien,
+                                  maxIterations,_Ts,0,firstSize);
+
+        for (size_t i=0; i<workers.size(); i++)
+            workers[i]->wait();
+
+        batchMutex.unlock();
         return true;
     }
     else
@@ -2311,7 +2722,7 @@ void D4CServer::run()
             printMessage(4,"processing %d items\n",table.size());
             
             Vector field;
-            getField(field);
+            computeField(field);
 
             xdot=If.integrate(field);
             x=Iv.integrate(xdot);
@@ -0,0 +1,133 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+#ifndef __FIXEDPOINTREMAP__
+#define __FIXEDPOINTREMAP__
+
+#include <vector>
+
+// yarp
+#include <yarp/sig/Image.h>
+
+namespace iCub {
+    namespace vis{
+        class FixedPointRemap;
+        class FixedPointRemapWorker;
+    }
+}
+
+/**
+ * Bilinear remapping of rgb images through compact fixed-point tables.
+ *
+ * The map is given as floating point source coordinates for every output
+ * pixel, as produced by cvInitUndistortMap(); for each output pixel the
+ * tables keep the offset of the top-left source pixel and the fractional
+ * parts of the coordinates in 1/256 of pixel, so that the interpolation
+ * is done with integer arithmetic only. Pixels mapped outside the source
+ * image are set to black.
+ *
+ * A following geometric stage (e.g. a resize or a log-polar sampling)
+ * can be fused with the map, so that every input frame is read once and
+ * interpolated once; a saturation adjustment can be applied in the same
+ * pass as well. The output rows are shared among a pool of threads, the
+ * calling one included.
+ */
+class iCub::vis::FixedPointRemap
+{
+private:
+    int srcW, srcH;
+    int mapW, mapH;
+    int outW, outH;
+    std::vector<float> mapX, mapY;
+    std::vector<float> postX, postY;
+
+    // fixed-point tables, built for a given row size of the source
+    int rowSize;
+    std::vector<int> ofs;
+    std::vector<unsigned short> frac;
+
+    // saturation in 1/256
+    int sat;
+
+    std::vector<FixedPointRemapWorker*> workers;
+
+    void build(int rowSize);
+    void remapRows(int first, int last,
+                   const yarp::sig::ImageOf<yarp::sig::PixelRgb> &in,
+                   yarp::sig::ImageOf<yarp::sig::PixelRgb> &out);
+
+    friend class FixedPointRemapWorker;
+
+public:
+    FixedPointRemap();
+    virtual ~FixedPointRemap();
+
+    /**
+     * Set the map.
+     * @param mapX source x coordinate of every output pixel (row-major).
+     * @param mapY source y coordinate of every output pixel (row-major).
+     * @param w width of the map, i.e. of the output image.
+     * @param h height of the map, i.e. of the output image.
+     * @param srcW width of the source image.
+     * @param srcH height of the source image.
+     * @return true/false on success/failure.
+     * @note any fused stage is discarded.
+     */
+    bool setMap(const float *mapX, const float *mapY, int w, int h,
+                int srcW, int srcH);
+
+    /**
+     * Fuse a geometric stage following the map.
+     * @param postX x coordinate within the remapped image of every pixel
+     *              of the final output (row-major).
+     * @param postY y coordinate within the remapped image of every pixel
+     *              of the final output (row-major).
+     * @param w width of the final output.
+     * @param h height of the final output.
+     * @return true/false on success/failure.
+     * @note a previously fused stage is replaced.
+     */
+    bool fuse(const float *postX, const float *postY, int w, int h);
+
+    /**
+     * Fuse a bilinear resize of the remapped image to w x h.
+     * @return true/false on success/failure.
+     */
+    bool fuseResize(int w, int h);
+
+    /**
+     * Set the saturation applied to the output pixels: 0 gives gray
+     * levels, 1 leaves the colours untouched and negative values invert
+     * the colours around the mean. Values beyond +/-1024, which give the
+     * same output, are bounded.
+     */
+    void setSaturation(double s);
+
+    /**
+     * Set the number of threads sharing the rows, the calling thread
+     * included.
+     */
+    bool setNumThreads(int n);
+    int getNumThreads() const { return (int)workers.size()+1; }
+
+    int getSourceWidth() const  { return srcW; }
+    int getSourceHeight() const { return srcH; }
+    int getOutputWidth() const  { return outW; }
+    int getOutputHeight() const { return outH; }
+
+    /**
+     * Remap the image; out is resized to the size of the output.
+     * @return false if no map is set or if the size of the input does
+     *         not match the map.
+     */
+    bool apply(const yarp::sig::ImageOf<yarp::sig::PixelRgb> &in,
+               yarp::sig::ImageOf<yarp::sig::PixelRgb> &out);
+};
+
+
+#endif
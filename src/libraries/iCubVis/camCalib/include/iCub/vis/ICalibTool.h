@@ -36,6 +36,11 @@ public:
     virtual bool configure (Searchable &config) = 0;
 
     virtual void apply(const ImageOf<PixelRgb> & in, ImageOf<PixelRgb> & out) = 0;    
+
+    /** Adjust the saturation of the output within apply(), returns
+      * false if the tool cannot do it.
+      */
+    virtual bool setSaturation(double satVal) { return false; }
 };
 
 
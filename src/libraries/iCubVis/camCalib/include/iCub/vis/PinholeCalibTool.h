@@ -28,6 +28,7 @@
 
 // iCub
 #include <iCub/vis/ICalibTool.h>
+#include <iCub/vis/FixedPointRemap.h>
 
 namespace iCub {
     namespace vis{
@@ -63,6 +64,11 @@ class iCub::vis::PinholeCalibTool : public ICalibTool
 
     bool _drawCenterCross;
 
+    // fixed-point remap, optionally fused with a resize
+    bool _fixedPoint;
+    CvSize _outImgSize;
+    iCub::vis::FixedPointRemap _remap;
+
     bool init(CvSize currImgSize, CvSize calibImgSize);
 
 public:
@@ -105,6 +111,11 @@ public:
     * input image.
     */
     void apply(const ImageOf<PixelRgb> & in, ImageOf<PixelRgb> & out);    
+
+    /** Fuse the saturation adjustment with the remap, only available
+      * with the fixed-point remap.
+      */
+    virtual bool setSaturation(double satVal);
     
 };
 
@@ -20,6 +20,7 @@
 
 // iCub
 #include <iCub/vis/ICalibTool.h>
+#include <iCub/vis/FixedPointRemap.h>
 #include <iCub/vis/spherical_projection.h>
 
 namespace iCub {
@@ -58,6 +59,11 @@ private:
 
     bool _drawCenterCross;
 
+    // fixed-point remap, optionally fused with a resize
+    bool _fixedPoint;
+    CvSize _outImgSize;
+    iCub::vis::FixedPointRemap _remap;
+
     bool init(CvSize currImgSize, CvSize calibImgSize);
 
 public:
@@ -72,6 +78,11 @@ public:
 
     // ICalibTool
     void apply(const ImageOf<PixelRgb> & in, ImageOf<PixelRgb> & out);    
+
+    /** Fuse the saturation adjustment with the remap, only available
+      * with the fixed-point remap.
+      */
+    virtual bool setSaturation(double satVal);
 };
 
 
@@ -0,0 +1,304 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
+
+#include <cmath>
+
+#include <iCub/vis/FixedPointRemap.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::vis;
+
+
+/**
+ * Helper thread of FixedPointRemap: remaps a block of rows on request.
+ */
+class iCub::vis::FixedPointRemapWorker : public yarp::os::Thread {
+private:
+    FixedPointRemap *owner;
+    Semaphore go;
+    Semaphore done;
+    int first;
+    int last;
+    const ImageOf<PixelRgb> *in;
+    ImageOf<PixelRgb> *out;
+
+public:
+    FixedPointRemapWorker(FixedPointRemap *owner) :
+        owner(owner), go(0), done(0) {
+        first = last = 0;
+        in = NULL;
+        out = NULL;
+    }
+
+    void post(int first, int last, const ImageOf<PixelRgb> *in, ImageOf<PixelRgb> *out) {
+        this->first = first;
+        this->last = last;
+        this->in = in;
+        this->out = out;
+        go.post();
+    }
+
+    void wait() {
+        done.wait();
+    }
+
+    void run() {
+        while (!isStopping()) {
+            go.wait();
+            if (isStopping())
+                break;
+
+            owner->remapRows(first, last, *in, *out);
+            done.post();
+        }
+    }
+
+    void onStop() {
+        go.post();
+    }
+};
+
+
+FixedPointRemap::FixedPointRemap() {
+    srcW = srcH = 0;
+    mapW = mapH = 0;
+    outW = outH = 0;
+    rowSize = -1;
+    sat = 256;
+}
+
+FixedPointRemap::~FixedPointRemap() {
+    setNumThreads(1);
+}
+
+bool FixedPointRemap::setMap(const float *mapX, const float *mapY, int w, int h,
+                             int srcW, int srcH) {
+    // the interpolation needs two rows and two columns
+    if (mapX==NULL || mapY==NULL || w<1 || h<1 || srcW<2 || srcH<2)
+        return false;
+
+    this->mapX.assign(mapX, mapX+w*h);
+    this->mapY.assign(mapY, mapY+w*h);
+    this->srcW = srcW;
+    this->srcH = srcH;
+    mapW = outW = w;
+    mapH = outH = h;
+    postX.clear();
+    postY.clear();
+    rowSize = -1;
+    return true;
+}
+
+bool FixedPointRemap::fuse(const float *postX, const float *postY, int w, int h) {
+    if (mapX.empty() || postX==NULL || postY==NULL || w<1 || h<1)
+        return false;
+
+    this->postX.assign(postX, postX+w*h);
+    this->postY.assign(postY, postY+w*h);
+    outW = w;
+    outH = h;
+    rowSize = -1;
+    return true;
+}
+
+bool FixedPointRemap::fuseResize(int w, int h) {
+    if (mapX.empty() || w<1 || h<1)
+        return false;
+
+    // same sampling as cvResize with linear interpolation
+    vector<float> px(w*h), py(w*h);
+    float sx = (float)mapW / (float)w;
+    float sy = (float)mapH / (float)h;
+    for (int y=0; y<h; y++) {
+        float v = (y+0.5f)*sy-0.5f;
+        v = v<0.0f ? 0.0f : (v>mapH-1 ? (float)(mapH-1) : v);
+        for (int x=0; x<w; x++) {
+            float u = (x+0.5f)*sx-0.5f;
+            u = u<0.0f ? 0.0f : (u>mapW-1 ? (float)(mapW-1) : u);
+            px[y*w+x] = u;
+            py[y*w+x] = v;
+        }
+    }
+
+    return fuse(&px[0], &py[0], w, h);
+}
+
+void FixedPointRemap::setSaturation(double s) {
+    // a channel differs from the mean by at least 1/3, hence beyond 765
+    // every pixel that is not gray is already saturated; the bound keeps
+    // the products of remapRows() well within an int
+    const double maxSat = 1024.0;
+    if (s>maxSat)
+        s = maxSat;
+    else if (s<-maxSat)
+        s = -maxSat;
+    sat = (int)floor(256.0*s+0.5);
+}
+
+bool FixedPointRemap::setNumThreads(int n) {
+    if (n<1)
+        return false;
+
+    for (size_t k=0; k<workers.size(); k++) {
+        workers[k]->stop();
+        delete workers[k];
+    }
+    workers.clear();
+
+    for (int k=1; k<n; k++) {
+        FixedPointRemapWorker *worker = new FixedPointRemapWorker(this);
+        worker->start();
+        workers.push_back(worker);
+    }
+    return true;
+}
+
+void FixedPointRemap::build(int rowSize) {
+    int n = outW*outH;
+    ofs.resize(n);
+    frac.resize(n);
+
+    for (int i=0; i<n; i++) {
+        float sx, sy;
+        if (postX.empty()) {
+            sx = mapX[i];
+            sy = mapY[i];
+        }
+        else {
+            // look the fused stage up into the map
+            float u = postX[i];
+            float v = postY[i];
+            if (!(u>=0.0f && u<=mapW-1 && v>=0.0f && v<=mapH-1)) {
+                ofs[i] = -1;
+                frac[i] = 0;
+                continue;
+            }
+
+            int u0 = (int)u;
+            int v0 = (int)v;
+            int u1 = u0<mapW-1 ? u0+1 : u0;
+            int v1 = v0<mapH-1 ? v0+1 : v0;
+            float a = u-u0;
+            float b = v-v0;
+            int i00 = v0*mapW+u0, i01 = v0*mapW+u1;
+            int i10 = v1*mapW+u0, i11 = v1*mapW+u1;
+            sx = (1.0f-b)*((1.0f-a)*mapX[i00]+a*mapX[i01])+b*((1.0f-a)*mapX[i10]+a*mapX[i11]);
+            sy = (1.0f-b)*((1.0f-a)*mapY[i00]+a*mapY[i01])+b*((1.0f-a)*mapY[i10]+a*mapY[i11]);
+        }
+
+        // the test fails on NaN as well
+        if (!(sx>=0.0f && sx<=srcW-1 && sy>=0.0f && sy<=srcH-1)) {
+            ofs[i] = -1;
+            frac[i] = 0;
+            continue;
+        }
+
+        int x0 = (int)sx;
+        int y0 = (int)sy;
+        int fx = (int)((sx-x0)*256.0f+0.5f);
+        int fy = (int)((sy-y0)*256.0f+0.5f);
+        if (fx==256) {
+            x0++;
+            fx = 0;
+        }
+        if (fy==256) {
+            y0++;
+            fy = 0;
+        }
+
+        // keep the bottom-right neighbour within the image
+        if (x0>srcW-2) {
+            x0 = srcW-2;
+            fx = 255;
+        }
+        if (y0>srcH-2) {
+            y0 = srcH-2;
+            fy = 255;
+        }
+
+        ofs[i] = y0*rowSize+3*x0;
+        frac[i] = (unsigned short)((fy<<8)|fx);
+    }
+
+    this->rowSize = rowSize;
+}
+
+void FixedPointRemap::remapRows(int first, int last,
+                                const ImageOf<PixelRgb> &in,
+                                ImageOf<PixelRgb> &out) {
+    const unsigned char *src = in.getRawImage();
+    unsigned char *dst = out.getRawImage();
+    int outRowSize = out.getRowSize();
+    int s = sat;
+
+    for (int y=first; y<last; y++) {
+        unsigned char *d = dst+y*outRowSize;
+        const int *o = &ofs[y*outW];
+        const unsigned short *f = &frac[y*outW];
+
+        for (int x=0; x<outW; x++, d+=3) {
+            if (o[x]<0) {
+                d[0] = d[1] = d[2] = 0;
+                continue;
+            }
+
+            const unsigned char *p = src+o[x];
+            const unsigned char *q = p+rowSize;
+            int fx = f[x]&0xff;
+            int fy = f[x]>>8;
+            int w00 = (256-fx)*(256-fy);
+            int w01 = fx*(256-fy);
+            int w10 = (256-fx)*fy;
+            int w11 = fx*fy;
+
+            int c[3];
+            for (int k=0; k<3; k++)
+                c[k] = (p[k]*w00+p[k+3]*w01+q[k]*w10+q[k+3]*w11+32768)>>16;
+
+            if (s!=256) {
+                // mean+s*(c-mean), with mean=sum/3, on 768ths
+                int sum = c[0]+c[1]+c[2];
+                for (int k=0; k<3; k++) {
+                    int v = (3*s*c[k]+(256-s)*sum)/768;
+                    c[k] = v<0 ? 0 : (v>255 ? 255 : v);
+                }
+            }
+
+            d[0] = (unsigned char)c[0];
+            d[1] = (unsigned char)c[1];
+            d[2] = (unsigned char)c[2];
+        }
+    }
+}
+
+bool FixedPointRemap::apply(const ImageOf<PixelRgb> &in, ImageOf<PixelRgb> &out) {
+    if (mapX.empty() || in.width()!=srcW || in.height()!=srcH)
+        return false;
+
+    // the offsets depend on the padding of the source rows
+    if (in.getRowSize()!=rowSize)
+        build(in.getRowSize());
+
+    out.resize(outW, outH);
+
+    // the calling thread remaps the first block of rows
+    int block = outH / getNumThreads();
+    int first = outH - block * (int)workers.size();
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k]->post(first+(int)k*block, first+(int)(k+1)*block, &in, &out);
+    remapRows(0, first, in, out);
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k]->wait();
+
+    return true;
+}
@@ -15,6 +15,9 @@ SphericalCalibTool::SphericalCalibTool(){
     _mapY = NULL;
     _oldImgSize.width = -1;
     _oldImgSize.height = -1;
+    _outImgSize.width = 0;
+    _outImgSize.height = 0;
+    _fixedPoint = true;
     _needInit = true;
 }
 
@@ -63,11 +66,36 @@ bool SphericalCalibTool::configure (Searchable &config){
     _cx_scaled = _cx;
     _cy_scaled = _cy;
 
+    _fixedPoint = config.check("fixedPoint",
+                               Value(1),
+                               "Remap through fixed-point tables (int [0|1]).").asInt()!=0;
+
+    _outImgSize.width = config.check("outWidth",
+                                     Value(0),
+                                     "Width of the output image, resized within the remap (int, 0 for the input width).").asInt();
+
+    _outImgSize.height = config.check("outHeight",
+                                      Value(0),
+                                      "Height of the output image, resized within the remap (int, 0 for the input height).").asInt();
+
+    _remap.setNumThreads(config.check("threads",
+                                      Value(1),
+                                      "Number of threads remapping the image (int).").asInt());
+
     _needInit = true;
 
     return true;
 }
 
+bool SphericalCalibTool::setSaturation(double satVal){
+
+    if (!_fixedPoint)
+        return false;
+
+    _remap.setSaturation(satVal);
+    return true;
+}
+
 
 bool SphericalCalibTool::init(CvSize currImgSize, CvSize calibImgSize){
 
@@ -110,6 +138,16 @@ bool SphericalCalibTool::init(CvSize currImgSize, CvSize calibImgSize){
                         (float*)_mapX->imageData, (float*)_mapY->imageData))
         return false;
 
+    // fixed-point tables, with the resize fused if required
+    if (_fixedPoint){
+        _remap.setMap((float*)_mapX->imageData, (float*)_mapY->imageData,
+                      currImgSize.width, currImgSize.height,
+                      currImgSize.width, currImgSize.height);
+        if (_outImgSize.width>0 && _outImgSize.height>0 &&
+            (_outImgSize.width!=currImgSize.width || _outImgSize.height!=currImgSize.height))
+            _remap.fuseResize(_outImgSize.width, _outImgSize.height);
+    }
+
     _needInit = false;
     return true;
 }
@@ -124,16 +162,19 @@ void SphericalCalibTool::apply(const ImageOf<PixelRgb> & in, ImageOf<PixelRgb> &
         _needInit)
         init(inSize,_calibImgSize);
 
-    out.resize(inSize.width, inSize.height);
-
-    cvRemap( in.getIplImage(), out.getIplImage(),
-           _mapX, _mapY,
-           CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS, cvScalarAll(0));
+    if (_fixedPoint)
+        _remap.apply(in, out);
+    else{
+        out.resize(inSize.width, inSize.height);
+        cvRemap( in.getIplImage(), out.getIplImage(),
+               _mapX, _mapY,
+               CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS, cvScalarAll(0));
+    }
 
     // painting crosshair at calibration center
     if (_drawCenterCross){
 	    yarp::sig::PixelRgb pix = yarp::sig::PixelRgb(255,255,255);
-		yarp::sig::draw::addCrossHair(out, pix, (int)_cx_scaled, (int)_cy_scaled, 10);
+		yarp::sig::draw::addCrossHair(out, pix, (int)(_cx_scaled*out.width()/inSize.width), (int)(_cy_scaled*out.height()/inSize.height), 10);
     }
 
     // buffering old image size
@@ -21,12 +21,21 @@
 namespace iCub {
     namespace vis {
         class GroupSalience;
+        class GroupSalienceWorker;
     }
 }
 
 
 /**
  * A group of filters.
+ *
+ * The children are independent, therefore with the "threads" option
+ * greater than 1 they are evaluated concurrently, each thread taking
+ * care of a subset of them (the calling thread included); the weighted
+ * sum of their maps is then shared among the threads by rows. Every
+ * child keeps its own output images from one frame to the next and the
+ * maps are summed in the order of the children, so the result does not
+ * depend on the number of threads.
  */
 class iCub::vis::GroupSalience : public Salience { 
 public:
@@ -35,6 +44,7 @@ public:
     }
     
     virtual ~GroupSalience() {
+        setNumThreads(1);
         clear();
     }
 
@@ -59,7 +69,24 @@ public:
     virtual bool setChildWeight(int j, double w);
     virtual double getChildWeight(int j);
 
+    /**
+     * Set the number of threads evaluating the children, the calling
+     * thread included (1 evaluates them one after the other).
+     */
+    virtual bool setNumThreads(int n);
+    virtual int getNumThreads() { return (int)workers.size()+1; }
+
 private:
+    // evaluate the children assigned to the given thread
+    void applyChildren(int slot, yarp::sig::ImageOf<yarp::sig::PixelRgb>& src);
+
+    // weighted sum of the children maps on the rows [first, last)
+    void combineRows(int first, int last,
+                     yarp::sig::ImageOf<yarp::sig::PixelRgb>& dest,
+                     yarp::sig::ImageOf<yarp::sig::PixelFloat>& sal);
+
+    friend class GroupSalienceWorker;
+
     void clear() {
         for (unsigned int i=0; i<group.size(); i++) {
             delete group[i];
@@ -73,7 +100,7 @@ private:
     std::vector<yarp::sig::ImageOf<yarp::sig::PixelFloat> > salienceMap;
     std::vector<yarp::sig::ImageOf<yarp::sig::PixelRgb> > salienceView;
     double weightSum;
-    
+    std::vector<GroupSalienceWorker*> workers;
 };
 
 
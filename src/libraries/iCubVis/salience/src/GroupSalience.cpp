@@ -18,6 +18,71 @@ using namespace std;
 using namespace iCub::vis;
 
 
+/**
+ * Helper thread of GroupSalience: evaluates its share of the children,
+ * or a block of rows of the weighted sum, on request.
+ */
+class iCub::vis::GroupSalienceWorker : public yarp::os::Thread {
+private:
+    GroupSalience *owner;
+    int slot;
+    Semaphore go;
+    Semaphore done;
+    bool combine;
+    int first;
+    int last;
+    ImageOf<PixelRgb> *src;
+    ImageOf<PixelRgb> *dest;
+    ImageOf<PixelFloat> *sal;
+
+public:
+    GroupSalienceWorker(GroupSalience *owner, int slot) :
+        owner(owner), slot(slot), go(0), done(0) {
+        combine = false;
+        first = last = 0;
+        src = dest = NULL;
+        sal = NULL;
+    }
+
+    void postChildren(ImageOf<PixelRgb> *src) {
+        this->combine = false;
+        this->src = src;
+        go.post();
+    }
+
+    void postCombine(int first, int last, ImageOf<PixelRgb> *dest, ImageOf<PixelFloat> *sal) {
+        this->combine = true;
+        this->first = first;
+        this->last = last;
+        this->dest = dest;
+        this->sal = sal;
+        go.post();
+    }
+
+    void wait() {
+        done.wait();
+    }
+
+    void run() {
+        while (!isStopping()) {
+            go.wait();
+            if (isStopping())
+                break;
+
+            if (combine)
+                owner->combineRows(first, last, *dest, *sal);
+            else
+                owner->applyChildren(slot, *src);
+            done.post();
+        }
+    }
+
+    void onStop() {
+        go.post();
+    }
+};
+
+
 bool GroupSalience::open(yarp::os::Searchable& config) {
 
     bool ok = Salience::open(config);
@@ -66,7 +131,9 @@ bool GroupSalience::open(yarp::os::Searchable& config) {
         
     }
 
-    return true;
+    int threads = config.check("threads",Value(1),
+                               "number of threads evaluating the subfilters").asInt();
+    return setNumThreads(threads);
 }
 
 bool GroupSalience::configure(Searchable& config){
@@ -119,28 +186,80 @@ void GroupSalience::apply(ImageOf<PixelRgb>& src,
                           ImageOf<PixelFloat>& sal) {
     dest.resize(src);
     sal.resize(src);
-    dest.zero();
-    sal.zero();
-    double weight_i;
+
+    // the children images are reused as long as the size does not change
     for (unsigned int i=0; i<group.size(); i++) {
-        ImageOf<PixelFloat>& sal_i = salienceMap[i];
-        ImageOf<PixelRgb>& dest_i = salienceView[i];
-        sal_i.resize(src);
-        dest_i.resize(src);
-        group[i]->apply(src, dest_i, sal_i);
-        weight_i = group[i]->getWeight() / weightSum;
-        IMGFOR(sal_i,x,y) {
-            sal(x,y) += (float)(weight_i * sal_i(x,y));
-            PixelRgb& pix_i = dest_i(x,y);
-            PixelRgb& pix = dest(x,y);
-            pix.r += (unsigned char)(weight_i * (int)pix_i.r);
-            pix.g += (unsigned char)(weight_i * (int)pix_i.g);
-            pix.b += (unsigned char)(weight_i * (int)pix_i.b);
+        salienceMap[i].resize(src);
+        salienceView[i].resize(src);
+    }
+
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k]->postChildren(&src);
+    applyChildren(0, src);
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k]->wait();
+
+    // the calling thread sums the first block of rows
+    int h = src.height();
+    int block = h / getNumThreads();
+    int first = h - block * (int)workers.size();
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k]->postCombine(first+(int)k*block, first+(int)(k+1)*block, &dest, &sal);
+    combineRows(0, first, dest, sal);
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k]->wait();
+}
+
+void GroupSalience::applyChildren(int slot, ImageOf<PixelRgb>& src) {
+    int n = getNumThreads();
+    for (int i=slot; i<(int)group.size(); i+=n)
+        group[i]->apply(src, salienceView[i], salienceMap[i]);
+}
+
+// same arithmetic as summing the children one after the other over whole
+// images, written as plain loops over the rows so that they can be vectorized
+void GroupSalience::combineRows(int first, int last,
+                                ImageOf<PixelRgb>& dest,
+                                ImageOf<PixelFloat>& sal) {
+    int w = sal.width();
+    for (int y=first; y<last; y++) {
+        float *s = (float*)sal.getRow(y);
+        unsigned char *d = dest.getRow(y);
+        for (int x=0; x<w; x++)
+            s[x] = 0.0f;
+        for (int x=0; x<3*w; x++)
+            d[x] = 0;
+
+        for (unsigned int i=0; i<group.size(); i++) {
+            double weight_i = group[i]->getWeight() / weightSum;
+            const float *s_i = (const float*)salienceMap[i].getRow(y);
+            const unsigned char *d_i = salienceView[i].getRow(y);
+            for (int x=0; x<w; x++)
+                s[x] += (float)(weight_i * s_i[x]);
+            for (int x=0; x<3*w; x++)
+                d[x] += (unsigned char)(weight_i * (int)d_i[x]);
         }
-        
     }
 }
 
+bool GroupSalience::setNumThreads(int n) {
+    if (n<1)
+        return false;
+
+    for (size_t k=0; k<workers.size(); k++) {
+        workers[k]->stop();
+        delete workers[k];
+    }
+    workers.clear();
+
+    for (int k=1; k<n; k++) {
+        GroupSalienceWorker *worker = new GroupSalienceWorker(this, k);
+        worker->start();
+        workers.push_back(worker);
+    }
+    return true;
+}
+
 void GroupSalience::add(Salience *filter){
     group.push_back(filter);
     ImageOf<PixelFloat> blankFloat;
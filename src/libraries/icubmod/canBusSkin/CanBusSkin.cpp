@@ -46,9 +46,17 @@ bool CanBusSkin::open(yarp::os::Searchable& config) {
     {
         cerr<<"Warning: CanBusSkin id list contains more than one entry -> devices will be merged. "<<endl;
     }
+    for (int i=0; i<16; i++)
+        cardIndex[i].clear();
     for (int i=0; i<ids.size(); i++)
     {
         int id = ids.get(i).asInt();
+        if (id<0 || id>15)
+        {
+            cerr<<"Error: CanBusSkin id "<<id<<" out of range [0, 15]"<<endl;
+            return false;
+        }
+        cardIndex[id].push_back(cardId.size());
         cardId.push_back (id);
         #if SKIN_DEBUG
             fprintf(stderr, "Id reading from %d\n", id);
@@ -130,8 +138,7 @@ bool CanBusSkin::open(yarp::os::Searchable& config) {
 
     //elements are:
     sensorsNum=16*12*cardId.size();
-    data.resize(sensorsNum);
-    data.zero();
+    frame.resize(sensorsNum,12);
 
     RateThread::start();
     return true;
@@ -152,7 +159,7 @@ bool CanBusSkin::close()
 int CanBusSkin::read(yarp::sig::Vector &out) 
 {
     mutex.wait();
-    out=data;
+    frame.toVector(out);
     mutex.post();
 
     return yarp::dev::IAnalogSensor::AS_OK;
@@ -191,6 +198,17 @@ int CanBusSkin::calibrateChannel(int ch)
 }
 
 
+bool CanBusSkin::readFrame(iCub::skinDynLib::skinFrame &out)
+{
+    mutex.wait();
+    out=frame;
+    frame.clearChanged();
+    mutex.post();
+
+    return true;
+}
+
+
 bool CanBusSkin::threadInit() {
     if(sendCANMessage4C()) {
         return sendCANMessage4E();
@@ -221,29 +239,19 @@ void CanBusSkin::run() {
         sensorId=msgid&0x000f;
 
         unsigned int type=msg.getData()[0]&0x80;
-        int len=msg.getLen();
 
-        for (int i=0; i<cardId.size(); i++)
+        // the cards are found straight from their address
+        const vector<int> &cards=cardIndex[id];
+        for (size_t c=0; c<cards.size(); c++)
         {
-            if (id==cardId[i])
-            {
-                int index=16*12*i + sensorId*12;
-                
-                if (type)
-                    {
-                        for(int k=0;k<5;k++)
-                            data[index+k+7]=msg.getData()[k+1];
-                    }
-                else 
-                    {
-                        for(int k=0;k<7;k++)
-                            data[index+k]=msg.getData()[k+1];
-                    }
-          //    else
-          //        {
-          //            std::cerr<<"Error: skin received malformed message\n";
-          //        }
-            }
+            int index=16*12*cards[c] + sensorId*12;
+
+            // the readings are stored as they are (8 bit) and the triangle
+            // is marked as changed only if some of them differ
+            if (type)
+                frame.update(index+7, msg.getData()+1, 5);
+            else
+                frame.update(index, msg.getData()+1, 7);
         }
     }
 
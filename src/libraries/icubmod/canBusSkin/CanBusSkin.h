@@ -9,6 +9,7 @@
 
 //#include <stdio.h>
 #include <string>
+#include <vector>
 
 #include <yarp/os/RateThread.h>
 #include <yarp/os/Semaphore.h>
@@ -18,8 +19,11 @@
 #include <yarp/dev/CanBusInterface.h>
 #include <yarp/sig/Vector.h>
 
+#include <iCub/skinDynLib/skinFrame.h>
 
-class CanBusSkin : public yarp::os::RateThread, public yarp::dev::IAnalogSensor, public yarp::dev::DeviceDriver 
+
+class CanBusSkin : public yarp::os::RateThread, public yarp::dev::IAnalogSensor, public yarp::dev::DeviceDriver,
+                   public iCub::skinDynLib::ISkinFrameSource
 {
 private:
     /* *************************************************************************************** */
@@ -50,9 +54,13 @@ protected:
     yarp::os::Semaphore mutex;
 
     yarp::sig::VectorOf<int> cardId;
+    // positions in cardId of each of the 16 CAN addresses (a repeated
+    // address gets the same readings in every position)
+    std::vector<int> cardIndex[16];
     int sensorsNum;
 
-    yarp::sig::Vector data;
+    // raw readings, one patch per triangle (12 taxels)
+    iCub::skinDynLib::skinFrame frame;
 
 public:
     CanBusSkin(int period=20) : RateThread(period),mutex(1) {}
@@ -75,6 +83,9 @@ public:
     virtual int calibrateSensor(const yarp::sig::Vector& v);
     virtual int calibrateChannel(int ch);
 
+    //ISkinFrameSource interface
+    virtual bool readFrame(iCub::skinDynLib::skinFrame &out);
+
 private:
     /**
      * Checks that the given parameter list, extracted from the configuration file, is of the same lenght as the number of cards on the CAN bus.
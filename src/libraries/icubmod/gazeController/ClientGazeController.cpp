@@ -869,6 +869,144 @@ bool ClientGazeController::triangulate3DPoint(const Vector &pxl, const Vector &p
 }
 
 
+/************************************************************************/
+bool ClientGazeController::get2DPixels(const int camSel, const Matrix &x, Matrix &px)
+{
+    if (!connected || (x.cols()<3))
+        return false;
+
+    Bottle command, reply;
+    command.addString("get");
+    command.addString("2Ds");
+    Bottle &bOpt=command.addList();
+    bOpt.addString((camSel==0)?"left":"right");
+    for (int i=0; i<x.rows(); i++)
+    {
+        bOpt.addDouble(x(i,0));
+        bOpt.addDouble(x(i,1));
+        bOpt.addDouble(x(i,2));
+    }
+
+    if (!portRpc.write(command,reply))
+    {
+        printf("Error: unable to get reply from server!\n");
+        return false;
+    }
+
+    if ((reply.get(0).asVocab()==GAZECTRL_ACK) && (reply.size()>1))
+    {
+        if (Bottle *bPixels=reply.get(1).asList())
+        {
+            if (bPixels->size()==2*x.rows())
+            {
+                px.resize(x.rows(),2);
+                for (int i=0; i<px.rows(); i++)
+                {
+                    px(i,0)=bPixels->get(2*i).asDouble();
+                    px(i,1)=bPixels->get(2*i+1).asDouble();
+                }
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/************************************************************************/
+bool ClientGazeController::get3DPoints(const int camSel, const Matrix &px,
+                                       const Vector &z, Matrix &x)
+{
+    if (!connected || (px.cols()<2) || ((int)z.length()!=px.rows()))
+        return false;
+
+    Bottle command, reply;
+    command.addString("get");
+    command.addString("3Ds");
+    command.addString("mono");
+    Bottle &bOpt=command.addList();
+    bOpt.addString((camSel==0)?"left":"right");
+    for (int i=0; i<px.rows(); i++)
+    {
+        bOpt.addDouble(px(i,0));
+        bOpt.addDouble(px(i,1));
+        bOpt.addDouble(z[i]);
+    }
+
+    if (!portRpc.write(command,reply))
+    {
+        printf("Error: unable to get reply from server!\n");
+        return false;
+    }
+
+    if ((reply.get(0).asVocab()==GAZECTRL_ACK) && (reply.size()>1))
+    {
+        if (Bottle *bPoints=reply.get(1).asList())
+        {
+            if (bPoints->size()==3*px.rows())
+            {
+                x.resize(px.rows(),3);
+                for (int i=0; i<x.rows(); i++)
+                    for (int j=0; j<3; j++)
+                        x(i,j)=bPoints->get(3*i+j).asDouble();
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/************************************************************************/
+bool ClientGazeController::triangulate3DPoints(const Matrix &pxl, const Matrix &pxr,
+                                               Matrix &x)
+{
+    if (!connected || (pxl.cols()<2) || (pxr.cols()<2) || (pxl.rows()!=pxr.rows()))
+        return false;
+
+    Bottle command, reply;
+    command.addString("get");
+    command.addString("3Ds");
+    command.addString("stereo");
+    Bottle &bOpt=command.addList();
+    for (int i=0; i<pxl.rows(); i++)
+    {
+        bOpt.addDouble(pxl(i,0));
+        bOpt.addDouble(pxl(i,1));
+        bOpt.addDouble(pxr(i,0));
+        bOpt.addDouble(pxr(i,1));
+    }
+
+    if (!portRpc.write(command,reply))
+    {
+        printf("Error: unable to get reply from server!\n");
+        return false;
+    }
+
+    if ((reply.get(0).asVocab()==GAZECTRL_ACK) && (reply.size()>1))
+    {
+        if (Bottle *bPoints=reply.get(1).asList())
+        {
+            if (bPoints->size()==3*pxl.rows())
+            {
+                x.resize(pxl.rows(),3);
+                for (int i=0; i<x.rows(); i++)
+                    for (int j=0; j<3; j++)
+                        x(i,j)=bPoints->get(3*i+j).asDouble();
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
 /************************************************************************/
 bool ClientGazeController::getJointsDesired(Vector &qdes)
 {
@@ -48,6 +48,7 @@
 #include <yarp/os/BufferedPort.h>
 #include <yarp/os/Stamp.h>
 #include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
 
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/dev/GazeControl.h>
@@ -192,6 +193,13 @@ public:
     bool tweakSet(const yarp::os::Bottle &options);
     bool tweakGet(yarp::os::Bottle &options);
 
+    // batch versions of get2DPixel(), get3DPoint() and triangulate3DPoint():
+    // points and pixels are given as the rows of the matrices and are
+    // processed by the server in one go against the same kinematics
+    bool get2DPixels(const int camSel, const yarp::sig::Matrix &x, yarp::sig::Matrix &px);
+    bool get3DPoints(const int camSel, const yarp::sig::Matrix &px, const yarp::sig::Vector &z, yarp::sig::Matrix &x);
+    bool triangulate3DPoints(const yarp::sig::Matrix &pxl, const yarp::sig::Matrix &pxr, yarp::sig::Matrix &x);
+
     virtual ~ClientGazeController();
 };
 
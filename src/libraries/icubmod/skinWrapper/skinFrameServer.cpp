@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ *
+ */
+
+#include "skinFrameServer.h"
+#include "Debug.h"
+
+using namespace std;
+using namespace yarp::os;
+using namespace iCub::skinDynLib;
+
+SkinFrameServer::SkinFrameServer(int period, int _keyFrame) : RateThread(period)
+{
+    yTrace();
+    source=NULL;
+    keyFrame=_keyFrame>0 ? _keyFrame : 1;
+    counter=0;
+}
+
+SkinFrameServer::~SkinFrameServer()
+{
+    yTrace();
+    for(unsigned int i=0; i<framePorts.size(); i++)
+    {
+        framePorts[i]->port.close();
+        delete framePorts[i];
+    }
+}
+
+bool SkinFrameServer::addPort(const string &name, int offset, int length)
+{
+    SkinFramePortEntry *entry=new SkinFramePortEntry;
+    entry->port_name=name;
+    entry->offset=offset;
+    entry->length=length;
+    entry->seq=0;
+    if (!entry->port.open(name.c_str()))
+    {
+        yError() << "SkinFrameServer: unable to open port " << name.c_str();
+        delete entry;
+        return false;
+    }
+    framePorts.push_back(entry);
+    return true;
+}
+
+void SkinFrameServer::attach(ISkinFrameSource *s)
+{
+    yTrace();
+    source=s;
+}
+
+void SkinFrameServer::threadRelease()
+{
+    yTrace();
+    for(unsigned int i=0; i<framePorts.size(); i++)
+    {
+        framePorts[i]->port.interrupt();
+    }
+}
+
+void SkinFrameServer::publish(SkinFramePortEntry &entry, bool key)
+{
+    int first=entry.offset;
+    int n=(entry.length==-1) ? frame.size()-first : entry.length;
+    if ((n<=0) || (first+n>frame.size()))
+    {
+        yError() << "SkinFrameServer: port " << entry.port_name.c_str() << " exceeds the " << frame.size() << " taxels of the device";
+        return;
+    }
+
+    // a new state starts with all the patches marked as changed
+    int ps=frame.getPatchSize();
+    if (entry.state.size()!=n)
+        entry.state.resize(n,ps);
+
+    // copy only the patches of the port overlapping a changed patch of the device
+    for (int p=0; p<entry.state.getPatchNum(); p++)
+    {
+        int a=first+p*ps;
+        int b=(p+1)*ps<n ? first+(p+1)*ps : first+n;
+        bool changed=false;
+        for (int dp=a/ps; (dp<=(b-1)/ps) && !changed; dp++)
+            changed=frame.isChanged(dp);
+        if (changed)
+            entry.state.update(p*ps, frame.data()+a, b-a);
+    }
+
+    // nothing to say, the readers keep the last frame
+    if (!key && !entry.state.anyChanged())
+        return;
+
+    // the readers detect a lost frame through the sequence number
+    skinFrame &out=entry.port.prepare();
+    out=entry.state;
+    out.setFull(key);
+    out.setSeq(entry.seq++);
+    entry.port.setEnvelope(lastStateStamp);
+    entry.port.write();
+    entry.state.clearChanged();
+}
+
+void SkinFrameServer::run()
+{
+    if ((source==NULL) || !source->readFrame(frame))
+        return;
+
+    lastStateStamp.update();
+    bool key=(counter==0);
+    if (++counter>=keyFrame)
+        counter=0;
+
+    for(unsigned int i=0; i<framePorts.size(); i++)
+    {
+        publish(*framePorts[i],key);
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ *
+ */
+
+#ifndef SKINFRAMESERVER_H_
+#define SKINFRAMESERVER_H_
+
+#include <string>
+#include <vector>
+
+#include <yarp/os/RateThread.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Stamp.h>
+
+#include <iCub/skinDynLib/skinFrame.h>
+
+/**
+  * Output port streaming a range of taxels as skinFrame.
+  */
+struct SkinFramePortEntry
+{
+    yarp::os::BufferedPort<iCub::skinDynLib::skinFrame> port;
+    std::string port_name;              // the complete name of the port
+    int offset;                         // the port is mapped starting from this taxel
+    int length;                         // number of taxels of the port (-1 for max length)
+    iCub::skinDynLib::skinFrame state;  // readings last published on the port
+    unsigned int seq;                   // sequence number of the next frame of the port
+};
+
+/**
+  * It reads the raw frames from a skin device and publishes them in compact
+  * form: a port is written only when some of its patches changed, and then
+  * only the changed patches are sent, except for a full frame every keyFrame
+  * periods so that the readers connected later can synchronize.
+  */
+class SkinFrameServer: public yarp::os::RateThread
+{
+private:
+    iCub::skinDynLib::ISkinFrameSource *source;     // the device to read from
+    iCub::skinDynLib::skinFrame frame;              // last frame read from the device
+    std::vector<SkinFramePortEntry*> framePorts;    // the list of output ports
+    yarp::os::Stamp lastStateStamp;                 // the last reading time stamp
+    int keyFrame;
+    int counter;
+
+    void publish(SkinFramePortEntry &entry, bool key);
+
+public:
+    SkinFrameServer(int period=20, int _keyFrame=50);
+    ~SkinFrameServer();
+
+    /**
+      * Open an output port streaming the taxels [offset, offset+length),
+      * or all the taxels from offset on if length is -1.
+      */
+    bool addPort(const std::string &name, int offset, int length);
+
+    void attach(iCub::skinDynLib::ISkinFrameSource *s);
+
+    void threadRelease();
+    void run();
+};
+
+#endif /* SKINFRAMESERVER_H_ */
@@ -17,6 +17,9 @@ skinWrapper::skinWrapper()
     yTrace(); 
     analogServer=NULL;
     analog=NULL;
+    frameServer=NULL;
+    compact=true;
+    keyFrame=50;
 		setId("undefinedPartName");
 }
 
@@ -61,6 +64,11 @@ bool skinWrapper::open(yarp::os::Searchable &inputParams)
         yDebug() <<"SkinWrapper Warning: part "<<id<<" using default period ("<<period<<")\n";
     }
 
+    // the raw frames are also streamed in compact form on <port>/compact:o,
+    // provided that the device supports it
+    compact=params.check("compact",Value(1)).asInt()!=0;
+    keyFrame=params.check("keyFrame",Value(50)).asInt();
+
 /*  // Open the device -- no necessary, the factory will do the job, add an attach method for getting the IAnalogInterface from the sensor
     
 		std::string devicename=params.find("device").asString().c_str();
@@ -156,6 +164,15 @@ bool skinWrapper::open(yarp::os::Searchable &inputParams)
     // If everything is ok create analog server, for now with period 0 (disabled I guess)
     analogServer = new yarp::dev::AnalogServer(skinPorts);
     analogServer->setRate(0);
+
+    // the compact ports mirror the analog ones, they are dropped at attach time
+    // if the device cannot provide its raw frames
+    if (compact)
+    {
+        frameServer = new SkinFrameServer(period, keyFrame);
+        for(size_t k=0;k<skinPorts.size();k++)
+            frameServer->addPort(skinPorts[k].port_name+"/compact:o", skinPorts[k].offset, skinPorts[k].length);
+    }
     return true;
 }
 
@@ -165,6 +182,12 @@ bool skinWrapper::close()
     {
         delete analogServer;
     }
+    if (NULL != frameServer)
+    {
+        frameServer->stop();
+        delete frameServer;
+        frameServer=NULL;
+    }
     if (NULL != analog)
         analog=0;
 
@@ -212,6 +235,24 @@ bool skinWrapper::attachAll(const yarp::dev::PolyDriverList &skinDev)
     analogServer->setRate(period);
     analogServer->attach(analog);
     analogServer->start();
+
+    if (NULL != frameServer)
+    {
+        iCub::skinDynLib::ISkinFrameSource *frameSource=NULL;
+        subdevice->view(frameSource);
+        if (NULL != frameSource)
+        {
+            frameServer->setRate(period);
+            frameServer->attach(frameSource);
+            frameServer->start();
+        }
+        else
+        {
+            yDebug() << "skinWrapper: the device of part " << id << " does not provide raw frames, no compact ports";
+            delete frameServer;
+            frameServer=NULL;
+        }
+    }
     return true;
 }
 
@@ -219,6 +260,8 @@ bool skinWrapper::detachAll()
 {
     yTrace();
     analogServer->stop();
+    if (NULL != frameServer)
+        frameServer->stop();
     return true;
 }
 
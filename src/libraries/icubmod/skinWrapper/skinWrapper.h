@@ -40,6 +40,7 @@
 #include <yarp/dev/Wrapper.h>
 
 #include "analogServer.h"
+#include "skinFrameServer.h"
 #include "Debug.h"
 
 class skinWrapper : public yarp::dev::DeviceDriver,
@@ -51,6 +52,11 @@ private:
     int period;
     yarp::dev::IAnalogSensor *analog;
 
+    // compact streaming of the raw frames, if the device supports it
+    SkinFrameServer *frameServer;
+    bool compact;
+    int keyFrame;
+
 
 //    yarp::sig::Vector wholeData;      // may be useful if one the skin wrapper has to get data from more than one device...
 
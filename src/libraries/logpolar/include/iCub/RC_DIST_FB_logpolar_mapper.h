@@ -46,6 +46,8 @@
 #define RC_DIST_FB_logpolar_mapper_h
 
 #include <iostream>
+#include <vector>
+#include <string>
 #include <string.h>
 
 #include <yarp/sig/Image.h>
@@ -63,6 +65,7 @@ namespace iCub {
     */
     namespace logpolar {
         class logpolarTransform;
+        class logpolarWorker;
 
         const double PI = 3.1415926535897932384626433832795;
 
@@ -137,6 +140,33 @@ class iCub::logpolar::logpolarTransform {
 private:
     cart2LpPixel *c2lTable;
     lp2CartPixel *l2cTable;
+
+    /*
+    * Flattened (CSR-like) copies of the lookup tables used at run time.
+    * The entries of output pixel k span [index[k], index[k+1]) of the data
+    * array: (position, weight) pairs for c2l, positions only for l2c.
+    * The norm arrays hold the reciprocal of the per pixel normalizers.
+    */
+    int *c2lIndex_;
+    int *c2lData_;
+    double *c2lNorm_;
+    int *l2cIndex_;
+    int *l2cData_;
+    double *l2cNorm_;
+
+    /*
+    * When the flattened tables come from the on-disk cache, they live in
+    * read-only memory mappings shared among all the processes using the
+    * same tables; these are the mappings (0 when the tables are on the heap).
+    */
+    void *c2lMap_;
+    size_t c2lMapSize_;
+    void *l2cMap_;
+    size_t l2cMapSize_;
+    std::string cacheDir_;
+
+    std::vector<logpolarWorker*> workers_;
+
     int necc_;
     int nang_;
     int width_;
@@ -165,6 +195,47 @@ private:
     */
     void RCdeAllocateL2CTable ();
 
+    /**
+    * \brief Flattens the c2l look-up table into the contiguous arrays used by the remapping.
+    * @return true iff successful.
+    */
+    bool RCflattenC2LTable ();
+
+    /**
+    * \brief Flattens the l2c look-up table into the contiguous arrays used by the remapping.
+    * @return true iff successful.
+    */
+    bool RCflattenL2CTable ();
+
+    /**
+    * \brief Builds the name of the cache file of a flattened table.
+    * @param which is either C2L or L2C.
+    * @param padding is the padding the table has been built with.
+    * @return the full path of the file, empty when the cache is disabled.
+    */
+    std::string RCcacheFileName (int which, int padding);
+
+    /**
+    * \brief Maps a flattened table from the cache, replacing the one in memory if any.
+    * @param which is either C2L or L2C.
+    * @param padding is the padding the table has been built with.
+    * @return true iff a valid table has been found.
+    */
+    bool RCloadTable (int which, int padding);
+
+    /**
+    * \brief Stores a flattened table into the cache.
+    * @param which is either C2L or L2C.
+    * @param padding is the padding the table has been built with.
+    * @return true iff successful.
+    */
+    bool RCsaveTable (int which, int padding);
+
+    /**
+    * \brief Releases a flattened table, either unmapping or deleting it.
+    */
+    static void freeFlatTable (int *&index, int *&data, double *&norm, void *&map, size_t &mapSize);
+
     /**
     * \brief Generates the look-up table for the transformation from a cartesian image to a log polar one, both images are color images
     * @param scaleFact the ratio between the size of the smallest logpolar pixel and the cartesian ones
@@ -193,23 +264,29 @@ private:
     * \brief Generates a log polar image from a cartesian one
     * @param lpImg is the output LogPolar image
     * @param cartImg is the input Cartesian image
-    * @param Table is the LUT used for the transformation
     * @param padding is the padding of the logpolar image (output)
-    is generated otherways
     */
-    void RCgetLpImg (unsigned char *lpImg,
-                     unsigned char *cartImg,
-                     cart2LpPixel * Table, 
-                     int padding);
+    void RCgetLpImg (unsigned char *lpImg, const unsigned char *cartImg, int padding);
 
     /**
     * \brief Remaps a log polar image to a cartesian one
     * @param cartImg is the output Cartesian image
     * @param lpImg is the input LogPolar image
-    * @param Table is the LUT used for the transformation
-    * @param cartSize is the size of the log polar image
+    * @param padding is the padding of the cartesian image (output)
     */
-    void RCgetCartImg (unsigned char *cartImg, unsigned char *lpImg, lp2CartPixel * Table, int cartSize);
+    void RCgetCartImg (unsigned char *cartImg, const unsigned char *lpImg, int padding);
+
+    /**
+    * \brief Computes the rings [first, last) of a log polar image from a cartesian one
+    */
+    void RCgetLpRows (unsigned char *lpImg, const unsigned char *cartImg, int padding, int first, int last);
+
+    /**
+    * \brief Computes the rows [first, last) of a cartesian image from a log polar one
+    */
+    void RCgetCartRows (unsigned char *cartImg, const unsigned char *lpImg, int padding, int first, int last);
+
+    friend class logpolarWorker;
 
     /**
     * \brief Computes the logarithm index
@@ -231,6 +308,17 @@ public:
     logpolarTransform() {
         c2lTable = 0;
         l2cTable = 0;
+        c2lIndex_ = 0;
+        c2lData_ = 0;
+        c2lNorm_ = 0;
+        l2cIndex_ = 0;
+        l2cData_ = 0;
+        l2cNorm_ = 0;
+        c2lMap_ = 0;
+        c2lMapSize_ = 0;
+        l2cMap_ = 0;
+        l2cMapSize_ = 0;
+        cacheDir_ = defaultCacheDirectory();
         necc_ = 0;
         nang_ = 0;
         width_ = 0;
@@ -241,6 +329,7 @@ public:
 
     /** destructor */
     virtual ~logpolarTransform() {
+        setNumThreads(1);
         freeLookupTables();
     }
 
@@ -249,7 +338,7 @@ public:
      * @return true iff one or both LUTs are different from zero.
      */
     virtual const bool allocated() const {
-        if (c2lTable != 0 || l2cTable != 0)
+        if (c2lIndex_ != 0 || l2cIndex_ != 0)
             return true;
         else
             return false;
@@ -257,6 +346,9 @@ public:
 
     /**
      * alloc the lookup tables and stores them in memory.
+     * The tables are looked for in the cache directory first, where they
+     * are memory-mapped and shared among processes; when missing, they
+     * are built and stored there for the next time.
      * @param necc is the number of eccentricities of the logpolar image.
      * @param nang is the number of angles of the logpolar image.
      * @param w is the width of the original rectangular image.
@@ -292,6 +384,44 @@ public:
     virtual bool logpolarToCart(yarp::sig::ImageOf<yarp::sig::PixelRgb>& cart,
                                 const yarp::sig::ImageOf<yarp::sig::PixelRgb>& lp);
 
+    /**
+     * set the directory of the lookup tables cache; it is taken into
+     * account by the next allocation.
+     * @param dir is the directory, an empty string disables the cache.
+     */
+    void setCacheDirectory(const std::string &dir) { cacheDir_ = dir; }
+
+    /**
+     * get the directory of the lookup tables cache.
+     * @return the directory, empty when the cache is disabled.
+     */
+    const std::string &getCacheDirectory(void) const { return cacheDir_; }
+
+    /**
+     * the default directory of the lookup tables cache: the value of the
+     * ICUB_LOGPOLAR_CACHE environment variable if defined, an empty
+     * string (the cache is disabled) otherwise. The directory should be
+     * writable by its owner only, since the cached tables are trusted
+     * once they pass the consistency checks.
+     * @return the default directory.
+     */
+    static std::string defaultCacheDirectory(void);
+
+    /**
+     * set the number of threads sharing the rows of each conversion
+     * (the calling thread included). Rows are split in contiguous
+     * blocks, therefore the result does not depend on the number of threads.
+     * @param n is the number of threads (default 1, i.e. no helper threads).
+     * @return true iff successful.
+     */
+    bool setNumThreads(int n);
+
+    /**
+     * get the number of threads sharing the rows of each conversion.
+     * @return the number of threads, the calling thread included.
+     */
+    int getNumThreads(void) const { return (int)workers_.size()+1; }
+
     /**
      * check the number of eccentricities (rings).
      * @return the number of rings in the logpolar mapping (default 152).
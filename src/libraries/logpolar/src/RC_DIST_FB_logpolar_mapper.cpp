@@ -25,16 +25,92 @@
 
 #include <iCub/RC_DIST_FB_logpolar_mapper.h>
 #include <yarp/sig/IplImage.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
 
 #include <iostream>
+#include <sstream>
 #include <math.h>
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef WIN32
+#include <windows.h>
+#include <process.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace iCub::logpolar;
 using namespace yarp::os;
 using namespace yarp::sig;
 using namespace std;
 
+/**
+ * helper thread of logpolarTransform, computing a block of rows of
+ * either conversion on request.
+ */
+class iCub::logpolar::logpolarWorker : public yarp::os::Thread {
+private:
+    logpolarTransform *owner;
+    yarp::os::Semaphore go;
+    yarp::os::Semaphore done;
+    bool toLp;
+    unsigned char *dst;
+    const unsigned char *src;
+    int padding;
+    int first;
+    int last;
+
+public:
+    logpolarWorker(logpolarTransform *owner) : owner(owner), go(0), done(0) {
+        toLp = true;
+        dst = 0;
+        src = 0;
+        padding = first = last = 0;
+    }
+
+    void post(bool toLp, unsigned char *dst, const unsigned char *src, int padding, int first, int last) {
+        this->toLp = toLp;
+        this->dst = dst;
+        this->src = src;
+        this->padding = padding;
+        this->first = first;
+        this->last = last;
+        go.post();
+    }
+
+    void wait() {
+        done.wait();
+    }
+
+    void run() {
+        while (!isStopping()) {
+            go.wait();
+            if (isStopping())
+                break;
+
+            if (toLp)
+                owner->RCgetLpRows(dst, src, padding, first, last);
+            else
+                owner->RCgetCartRows(dst, src, padding, first, last);
+            done.post();
+        }
+    }
+
+    void onStop() {
+        go.post();
+    }
+};
+
 //
 bool iCub::logpolar::subsampleFovea(yarp::sig::ImageOf<yarp::sig::PixelRgb>& dst, const yarp::sig::ImageOf<yarp::sig::PixelRgb>& src) {
     //
@@ -131,24 +207,47 @@ bool logpolarTransform::allocLookupTables(int mode, int necc, int nang, int w, i
     mode_ = mode;
     const double scaleFact = RCcomputeScaleFactor ();    
     
-    if (c2lTable == 0 && (mode & C2L)) {
+    const int c2lPadding = PAD_BYTES(w*3, YARP_IMAGE_ALIGN);
+    const int l2cPadding = PAD_BYTES(nang*3, YARP_IMAGE_ALIGN);
+
+    if (c2lIndex_ == 0 && (mode & C2L) && !RCloadTable (C2L, c2lPadding)) {
         c2lTable = new cart2LpPixel[necc*nang];
         if (c2lTable == 0) {
             cerr << "logpolarTransform: can't allocate c2l lookup tables, wrong size?" << endl;
             return false;
         }
+        c2lTable[0].position = 0;
+
+        // the pointer based table is only an intermediate step.
+        const bool ok = (RCbuildC2LMap (scaleFact, ELLIPTICAL, c2lPadding) == 0) && RCflattenC2LTable ();
+        RCdeAllocateC2LTable ();
+        if (!ok) {
+            cerr << "logpolarTransform: can't build c2l lookup tables" << endl;
+            return false;
+        }
 
-        RCbuildC2LMap (scaleFact, ELLIPTICAL, PAD_BYTES(w*3, YARP_IMAGE_ALIGN));
+        // from now on the table is shared through the cache, if possible.
+        if (RCsaveTable (C2L, c2lPadding))
+            RCloadTable (C2L, c2lPadding);
     }
 
-    if (l2cTable == 0 && (mode & L2C)) {
+    if (l2cIndex_ == 0 && (mode & L2C) && !RCloadTable (L2C, l2cPadding)) {
         l2cTable = new lp2CartPixel[w*h];
         if (l2cTable == 0) {
             cerr << "logPolarLibrary: can't allocate l2c lookup tables, wrong size?" << endl;
             return false;
         }
+        l2cTable[0].position = 0;
 
-        RCbuildL2CMap (scaleFact, 0, 0, ELLIPTICAL, PAD_BYTES(nang*3, YARP_IMAGE_ALIGN));
+        const bool ok = (RCbuildL2CMap (scaleFact, 0, 0, ELLIPTICAL, l2cPadding) == 0) && RCflattenL2CTable ();
+        RCdeAllocateL2CTable ();
+        if (!ok) {
+            cerr << "logpolarTransform: can't build l2c lookup tables" << endl;
+            return false;
+        }
+
+        if (RCsaveTable (L2C, l2cPadding))
+            RCloadTable (L2C, l2cPadding);
     }
     return true;
 }
@@ -158,6 +257,30 @@ bool logpolarTransform::freeLookupTables() {
         RCdeAllocateC2LTable ();
     if (l2cTable)
         RCdeAllocateL2CTable ();
+
+    freeFlatTable (c2lIndex_, c2lData_, c2lNorm_, c2lMap_, c2lMapSize_);
+    freeFlatTable (l2cIndex_, l2cData_, l2cNorm_, l2cMap_, l2cMapSize_);
+    return true;
+}
+
+bool logpolarTransform::setNumThreads(int n) {
+    if (n < 1) {
+        cerr << "logpolarTransform: the number of threads must be at least 1" << endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < workers_.size(); i++) {
+        workers_[i]->stop();
+        delete workers_[i];
+    }
+    workers_.clear();
+
+    // the calling thread computes the first block of rows.
+    for (int i = 1; i < n; i++) {
+        logpolarWorker *w = new logpolarWorker(this);
+        w->start();
+        workers_.push_back(w);
+    }
     return true;
 }
 
@@ -169,7 +292,7 @@ bool logpolarTransform::cartToLogpolar(yarp::sig::ImageOf<yarp::sig::PixelRgb>&
     }
 
     // LATER: assert whether lp & cart are effectively nang * necc as the c2lTable requires.
-    RCgetLpImg (lp.getRawImage(), (unsigned char *)cart.getRawImage(), c2lTable, lp.getPadding());
+    RCgetLpImg (lp.getRawImage(), cart.getRawImage(), lp.getPadding());
     return true;
 }
 
@@ -181,7 +304,7 @@ bool logpolarTransform::logpolarToCart(yarp::sig::ImageOf<yarp::sig::PixelRgb>&
     }
 
     // LATER: assert whether lp & cart are effectively of the correct size.
-    RCgetCartImg (cart.getRawImage(), lp.getRawImage(), l2cTable, cart.getPadding());
+    RCgetCartImg (cart.getRawImage(), lp.getRawImage(), cart.getPadding());
 
     return true;
 }
@@ -538,71 +661,405 @@ C2LAllocError:
     return 2;
 }
 
-void logpolarTransform::RCgetLpImg (unsigned char *lpImg, unsigned char *cartImg, cart2LpPixel * Table, int padding)
+
+// on-disk cache of the flattened tables.
+//
+// A file holds one direction of the mapping: the header below, followed by
+// the normalizers (double[entries]), the index (int[entries+1]) and the data
+// (int[dataSize]). The header is a multiple of 8 bytes long, so that the
+// normalizers are aligned once the file is mapped. Files are written under a
+// temporary name and then renamed, so that a concurrent reader either finds
+// a complete table or none at all. Any change to the tables or to the layout
+// must bump LP_CACHE_VERSION.
+
+#define LP_CACHE_VERSION 1
+
+struct lpCacheHeader {
+    char magic[8];      // "LPTABLE"
+    int version;
+    int byteOrder;      // 1 as written by the host, detects foreign files
+    int which;          // C2L or L2C
+    int necc;
+    int nang;
+    int width;
+    int height;
+    int padding;
+    int entries;        // output pixels
+    int dataSize;       // ints in the data array
+    double overlap;
+};
+
+static void *mapFile (const std::string &name, size_t &size)
 {
-    int r[3];
-    int t = 0;
+#ifdef WIN32
+    HANDLE file = CreateFileA (name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return 0;
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx (file, &sz) || sz.QuadPart == 0) {
+        CloseHandle (file);
+        return 0;
+    }
 
-    unsigned char *img = lpImg;
+    HANDLE mapping = CreateFileMappingA (file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle (file);
+    if (mapping == NULL)
+        return 0;
+
+    // the view keeps the mapping alive.
+    void *view = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle (mapping);
+    size = (size_t)sz.QuadPart;
+    return view;
+#else
+    int fd = open (name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    struct stat st;
+    if (fstat (fd, &st) != 0 || st.st_size == 0) {
+        close (fd);
+        return 0;
+    }
 
-    for (int i = 0; i < necc_; i++, img+=padding) {
-        for (int j = 0; j < nang_; j++) {
-            r[0] = r[1] = r[2] = 0;
-            t = 0;
-
-            const int div = Table->divisor;
-            int *pos = Table->position;
-            int *w = Table->iweight;
-            for (int i = 0; i < div; i++, pos++, w++) {
-                int *d = r;
-                unsigned char *in = &cartImg[*pos];
-                *d++ += *in++ * *w;
-                *d++ += *in++ * *w;
-                *d += *in * *w;
-                t += *w;
-            }
+    // the mapping outlives the descriptor.
+    void *view = mmap (0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (view == MAP_FAILED)
+        return 0;
+
+    size = (size_t)st.st_size;
+    return view;
+#endif
+}
+
+static void unmapFile (void *view, size_t size)
+{
+#ifdef WIN32
+    UnmapViewOfFile (view);
+#else
+    munmap (view, size);
+#endif
+}
+
+void logpolarTransform::freeFlatTable (int *&index, int *&data, double *&norm, void *&map, size_t &mapSize)
+{
+    if (map != 0)
+        unmapFile (map, mapSize);
+    else {
+        delete[] index;
+        delete[] data;
+        delete[] norm;
+    }
+    index = data = 0;
+    norm = 0;
+    map = 0;
+    mapSize = 0;
+}
 
-            *img++ = (unsigned char)(r[0] / t);
-            *img++ = (unsigned char)(r[1] / t);
-            *img++ = (unsigned char)(r[2] / t);
+// the cache is opt-in: a shared directory such as /tmp would let anybody
+// plant the tables read by the conversions.
+std::string logpolarTransform::defaultCacheDirectory (void)
+{
+    const char *dir = getenv ("ICUB_LOGPOLAR_CACHE");
+    return (dir != 0) ? dir : "";
+}
+
+std::string logpolarTransform::RCcacheFileName (int which, int padding)
+{
+    if (cacheDir_.empty())
+        return "";
+
+    ostringstream name;
+    name.precision(17);
+    name << cacheDir_ << "/logpolar_" << ((which == C2L) ? "c2l" : "l2c")
+         << "_v" << LP_CACHE_VERSION << "_" << necc_ << "x" << nang_ << "_"
+         << width_ << "x" << height_ << "_" << overlap_ << "_" << padding << ".tab";
+    return name.str();
+}
+
+bool logpolarTransform::RCloadTable (int which, int padding)
+{
+    const std::string name = RCcacheFileName (which, padding);
+    if (name.empty())
+        return false;
 
-            Table++;
+    size_t size = 0;
+    char *view = (char*)mapFile (name, size);
+    if (view == 0)
+        return false;
+
+    const int entries = (which == C2L) ? necc_ * nang_ : width_ * height_;
+    const int perEntry = (which == C2L) ? 2 : 1;
+    const lpCacheHeader *h = (const lpCacheHeader*)view;
+
+    bool ok = (size >= sizeof(lpCacheHeader)) &&
+              (strncmp (h->magic, "LPTABLE", 8) == 0) &&
+              (h->version == LP_CACHE_VERSION) && (h->byteOrder == 1) &&
+              (h->which == which) && (h->necc == necc_) && (h->nang == nang_) &&
+              (h->width == width_) && (h->height == height_) &&
+              (h->padding == padding) && (h->overlap == overlap_) &&
+              (h->entries == entries) && (h->dataSize >= 0);
+
+    ok = ok && (size == sizeof(lpCacheHeader) + entries * sizeof(double) +
+                        (entries + 1) * sizeof(int) + perEntry * (size_t)h->dataSize * sizeof(int));
+
+    double *norm = (double*)(view + sizeof(lpCacheHeader));
+    int *index = (int*)(norm + entries);
+    int *data = index + entries + 1;
+    ok = ok && (index[0] == 0) && (index[entries] == h->dataSize);
+
+    // the conversions trust the tables blindly: every entry must stay
+    // within the data array and every pixel offset within the source image.
+    for (int k = 0; ok && k < entries; k++)
+        ok = (index[k] <= index[k+1]) && (norm[k] >= 0.0) && (norm[k] <= 1.0);
+
+    const int srcSize = (which == C2L) ? height_ * (width_ * 3 + padding) : necc_ * (nang_ * 3 + padding);
+    for (int k = 0; ok && k < h->dataSize; k++) {
+        const int *e = data + perEntry * k;
+        ok = (e[0] >= 0) && (e[0] <= srcSize - 3) && (perEntry == 1 || e[1] >= 0);
+    }
+
+    if (!ok) {
+        cerr << "logpolarTransform: ignoring the stale cache file " << name << endl;
+        unmapFile (view, size);
+        return false;
+    }
+
+    // the tables are only read from now on, mapping them read-only is safe.
+    if (which == C2L) {
+        freeFlatTable (c2lIndex_, c2lData_, c2lNorm_, c2lMap_, c2lMapSize_);
+        c2lIndex_ = index;
+        c2lData_ = data;
+        c2lNorm_ = norm;
+        c2lMap_ = view;
+        c2lMapSize_ = size;
+    }
+    else {
+        freeFlatTable (l2cIndex_, l2cData_, l2cNorm_, l2cMap_, l2cMapSize_);
+        l2cIndex_ = index;
+        l2cData_ = data;
+        l2cNorm_ = norm;
+        l2cMap_ = view;
+        l2cMapSize_ = size;
+    }
+    return true;
+}
+
+bool logpolarTransform::RCsaveTable (int which, int padding)
+{
+    const std::string name = RCcacheFileName (which, padding);
+    if (name.empty())
+        return false;
+
+    const int entries = (which == C2L) ? necc_ * nang_ : width_ * height_;
+    const int perEntry = (which == C2L) ? 2 : 1;
+    const int *index = (which == C2L) ? c2lIndex_ : l2cIndex_;
+    const int *data = (which == C2L) ? c2lData_ : l2cData_;
+    const double *norm = (which == C2L) ? c2lNorm_ : l2cNorm_;
+
+    lpCacheHeader h;
+    memset (&h, 0, sizeof(h));
+    strncpy (h.magic, "LPTABLE", 8);
+    h.version = LP_CACHE_VERSION;
+    h.byteOrder = 1;
+    h.which = which;
+    h.necc = necc_;
+    h.nang = nang_;
+    h.width = width_;
+    h.height = height_;
+    h.padding = padding;
+    h.entries = entries;
+    h.dataSize = index[entries];
+    h.overlap = overlap_;
+
+    ostringstream tmp;
+#ifdef WIN32
+    tmp << name << "." << _getpid() << ".tmp";
+#else
+    tmp << name << "." << getpid() << ".tmp";
+#endif
+
+    // never follow nor reuse an existing file, it might not be ours.
+#ifdef WIN32
+    int fd = _open (tmp.str().c_str(), _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+    FILE *f = (fd >= 0) ? _fdopen (fd, "wb") : 0;
+#else
+    int fd = open (tmp.str().c_str(), O_CREAT | O_EXCL | O_WRONLY, 0600);
+    FILE *f = (fd >= 0) ? fdopen (fd, "wb") : 0;
+#endif
+    if (f == 0) {
+        if (fd >= 0) {
+#ifdef WIN32
+            _close (fd);
+#else
+            close (fd);
+#endif
+            remove (tmp.str().c_str());
         }
+        cerr << "logpolarTransform: can't write the cache file " << name << endl;
+        return false;
+    }
+
+    bool ok = (fwrite (&h, sizeof(h), 1, f) == 1) &&
+              (fwrite (norm, sizeof(double), entries, f) == (size_t)entries) &&
+              (fwrite (index, sizeof(int), entries + 1, f) == (size_t)(entries + 1)) &&
+              (fwrite (data, sizeof(int), perEntry * h.dataSize, f) == (size_t)(perEntry * h.dataSize));
+    ok = (fclose (f) == 0) && ok;
+
+    // another process may have stored the same table meanwhile: either copy is fine.
+    if (ok && rename (tmp.str().c_str(), name.c_str()) != 0) {
+        remove (tmp.str().c_str());
+        FILE *g = fopen (name.c_str(), "rb");
+        ok = (g != 0);
+        if (g != 0)
+            fclose (g);
     }
+    else if (!ok)
+        remove (tmp.str().c_str());
+
+    return ok;
 }
 
-void logpolarTransform::RCgetCartImg (unsigned char *cartImg, unsigned char *lpImg, lp2CartPixel * Table, int padding)
+// the normalizers are stored as reciprocals: for 0 <= r <= 255*t the
+// truncated quotient r/t equals (r+0.5)*(1/t) truncated, in double precision.
+bool logpolarTransform::RCflattenC2LTable ()
 {
-    int k, i, j;
-    int tempPixel[3];
-    unsigned char *img = cartImg;
-
-    for (k = 0; k < height_; k++, img += padding) {
-        for (j = 0; j < width_; j++) {
-            tempPixel[0] = 0;
-            tempPixel[1] = 0;
-            tempPixel[2] = 0;
-
-            if (Table->iweight != 0) {
-                for (i = 0; i < Table->iweight; i++) {
-                    int *d = tempPixel;
-                    unsigned char *lp = &lpImg[Table->position[i]];
-                    *d++ += *lp++;
-                    *d++ += *lp++;
-                    *d += *lp;
-                }
+    const int n = necc_ * nang_;
+    int sz = 0;
+    for (int k = 0; k < n; k++)
+        sz += c2lTable[k].divisor;
+
+    c2lIndex_ = new int[n+1];
+    c2lData_ = new int[2*sz];
+    c2lNorm_ = new double[n];
+    if (c2lIndex_ == 0 || c2lData_ == 0 || c2lNorm_ == 0)
+        return false;
+
+    int *d = c2lData_;
+    c2lIndex_[0] = 0;
+    for (int k = 0; k < n; k++) {
+        const cart2LpPixel &p = c2lTable[k];
+        int t = 0;
+        for (int i = 0; i < p.divisor; i++) {
+            *d++ = p.position[i];
+            *d++ = p.iweight[i];
+            t += p.iweight[i];
+        }
+        c2lIndex_[k+1] = c2lIndex_[k] + p.divisor;
+        c2lNorm_[k] = (t != 0) ? 1.0 / t : 0.0;
+    }
+    return true;
+}
 
-                *img++ = tempPixel[0] / Table->iweight;
-                *img++ = tempPixel[1] / Table->iweight;
-                *img++ = tempPixel[2] / Table->iweight;
+bool logpolarTransform::RCflattenL2CTable ()
+{
+    const int n = width_ * height_;
+    int sz = 0;
+    for (int k = 0; k < n; k++)
+        sz += l2cTable[k].iweight;
+
+    l2cIndex_ = new int[n+1];
+    l2cData_ = new int[sz];
+    l2cNorm_ = new double[n];
+    if (l2cIndex_ == 0 || l2cData_ == 0 || l2cNorm_ == 0)
+        return false;
+
+    int *d = l2cData_;
+    l2cIndex_[0] = 0;
+    for (int k = 0; k < n; k++) {
+        const lp2CartPixel &p = l2cTable[k];
+        for (int i = 0; i < p.iweight; i++)
+            *d++ = p.position[i];
+        l2cIndex_[k+1] = l2cIndex_[k] + p.iweight;
+        l2cNorm_[k] = (p.iweight != 0) ? 1.0 / p.iweight : 0.0;
+    }
+    return true;
+}
+
+void logpolarTransform::RCgetLpImg (unsigned char *lpImg, const unsigned char *cartImg, int padding)
+{
+    const int nthreads = getNumThreads();
+    const int block = necc_ / nthreads;
+    const int first = necc_ - block * (int)workers_.size();
+
+    for (size_t i = 0; i < workers_.size(); i++)
+        workers_[i]->post(true, lpImg, cartImg, padding, first + (int)i * block, first + (int)(i+1) * block);
+
+    RCgetLpRows (lpImg, cartImg, padding, 0, first);
+
+    for (size_t i = 0; i < workers_.size(); i++)
+        workers_[i]->wait();
+}
+
+void logpolarTransform::RCgetCartImg (unsigned char *cartImg, const unsigned char *lpImg, int padding)
+{
+    const int nthreads = getNumThreads();
+    const int block = height_ / nthreads;
+    const int first = height_ - block * (int)workers_.size();
+
+    for (size_t i = 0; i < workers_.size(); i++)
+        workers_[i]->post(false, cartImg, lpImg, padding, first + (int)i * block, first + (int)(i+1) * block);
+
+    RCgetCartRows (cartImg, lpImg, padding, 0, first);
+
+    for (size_t i = 0; i < workers_.size(); i++)
+        workers_[i]->wait();
+}
+
+// the inner loops run over contiguous memory with no branches.
+void logpolarTransform::RCgetLpRows (unsigned char *lpImg, const unsigned char *cartImg, int padding, int first, int last)
+{
+    for (int i = first; i < last; i++) {
+        unsigned char *img = lpImg + i * (nang_ * 3 + padding);
+        const int *index = c2lIndex_ + i * nang_;
+        const double *norm = c2lNorm_ + i * nang_;
+
+        for (int j = 0; j < nang_; j++) {
+            const int *e = c2lData_ + 2 * index[j];
+            const int *end = c2lData_ + 2 * index[j+1];
+            int r0 = 0, r1 = 0, r2 = 0;
+
+            for (; e < end; e += 2) {
+                const unsigned char *in = cartImg + e[0];
+                const int w = e[1];
+                r0 += in[0] * w;
+                r1 += in[1] * w;
+                r2 += in[2] * w;
             }
-            else {
-                *img++ = 0;
-                *img++ = 0;
-                *img++ = 0;
+
+            const double n = norm[j];
+            *img++ = (unsigned char)((r0 + 0.5) * n);
+            *img++ = (unsigned char)((r1 + 0.5) * n);
+            *img++ = (unsigned char)((r2 + 0.5) * n);
+        }
+    }
+}
+
+void logpolarTransform::RCgetCartRows (unsigned char *cartImg, const unsigned char *lpImg, int padding, int first, int last)
+{
+    for (int k = first; k < last; k++) {
+        unsigned char *img = cartImg + k * (width_ * 3 + padding);
+        const int *index = l2cIndex_ + k * width_;
+        const double *norm = l2cNorm_ + k * width_;
+
+        for (int j = 0; j < width_; j++) {
+            const int *e = l2cData_ + index[j];
+            const int *end = l2cData_ + index[j+1];
+            int r0 = 0, r1 = 0, r2 = 0;
+
+            for (; e < end; e++) {
+                const unsigned char *lp = lpImg + *e;
+                r0 += lp[0];
+                r1 += lp[1];
+                r2 += lp[2];
             }
 
-            Table++;
+            const double n = norm[j];
+            *img++ = (unsigned char)((r0 + 0.5) * n);
+            *img++ = (unsigned char)((r1 + 0.5) * n);
+            *img++ = (unsigned char)((r2 + 0.5) * n);
         }
     }
 }
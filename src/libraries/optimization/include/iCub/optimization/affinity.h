@@ -46,6 +46,11 @@ namespace optimization
 * A class that deals with the problem of determining the affine 
 * transformation matrix A between two sets of matching 3D points
 * employing IpOpt. 
+*  
+* By default the cost is evaluated through the moments of the 
+* points pairs (see MatchedPointsMoments), which are updated 
+* within addPoints(), so that the time spent by the optimizer 
+* does not depend on the number of pairs. 
 */
 class AffinityWithMatchedPoints : public MatrixTransformationWithMatchedPoints
 {
@@ -55,10 +60,14 @@ protected:
 
     int max_iter;
     double tol;
+    bool use_moments;
+    bool store_points;
     
     std::deque<yarp::sig::Vector> p0;
     std::deque<yarp::sig::Vector> p1;
+    MatchedPointsMoments moments;
 
+    bool hasAllPoints() const;
     double evalError(const yarp::sig::Matrix &A);
 
 public:
@@ -88,18 +97,19 @@ public:
     virtual bool addPoints(const yarp::sig::Vector &p0, const yarp::sig::Vector &p1);
 
     /**
-    * Return the number of 3D-points pairs currently contained into 
-    * the internal database. 
+    * Return the number of 3D-points pairs accounted for so far, 
+    * even if they are not stored (see setCalibrationOptions()). 
     * @return the number of pairs. 
     */
-    virtual size_t getNumPoints() const { return p0.size(); }
+    virtual size_t getNumPoints() const { return moments.size(); }
 
     /**
     * Retrieve copies of the database of 3D-points pairs.
     * @param p0 the list of free 3D-points.
     * @param p1 the list of 3D-points which correspond to A*p0. 
     *  
-    * @note points are retrived in 4x1 homogeneous format. 
+    * @note points are retrived in 4x1 homogeneous format; the 
+    *       lists are empty if the points are not stored.
     */
     virtual void getPoints(std::deque<yarp::sig::Vector> &p0, std::deque<yarp::sig::Vector> &p1) const;
 
@@ -121,6 +131,22 @@ public:
     * @param options a Property-like object accounting for 
     *               calibration options.
     * @return true/false on success/fail. 
+    *  
+    * @note available options are: 
+    *  
+    * \b max_iter <int>: maximum number of iterations. 
+    *  
+    * \b tol <double>: tolerance. 
+    *  
+    * \b objective [moments|points]: evaluate the cost through 
+    *    the moments of the pairs (default), or by going through
+    *    the stored pairs at each iteration.
+    *  
+    * \b store_points [on|off]: keep the pairs in the database 
+    *    (default), or account for them only in the moments, so that
+    *    memory does not grow with the number of pairs; switching it
+    *    off drops the stored pairs and then the residual error is
+    *    given as the rms value.
     */
     virtual bool setCalibrationOptions(const yarp::os::Property &options);
 
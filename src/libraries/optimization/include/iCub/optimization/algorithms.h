@@ -36,6 +36,7 @@
 #define __ICUB_OPT_ALGORITHMS_H__
 
 #include <deque>
+#include <vector>
 #include <yarp/sig/all.h>
 
 namespace iCub
@@ -44,6 +45,9 @@ namespace iCub
 namespace optimization
 {
 
+class MinVolumeEllipsoidWorker;
+
+
 /**
 * \ingroup GenericAlgorithms
 *
@@ -62,6 +66,112 @@ bool minVolumeEllipsoid(const std::deque<yarp::sig::Vector> &points,
                         const double tol, yarp::sig::Matrix &A,
                         yarp::sig::Vector &c);
 
+
+/**
+* \ingroup GenericAlgorithms
+*
+* Find the minimum volume ellipsoide (MVEE) of a set of N 
+* d-dimensional data points that grows over time. 
+*  
+* The Khachiyan weights found by compute() are retained: when new
+* points are added, the iterations restart from the previous 
+* solution with null weights assigned to the new points, thus 
+* terminating almost immediately if they lie within the current
+* ellipsoid. Each iteration takes O(N*d^2) operations and the 
+* pass over the points can be shared among several threads. 
+*/
+class MinVolumeEllipsoid
+{
+protected:
+    int d;
+    double tol;
+    std::vector<double> q;
+    std::vector<double> w;
+    double scale;
+    size_t numWeighted;
+    std::vector<MinVolumeEllipsoidWorker*> workers;
+
+    friend class MinVolumeEllipsoidWorker;
+    void findMax(const double *invX, const size_t first, const size_t last,
+                 size_t &j, double &max) const;
+
+public:
+    /**
+    * Constructor. 
+    * @param tol the tolerance of the algorithm given in the points
+    *            metrics.
+    */
+    MinVolumeEllipsoid(const double tol=0.001);
+
+    /**
+    * Copy constructor. 
+    * @param mvee the object to copy. 
+    * @note the points and the current solution are copied, whereas
+    *       the copy computes with one thread only.
+    */
+    MinVolumeEllipsoid(const MinVolumeEllipsoid &mvee);
+
+    /**
+    * Assignment operator. 
+    * @param mvee the object to copy. 
+    * @note the number of threads is not affected.
+    */
+    MinVolumeEllipsoid &operator=(const MinVolumeEllipsoid &mvee);
+
+    /**
+    * Set the number of threads sharing the iterations. 
+    * @param n the number of threads, including the caller. 
+    * @return true/false on success/fail. 
+    */
+    bool setNumThreads(const int n);
+
+    /**
+    * Return the number of threads sharing the iterations. 
+    * @return the number of threads. 
+    */
+    int getNumThreads() const { return (int)workers.size()+1; }
+
+    /**
+    * Change the tolerance of the algorithm. 
+    * @param tol the tolerance given in the points metrics.
+    */
+    void setTolerance(const double tol) { this->tol=tol; }
+
+    /**
+    * Remove all the points and the current solution.
+    */
+    void clear();
+
+    /**
+    * Add a point to the set. 
+    * @param p the d-dimensional point; the dimension is given by 
+    *          the first point added.
+    * @return true/false on success/fail. 
+    */
+    bool addPoint(const yarp::sig::Vector &p);
+
+    /**
+    * Return the number of points of the set. 
+    * @return the number of points. 
+    */
+    size_t size() const { return w.size(); }
+
+    /**
+    * Update the ellipsoid enclosing the current set of points. 
+    * @param A the dxd matrix of the ellipsoid equation in the 
+    *          center form: (x-c)'*A*(x-c)=1.
+    * @param c the d-dimensional vector representing the 
+    *          ellipsoid's center.
+    * @return true/false on success/fail.
+    */
+    bool compute(yarp::sig::Matrix &A, yarp::sig::Vector &c);
+
+    /**
+    * Destructor.
+    */
+    virtual ~MinVolumeEllipsoid();
+};
+
 }
  
 }
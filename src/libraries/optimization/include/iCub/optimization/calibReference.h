@@ -50,6 +50,11 @@ namespace optimization
 * \f[ 
 * (H,S)=\arg\min_{H\in SE\left(3\right),S\in diag\left(s_1,s_2,s_3,1\right)}\left(\frac{1}{N}\sum_{i=1}^{N} \left \| p_i^{O_1}-S \cdot H \cdot p_i^{O_2} \right \|^2 \right)
 * \f] 
+*  
+* By default the cost is evaluated through the moments of the 
+* points pairs (see MatchedPointsMoments), which are updated 
+* within addPoints(), so that the time spent by the optimizer 
+* does not depend on the number of pairs. 
 */
 class CalibReferenceWithMatchedPoints : public MatrixTransformationWithMatchedPoints
 {
@@ -63,10 +68,14 @@ protected:
     double min_s_scalar;
     double max_s_scalar;
     double s0_scalar;
+    bool use_moments;
+    bool store_points;
 
     std::deque<yarp::sig::Vector> p0;
     std::deque<yarp::sig::Vector> p1;
+    MatchedPointsMoments moments;
 
+    bool hasAllPoints() const;
     double evalError(const yarp::sig::Matrix &H);
 
 public:
@@ -139,11 +148,11 @@ public:
     virtual bool addPoints(const yarp::sig::Vector &p0, const yarp::sig::Vector &p1);
 
     /**
-    * Return the number of 3D-points pairs currently contained into 
-    * the internal database. 
+    * Return the number of 3D-points pairs accounted for so far, 
+    * even if they are not stored (see setCalibrationOptions()). 
     * @return the number of pairs. 
     */
-    virtual size_t getNumPoints() const { return p0.size(); }
+    virtual size_t getNumPoints() const { return moments.size(); }
 
     /**
     * Retrieve copies of the database of 3D-points pairs.
@@ -151,7 +160,8 @@ public:
     * @param p1 the list of 3D-points which correspond either to
     *           H*p0 or to S*H*p0.
     *  
-    * @note points are retrived in 4x1 homogeneous format. 
+    * @note points are retrived in 4x1 homogeneous format; the 
+    *       lists are empty if the points are not stored.
     */
     virtual void getPoints(std::deque<yarp::sig::Vector> &p0, std::deque<yarp::sig::Vector> &p1) const;
 
@@ -188,6 +198,22 @@ public:
     * @param options a Property-like object accounting for 
     *               calibration options.
     * @return true/false on success/fail. 
+    *  
+    * @note available options are: 
+    *  
+    * \b max_iter <int>: maximum number of iterations. 
+    *  
+    * \b tol <double>: tolerance. 
+    *  
+    * \b objective [moments|points]: evaluate the cost through 
+    *    the moments of the pairs (default), or by going through
+    *    the stored pairs at each iteration.
+    *  
+    * \b store_points [on|off]: keep the pairs in the database 
+    *    (default), or account for them only in the moments, so that
+    *    memory does not grow with the number of pairs; switching it
+    *    off drops the stored pairs and then the residual error is
+    *    given as the rms value.
     */
     virtual bool setCalibrationOptions(const yarp::os::Property &options);
 
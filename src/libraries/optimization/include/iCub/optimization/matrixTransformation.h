@@ -29,6 +29,7 @@
 #ifndef __ICUB_OPT_MATRIXTRANSFORMATION_H__
 #define __ICUB_OPT_MATRIXTRANSFORMATION_H__
 
+#include <deque>
 #include <yarp/os/all.h>
 #include <yarp/sig/all.h>
 
@@ -38,6 +39,71 @@ namespace iCub
 namespace optimization
 {
 
+/**
+* @ingroup MatrixTransformations
+*
+* Sufficient statistics of a set of matching 3D points pairs 
+* (p0,p1) in homogeneous form, given by the moments 
+* \f$ \sum p_0 p_0^T \f$, \f$ \sum p_1 p_0^T \f$ and 
+* \f$ \sum p_1^T p_1 \f$. 
+*  
+* Since the cost \f$ \frac{1}{N}\sum \left \| p_1-A \cdot p_0 
+* \right \|^2 \f$ is a quadratic form in the points, it can be 
+* evaluated along with its gradient in constant time regardless 
+* of the number of pairs; moreover the moments are updated as the 
+* points arrive. 
+*/
+class MatchedPointsMoments
+{
+protected:
+    double M00[4][4];
+    double M10[4][4];
+    double m11;
+    size_t N;
+
+public:
+    /**
+    * Default Constructor. 
+    */
+    MatchedPointsMoments();
+
+    /**
+    * Account for a new pair of points. 
+    * @param p0 the free 3D-point in 4x1 homogeneous format.
+    * @param p1 the corresponding 3D-point in 4x1 homogeneous 
+    *           format.
+    */
+    void add(const yarp::sig::Vector &p0, const yarp::sig::Vector &p1);
+
+    /**
+    * Reset the moments.
+    */
+    void clear();
+
+    /**
+    * Return the number of pairs accounted for. 
+    * @return the number of pairs. 
+    */
+    size_t size() const { return N; }
+
+    /**
+    * Evaluate the mean squared residual of the transformation A.
+    * @param A the 4x4 transformation matrix. 
+    * @return the cost. 
+    */
+    double evalCost(const yarp::sig::Matrix &A) const;
+
+    /**
+    * Evaluate the gradient of the cost with respect to the 
+    * elements of A. 
+    * @param A the 4x4 transformation matrix. 
+    * @param G the 4x4 gradient, such that the derivative of the 
+    *          cost along dA is sum(dA(i,j)*G(i,j)).
+    */
+    void evalCostGradient(const yarp::sig::Matrix &A, yarp::sig::Matrix &G) const;
+};
+
+
 /**
 * @ingroup MatrixTransformations
 *
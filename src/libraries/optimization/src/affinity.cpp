@@ -56,6 +56,7 @@ class AffinityWithMatchedPointsNLP : public Ipopt::TNLP
 protected:    
     const deque<Vector> &p0;
     const deque<Vector> &p1;
+    const MatchedPointsMoments *moments;
 
     deque<Matrix> dA;
     Matrix min;
@@ -67,8 +68,9 @@ public:
     /****************************************************************/
     AffinityWithMatchedPointsNLP(const deque<Vector> &_p0,
                                  const deque<Vector> &_p1,
+                                 const MatchedPointsMoments *_moments,
                                  const Matrix &_min, const Matrix &_max) :
-                                 p0(_p0), p1(_p1)
+                                 p0(_p0), p1(_p1), moments(_moments)
     {
         min=_min;
         max=_max;
@@ -147,6 +149,11 @@ public:
                 Ipopt::Number &obj_value)
     {
         Matrix A=computeA(x);
+        if (moments!=NULL)
+        {
+            obj_value=moments->evalCost(A);
+            return true;
+        }
 
         obj_value=0.0;
         if (p0.size()>0)
@@ -165,6 +172,23 @@ public:
                      Ipopt::Number *grad_f)
     {
         Matrix A=computeA(x);
+        if (moments!=NULL)
+        {
+            // the variables are the elements of A
+            // taken column-wise from the first 3 rows
+            Matrix G;
+            moments->evalCostGradient(A,G);
+
+            Ipopt::Index i=0;
+            for (int c=0; c<A.cols(); c++)
+            {
+                for (int r=0; r<A.rows()-1; r++)
+                    grad_f[i++]=G(r,c);
+            }
+
+            return true;
+        }
+
         for (Ipopt::Index i=0; i<n; i++)
             grad_f[i]=0.0;
 
@@ -230,6 +254,8 @@ AffinityWithMatchedPoints::AffinityWithMatchedPoints()
 {
     max_iter=300;
     tol=1e-8;
+    use_moments=true;
+    store_points=true;
 
     min=max=eye(4,4);
     for (int c=0; c<min.cols(); c++)
@@ -261,19 +287,25 @@ void AffinityWithMatchedPoints::setBounds(const Matrix &min,
 }
 
 
+/****************************************************************/
+bool AffinityWithMatchedPoints::hasAllPoints() const
+{
+    return ((p0.size()>0) && (p0.size()==moments.size()));
+}
+
+
 /****************************************************************/
 double AffinityWithMatchedPoints::evalError(const Matrix &A)
 {
-    double error=0.0;
-    if (p0.size()>0)
-    {
-        for (size_t i=0; i<p0.size(); i++)
-            error+=norm(p1[i]-A*p0[i]);
+    // without the points at hand, resort to the rms residual
+    if (!hasAllPoints())
+        return sqrt(moments.evalCost(A));
 
-        error/=p0.size();
-    }
+    double error=0.0;
+    for (size_t i=0; i<p0.size(); i++)
+        error+=norm(p1[i]-A*p0[i]);
 
-    return error;
+    return error/p0.size();
 }
 
 
@@ -286,8 +318,12 @@ bool AffinityWithMatchedPoints::addPoints(const Vector &p0,
         Vector _p0=p0.subVector(0,2); _p0.push_back(1.0);
         Vector _p1=p1.subVector(0,2); _p1.push_back(1.0);
 
-        this->p0.push_back(_p0);
-        this->p1.push_back(_p1);
+        moments.add(_p0,_p1);
+        if (store_points)
+        {
+            this->p0.push_back(_p0);
+            this->p1.push_back(_p1);
+        }
 
         return true;
     }
@@ -310,6 +346,7 @@ void AffinityWithMatchedPoints::clearPoints()
 {
     p0.clear();
     p1.clear();
+    moments.clear();
 }
 
 
@@ -334,6 +371,27 @@ bool AffinityWithMatchedPoints::setCalibrationOptions(const Property &options)
     if (opt.check("tol"))
         tol=opt.find("tol").asDouble();
 
+    if (opt.check("objective"))
+    {
+        string objective=opt.find("objective").asString().c_str();
+        if (objective=="moments")
+            use_moments=true;
+        else if (objective=="points")
+            use_moments=false;
+        else
+            return false;
+    }
+
+    if (opt.check("store_points"))
+    {
+        store_points=(opt.find("store_points").asString()=="on");
+        if (!store_points)
+        {
+            p0.clear();
+            p1.clear();
+        }
+    }
+
     return true;
 }
 
@@ -341,7 +399,7 @@ bool AffinityWithMatchedPoints::setCalibrationOptions(const Property &options)
 /****************************************************************/
 bool AffinityWithMatchedPoints::calibrate(Matrix &A, double &error)
 {
-    if (p0.size()>0)
+    if (moments.size()>0)
     {
         Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
         app->Options()->SetNumericValue("tol",tol);
@@ -358,7 +416,8 @@ bool AffinityWithMatchedPoints::calibrate(Matrix &A, double &error)
         app->Options()->SetStringValue("derivative_test","none");
         app->Initialize();
 
-        Ipopt::SmartPtr<AffinityWithMatchedPointsNLP> nlp=new AffinityWithMatchedPointsNLP(p0,p1,min,max);
+        const MatchedPointsMoments *m=(use_moments || !hasAllPoints())?&moments:NULL;
+        Ipopt::SmartPtr<AffinityWithMatchedPointsNLP> nlp=new AffinityWithMatchedPointsNLP(p0,p1,m,min,max);
 
         nlp->set_A0(A0);
         Ipopt::ApplicationReturnStatus status=app->OptimizeTNLP(GetRawPtr(nlp));
@@ -15,20 +15,220 @@
  * Public License for more details
 */
 
+#include <cmath>
+#include <algorithm>
+
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
 #include <yarp/math/Math.h>
 #include <yarp/math/SVD.h>
 #include <iCub/optimization/algorithms.h>
 
 using namespace std;
+using namespace yarp::os;
 using namespace yarp::sig;
 using namespace yarp::math;
 using namespace iCub::optimization;
 
 
+namespace iCub
+{
+
+namespace optimization
+{
+
+/****************************************************************/
+class MinVolumeEllipsoidWorker : public Thread
+{
+    const MinVolumeEllipsoid *owner;
+    Semaphore go,done;
+    const double *invX;
+    size_t first,last;
+
+public:
+    size_t j;
+    double max;
+
+    /****************************************************************/
+    MinVolumeEllipsoidWorker(const MinVolumeEllipsoid *owner) :
+                             owner(owner), go(0), done(0), invX(NULL),
+                             first(0), last(0), j(0), max(0.0) { }
+
+    /****************************************************************/
+    void post(const double *invX, const size_t first, const size_t last)
+    {
+        this->invX=invX;
+        this->first=first;
+        this->last=last;
+        go.post();
+    }
+
+    /****************************************************************/
+    void wait()
+    {
+        done.wait();
+    }
+
+    /****************************************************************/
+    void run()
+    {
+        while (!isStopping())
+        {
+            go.wait();
+            if (isStopping())
+                break;
+
+            owner->findMax(invX,first,last,j,max);
+            done.post();
+        }
+    }
+
+    /****************************************************************/
+    void onStop()
+    {
+        go.post();
+    }
+};
+
+}
+
+}
+
+
 /****************************************************************/
 bool iCub::optimization::minVolumeEllipsoid(const deque<Vector> &points,
                                             const double tol,
                                             Matrix &A, Vector &c)
+{
+    MinVolumeEllipsoid mvee(tol);
+    for (size_t i=0; i<points.size(); i++)
+        if (!mvee.addPoint(points[i]))
+            return false;
+
+    return mvee.compute(A,c);
+}
+
+
+/****************************************************************/
+MinVolumeEllipsoid::MinVolumeEllipsoid(const double tol) : tol(tol)
+{
+    clear();
+}
+
+
+/****************************************************************/
+MinVolumeEllipsoid::MinVolumeEllipsoid(const MinVolumeEllipsoid &mvee)
+{
+    *this=mvee;
+}
+
+
+/****************************************************************/
+MinVolumeEllipsoid &MinVolumeEllipsoid::operator=(const MinVolumeEllipsoid &mvee)
+{
+    if (this!=&mvee)
+    {
+        d=mvee.d;
+        tol=mvee.tol;
+        q=mvee.q;
+        w=mvee.w;
+        scale=mvee.scale;
+        numWeighted=mvee.numWeighted;
+    }
+
+    return *this;
+}
+
+
+/****************************************************************/
+bool MinVolumeEllipsoid::setNumThreads(const int n)
+{
+    if (n<1)
+        return false;
+
+    for (size_t i=0; i<workers.size(); i++)
+    {
+        workers[i]->stop();
+        delete workers[i];
+    }
+    workers.clear();
+
+    // the calling thread takes care of the first block of points
+    for (int i=1; i<n; i++)
+    {
+        MinVolumeEllipsoidWorker *worker=new MinVolumeEllipsoidWorker(this);
+        worker->start();
+        workers.push_back(worker);
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+void MinVolumeEllipsoid::clear()
+{
+    d=0;
+    q.clear();
+    w.clear();
+    scale=1.0;
+    numWeighted=0;
+}
+
+
+/****************************************************************/
+bool MinVolumeEllipsoid::addPoint(const Vector &p)
+{
+    if (w.empty())
+    {
+        if (p.length()==0)
+            return false;
+        d=(int)p.length();
+    }
+    else if ((int)p.length()!=d)
+        return false;
+
+    for (int i=0; i<d; i++)
+        q.push_back(p[i]);
+    q.push_back(1.0);
+
+    // new points do not take part in the current solution
+    w.push_back(0.0);
+    return true;
+}
+
+
+/****************************************************************/
+void MinVolumeEllipsoid::findMax(const double *invX, const size_t first,
+                                 const size_t last, size_t &j,
+                                 double &max) const
+{
+    // max over the points of the diagonal of Q'*inv(Q*U*Q')*Q
+    const int D=d+1;
+    j=first; max=-1.0;
+    for (size_t i=first; i<last; i++)
+    {
+        const double *qi=&q[i*D];
+        double Mii=0.0;
+        for (int r=0; r<D; r++)
+        {
+            double tmp=0.0;
+            for (int c=0; c<D; c++)
+                tmp+=invX[r*D+c]*qi[c];
+            Mii+=qi[r]*tmp;
+        }
+
+        if (Mii>max)
+        {
+            max=Mii;
+            j=i;
+        }
+    }
+}
+
+
+/****************************************************************/
+bool MinVolumeEllipsoid::compute(Matrix &A, Vector &c)
 {
     // This code is a C++ version of the MATLAB script written by:
     // Nima Moshtagh (nima@seas.upenn.edu), University of Pennsylvania
@@ -38,55 +238,122 @@ bool iCub::optimization::minVolumeEllipsoid(const deque<Vector> &points,
     //
     // min log(det(A))
     // s.t. (points[i]-c)'*A*(points[i]-c)<=1
+    //
+    // Only the diagonal of the NxN matrix Q'*inv(Q*U*Q')*Q is
+    // computed, while Q*U*Q' is updated through rank-1 corrections;
+    // the weights are stored as u=scale*w, so that rescaling them
+    // costs O(1).
 
-    if (points.empty())
+    if (w.empty())
         return false;
 
-    // initialization
-    int d=points.front().length();
-    int N=(int)points.size();
-    Vector u(N,1.0/N);
-    Matrix U(N,N); U.diagonal(u);
-    Matrix Q(d+1,N);
-    for (int row=0; row<Q.rows(); row++)
-        for (int col=0; col<Q.cols(); col++)
-            Q(row,col)=points[col][row];
-    for (int col=0; col<Q.cols(); col++)
-        Q(Q.rows()-1,col)=1.0;
-    Matrix Qt=Q.transposed();
+    const int D=d+1;
+    const size_t N=w.size();
+
+    // (re)initialization: uniform weights, unless a previous
+    // solution is available to warm start the iterations
+    if (numWeighted==0)
+    {
+        w.assign(N,1.0/N);
+        scale=1.0;
+    }
+    numWeighted=N;
+
+    Matrix X(D,D); X.zero();
+    double sumU2=0.0;
+    for (size_t i=0; i<N; i++)
+    {
+        double ui=scale*w[i];
+        if (ui==0.0)
+            continue;
+
+        const double *qi=&q[i*D];
+        for (int r=0; r<D; r++)
+            for (int c=0; c<D; c++)
+                X(r,c)+=ui*qi[r]*qi[c];
+
+        sumU2+=ui*ui;
+    }
 
     // run the Khachiyan algorithm
-    Matrix M;
+    vector<double> invX(D*D);
+    const size_t nThreads=workers.size()+1;
+    const size_t block=(N+nThreads-1)/nThreads;
     while (true)
     {
-        M=Qt*pinv(Q*U*Qt)*Q;
-        int j=0; double max=M(j,j);
-        for (int row=1; row<M.rows(); row++)
+        Matrix _invX=pinv(X);
+        for (int r=0; r<D; r++)
+            for (int c=0; c<D; c++)
+                invX[r*D+c]=_invX(r,c);
+
+        for (size_t i=0; i<workers.size(); i++)
+        {
+            size_t first=std::min(N,(i+1)*block);
+            size_t last=std::min(N,(i+2)*block);
+            workers[i]->post(&invX[0],first,last);
+        }
+
+        size_t j; double max;
+        findMax(&invX[0],0,std::min(N,block),j,max);
+
+        // blocks are scanned in order, so that ties are solved
+        // as the sequential scan would do
+        for (size_t i=0; i<workers.size(); i++)
         {
-            if (M(row,row)>max)
+            workers[i]->wait();
+            if (workers[i]->max>max)
             {
-                max=M(row,row);
-                j=row;
+                max=workers[i]->max;
+                j=workers[i]->j;
             }
         }
+
         double step_size=(max-d-1.0)/((d+1.0)*(max-1.0));
-        Vector new_u=(1.0-step_size)*u;
-        new_u[j]+=step_size;
-        if (norm(new_u-u)<tol)
+        double uj=scale*w[j];
+
+        // norm(new_u-u), with new_u=(1-step_size)*u+step_size*e_j
+        if (fabs(step_size)*sqrt(std::max(sumU2-2.0*uj+1.0,0.0))<tol)
             break;
-        u=new_u;
-        U.diagonal(u);
+
+        scale*=(1.0-step_size);
+        w[j]+=step_size/scale;
+        sumU2=(1.0-step_size)*(1.0-step_size)*sumU2+
+              2.0*(1.0-step_size)*step_size*uj+step_size*step_size;
+
+        const double *qj=&q[j*D];
+        for (int r=0; r<D; r++)
+            for (int c=0; c<D; c++)
+                X(r,c)=(1.0-step_size)*X(r,c)+step_size*qj[r]*qj[c];
+
+        // keep the scale far from the underflow
+        if (fabs(scale)<1e-100)
+        {
+            for (size_t i=0; i<N; i++)
+                w[i]*=scale;
+            scale=1.0;
+        }
     }
 
-    // compute the ellipsoid parameters
-    Matrix P=Q.removeRows(Q.rows()-1,1);
-    c=P*u;
-    Matrix C(c.length(),c.length());
-    for (int col=0; col<C.cols(); col++)
-        C.setCol(col,c[col]*c);
-    A=(1.0/d)*pinv(P*U*P.transposed()-C);
+    // compute the ellipsoid parameters:
+    // the center c=P*u and the second moment P*U*P'
+    // are available in the blocks of X=Q*U*Q'
+    c.resize(d);
+    Matrix C(d,d);
+    for (int r=0; r<d; r++)
+        c[r]=X(r,d);
+    for (int r=0; r<d; r++)
+        for (int col=0; col<d; col++)
+            C(r,col)=X(r,col)-c[r]*c[col];
+    A=(1.0/d)*pinv(C);
 
     return true;
 }
 
 
+/****************************************************************/
+MinVolumeEllipsoid::~MinVolumeEllipsoid()
+{
+    setNumThreads(1);
+}
+
+
@@ -58,6 +58,36 @@ inline Matrix computeH(const Ipopt::Number *x)
     return computeH(_x);
 }
 
+/****************************************************************/
+inline void computeDH(const Ipopt::Number *x, Matrix *dH)
+{
+    double ca=cos(x[3]);  double sa=sin(x[3]);
+    double cb=cos(x[4]);  double sb=sin(x[4]);
+    double cg=cos(x[5]);  double sg=sin(x[5]);
+
+    Matrix Rza=eye(4,4);
+    Rza(0,0)=ca;   Rza(1,1)=ca;   Rza(1,0)=sa;   Rza(0,1)=-sa;
+    Matrix dRza=zeros(4,4);
+    dRza(0,0)=-sa; dRza(1,1)=-sa; dRza(1,0)=ca;  dRza(0,1)=-ca;
+
+    Matrix Rzg=eye(4,4);
+    Rzg(0,0)=cg;   Rzg(1,1)=cg;   Rzg(1,0)=sg;   Rzg(0,1)=-sg;
+    Matrix dRzg=zeros(4,4);
+    dRzg(0,0)=-sg; dRzg(1,1)=-sg; dRzg(1,0)=cg;  dRzg(0,1)=-cg;
+
+    Matrix Ryb=eye(4,4);
+    Ryb(0,0)=cb;   Ryb(2,2)=cb;   Ryb(2,0)=-sb;  Ryb(0,2)=sb;
+    Matrix dRyb=zeros(4,4);
+    dRyb(0,0)=-sb; dRyb(2,2)=-sb; dRyb(2,0)=-cb; dRyb(0,2)=cb;
+
+    dH[0]=zeros(4,4); dH[0](0,3)=1.0;
+    dH[1]=zeros(4,4); dH[1](1,3)=1.0;
+    dH[2]=zeros(4,4); dH[2](2,3)=1.0;
+    dH[3]=dRza*Ryb*Rzg;
+    dH[4]=Rza*dRyb*Rzg;
+    dH[5]=Rza*Ryb*dRzg;
+}
+
 
 /****************************************************************/
 class CalibReferenceWithMatchedPointsNLP : public Ipopt::TNLP
@@ -65,18 +95,73 @@ class CalibReferenceWithMatchedPointsNLP : public Ipopt::TNLP
 protected:
     const deque<Vector> &p0;
     const deque<Vector> &p1;
+    const MatchedPointsMoments *moments;
 
     Vector min;
     Vector max;
     Vector x0;
     Vector x;
 
+    /****************************************************************/
+    double evalCost(const Matrix &A) const
+    {
+        if (moments!=NULL)
+            return moments->evalCost(A);
+
+        double cost=0.0;
+        if (p0.size()>0)
+        {
+            for (size_t i=0; i<p0.size(); i++)
+                cost+=norm2(p1[i]-A*p0[i]);
+
+            cost/=p0.size();
+        }
+
+        return cost;
+    }
+
+    /****************************************************************/
+    void evalCostGradient(const Matrix &A, const Matrix *dA,
+                          Ipopt::Index n, Ipopt::Number *grad_f) const
+    {
+        // G is such that the derivative of the cost
+        // along dA is given by sum(dA(r,c)*G(r,c))
+        Matrix G;
+        if (moments!=NULL)
+            moments->evalCostGradient(A,G);
+        else
+        {
+            G=zeros(4,4);
+            if (p0.size()>0)
+            {
+                for (size_t i=0; i<p0.size(); i++)
+                {
+                    Vector d=p1[i]-A*p0[i];
+                    for (int r=0; r<4; r++)
+                        for (int c=0; c<4; c++)
+                            G(r,c)-=d[r]*p0[i][c];
+                }
+
+                G*=2.0/p0.size();
+            }
+        }
+
+        for (Ipopt::Index j=0; j<n; j++)
+        {
+            grad_f[j]=0.0;
+            for (int r=0; r<4; r++)
+                for (int c=0; c<4; c++)
+                    grad_f[j]+=dA[j](r,c)*G(r,c);
+        }
+    }
+
 public:
     /****************************************************************/
     CalibReferenceWithMatchedPointsNLP(const deque<Vector> &_p0,
                                        const deque<Vector> &_p1,
+                                       const MatchedPointsMoments *_moments,
                                        const Vector &_min, const Vector &_max) :
-                                       p0(_p0), p1(_p1)
+                                       p0(_p0), p1(_p1), moments(_moments)
     {
         min=_min;
         max=_max;
@@ -136,17 +221,7 @@ public:
     bool eval_f(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
                 Ipopt::Number &obj_value)
     {
-        Matrix H=computeH(x);
-
-        obj_value=0.0;
-        if (p0.size()>0)
-        {
-            for (size_t i=0; i<p0.size(); i++)
-                obj_value+=norm2(p1[i]-H*p0[i]);
-
-            obj_value/=p0.size();
-        }
-
+        obj_value=evalCost(computeH(x));
         return true;
     }
     
@@ -154,52 +229,10 @@ public:
     bool eval_grad_f(Ipopt::Index n, const Ipopt::Number* x, bool new_x,
                      Ipopt::Number *grad_f)
     {
-        double ca=cos(x[3]);  double sa=sin(x[3]);
-        double cb=cos(x[4]);  double sb=sin(x[4]);
-        double cg=cos(x[5]);  double sg=sin(x[5]);
-
-        Matrix Rza=eye(4,4);
-        Rza(0,0)=ca;   Rza(1,1)=ca;   Rza(1,0)=sa;   Rza(0,1)=-sa;
-        Matrix dRza=zeros(4,4);
-        dRza(0,0)=-sa; dRza(1,1)=-sa; dRza(1,0)=ca;  dRza(0,1)=-ca;
-
-        Matrix Rzg=eye(4,4);
-        Rzg(0,0)=cg;   Rzg(1,1)=cg;   Rzg(1,0)=sg;   Rzg(0,1)=-sg;
-        Matrix dRzg=zeros(4,4);
-        dRzg(0,0)=-sg; dRzg(1,1)=-sg; dRzg(1,0)=cg;  dRzg(0,1)=-cg;
-
-        Matrix Ryb=eye(4,4);
-        Ryb(0,0)=cb;   Ryb(2,2)=cb;   Ryb(2,0)=-sb;  Ryb(0,2)=sb;
-        Matrix dRyb=zeros(4,4);
-        dRyb(0,0)=-sb; dRyb(2,2)=-sb; dRyb(2,0)=-cb; dRyb(0,2)=cb;
-
-        Matrix dHdx0=zeros(4,4); dHdx0(0,3)=1.0;
-        Matrix dHdx1=zeros(4,4); dHdx1(1,3)=1.0;
-        Matrix dHdx2=zeros(4,4); dHdx2(2,3)=1.0;
-        Matrix dHdx3=dRza*Ryb*Rzg;
-        Matrix dHdx4=Rza*dRyb*Rzg;
-        Matrix dHdx5=Rza*Ryb*dRzg;
-
-        Matrix H=computeH(x);
-        grad_f[0]=grad_f[1]=grad_f[2]=0.0;
-        grad_f[3]=grad_f[4]=grad_f[5]=0.0;
-        if (p0.size()>0)
-        {
-            for (size_t i=0; i<p0.size(); i++)
-            {
-                Vector d=p1[i]-H*p0[i];
-                grad_f[0]-=2.0*dot(d,(dHdx0*p0[i]));
-                grad_f[1]-=2.0*dot(d,(dHdx1*p0[i]));
-                grad_f[2]-=2.0*dot(d,(dHdx2*p0[i]));
-                grad_f[3]-=2.0*dot(d,(dHdx3*p0[i]));
-                grad_f[4]-=2.0*dot(d,(dHdx4*p0[i]));
-                grad_f[5]-=2.0*dot(d,(dHdx5*p0[i]));
-            }
-
-            for (Ipopt::Index i=0; i<n; i++)
-                grad_f[i]/=p0.size();
-        }
+        Matrix dH[6];
+        computeDH(x,dH);
 
+        evalCostGradient(computeH(x),dH,n,grad_f);
         return true;
     }
 
@@ -249,8 +282,9 @@ public:
     /****************************************************************/
     CalibReferenceWithScaledMatchedPointsNLP(const deque<Vector> &_p0,
                                              const deque<Vector> &_p1,
+                                             const MatchedPointsMoments *_moments,
                                              const Vector &_min, const Vector &_max) :
-                                             CalibReferenceWithMatchedPointsNLP(_p0,_p1,_min,_max) { }
+                                             CalibReferenceWithMatchedPointsNLP(_p0,_p1,_moments,_min,_max) { }
 
     /****************************************************************/
     bool get_nlp_info(Ipopt::Index &n, Ipopt::Index &m, Ipopt::Index &nnz_jac_g,
@@ -266,22 +300,10 @@ public:
     bool eval_f(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
                 Ipopt::Number &obj_value)
     {
-        Matrix H=computeH(x);
-        Vector s(4);
-        s[0]=x[6];
-        s[1]=x[7];
-        s[2]=x[8];
-        s[3]=1.0;
-
-        obj_value=0.0;
-        if (p0.size()>0)
-        {
-            for (size_t i=0; i<p0.size(); i++)
-                obj_value+=norm2(p1[i]-s*(H*p0[i]));
-
-            obj_value/=p0.size();
-        }
+        Matrix S=eye(4,4);
+        S(0,0)=x[6]; S(1,1)=x[7]; S(2,2)=x[8];
 
+        obj_value=evalCost(S*computeH(x));
         return true;
     }
     
@@ -289,66 +311,22 @@ public:
     bool eval_grad_f(Ipopt::Index n, const Ipopt::Number* x, bool new_x,
                      Ipopt::Number *grad_f)
     {
-        double ca=cos(x[3]);  double sa=sin(x[3]);
-        double cb=cos(x[4]);  double sb=sin(x[4]);
-        double cg=cos(x[5]);  double sg=sin(x[5]);
-
-        Matrix Rza=eye(4,4);
-        Rza(0,0)=ca;   Rza(1,1)=ca;   Rza(1,0)=sa;   Rza(0,1)=-sa;
-        Matrix dRza=zeros(4,4);
-        dRza(0,0)=-sa; dRza(1,1)=-sa; dRza(1,0)=ca;  dRza(0,1)=-ca;
-
-        Matrix Rzg=eye(4,4);
-        Rzg(0,0)=cg;   Rzg(1,1)=cg;   Rzg(1,0)=sg;   Rzg(0,1)=-sg;
-        Matrix dRzg=zeros(4,4);
-        dRzg(0,0)=-sg; dRzg(1,1)=-sg; dRzg(1,0)=cg;  dRzg(0,1)=-cg;
-
-        Matrix Ryb=eye(4,4);
-        Ryb(0,0)=cb;   Ryb(2,2)=cb;   Ryb(2,0)=-sb;  Ryb(0,2)=sb;
-        Matrix dRyb=zeros(4,4);
-        dRyb(0,0)=-sb; dRyb(2,2)=-sb; dRyb(2,0)=-cb; dRyb(0,2)=cb;
-
-        Matrix dHdx0=zeros(4,4); dHdx0(0,3)=1.0;
-        Matrix dHdx1=zeros(4,4); dHdx1(1,3)=1.0;
-        Matrix dHdx2=zeros(4,4); dHdx2(2,3)=1.0;
-        Matrix dHdx3=dRza*Ryb*Rzg;
-        Matrix dHdx4=Rza*dRyb*Rzg;
-        Matrix dHdx5=Rza*Ryb*dRzg;
-
+        Matrix S=eye(4,4);
+        S(0,0)=x[6]; S(1,1)=x[7]; S(2,2)=x[8];
         Matrix H=computeH(x);
-        Matrix dHdx6=zeros(4,4); dHdx6(0,0)=1.0; dHdx6*=H;
-        Matrix dHdx7=zeros(4,4); dHdx7(1,1)=1.0; dHdx7*=H;
-        Matrix dHdx8=zeros(4,4); dHdx8(2,2)=1.0; dHdx8*=H;
-
-        Vector s(4);
-        s[0]=x[6];
-        s[1]=x[7];
-        s[2]=x[8];
-        s[3]=1.0;
-
-        grad_f[0]=grad_f[1]=grad_f[2]=0.0;
-        grad_f[3]=grad_f[4]=grad_f[5]=0.0;
-        grad_f[6]=grad_f[7]=grad_f[8]=0.0;
-        if (p0.size()>0)
-        {
-            for (size_t i=0; i<p0.size(); i++)
-            {
-                Vector d=p1[i]-s*(H*p0[i]);
-                grad_f[0]-=2.0*dot(d,(dHdx0*p0[i]));
-                grad_f[1]-=2.0*dot(d,(dHdx1*p0[i]));
-                grad_f[2]-=2.0*dot(d,(dHdx2*p0[i]));
-                grad_f[3]-=2.0*dot(d,(dHdx3*p0[i]));
-                grad_f[4]-=2.0*dot(d,(dHdx4*p0[i]));
-                grad_f[5]-=2.0*dot(d,(dHdx5*p0[i]));
-                grad_f[6]-=2.0*dot(d,(dHdx6*p0[i]));
-                grad_f[7]-=2.0*dot(d,(dHdx7*p0[i]));
-                grad_f[8]-=2.0*dot(d,(dHdx8*p0[i]));
-            }
 
-            for (Ipopt::Index i=0; i<n; i++)
-                grad_f[i]/=p0.size();
+        Matrix dA[9];
+        computeDH(x,dA);
+        for (int i=0; i<6; i++)
+            dA[i]=S*dA[i];
+
+        for (int i=0; i<3; i++)
+        {
+            dA[6+i]=zeros(4,4);
+            dA[6+i].setRow(i,H.getRow(i));
         }
 
+        evalCostGradient(S*H,dA,n,grad_f);
         return true;
     }
 };
@@ -361,8 +339,9 @@ public:
     /****************************************************************/
     CalibReferenceWithScalarScaledMatchedPointsNLP(const deque<Vector> &_p0,
                                                    const deque<Vector> &_p1,
+                                                   const MatchedPointsMoments *_moments,
                                                    const Vector &_min, const Vector &_max) :
-                                                   CalibReferenceWithMatchedPointsNLP(_p0,_p1,_min,_max) { }
+                                                   CalibReferenceWithMatchedPointsNLP(_p0,_p1,_moments,_min,_max) { }
 
     /****************************************************************/
     bool get_nlp_info(Ipopt::Index &n, Ipopt::Index &m, Ipopt::Index &nnz_jac_g,
@@ -378,20 +357,10 @@ public:
     bool eval_f(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
                 Ipopt::Number &obj_value)
     {
-        Matrix H=computeH(x);
-        Vector s(4);
-        s[0]=s[1]=s[2]=x[6];
-        s[3]=1.0;
-
-        obj_value=0.0;
-        if (p0.size()>0)
-        {
-            for (size_t i=0; i<p0.size(); i++)
-                obj_value+=norm2(p1[i]-s*(H*p0[i]));
-
-            obj_value/=p0.size();
-        }
+        Matrix S=eye(4,4);
+        S(0,0)=S(1,1)=S(2,2)=x[6];
 
+        obj_value=evalCost(S*computeH(x));
         return true;
     }
     
@@ -399,60 +368,19 @@ public:
     bool eval_grad_f(Ipopt::Index n, const Ipopt::Number* x, bool new_x,
                      Ipopt::Number *grad_f)
     {
-        double ca=cos(x[3]);  double sa=sin(x[3]);
-        double cb=cos(x[4]);  double sb=sin(x[4]);
-        double cg=cos(x[5]);  double sg=sin(x[5]);
-
-        Matrix Rza=eye(4,4);
-        Rza(0,0)=ca;   Rza(1,1)=ca;   Rza(1,0)=sa;   Rza(0,1)=-sa;
-        Matrix dRza=zeros(4,4);
-        dRza(0,0)=-sa; dRza(1,1)=-sa; dRza(1,0)=ca;  dRza(0,1)=-ca;
-
-        Matrix Rzg=eye(4,4);
-        Rzg(0,0)=cg;   Rzg(1,1)=cg;   Rzg(1,0)=sg;   Rzg(0,1)=-sg;
-        Matrix dRzg=zeros(4,4);
-        dRzg(0,0)=-sg; dRzg(1,1)=-sg; dRzg(1,0)=cg;  dRzg(0,1)=-cg;
-
-        Matrix Ryb=eye(4,4);
-        Ryb(0,0)=cb;   Ryb(2,2)=cb;   Ryb(2,0)=-sb;  Ryb(0,2)=sb;
-        Matrix dRyb=zeros(4,4);
-        dRyb(0,0)=-sb; dRyb(2,2)=-sb; dRyb(2,0)=-cb; dRyb(0,2)=cb;
-
-        Matrix dHdx0=zeros(4,4); dHdx0(0,3)=1.0;
-        Matrix dHdx1=zeros(4,4); dHdx1(1,3)=1.0;
-        Matrix dHdx2=zeros(4,4); dHdx2(2,3)=1.0;
-        Matrix dHdx3=dRza*Ryb*Rzg;
-        Matrix dHdx4=Rza*dRyb*Rzg;
-        Matrix dHdx5=Rza*Ryb*dRzg;
-
+        Matrix S=eye(4,4);
+        S(0,0)=S(1,1)=S(2,2)=x[6];
         Matrix H=computeH(x);
-        Matrix dHdx6=zeros(4,4); dHdx6(0,0)=1.0; dHdx6*=H;
-
-        Vector s(4);
-        s[0]=s[1]=s[2]=x[6];
-        s[3]=1.0;
 
-        grad_f[0]=grad_f[1]=grad_f[2]=0.0;
-        grad_f[3]=grad_f[4]=grad_f[5]=0.0;
-        grad_f[6]=0.0;
-        if (p0.size()>0)
-        {
-            for (size_t i=0; i<p0.size(); i++)
-            {
-                Vector d=p1[i]-s*(H*p0[i]);
-                grad_f[0]-=2.0*dot(d,(dHdx0*p0[i]));
-                grad_f[1]-=2.0*dot(d,(dHdx1*p0[i]));
-                grad_f[2]-=2.0*dot(d,(dHdx2*p0[i]));
-                grad_f[3]-=2.0*dot(d,(dHdx3*p0[i]));
-                grad_f[4]-=2.0*dot(d,(dHdx4*p0[i]));
-                grad_f[5]-=2.0*dot(d,(dHdx5*p0[i]));
-                grad_f[6]-=2.0*dot(d,(dHdx6*p0[i]));
-            }
+        Matrix dA[7];
+        computeDH(x,dA);
+        for (int i=0; i<6; i++)
+            dA[i]=S*dA[i];
 
-            for (Ipopt::Index i=0; i<n; i++)
-                grad_f[i]/=p0.size();
-        }
+        dA[6]=H;
+        dA[6].setRow(3,zeros(4));
 
+        evalCostGradient(S*H,dA,n,grad_f);
         return true;
     }
 };
@@ -467,6 +395,8 @@ CalibReferenceWithMatchedPoints::CalibReferenceWithMatchedPoints()
 {
     max_iter=300;
     tol=1e-8;
+    use_moments=true;
+    store_points=true;
 
     min.resize(6); max.resize(6);
     min[0]=-1.0;   max[0]=1.0;
@@ -546,19 +476,25 @@ void CalibReferenceWithMatchedPoints::setScalingBounds(const double min,
 }
 
 
+/****************************************************************/
+bool CalibReferenceWithMatchedPoints::hasAllPoints() const
+{
+    return ((p0.size()>0) && (p0.size()==moments.size()));
+}
+
+
 /****************************************************************/
 double CalibReferenceWithMatchedPoints::evalError(const Matrix &H)
 {
-    double error=0.0;
-    if (p0.size()>0)
-    {
-        for (size_t i=0; i<p0.size(); i++)
-            error+=norm(p1[i]-H*p0[i]);
+    // without the points at hand, resort to the rms residual
+    if (!hasAllPoints())
+        return sqrt(moments.evalCost(H));
 
-        error/=p0.size();
-    }
+    double error=0.0;
+    for (size_t i=0; i<p0.size(); i++)
+        error+=norm(p1[i]-H*p0[i]);
 
-    return error;
+    return error/p0.size();
 }
 
 
@@ -571,8 +507,12 @@ bool CalibReferenceWithMatchedPoints::addPoints(const Vector &p0,
         Vector _p0=p0.subVector(0,2); _p0.push_back(1.0);
         Vector _p1=p1.subVector(0,2); _p1.push_back(1.0);
 
-        this->p0.push_back(_p0);
-        this->p1.push_back(_p1);
+        moments.add(_p0,_p1);
+        if (store_points)
+        {
+            this->p0.push_back(_p0);
+            this->p1.push_back(_p1);
+        }
 
         return true;
     }
@@ -595,6 +535,7 @@ void CalibReferenceWithMatchedPoints::clearPoints()
 {
     p0.clear();
     p1.clear();
+    moments.clear();
 }
 
 
@@ -645,6 +586,27 @@ bool CalibReferenceWithMatchedPoints::setCalibrationOptions(const Property &opti
     if (opt.check("tol"))
         tol=opt.find("tol").asDouble();
 
+    if (opt.check("objective"))
+    {
+        string objective=opt.find("objective").asString().c_str();
+        if (objective=="moments")
+            use_moments=true;
+        else if (objective=="points")
+            use_moments=false;
+        else
+            return false;
+    }
+
+    if (opt.check("store_points"))
+    {
+        store_points=(opt.find("store_points").asString()=="on");
+        if (!store_points)
+        {
+            p0.clear();
+            p1.clear();
+        }
+    }
+
     return true;
 }
 
@@ -652,7 +614,7 @@ bool CalibReferenceWithMatchedPoints::setCalibrationOptions(const Property &opti
 /****************************************************************/
 bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, double &error)
 {
-    if (p0.size()>0)
+    if (moments.size()>0)
     {
         Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
         app->Options()->SetNumericValue("tol",tol);
@@ -666,7 +628,8 @@ bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, double &error)
         app->Options()->SetStringValue("derivative_test","none");
         app->Initialize();
 
-        Ipopt::SmartPtr<CalibReferenceWithMatchedPointsNLP> nlp=new CalibReferenceWithMatchedPointsNLP(p0,p1,min,max);
+        const MatchedPointsMoments *m=(use_moments || !hasAllPoints())?&moments:NULL;
+        Ipopt::SmartPtr<CalibReferenceWithMatchedPointsNLP> nlp=new CalibReferenceWithMatchedPointsNLP(p0,p1,m,min,max);
 
         nlp->set_x0(x0);
         Ipopt::ApplicationReturnStatus status=app->OptimizeTNLP(GetRawPtr(nlp));
@@ -686,7 +649,7 @@ bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, double &error)
 bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, Vector &s,
                                                 double &error)
 {
-    if (p0.size()>0)
+    if (moments.size()>0)
     {
         Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
         app->Options()->SetNumericValue("tol",tol);
@@ -700,7 +663,8 @@ bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, Vector &s,
         app->Options()->SetStringValue("derivative_test","none");
         app->Initialize();
 
-        Ipopt::SmartPtr<CalibReferenceWithScaledMatchedPointsNLP> nlp=new CalibReferenceWithScaledMatchedPointsNLP(p0,p1,cat(min,min_s),cat(max,max_s));
+        const MatchedPointsMoments *m=(use_moments || !hasAllPoints())?&moments:NULL;
+        Ipopt::SmartPtr<CalibReferenceWithScaledMatchedPointsNLP> nlp=new CalibReferenceWithScaledMatchedPointsNLP(p0,p1,m,cat(min,min_s),cat(max,max_s));
 
         nlp->set_x0(cat(x0,s0));
         Ipopt::ApplicationReturnStatus status=app->OptimizeTNLP(GetRawPtr(nlp));
@@ -723,7 +687,7 @@ bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, Vector &s,
 bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, double &s,
                                                 double &error)
 {
-    if (p0.size()>0)
+    if (moments.size()>0)
     {
         Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
         app->Options()->SetNumericValue("tol",tol);
@@ -737,7 +701,8 @@ bool CalibReferenceWithMatchedPoints::calibrate(Matrix &H, double &s,
         app->Options()->SetStringValue("derivative_test","none");
         app->Initialize();
 
-        Ipopt::SmartPtr<CalibReferenceWithScalarScaledMatchedPointsNLP> nlp=new CalibReferenceWithScalarScaledMatchedPointsNLP(p0,p1,cat(min,min_s_scalar),cat(max,max_s_scalar));
+        const MatchedPointsMoments *m=(use_moments || !hasAllPoints())?&moments:NULL;
+        Ipopt::SmartPtr<CalibReferenceWithScalarScaledMatchedPointsNLP> nlp=new CalibReferenceWithScalarScaledMatchedPointsNLP(p0,p1,m,cat(min,min_s_scalar),cat(max,max_s_scalar));
 
         nlp->set_x0(cat(x0,s0_scalar));
         Ipopt::ApplicationReturnStatus status=app->OptimizeTNLP(GetRawPtr(nlp));
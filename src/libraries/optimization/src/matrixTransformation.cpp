@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <iCub/optimization/matrixTransformation.h>
+
+using namespace yarp::sig;
+using namespace iCub::optimization;
+
+
+/****************************************************************/
+MatchedPointsMoments::MatchedPointsMoments()
+{
+    clear();
+}
+
+
+/****************************************************************/
+void MatchedPointsMoments::clear()
+{
+    for (int r=0; r<4; r++)
+    {
+        for (int c=0; c<4; c++)
+            M00[r][c]=M10[r][c]=0.0;
+    }
+
+    m11=0.0;
+    N=0;
+}
+
+
+/****************************************************************/
+void MatchedPointsMoments::add(const Vector &p0, const Vector &p1)
+{
+    for (int r=0; r<4; r++)
+    {
+        for (int c=0; c<4; c++)
+        {
+            M00[r][c]+=p0[r]*p0[c];
+            M10[r][c]+=p1[r]*p0[c];
+        }
+
+        m11+=p1[r]*p1[r];
+    }
+
+    N++;
+}
+
+
+/****************************************************************/
+double MatchedPointsMoments::evalCost(const Matrix &A) const
+{
+    if (N==0)
+        return 0.0;
+
+    // sum||p1-A*p0||^2 = sum(p1'*p1) - 2*<A,M10> + <A*M00,A>
+    double cost=m11;
+    for (int r=0; r<4; r++)
+    {
+        for (int c=0; c<4; c++)
+        {
+            double AM00=0.0;
+            for (int k=0; k<4; k++)
+                AM00+=A(r,k)*M00[k][c];
+
+            cost+=A(r,c)*(AM00-2.0*M10[r][c]);
+        }
+    }
+
+    // the cancellation may yield tiny negative values
+    return (cost>0.0?cost/N:0.0);
+}
+
+
+/****************************************************************/
+void MatchedPointsMoments::evalCostGradient(const Matrix &A, Matrix &G) const
+{
+    G.resize(4,4);
+    G.zero();
+    if (N==0)
+        return;
+
+    // G=2*(A*M00-M10)/N
+    double k2=2.0/N;
+    for (int r=0; r<4; r++)
+    {
+        for (int c=0; c<4; c++)
+        {
+            double AM00=0.0;
+            for (int k=0; k<4; k++)
+                AM00+=A(r,k)*M00[k][c];
+
+            G(r,c)=k2*(AM00-M10[r][c]);
+        }
+    }
+}
+
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+/**
+ * Byte buffer used by the compact binary serialization of the contact lists.
+ *
+ * \section intro_sec Description
+ *
+ * A whole dynContactList (or skinContactList) is packed into one contiguous
+ * block of bytes that travels as a single blob on the connection, instead of
+ * being spelled out as nested Bottle lists with one tag per scalar.
+ * Integers are stored as little-endian 32-bit words, doubles are copied as they
+ * are (IEEE 754, same byte order used by YARP on the wire), counters are stored
+ * as variable-length unsigned integers, and taxel lists are delta- or
+ * bitmap-encoded, whichever is shorter.
+ *
+ * \section tested_os_sec Tested OS
+ *
+ * Linux
+ *
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ *
+ **/
+
+#ifndef __COMPACTBLOCK_H__
+#define __COMPACTBLOCK_H__
+
+#include <cstddef>
+#include <vector>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/sig/Vector.h>
+
+namespace iCub
+{
+namespace skinDynLib
+{
+
+/**
+* @ingroup skinDynLib
+*
+* Contiguous byte block with sequential put/get access, used for the
+* compact serialization of dynContactList and skinContactList.
+*/
+class compactBlock
+{
+protected:
+    std::vector<unsigned char> data;
+    // current reading position
+    size_t pos;
+
+    // encoding of a taxel list
+    enum TaxelEncoding { TAXEL_RAW=0, TAXEL_DELTA=1, TAXEL_BITMAP=2 };
+
+    static size_t uintSize(unsigned int v);
+    bool getByte(unsigned char &v);
+
+public:
+    compactBlock();
+
+    /**
+    * Empty the block and rewind it.
+    */
+    void clear();
+
+    /**
+    * Number of bytes currently stored in the block.
+    */
+    size_t size() const { return data.size(); }
+
+    //~~~~~~~~~~~~~~~~~~~~~~
+	//   PUT methods
+	//~~~~~~~~~~~~~~~~~~~~~~
+    void putInt(int v);
+    void putUInt(unsigned int v);
+    void putDoubles(const double *v, size_t n);
+    void putBytes(const unsigned char *v, size_t n);
+    /**
+    * Append the first n elements of the vector v (zeros if v is shorter).
+    */
+    void putVector(const yarp::sig::Vector &v, size_t n);
+    /**
+    * Append a list of taxel ids. Strictly increasing lists are delta-encoded
+    * or stored as a bitmap over their range, whichever takes less room; any
+    * other list is stored as it is, so that its order is preserved.
+    */
+    void putTaxelList(const std::vector<unsigned int> &list);
+
+    //~~~~~~~~~~~~~~~~~~~~~~
+	//   GET methods
+	//~~~~~~~~~~~~~~~~~~~~~~
+    /*
+    * All the get methods return false if the block does not contain enough data.
+    */
+    bool getInt(int &v);
+    bool getUInt(unsigned int &v);
+    bool getDoubles(double *v, size_t n);
+    bool getBytes(unsigned char *v, size_t n);
+    bool getVector(yarp::sig::Vector &v, size_t n);
+    bool getTaxelList(std::vector<unsigned int> &list);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~
+	//   SERIALIZATION methods
+	//~~~~~~~~~~~~~~~~~~~~~~~~~
+    /**
+    * Write the block to a connection as a Bottle list containing one blob,
+    * i.e. BOTTLE_TAG_LIST+BOTTLE_TAG_BLOB, 1, size, bytes.
+    * The bytes are passed to ConnectionWriter::appendBlock(), which keeps its
+    * own copy, so the block can be changed or destroyed as soon as write()
+    * returns.
+    */
+    bool write(yarp::os::ConnectionWriter& connection) const;
+
+    /**
+    * Read the block from a connection, after its leading tag
+    * (BOTTLE_TAG_LIST+BOTTLE_TAG_BLOB) has already been consumed, and rewind it.
+    */
+    bool read(yarp::os::ConnectionReader& connection);
+
+    /**
+    * Write the block as the body of a blob (size, bytes), without any tag.
+    */
+    bool writeRaw(yarp::os::ConnectionWriter& connection) const;
+
+    /**
+    * Read the body of a blob (size, bytes) and rewind the block.
+    */
+    bool readRaw(yarp::os::ConnectionReader& connection);
+};
+
+}
+
+}
+#endif
@@ -27,6 +27,7 @@
 
 #include <yarp/os/Portable.h>
 #include <yarp/sig/Vector.h>
+#include "iCub/skinDynLib/compactBlock.h"
 #include <yarp/sig/Matrix.h>
 #include "iCub/skinDynLib/common.h"
 
@@ -307,6 +308,19 @@ public:
     * @return true iff the dynContact was written correctly
     */
     virtual bool write(yarp::os::ConnectionWriter& connection);
+    /**
+    * Append this dynContact to a compact block (see dynContactList::setCompact()):
+    * contactId, bodyPart and linkNumber as 32-bit integers, followed by
+    * CoP, force and moment as 9 packed doubles.
+    * @param block the block to append to
+    */
+    virtual void writeCompact(compactBlock &block) const;
+    /**
+    * Read this dynContact from a compact block, at its current position.
+    * @param block the block to read from
+    * @return true iff a dynContact was read correctly
+    */
+    virtual bool readCompact(compactBlock &block);
 
     
     /**
@@ -254,6 +254,20 @@ public:
     * @return true iff a skinContact was written correctly
     */
     virtual bool write(yarp::os::ConnectionWriter& connection);
+    /**
+    * Append this skinContact to a compact block (see skinContactList::setCompact()):
+    * the dynContact data, then skinPart as 32-bit integer, geometric center,
+    * normal direction and pressure as 7 packed doubles and finally the
+    * (delta or bitmap encoded) list of active taxel ids.
+    * @param block the block to append to
+    */
+    virtual void writeCompact(compactBlock &block) const;
+    /**
+    * Read this skinContact from a compact block, at its current position.
+    * @param block the block to read from
+    * @return true iff a skinContact was read correctly
+    */
+    virtual bool readCompact(compactBlock &block);
 
     /**
     * Convert this skinContact to a vector. The size of the vector is 21 plus
@@ -44,7 +44,11 @@ namespace skinDynLib
 class skinContactList  : public std::vector<skinContact>, public yarp::os::Portable
 {
 protected:
-    
+    // true if write() uses the compact binary form
+    bool compact;
+    // buffer used by read() to decode the compact binary form
+    compactBlock block;
+
 public:
     //~~~~~~~~~~~~~~~~~~~~~~
 	//   CONSTRUCTORS
@@ -80,6 +84,24 @@ public:
     */
     virtual bool write(yarp::os::ConnectionWriter& connection);
 
+    /**
+    * Select the format used by write(). By default the list is written as
+    * a Bottle-compatible list of lists (one per contact). In compact mode the
+    * whole list is packed into one contiguous binary block (see compactBlock)
+    * that travels as a Bottle list holding a single blob, which is much
+    * cheaper to write and read for lists with many contacts or large taxel lists.
+    * read() recognizes both formats, so the receivers do not need any
+    * configuration: the sender switches to the compact mode once all the
+    * readers on the port are recent enough to decode it.
+    * @param _compact true to write in compact mode
+    */
+    void setCompact(bool _compact=true){ compact=_compact; }
+
+    /**
+    * @return true if write() uses the compact binary form
+    */
+    bool isCompact() const { return compact; }
+
     /**
      * Convert this skinContactList to a dynContactList casting all its elements
      * to dynContact.
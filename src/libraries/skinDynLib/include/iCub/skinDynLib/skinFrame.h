@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+/**
+ * Compact representation of the raw readings of a set of tactile sensors.
+ *
+ * \section intro_sec Description
+ *
+ * The skin produces 8-bit readings, grouped in patches (the 12 taxels of a
+ * triangle of the iCub skin), most of which do not change from one sample
+ * to the next. A skinFrame keeps the readings as bytes and remembers which
+ * patches changed, so that it can be streamed either as a full frame or as
+ * a delta containing only the changed patches.
+ *
+ * \section tested_os_sec Tested OS
+ *
+ * Linux
+ *
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ *
+ **/
+
+#ifndef __SKINFRAME_H__
+#define __SKINFRAME_H__
+
+#include <vector>
+#include <yarp/os/Portable.h>
+#include <yarp/sig/Vector.h>
+#include "iCub/skinDynLib/compactBlock.h"
+
+namespace iCub
+{
+namespace skinDynLib
+{
+
+/**
+* @ingroup skinDynLib
+*
+* Raw 8-bit readings of a set of taxels, with the patches changed since
+* the last clearChanged().
+*
+* On the wire a skinFrame is a Bottle list of 5 elements:
+* - the vocab "full" or "delt"
+* - the sequence number, incremented by the sender at every frame
+* - the number of taxels
+* - the number of taxels of a patch
+* - a blob: for a full frame the readings of all the taxels, for a delta
+*   the number of changed patches followed, for each of them, by the
+*   distance from the previous changed patch and its readings.
+*
+* Since a BufferedPort may use a different object at every read, deltas
+* are not applied by read(): the receiver keeps its own frame and calls
+* apply() with every frame read from the port. A frame can be dropped on
+* the way, therefore a delta is applied only if its sequence number follows
+* the one of the last frame applied; after a gap the receiver waits for the
+* next full frame.
+*/
+class skinFrame : public yarp::os::Portable
+{
+protected:
+    // readings of all the taxels
+    std::vector<unsigned char> taxels;
+    // one flag per patch, non zero if the patch changed
+    std::vector<unsigned char> changed;
+    // number of taxels of a patch
+    int patchSize;
+    // true if write() has to send the whole frame
+    bool full;
+    // sequence number of the frame
+    unsigned int seq;
+    // true once a full frame has been applied to this frame
+    bool synchronized;
+    // buffer used by read() to decode the deltas
+    compactBlock block;
+
+    int changedNum() const;
+
+public:
+    //~~~~~~~~~~~~~~~~~~~~~~
+	//   CONSTRUCTORS
+	//~~~~~~~~~~~~~~~~~~~~~~
+    /**
+    * Constructor.
+    * @param nTaxels number of taxels
+    * @param _patchSize number of taxels of a patch
+    */
+    skinFrame(int nTaxels=0, int _patchSize=12);
+
+    /**
+    * Change the number of taxels. All the readings are set to zero and
+    * every patch is marked as changed.
+    */
+    void resize(int nTaxels, int _patchSize=12);
+
+    //~~~~~~~~~~~~~~~~~~~~~~
+	//   GET methods
+	//~~~~~~~~~~~~~~~~~~~~~~
+    int size() const                    { return (int)taxels.size(); }
+    int getPatchSize() const            { return patchSize; }
+    int getPatchNum() const             { return (int)changed.size(); }
+    unsigned char *data()               { return taxels.empty()?0:&taxels[0]; }
+    const unsigned char *data() const   { return taxels.empty()?0:&taxels[0]; }
+    bool isChanged(int patch) const     { return changed[patch]!=0; }
+    bool isFull() const                 { return full; }
+    unsigned int getSeq() const         { return seq; }
+    /**
+    * @return true if at least a patch changed since the last clearChanged()
+    */
+    bool anyChanged() const;
+    /**
+    * @return true if this frame has received a full frame through apply()
+    */
+    bool isSynchronized() const         { return synchronized; }
+
+    /**
+    * Copy the readings into a vector of double, as read by IAnalogSensor.
+    */
+    void toVector(yarp::sig::Vector &v) const;
+
+    //~~~~~~~~~~~~~~~~~~~~~~
+	//   SET methods
+	//~~~~~~~~~~~~~~~~~~~~~~
+    /**
+    * Overwrite n readings starting from the taxel first, marking as changed
+    * the patches whose readings actually differ.
+    * @return true if at least one reading changed
+    */
+    bool update(int first, const unsigned char *v, int n);
+    void markChanged(int patch)         { changed[patch] = 1; }
+    void clearChanged();
+    /**
+    * Force write() to send the whole frame, regardless of the changed patches.
+    */
+    void setFull(bool _full=true)       { full = _full; }
+    /**
+    * Set the sequence number sent by write().
+    */
+    void setSeq(unsigned int _seq)      { seq = _seq; }
+
+    /**
+    * Copy into this frame the patches carried by a frame read from a port
+    * and mark them as changed. Deltas are discarded until a full frame
+    * has been applied; a delta that does not follow the last frame applied
+    * (some frames went lost) makes the frame unsynchronized again.
+    * @return true if the frame was applied
+    */
+    bool apply(const skinFrame &f);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~
+	//   SERIALIZATION methods
+	//~~~~~~~~~~~~~~~~~~~~~~~~~
+    /**
+    * Read a full frame or a delta. After the reading, the patches carried by
+    * the message are marked as changed and isFull() tells the kind of message.
+    */
+    virtual bool read(yarp::os::ConnectionReader& connection);
+
+    /**
+    * Write the whole frame if setFull() was called or if at least half of the
+    * patches changed, otherwise write only the changed patches.
+    */
+    virtual bool write(yarp::os::ConnectionWriter& connection);
+};
+
+
+/**
+* @ingroup skinDynLib
+*
+* Interface of the devices that can provide their readings as a skinFrame.
+*/
+class ISkinFrameSource
+{
+public:
+    virtual ~ISkinFrameSource() {}
+
+    /**
+    * Copy the last readings into frame, with the patches changed since the
+    * previous call marked as changed, and clear the changes of the source.
+    * @param frame the frame to fill
+    * @return true if the frame was read correctly
+    */
+    virtual bool readFrame(skinFrame &frame) = 0;
+};
+
+}
+
+}
+#endif
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+#include <cstring>
+#include <yarp/os/Bottle.h>
+#include "iCub/skinDynLib/compactBlock.h"
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::skinDynLib;
+
+
+compactBlock::compactBlock(): pos(0){}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void compactBlock::clear()
+{
+    data.clear();
+    pos = 0;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+size_t compactBlock::uintSize(unsigned int v)
+{
+    size_t n = 1;
+    while(v>=0x80)
+    {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   PUT methods
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void compactBlock::putInt(int v)
+{
+    unsigned int u = (unsigned int)v;
+    data.push_back((unsigned char)(u));
+    data.push_back((unsigned char)(u>>8));
+    data.push_back((unsigned char)(u>>16));
+    data.push_back((unsigned char)(u>>24));
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void compactBlock::putUInt(unsigned int v)
+{
+    // 7 bits per byte, the msb tells whether another byte follows
+    while(v>=0x80)
+    {
+        data.push_back((unsigned char)(v|0x80));
+        v >>= 7;
+    }
+    data.push_back((unsigned char)v);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void compactBlock::putDoubles(const double *v, size_t n)
+{
+    if(n==0)
+        return;
+    size_t offset = data.size();
+    data.resize(offset + n*sizeof(double));
+    memcpy(&data[offset], v, n*sizeof(double));
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void compactBlock::putBytes(const unsigned char *v, size_t n)
+{
+    data.insert(data.end(), v, v+n);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void compactBlock::putVector(const Vector &v, size_t n)
+{
+    size_t m = (size_t)v.size()<n ? (size_t)v.size() : n;
+    putDoubles(v.data(), m);
+    for(size_t i=m;i<n;i++)
+    {
+        double zero = 0.0;
+        putDoubles(&zero, 1);
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void compactBlock::putTaxelList(const vector<unsigned int> &list)
+{
+    size_t n = list.size();
+    putUInt((unsigned int)n);
+    if(n==0)
+        return;
+
+    // delta encoding and bitmap are only possible on strictly increasing lists
+    bool increasing = true;
+    size_t deltaSize = uintSize(list[0]);
+    for(size_t i=1;i<n && increasing;i++)
+    {
+        if(list[i]<=list[i-1])
+            increasing = false;
+        else
+            deltaSize += uintSize(list[i]-list[i-1]-1);
+    }
+
+    if(!increasing)
+    {
+        data.push_back((unsigned char)TAXEL_RAW);
+        for(size_t i=0;i<n;i++)
+            putUInt(list[i]);
+        return;
+    }
+
+    // the bitmap can only win on lists that are dense enough
+    unsigned int range = list[n-1]-list[0];
+    if(range<8*deltaSize && uintSize(list[0])+uintSize(range+1)+(range+8)/8<deltaSize)
+    {
+        unsigned int span = range+1;
+        data.push_back((unsigned char)TAXEL_BITMAP);
+        putUInt(list[0]);
+        putUInt(span);
+        size_t offset = data.size();
+        data.resize(offset + (span+7)/8, 0);
+        unsigned char *bits = &data[offset];
+        for(size_t i=0;i<n;i++)
+        {
+            unsigned int b = list[i]-list[0];
+            bits[b>>3] |= (unsigned char)(1<<(b&7));
+        }
+    }
+    else
+    {
+        data.push_back((unsigned char)TAXEL_DELTA);
+        putUInt(list[0]);
+        for(size_t i=1;i<n;i++)
+            putUInt(list[i]-list[i-1]-1);
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   GET methods
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::getByte(unsigned char &v)
+{
+    if(pos>=data.size())
+        return false;
+    v = data[pos++];
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::getInt(int &v)
+{
+    if(data.size()-pos<4)
+        return false;
+    const unsigned char *p = &data[pos];
+    v = (int)((unsigned int)p[0] | ((unsigned int)p[1]<<8) |
+              ((unsigned int)p[2]<<16) | ((unsigned int)p[3]<<24));
+    pos += 4;
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::getUInt(unsigned int &v)
+{
+    v = 0;
+    unsigned char b;
+    for(int shift=0; shift<35; shift+=7)
+    {
+        if(!getByte(b))
+            return false;
+        v |= (unsigned int)(b&0x7f)<<shift;
+        if((b&0x80)==0)
+            return true;
+    }
+    return false;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::getDoubles(double *v, size_t n)
+{
+    if((data.size()-pos)/sizeof(double)<n)
+        return false;
+    if(n>0)
+        memcpy(v, &data[pos], n*sizeof(double));
+    pos += n*sizeof(double);
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::getBytes(unsigned char *v, size_t n)
+{
+    if(data.size()-pos<n)
+        return false;
+    if(n>0)
+        memcpy(v, &data[pos], n);
+    pos += n;
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::getVector(Vector &v, size_t n)
+{
+    if(v.size()!=n)
+        v.resize(n);
+    return getDoubles(v.data(), n);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::getTaxelList(vector<unsigned int> &list)
+{
+    unsigned int n;
+    if(!getUInt(n))
+        return false;
+    // every taxel takes at least one bit, reject corrupted counters
+    if(n>8*(data.size()-pos))
+        return false;
+    list.resize(n);
+    if(n==0)
+        return true;
+
+    unsigned char encoding;
+    if(!getByte(encoding))
+        return false;
+
+    if(encoding==TAXEL_RAW)
+    {
+        for(unsigned int i=0;i<n;i++)
+            if(!getUInt(list[i]))
+                return false;
+    }
+    else if(encoding==TAXEL_DELTA)
+    {
+        if(!getUInt(list[0]))
+            return false;
+        for(unsigned int i=1;i<n;i++)
+        {
+            unsigned int delta;
+            if(!getUInt(delta))
+                return false;
+            list[i] = list[i-1]+delta+1;
+        }
+    }
+    else if(encoding==TAXEL_BITMAP)
+    {
+        unsigned int first, span;
+        if(!getUInt(first) || !getUInt(span))
+            return false;
+        size_t bytes = ((size_t)span+7)/8;
+        if(data.size()-pos<bytes)
+            return false;
+        const unsigned char *bits = &data[pos];
+        // every id is stored and the counter advances only if its bit is set,
+        // which avoids a hard-to-predict branch per bit; the list is made
+        // 8 ids longer, so that a whole byte can be stored after the last id
+        list.resize(n+8);
+        unsigned int *ids = &list[0];
+        unsigned int i = 0;
+        for(size_t k=0; k<bytes; k++)
+        {
+            unsigned int c = bits[k];
+            if(c==0)
+                continue;
+            unsigned int id = first+(unsigned int)(8*k);
+            for(unsigned int b=0; b<8; b++)
+            {
+                ids[i] = id+b;
+                i += (c>>b)&1;
+            }
+            if(i>n)
+                return false;
+        }
+        list.resize(n);
+        pos += bytes;
+        if(i!=n)
+            return false;
+    }
+    else
+        return false;
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   SERIALIZATION methods
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::write(ConnectionWriter& connection) const
+{
+    // a Bottle list of blobs containing a single blob
+    connection.appendInt(BOTTLE_TAG_LIST + BOTTLE_TAG_BLOB);
+    connection.appendInt(1);
+    return writeRaw(connection);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::read(ConnectionReader& connection)
+{
+    if(connection.expectInt()!=1)
+        return false;
+    return readRaw(connection);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::writeRaw(ConnectionWriter& connection) const
+{
+    connection.appendInt((int)data.size());
+    if(!data.empty())
+        connection.appendBlock((const char*)&data[0], data.size());
+
+    return !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool compactBlock::readRaw(ConnectionReader& connection)
+{
+    pos = 0;
+    int len = connection.expectInt();
+    if(len<0 || (size_t)len>connection.getSize())
+        return false;
+
+    data.resize(len);
+    if(len>0 && !connection.expectBlock((char*)&data[0], len))
+        return false;
+
+    return !connection.isError();
+}
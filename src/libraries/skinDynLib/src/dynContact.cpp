@@ -258,6 +258,28 @@ bool dynContact::read(ConnectionReader& connection){
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void dynContact::writeCompact(compactBlock &block) const{
+    block.putInt(contactId);
+    block.putInt(bodyPart);
+    block.putInt(linkNumber);
+    block.putVector(CoP, 3);
+    block.putVector(F, 3);
+    block.putVector(Mu, 3);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool dynContact::readCompact(compactBlock &block){
+    int id, bp, link;
+    if(!block.getInt(id) || !block.getInt(bp) || !block.getInt(link))
+        return false;
+    contactId   = id;
+    bodyPart    = (BodyPart)bp;
+    linkNumber  = link;
+    if(!block.getVector(CoP, 3) || !block.getVector(F, 3) || !block.getVector(Mu, 3))
+        return false;
+    setForce(F);
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 string dynContact::toString(int precision) const{
     stringstream res;
     res<< "Contact id: "<< contactId<< "Body part: "<< BodyPart_s[bodyPart]<< ", link: "<< linkNumber<< ", CoP: "<< 
@@ -214,6 +214,29 @@ bool skinContact::read(ConnectionReader& connection){
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContact::writeCompact(compactBlock &block) const{
+    dynContact::writeCompact(block);
+    block.putInt(skinPart);
+    block.putVector(geoCenter, 3);
+    block.putVector(normalDir, 3);
+    block.putDoubles(&pressure, 1);
+    // activeTaxels may be set without the corresponding list of taxels
+    block.putUInt(activeTaxels);
+    block.putTaxelList(taxelList);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContact::readCompact(compactBlock &block){
+    if(!dynContact::readCompact(block))
+        return false;
+    int sp;
+    if(!block.getInt(sp))
+        return false;
+    skinPart = (SkinPart)sp;
+    if(!block.getVector(geoCenter, 3) || !block.getVector(normalDir, 3) || !block.getDoubles(&pressure, 1))
+        return false;
+    return block.getUInt(activeTaxels) && block.getTaxelList(taxelList);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Vector skinContact::toVector() const{
     Vector v(activeTaxels+21);
     unsigned int index = 0;
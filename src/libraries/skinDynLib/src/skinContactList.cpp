@@ -12,20 +12,23 @@
 
 #include "iCub/skinDynLib/skinContactList.h"
 #include <iCub/ctrl/math.h>
+#include <yarp/os/Vocab.h>
 
 using namespace std;
 using namespace yarp::os;
 using namespace iCub::skinDynLib;
 
+// identifies the compact form of a skinContactList (and its version)
+#define COMPACT_ID  VOCAB4('s','c','l','1')
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //   CONSTRUCTORS
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList()
-:vector<skinContact>(){}
+:vector<skinContact>(), compact(false){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList(const size_type &n, const skinContact& value)
-:vector<skinContact>(n, value){}
+:vector<skinContact>(n, value), compact(false){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList skinContactList::filterBodyPart(const BodyPart &bp)
 {
@@ -48,9 +51,29 @@ map<BodyPart, skinContactList> skinContactList::splitPerBodyPart()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool skinContactList::read(ConnectionReader& connection)
 {
+    int tag = connection.expectInt();
+
+    // compact form: a list containing one blob, see setCompact()
+    if(tag==BOTTLE_TAG_LIST+BOTTLE_TAG_BLOB)
+    {
+        int id, listLength;
+        if(!block.read(connection) || !block.getInt(id) || id!=COMPACT_ID || !block.getInt(listLength))
+            return false;
+        if(listLength<0 || (size_t)listLength>block.size())
+            return false;
+        if(listLength!=size())
+            resize(listLength);
+
+        for(iterator it=begin(); it!=end(); it++)
+            if(!it->readCompact(block))
+                return false;
+
+        return true;
+    }
+
     // A skinContactList is represented as a list of list
     // where each list is a skinContact
-    if(connection.expectInt()!=BOTTLE_TAG_LIST)
+    if(tag!=BOTTLE_TAG_LIST)
         return false;
 
     int listLength = connection.expectInt();
@@ -68,6 +91,25 @@ bool skinContactList::read(ConnectionReader& connection)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool skinContactList::write(ConnectionWriter& connection)
 {
+    if(compact)
+    {
+        // encode into a local block, so that concurrent writes of the
+        // same list never share the buffer handed to the connection
+        compactBlock out;
+        out.putInt(COMPACT_ID);
+        out.putInt(size());
+        for(const_iterator it=begin(); it!=end(); it++)
+            it->writeCompact(out);
+
+        if(!out.write(connection))
+            return false;
+
+        // if someone is foolish enough to connect in text mode,
+        // let them see something readable.
+        connection.convertTextMode();
+        return !connection.isError();
+    }
+
     // A skinContactList is represented as a list of list
     // where each list is a skinContact
     connection.appendInt(BOTTLE_TAG_LIST);
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+#include <cstring>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Vocab.h>
+#include "iCub/skinDynLib/skinFrame.h"
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::skinDynLib;
+
+#define SKIN_FRAME_FULL     VOCAB4('f','u','l','l')
+#define SKIN_FRAME_DELTA    VOCAB4('d','e','l','t')
+
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   CONSTRUCTORS
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+skinFrame::skinFrame(int nTaxels, int _patchSize): full(false), seq(0), synchronized(false)
+{
+    resize(nTaxels, _patchSize);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinFrame::resize(int nTaxels, int _patchSize)
+{
+    patchSize = _patchSize>0 ? _patchSize : 1;
+    taxels.assign(nTaxels>0 ? nTaxels : 0, 0);
+    changed.assign((taxels.size()+patchSize-1)/patchSize, 1);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   GET methods
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int skinFrame::changedNum() const
+{
+    int n = 0;
+    for(size_t i=0;i<changed.size();i++)
+        n += changed[i]!=0;
+    return n;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinFrame::anyChanged() const
+{
+    for(size_t i=0;i<changed.size();i++)
+        if(changed[i])
+            return true;
+    return false;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinFrame::toVector(Vector &v) const
+{
+    if(v.size()!=taxels.size())
+        v.resize(taxels.size());
+    for(size_t i=0;i<taxels.size();i++)
+        v[i] = taxels[i];
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   SET methods
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinFrame::update(int first, const unsigned char *v, int n)
+{
+    if(first<0 || n<=0 || first+n>(int)taxels.size())
+        return false;
+
+    bool res = false;
+    int last = first+n;
+    // compare and copy one patch at a time
+    for(int i=first; i<last; )
+    {
+        int patch = i/patchSize;
+        int end = (patch+1)*patchSize<last ? (patch+1)*patchSize : last;
+        if(memcmp(&taxels[i], v+(i-first), end-i)!=0)
+        {
+            memcpy(&taxels[i], v+(i-first), end-i);
+            changed[patch] = 1;
+            res = true;
+        }
+        i = end;
+    }
+    return res;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinFrame::clearChanged()
+{
+    changed.assign(changed.size(), 0);
+    full = false;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinFrame::apply(const skinFrame &f)
+{
+    if(f.full)
+    {
+        if(f.taxels.size()!=taxels.size() || f.patchSize!=patchSize)
+            resize(f.size(), f.patchSize);
+        taxels = f.taxels;
+        changed.assign(changed.size(), 1);
+        seq = f.seq;
+        synchronized = true;
+        return true;
+    }
+
+    // a delta is meaningful only on top of the frame it was computed from:
+    // if one went lost, the readings of its patches are stale until the
+    // next full frame.
+    if(!synchronized || f.seq!=seq+1 || f.taxels.size()!=taxels.size() || f.patchSize!=patchSize)
+    {
+        synchronized = false;
+        return false;
+    }
+
+    for(size_t p=0;p<f.changed.size();p++)
+        if(f.changed[p])
+        {
+            size_t first = p*patchSize;
+            size_t n = first+patchSize<=taxels.size() ? patchSize : taxels.size()-first;
+            memcpy(&taxels[first], &f.taxels[first], n);
+            changed[p] = 1;
+        }
+    seq = f.seq;
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   SERIALIZATION methods
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinFrame::write(ConnectionWriter& connection)
+{
+    // a delta costs at least one byte more per patch than the full frame
+    int nChanged = changedNum();
+    bool sendFull = full || 2*nChanged>=(int)changed.size();
+
+    connection.appendInt(BOTTLE_TAG_LIST);
+    connection.appendInt(5);
+    connection.appendInt(BOTTLE_TAG_VOCAB);
+    connection.appendInt(sendFull ? SKIN_FRAME_FULL : SKIN_FRAME_DELTA);
+    connection.appendInt(BOTTLE_TAG_INT);
+    connection.appendInt((int)seq);
+    connection.appendInt(BOTTLE_TAG_INT);
+    connection.appendInt((int)taxels.size());
+    connection.appendInt(BOTTLE_TAG_INT);
+    connection.appendInt(patchSize);
+    connection.appendInt(BOTTLE_TAG_BLOB);
+
+    if(sendFull)
+    {
+        connection.appendInt((int)taxels.size());
+        if(!taxels.empty())
+            connection.appendBlock((const char*)&taxels[0], taxels.size());
+    }
+    else
+    {
+        compactBlock out;
+        out.putUInt(nChanged);
+        unsigned int previous = 0;
+        for(size_t p=0;p<changed.size();p++)
+            if(changed[p])
+            {
+                size_t first = p*patchSize;
+                size_t n = first+patchSize<=taxels.size() ? patchSize : taxels.size()-first;
+                out.putUInt((unsigned int)p-previous);
+                out.putBytes(&taxels[first], n);
+                previous = (unsigned int)p;
+            }
+        out.writeRaw(connection);
+    }
+
+    // if someone is foolish enough to connect in text mode,
+    // let them see something readable.
+    connection.convertTextMode();
+
+    return !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinFrame::read(ConnectionReader& connection)
+{
+    if(connection.expectInt()!=BOTTLE_TAG_LIST || connection.expectInt()!=5)
+        return false;
+    if(connection.expectInt()!=BOTTLE_TAG_VOCAB)
+        return false;
+    int kind = connection.expectInt();
+    if(kind!=SKIN_FRAME_FULL && kind!=SKIN_FRAME_DELTA)
+        return false;
+    if(connection.expectInt()!=BOTTLE_TAG_INT)
+        return false;
+    seq = (unsigned int)connection.expectInt();
+    if(connection.expectInt()!=BOTTLE_TAG_INT)
+        return false;
+    int nTaxels = connection.expectInt();
+    if(connection.expectInt()!=BOTTLE_TAG_INT)
+        return false;
+    int _patchSize = connection.expectInt();
+    if(nTaxels<0 || _patchSize<=0 || connection.expectInt()!=BOTTLE_TAG_BLOB)
+        return false;
+
+    if(nTaxels!=(int)taxels.size() || _patchSize!=patchSize)
+        resize(nTaxels, _patchSize);
+    full = kind==SKIN_FRAME_FULL;
+
+    if(full)
+    {
+        if(connection.expectInt()!=nTaxels)
+            return false;
+        if(nTaxels>0 && !connection.expectBlock((char*)&taxels[0], nTaxels))
+            return false;
+        changed.assign(changed.size(), 1);
+        return !connection.isError();
+    }
+
+    changed.assign(changed.size(), 0);
+    unsigned int nChanged;
+    if(!block.readRaw(connection) || !block.getUInt(nChanged))
+        return false;
+
+    unsigned int p = 0;
+    for(unsigned int i=0;i<nChanged;i++)
+    {
+        unsigned int step;
+        if(!block.getUInt(step))
+            return false;
+        p += step;
+        if(p>=changed.size() || (i>0 && step==0))
+            return false;
+        size_t first = p*patchSize;
+        size_t n = first+patchSize<=taxels.size() ? patchSize : taxels.size()-first;
+        if(!block.getBytes(&taxels[first], n))
+            return false;
+        changed[p] = 1;
+    }
+
+    return !connection.isError();
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+/**
+ * Serialization micro-benchmark of skinContactList and dynContactList.
+ *
+ * A list of random contacts is written and read back through an in-memory
+ * connection, both in the Bottle-compatible format and in the compact one
+ * (see skinContactList::setCompact()); for each format the program prints
+ * the size of the message and the average write and read times.
+ *
+ * Usage: skinDynLibBenchmark [--contacts n] [--taxels n] [--iterations n]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/DummyConnector.h>
+#include "iCub/skinDynLib/skinContactList.h"
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::skinDynLib;
+
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Vector randomVector()
+{
+    Vector v(3);
+    for(int i=0;i<3;i++)
+        v[i] = rand()/(double)RAND_MAX - 0.5;
+    return v;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+skinContactList createContacts(int nContacts, int nTaxels)
+{
+    skinContactList l;
+    for(int i=0;i<nContacts;i++)
+    {
+        // taxels of a contact are neighbours: increasing ids with small gaps
+        vector<unsigned int> taxels(nTaxels);
+        unsigned int id = rand()%384;
+        for(int j=0;j<nTaxels;j++)
+        {
+            taxels[j] = id;
+            id += 1 + rand()%3;
+        }
+        l.push_back(skinContact(LEFT_ARM, SKIN_LEFT_FOREARM, 4, randomVector(), randomVector(),
+            taxels, rand()/(double)RAND_MAX, randomVector(), randomVector(), randomVector()));
+    }
+    return l;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+template<class List>
+bool benchmark(const string &name, List &l, bool compact, int iterations)
+{
+    DummyConnector con;
+    List res;
+    l.setCompact(compact);
+
+    double tWrite=0.0, tRead=0.0;
+    size_t bytes=0;
+    for(int i=0;i<iterations;i++)
+    {
+        con.reset();
+        double t0 = Time::now();
+        if(!l.write(con.getWriter()))
+            return false;
+        double t1 = Time::now();
+        ConnectionReader &reader = con.getReader();
+        bytes = reader.getSize();
+        if(!res.read(reader))
+            return false;
+        double t2 = Time::now();
+        tWrite += t1-t0;
+        tRead  += t2-t1;
+    }
+
+    if(res.toString()!=l.toString())
+    {
+        fprintf(stderr, "%s: the list read differs from the one written\n", name.c_str());
+        return false;
+    }
+
+    printf("%-16s %-8s %10d %12.2f %12.2f\n", name.c_str(), compact?"compact":"bottle", (int)bytes,
+        1e6*tWrite/iterations, 1e6*tRead/iterations);
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int main(int argc, char *argv[])
+{
+    Network::init();
+
+    Property opt;
+    opt.fromCommand(argc, argv);
+    int nContacts   = opt.check("contacts", Value(20)).asInt();
+    int nTaxels     = opt.check("taxels", Value(30)).asInt();
+    int iterations  = opt.check("iterations", Value(1000)).asInt();
+
+    skinContactList skinList = createContacts(nContacts, nTaxels);
+    dynContactList dynList = skinList.toDynContactList();
+
+    printf("%d contacts, %d taxels per contact, %d iterations\n", nContacts, nTaxels, iterations);
+    printf("%-16s %-8s %10s %12s %12s\n", "list", "format", "bytes", "write [us]", "read [us]");
+
+    bool ok = benchmark("skinContactList", skinList, false, iterations) &&
+              benchmark("skinContactList", skinList, true, iterations) &&
+              benchmark("dynContactList", dynList, false, iterations) &&
+              benchmark("dynContactList", dynList, true, iterations);
+
+    Network::fini();
+    return ok ? 0 : 1;
+}
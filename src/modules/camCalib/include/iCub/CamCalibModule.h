@@ -39,6 +39,7 @@ private:
     bool verbose;
     double t0;
     double currSat;
+    bool   fusedSat;
 
     virtual void onRead(yarp::sig::ImageOf<yarp::sig::PixelRgb> &yrpImgIn);
 
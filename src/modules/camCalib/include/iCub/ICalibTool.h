@@ -28,6 +28,11 @@ public:
 
     virtual void apply(const yarp::sig::ImageOf<yarp::sig::PixelRgb> & in,
                        yarp::sig::ImageOf<yarp::sig::PixelRgb> & out) = 0;    
+
+    /** Adjust the saturation of the output within apply(), returns
+      * false if the tool cannot do it.
+      */
+    virtual bool setSaturation(double satVal) { return false; }
 };
 
 
@@ -27,6 +27,7 @@
 
 // iCub
 #include <iCub/ICalibTool.h>
+#include <iCub/vis/FixedPointRemap.h>
 
 
 /**
@@ -52,6 +53,11 @@ class PinholeCalibTool : public ICalibTool
 
     bool _drawCenterCross;
 
+    // fixed-point remap, optionally fused with a resize
+    bool _fixedPoint;
+    CvSize _outImgSize;
+    iCub::vis::FixedPointRemap _remap;
+
     bool init(CvSize currImgSize, CvSize calibImgSize);
 
 public:
@@ -98,6 +104,11 @@ public:
     */
     void apply(const yarp::sig::ImageOf<yarp::sig::PixelRgb> & in,
                yarp::sig::ImageOf<yarp::sig::PixelRgb> & out);    
+
+    /** Fuse the saturation adjustment with the remap, only available
+      * with the fixed-point remap.
+      */
+    virtual bool setSaturation(double satVal);
     
 };
 
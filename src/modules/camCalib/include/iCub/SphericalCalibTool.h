@@ -20,6 +20,7 @@
 
 // iCub
 #include <iCub/ICalibTool.h>
+#include <iCub/vis/FixedPointRemap.h>
 #include <iCub/vis/spherical_projection.h>
 
 
@@ -49,6 +50,11 @@ private:
 
     bool _drawCenterCross;
 
+    // fixed-point remap, optionally fused with a resize
+    bool _fixedPoint;
+    CvSize _outImgSize;
+    iCub::vis::FixedPointRemap _remap;
+
     bool init(CvSize currImgSize, CvSize calibImgSize);
 
 public:
@@ -66,6 +72,11 @@ public:
     // ICalibTool
     void apply(const yarp::sig::ImageOf<yarp::sig::PixelRgb> & in,
                yarp::sig::ImageOf<yarp::sig::PixelRgb> & out);    
+
+    /** Fuse the saturation adjustment with the remap, only available
+      * with the fixed-point remap.
+      */
+    virtual bool setSaturation(double satVal);
 };
 
 
@@ -16,6 +16,8 @@ CamCalibPort::CamCalibPort()
 {
     portImgOut=NULL;
     calibTool=NULL;
+    currSat=1.0;
+    fusedSat=false;
 
     verbose=false;
     t0=Time::now();
@@ -30,6 +32,8 @@ void CamCalibPort::setPointers(yarp::os::Port *_portImgOut, ICalibTool *_calibTo
 void CamCalibPort::setSaturation(double satVal)
 {
     currSat = satVal;
+    // the tool may adjust the saturation while remapping
+    fusedSat = (calibTool!=NULL) && calibTool->setSaturation(satVal);
 }
 
 void CamCalibPort::onRead(ImageOf<PixelRgb> &yrpImgIn)
@@ -49,7 +53,7 @@ void CamCalibPort::onRead(ImageOf<PixelRgb> &yrpImgIn)
         {
             calibTool->apply(yrpImgIn,yrpImgOut);
 
-            for (int r =0; r <yrpImgOut.height(); r++)
+            for (int r =0; !fusedSat && r <yrpImgOut.height(); r++)
             {
                 for (int c=0; c<yrpImgOut.width(); c++)
                 {
@@ -158,9 +162,9 @@ bool CamCalibModule::configure(yarp::os::ResourceFinder &rf){
     {
         cout << "====> warning: port " << getName("/conf") << " already in use" << endl;    
     }
-    _prtImgIn.setSaturation(rf.check("saturation",Value(1.0)).asDouble());
     _prtImgIn.open(getName("/in"));
     _prtImgIn.setPointers(&_prtImgOut,_calibTool);
+    _prtImgIn.setSaturation(rf.check("saturation",Value(1.0)).asDouble());
     _prtImgIn.setVerbose(rf.check("verbose"));
     _prtImgIn.useCallback();
     _prtImgOut.open(getName("/out"));
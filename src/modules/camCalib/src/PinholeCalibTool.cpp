@@ -18,6 +18,9 @@ PinholeCalibTool::PinholeCalibTool(){
     _distortion_coeffs = cvCreateMat(1, 4, CV_32F);
     _oldImgSize.width = -1;
     _oldImgSize.height = -1;
+    _outImgSize.width = 0;
+    _outImgSize.height = 0;
+    _fixedPoint = true;
     _needInit = true;
 }
 
@@ -126,11 +129,36 @@ bool PinholeCalibTool::configure (Searchable &config){
     CV_MAT_ELEM( *_distortion_coeffs, float, 0, 3) = (float)config.check("p2",
                                                         Value(0.0),
                                                         "Tangential distortion 2(double)").asDouble();
+    _fixedPoint = config.check("fixedPoint",
+                               Value(1),
+                               "Remap through fixed-point tables (int [0|1]).").asInt()!=0;
+
+    _outImgSize.width = config.check("outWidth",
+                                     Value(0),
+                                     "Width of the output image, resized within the remap (int, 0 for the input width).").asInt();
+
+    _outImgSize.height = config.check("outHeight",
+                                      Value(0),
+                                      "Height of the output image, resized within the remap (int, 0 for the input height).").asInt();
+
+    _remap.setNumThreads(config.check("threads",
+                                      Value(1),
+                                      "Number of threads remapping the image (int).").asInt());
+
     _needInit = true;
 
     return true;
 }
 
+bool PinholeCalibTool::setSaturation(double satVal){
+
+    if (!_fixedPoint)
+        return false;
+
+    _remap.setSaturation(satVal);
+    return true;
+}
+
 
 bool PinholeCalibTool::init(CvSize currImgSize, CvSize calibImgSize){
 
@@ -179,6 +207,16 @@ bool PinholeCalibTool::init(CvSize currImgSize, CvSize calibImgSize){
     cvInitUndistortMap( _intrinsic_matrix_scaled, _distortion_coeffs,
                         _mapUndistortX, _mapUndistortY);
 
+    // fixed-point tables, with the resize fused if required
+    if (_fixedPoint){
+        _remap.setMap((float*)_mapUndistortX->imageData, (float*)_mapUndistortY->imageData,
+                      currImgSize.width, currImgSize.height,
+                      currImgSize.width, currImgSize.height);
+        if (_outImgSize.width>0 && _outImgSize.height>0 &&
+            (_outImgSize.width!=currImgSize.width || _outImgSize.height!=currImgSize.height))
+            _remap.fuseResize(_outImgSize.width, _outImgSize.height);
+    }
+
     _needInit = false;
     return true;
 }
@@ -193,16 +231,19 @@ void PinholeCalibTool::apply(const ImageOf<PixelRgb> & in, ImageOf<PixelRgb> & o
         _needInit)
         init(inSize,_calibImgSize);
 
-    out.resize(inSize.width, inSize.height);
-
-    cvRemap( in.getIplImage(), out.getIplImage(),
-           _mapUndistortX, _mapUndistortY);
+    if (_fixedPoint)
+        _remap.apply(in, out);
+    else{
+        out.resize(inSize.width, inSize.height);
+        cvRemap( in.getIplImage(), out.getIplImage(),
+               _mapUndistortX, _mapUndistortY);
+    }
 
 	// painting crosshair at calibration center
     if (_drawCenterCross){
 	    yarp::sig::PixelRgb pix = yarp::sig::PixelRgb(255,255,255);
-        yarp::sig::draw::addCrossHair(out, pix, (int)CV_MAT_ELEM( *_intrinsic_matrix_scaled , float, 0, 2),
-		                                    (int)CV_MAT_ELEM( *_intrinsic_matrix_scaled , float, 1, 2),
+        yarp::sig::draw::addCrossHair(out, pix, (int)(CV_MAT_ELEM( *_intrinsic_matrix_scaled , float, 0, 2)*out.width()/inSize.width),
+		                                    (int)(CV_MAT_ELEM( *_intrinsic_matrix_scaled , float, 1, 2)*out.height()/inSize.height),
 											10);
     }
 
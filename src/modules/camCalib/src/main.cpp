@@ -80,8 +80,18 @@
  * k2 0.180303
  * p1 4.08465e-005
  * p2 0.000456613
+ * fixedPoint 1
+ * threads 1
+ * outWidth 0
+ * outHeight 0
  *
  * </pre>
+ * With \c fixedPoint set to 1 the undistortion maps are converted into
+ * compact fixed-point tables and the rows are remapped by \c threads
+ * threads; in this mode a non-zero \c outWidth and \c outHeight resize
+ * the output within the same remap, and the saturation is adjusted in
+ * the same pass as well. Set \c fixedPoint to 0 to use cvRemap().
+ *
  * \section portsc_sec Ports Created
  *
  * Input port 
@@ -28,6 +28,7 @@
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <iCub/ctrl/math.h>
+#include <cmath>
 #include <iCub/ctrl/adaptWinPolyEstimator.h>
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
@@ -42,6 +43,72 @@ using namespace iCub::iDyn;
 using namespace iCub::skinDynLib;
 using namespace std;
 
+partCommand::partCommand()
+{
+	iCtrlMode = 0;
+	iTqs      = 0;
+	iImp      = 0;
+	nAxes     = 0;
+}
+
+void partCommand::init(const string &_name, IControlMode *_iCtrlMode, ITorqueControl *_iTqs, IImpedanceControl *_iImp)
+{
+	name      = _name;
+	iCtrlMode = _iCtrlMode;
+	iTqs      = _iTqs;
+	iImp      = _iImp;
+	nAxes     = 0;
+	if (iTqs) iTqs->getAxes(&nAxes);
+	modes.assign(nAxes,VOCAB_CM_UNKNOWN);
+	lastModes.assign(nAxes,VOCAB_CM_UNKNOWN);
+	impOffsets.resize(nAxes,0.0);
+	offsetSent.assign(nAxes,false);
+}
+
+controlModeMonitor::controlModeMonitor(int _rate) : RateThread(_rate)
+{
+}
+
+void controlModeMonitor::addPart(partCommand *part)
+{
+	mutex.wait();
+	parts.push_back(part);
+	modes.push_back(std::vector<int>(part->nAxes,VOCAB_CM_UNKNOWN));
+	mutex.post();
+}
+
+void controlModeMonitor::getModes(partCommand *part)
+{
+	mutex.wait();
+	for (size_t i=0; i<parts.size(); i++)
+	{
+		if (parts[i]==part)
+		{
+			part->modes=modes[i];
+			break;
+		}
+	}
+	mutex.post();
+}
+
+void controlModeMonitor::run()
+{
+	for (size_t i=0; i<parts.size(); i++)
+	{
+		if (parts[i]->iCtrlMode==0 || parts[i]->nAxes<=0)
+			continue;
+
+		// read outside the lock, the parts may answer slowly
+		std::vector<int> m(parts[i]->nAxes,VOCAB_CM_UNKNOWN);
+		if (parts[i]->iCtrlMode->getControlModes(&m[0]))
+		{
+			mutex.wait();
+			modes[i]=m;
+			mutex.post();
+		}
+	}
+}
+
 Vector gravityCompensatorThread::evalVelUp(const Vector &x)
 {
     AWPolyElement el;
@@ -187,7 +254,7 @@ void  gravityCompensatorThread::setUpperMeasure()
     icub->upperTorso->setInertialMeasure(w0,dw0,d2p0);
 }
 
-gravityCompensatorThread::gravityCompensatorThread(int _rate, PolyDriver *_ddLA, PolyDriver *_ddRA, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddRL, PolyDriver *_ddT, version_tag icub_type) : RateThread(_rate), ddLA(_ddLA), ddRA(_ddRA), ddLL(_ddLL), ddRL(_ddRL), ddH(_ddH), ddT(_ddT)
+gravityCompensatorThread::gravityCompensatorThread(int _rate, PolyDriver *_ddLA, PolyDriver *_ddRA, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddRL, PolyDriver *_ddT, version_tag icub_type, int _ctrlModeRate) : RateThread(_rate), ddLA(_ddLA), ddRA(_ddRA), ddLL(_ddLL), ddRL(_ddRL), ddH(_ddH), ddT(_ddT)
 {   
 	gravity_mode = GRAVITY_COMPENSATION_ON;
 	wholeBodyName = "wholeBodyDynamics";
@@ -288,6 +355,19 @@ gravityCompensatorThread::gravityCompensatorThread(int _rate, PolyDriver *_ddLA,
 	inertial_measurements.zero();
 	torque_offset.resize(ctrlJnt);
 
+	//-----------COMMANDS----------------//
+	cmd_arm_left.init("left_arm",iCtrlMode_arm_left,iTqs_arm_left,iImp_arm_left);
+	cmd_arm_right.init("right_arm",iCtrlMode_arm_right,iTqs_arm_right,iImp_arm_right);
+	cmd_torso.init("torso",iCtrlMode_torso,iTqs_torso,iImp_torso);
+	cmd_leg_left.init("left_leg",iCtrlMode_leg_left,iTqs_leg_left,iImp_leg_left);
+	cmd_leg_right.init("right_leg",iCtrlMode_leg_right,iTqs_leg_right,iImp_leg_right);
+	modeMonitor = new controlModeMonitor(_ctrlModeRate);
+	modeMonitor->addPart(&cmd_arm_left);
+	modeMonitor->addPart(&cmd_arm_right);
+	modeMonitor->addPart(&cmd_torso);
+	modeMonitor->addPart(&cmd_leg_left);
+	modeMonitor->addPart(&cmd_leg_right);
+
 	int ctrl_mode = 0;
 	
 	switch(gravity_mode)
@@ -486,36 +566,70 @@ bool gravityCompensatorThread::getUpperEncodersSpeedAndAcceleration()
 bool gravityCompensatorThread::threadInit()
 {       
 	thread_status = STATUS_OK;
+	// the first reading of the control modes is done before starting
+	modeMonitor->run();
+	modeMonitor->start();
 	return true;
 }
 
 
-void gravityCompensatorThread::feedFwdGravityControl(string s_part, IControlMode *iCtrlMode, ITorqueControl *iTqs, IImpedanceControl *iImp,const Vector &G, const Vector &ampli, bool releasing)
+void gravityCompensatorThread::feedFwdGravityControl(partCommand &part, const Vector &G, const Vector &ampli, bool releasing)
 {
 	//check if interfaces are still up (icubinterface running)  
-	if (iCtrlMode == 0) 
+	if (part.iCtrlMode == 0) 
 		{fprintf(stderr,"ControlMode interface already closed, unable to reset compensation offset.\n");    return;}
-	if (iTqs == 0)
+	if (part.iTqs == 0)
 		{fprintf(stderr,"TorqueControl interface already closed, unable to reset compensation offset.\n");  return;}
-	if (iImp == 0)
+	if (part.iImp == 0)
 		{fprintf(stderr,"Impedance interface already closed, unable to reset compensation offset.\n");      return;}
 
-	//set to zero all the offsets if the module is closing
-	if(releasing)
+	//the control modes are the ones cached by the monitor, no call is made to the part
+	if (!releasing)
+		modeMonitor->getModes(&part);
+
+	int n = ctrlJnt<part.nAxes ? ctrlJnt : part.nAxes;
+
+	//the feedforward term of each compensated joint
+	Vector ff(n);
+	for(int i=0;i<n;i++)
 	{
-		for(int i=0;i<ctrlJnt;i++)
-		{
-			iImp->setImpedanceOffset(i,0.0);
-			iTqs->setRefTorque(i,0.0);
-		}
+		if (releasing)
+			ff[i] = 0.0;
+		else if (gravity_mode == GRAVITY_COMPENSATION_ON && i<(int)G.size())
+			ff[i] = ampli[i]*G[i]+torque_offset[i];
+		else
+			ff[i] = torque_offset[i];
+	}
+
+	//when all the joints of the part are compensated, the torque references are sent
+	//in one call, also to the joints not in torque mode, which get the reference they
+	//will need when switched to torque mode; otherwise the references of the other
+	//joints belong to someone else, and only the compensated joints in torque mode
+	//are commanded one by one
+	if (n==part.nAxes)
+	{
+		if (n>0)
+			part.iTqs->setRefTorques(ff.data());
+	}
+	else
+	{
+		for(int i=0;i<n;i++)
+			if (releasing || part.modes[i]==VOCAB_CM_TORQUE)
+				part.iTqs->setRefTorque(i,ff[i]);
+	}
+
+	//when releasing, the offsets are reset whatever the control mode
+	if (releasing)
+	{
+		for(int i=0;i<n;i++)
+			part.iImp->setImpedanceOffset(i,0.0);
 		return;
 	}
 
-	//set the appropriate feedforward term (normal operation)
-	for(int i=0;i<ctrlJnt;i++)
+	//the impedance offsets have no whole part call, they are sent only if they changed
+	for(int i=0;i<n;i++)
 	{
-		int ctrl_mode=0;
-		iCtrlMode->getControlMode(i,&ctrl_mode);
+		int ctrl_mode = part.modes[i];
 		switch(ctrl_mode)
 		{
 			//for all this control modes do nothing
@@ -523,47 +637,36 @@ void gravityCompensatorThread::feedFwdGravityControl(string s_part, IControlMode
 			case VOCAB_CM_IDLE:
 			case VOCAB_CM_POSITION:
 			case VOCAB_CM_VELOCITY:
-            case VOCAB_CM_UNKNOWN:
-				break;
-
+			case VOCAB_CM_UNKNOWN:
 			case VOCAB_CM_TORQUE:	
-				if(gravity_mode == GRAVITY_COMPENSATION_ON)
-				{
-					iTqs->setRefTorque(i,ampli[i]*G[i]+torque_offset[i]);
-				}
-				else
-				{
-					iTqs->setRefTorque(i,torque_offset[i]);
-				}
+				part.offsetSent[i] = false;
 				break;
+
 			case VOCAB_CM_IMPEDANCE_POS:
 			case VOCAB_CM_IMPEDANCE_VEL:
-				if(gravity_mode == GRAVITY_COMPENSATION_ON)
-				{
-					//fprintf(stderr,"compensating gravity\n");
-					double off = ampli[i]*G[i]+torque_offset[i];
-					iImp->setImpedanceOffset(i,off);
-					//iImp->getImpedance(i,&k,&d,&o);
-					//iImp->setImpedance(i,k,d,ampli[i]*G[i]+torque_offset[i]);
-				}
-				else
+				if (!part.offsetSent[i] || ctrl_mode!=part.lastModes[i] || 
+					fabs(ff[i]-part.impOffsets[i])>IMPEDANCE_OFFSET_TOLERANCE)
 				{
-					//iImp->getImpedance(i,&k,&d,&o);
-					iImp->setImpedanceOffset(i,torque_offset[i]);
+					part.iImp->setImpedanceOffset(i,ff[i]);
+					part.impOffsets[i] = ff[i];
+					part.offsetSent[i] = true;
 				}
 				break;
 			default:
-				if (s_part=="torso" && i==3)
+				part.offsetSent[i] = false;
+				if (part.name=="torso" && i==3)
 				{
 					// do nothing, because joint 3 of the torso is only virtual
 				}
-				else					
+				else if (ctrl_mode!=part.lastModes[i])
 				{
-					fprintf(stderr,"Unknown control mode (part: %s jnt:%d).\n",s_part.c_str(), i);
+					fprintf(stderr,"Unknown control mode (part: %s jnt:%d).\n",part.name.c_str(), i);
 				}
 				break;
 		}
 	}
+
+	part.lastModes = part.modes;
 }
 
 void gravityCompensatorThread::run()
@@ -622,7 +725,7 @@ void gravityCompensatorThread::run()
 
 		if (iCtrlMode_arm_left)  
 		{
-			feedFwdGravityControl("left_arm", iCtrlMode_arm_left,iTqs_arm_left,iImp_arm_left,torques_LA,ampli_larm);
+			feedFwdGravityControl(cmd_arm_left,torques_LA,ampli_larm);
 			if (left_arm_torques->getOutputCount()>0)
             {
                 left_arm_torques->prepare()  =  torques_LA;
@@ -631,7 +734,7 @@ void gravityCompensatorThread::run()
 		}
 		if (iCtrlMode_arm_right)
 		{
-			feedFwdGravityControl("right_arm", iCtrlMode_arm_right,iTqs_arm_right,iImp_arm_right,torques_RA,ampli_rarm);
+			feedFwdGravityControl(cmd_arm_right,torques_RA,ampli_rarm);
 			if (right_arm_torques->getOutputCount()>0)
             {
                 right_arm_torques->prepare() =  torques_RA;
@@ -640,7 +743,7 @@ void gravityCompensatorThread::run()
 		}
 		if (iCtrlMode_torso)  
 		{
-			feedFwdGravityControl("torso", iCtrlMode_torso,iTqs_torso,iImp_torso,torques_TO,ampli_torso);
+			feedFwdGravityControl(cmd_torso,torques_TO,ampli_torso);
 			if (torso_torques->getOutputCount()>0)
             {
                 torso_torques->prepare()  =  torques_TO;
@@ -649,7 +752,7 @@ void gravityCompensatorThread::run()
 		}
 		if (iCtrlMode_leg_left)	
 		{
-			feedFwdGravityControl("left_leg", iCtrlMode_leg_left,iTqs_leg_left,iImp_leg_left,torques_LL,ampli_lleg);
+			feedFwdGravityControl(cmd_leg_left,torques_LL,ampli_lleg);
 			if (left_leg_torques->getOutputCount()>0)
             {
                 left_leg_torques->prepare() =  torques_LL;
@@ -658,7 +761,7 @@ void gravityCompensatorThread::run()
 		}
 		if (iCtrlMode_leg_right)
 		{
-			feedFwdGravityControl("right_leg", iCtrlMode_leg_right,iTqs_leg_right,iImp_leg_right,torques_RL,ampli_rleg);
+			feedFwdGravityControl(cmd_leg_right,torques_RL,ampli_rleg);
 			if (right_leg_torques->getOutputCount()>0)
             {
                 right_leg_torques->prepare()  =  torques_RL;
@@ -718,31 +821,38 @@ void gravityCompensatorThread::threadRelease()
 	if (iCtrlMode_arm_left)
 	{
 		fprintf(stderr,"Setting gravity compensation offset to zero, left arm\n");
-		feedFwdGravityControl("left_arm",iCtrlMode_arm_left,iTqs_arm_left,iImp_arm_left,Z,ampli_larm,true);
+		feedFwdGravityControl(cmd_arm_left,Z,ampli_larm,true);
 	}
 	if (iCtrlMode_arm_right)	
 	{
 		fprintf(stderr,"Setting gravity compensation offset to zero, right arm\n");
-		feedFwdGravityControl("right_arm",iCtrlMode_arm_right,iTqs_arm_right,iImp_arm_right,Z,ampli_rarm,true);
+		feedFwdGravityControl(cmd_arm_right,Z,ampli_rarm,true);
 	}
 	if (iCtrlMode_leg_left)	 
 	{
 		fprintf(stderr,"Setting gravity compensation offset to zero, left leg\n");
-		feedFwdGravityControl("left_leg", iCtrlMode_leg_left,iTqs_leg_left,iImp_leg_left,Z,ampli_lleg,true);
+		feedFwdGravityControl(cmd_leg_left,Z,ampli_lleg,true);
 	}
 	if (iCtrlMode_leg_right)
 	{
 		fprintf(stderr,"Setting gravity compensation offset to zero, right leg\n");
-		feedFwdGravityControl("right_leg",iCtrlMode_leg_right,iTqs_leg_right,iImp_leg_right,Z,ampli_rleg,true);
+		feedFwdGravityControl(cmd_leg_right,Z,ampli_rleg,true);
 	}
     if (iCtrlMode_torso)
 	{
 		fprintf(stderr,"Setting gravity compensation offset to zero, torso\n");
-		feedFwdGravityControl("torso",iCtrlMode_torso,iTqs_torso,iImp_torso,Z,ampli_torso,true);
+		feedFwdGravityControl(cmd_torso,Z,ampli_torso,true);
 	}
 
 	Time::delay(0.5);
 
+	if (modeMonitor)
+	{
+		modeMonitor->stop();
+		delete modeMonitor;
+		modeMonitor = 0;
+	}
+
 /*	left_arm_torques->interrupt();
     right_arm_torques->interrupt();
     left_leg_torques->interrupt();
@@ -25,12 +25,15 @@
 #include <yarp/os/Network.h>
 #include <yarp/os/RateThread.h>
 #include <yarp/os/Stamp.h>
+#include <yarp/os/Semaphore.h>
 #include <yarp/sig/Vector.h>
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <iCub/ctrl/adaptWinPolyEstimator.h>
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
+#include <string>
+#include <vector>
 
 using namespace yarp::os;
 using namespace yarp::sig;
@@ -44,6 +47,43 @@ enum thread_status_enum {STATUS_OK=0, STATUS_DISCONNECTED};
 enum{GRAVITY_COMPENSATION_OFF = 0, GRAVITY_COMPENSATION_ON = 1};
 enum{TORQUE_INTERFACE = 0, IMPEDANCE_POSITION = 1, IMPEDANCE_VELOCITY = 2};
 
+// the impedance offsets are sent again only if they change more than this [Nm]
+#define IMPEDANCE_OFFSET_TOLERANCE 1e-3
+
+// the interfaces of a part and the state of the commands sent to it
+struct partCommand
+{
+	std::string        name;
+	IControlMode      *iCtrlMode;
+	ITorqueControl    *iTqs;
+	IImpedanceControl *iImp;
+	int                nAxes;
+	std::vector<int>   modes;        // control modes of all the joints, as cached by controlModeMonitor
+	std::vector<int>   lastModes;    // control modes used by the previous command
+	Vector             impOffsets;   // impedance offsets last sent
+	std::vector<bool>  offsetSent;   // true if impOffsets[i] is the offset currently set
+
+	partCommand();
+	void init(const std::string &_name, IControlMode *_iCtrlMode, ITorqueControl *_iTqs, IImpedanceControl *_iImp);
+};
+
+// reads the control modes of all the joints of the parts, one call per part,
+// so that the compensation loop never waits for them
+class controlModeMonitor: public yarp::os::RateThread
+{
+private:
+	yarp::os::Semaphore mutex;
+	std::vector<partCommand*> parts;
+	std::vector<std::vector<int> > modes;
+
+public:
+	controlModeMonitor(int _rate);
+	void addPart(partCommand *part);
+	// copy the last modes read into part->modes
+	void getModes(partCommand *part);
+	void run();
+};
+
 class gravityCompensatorThread: public yarp::os::RateThread
 {
 private:
@@ -131,6 +171,9 @@ private:
 	Vector torques_LA,torques_RA,torques_LL,torques_RL, torques_TO;
 	Vector ampli_larm, ampli_rarm, ampli_lleg, ampli_rleg, ampli_torso;
 	bool isCalibrated;
+
+	partCommand cmd_arm_left, cmd_arm_right, cmd_torso, cmd_leg_left, cmd_leg_right;
+	controlModeMonitor *modeMonitor;
 	
     Vector evalVelUp(const Vector &x);
 	Vector evalVelLow(const Vector &x);
@@ -146,14 +189,14 @@ public:
 	
 	int gravity_mode;
 
-    gravityCompensatorThread(int _rate, PolyDriver *_ddLA, PolyDriver *_ddRA, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddRL, PolyDriver *_ddT, version_tag icub_type);
+    gravityCompensatorThread(int _rate, PolyDriver *_ddLA, PolyDriver *_ddRA, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddRL, PolyDriver *_ddT, version_tag icub_type, int _ctrlModeRate=100);
 
 	void setZeroJntAngVelAcc();
 	bool readAndUpdate(bool waitMeasure=false);
 	bool getLowerEncodersSpeedAndAcceleration();
 	bool getUpperEncodersSpeedAndAcceleration();
     bool threadInit();
-	void feedFwdGravityControl(std::string s_part, IControlMode *iCtrlMode, ITorqueControl *iTqs, IImpedanceControl *iImp,const Vector &G, const Vector &ampli, bool releasing=false);
+	void feedFwdGravityControl(partCommand &part, const Vector &G, const Vector &ampli, bool releasing=false);
     void run();
     void threadRelease();
 	void closePort(Contactable *_port);
@@ -34,6 +34,12 @@ http://wiki.icub.org/wiki/Force_Control
 --no_legs
 - This option disables the gravity compensation for the legs joints.
 
+--ctrl_mode_rate \e r
+- The control modes of the joints are read by a separate thread every
+  \e r ms (default \e 100ms), so that the compensation loop does not
+  wait for them: the torque references are sent to each part in a single
+  call and the impedance offsets only when they change.
+
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -207,6 +213,11 @@ public:
             rate = rf.find("rate").asInt();
         else rate = 20;
 
+        int ctrl_mode_rate;
+        if (rf.check("ctrl_mode_rate"))
+            ctrl_mode_rate = rf.find("ctrl_mode_rate").asInt();
+        else ctrl_mode_rate = 100;
+
         //-----------------GET THE ROBOT NAME-------------------//
         string robot_name;
         if (rf.check("robot"))
@@ -316,7 +327,7 @@ public:
 
         //--------------------------THREAD--------------------------
 
-        g_comp = new gravityCompensatorThread(rate, dd_left_arm, dd_right_arm, dd_head, dd_left_leg, dd_right_leg, dd_torso, icub_type);
+        g_comp = new gravityCompensatorThread(rate, dd_left_arm, dd_right_arm, dd_head, dd_left_leg, dd_right_leg, dd_torso, icub_type, ctrl_mode_rate);
         fprintf(stderr,"ft thread istantiated...\n");
         g_comp->start();
         fprintf(stderr,"thread started\n");
@@ -433,6 +444,7 @@ int main(int argc, char * argv[])
         cout << "\t--from       from: the name of the file.ini to be used for calibration"                                        << endl;
         cout << "\t--rate       rate: the period used by the module. default 100ms (not less than 15ms)"                          << endl;
         cout << "\t--no_legs    this option disables the gravity compensation for the legs joints"                                << endl;
+        cout << "\t--ctrl_mode_rate rate: the period used to read the control modes of the joints. default 100ms"                    << endl;
         cout << "\t--headV2     use the model of the headV2" << endl;  
         cout << "\t--no_left_arm    disables the left arm" << endl;
         cout << "\t--no_right_arm   disabled the right arm" << endl;
@@ -93,6 +93,8 @@ protected:
     double q_stamp;
     double Ts;
 
+    syncStats stats;
+
     Matrix lim;
     Vector q0deg,qddeg,qdeg,vdeg;
     Vector v,vNeck,vEyes;
@@ -53,6 +53,7 @@ protected:
     Stamp txInfo_ang;
 
     unsigned int period;
+    syncStats    stats;
 
     Matrix eyeCAbsFrame;
     Matrix invEyeCAbsFrame;
@@ -70,6 +71,7 @@ protected:
     void handleStereoInput();
     void handleAnglesInput();
     void handleAnglesOutput();
+    void getEyesJoints(Vector &qL, Vector &qR);
 
 public:
     Localizer(exchangeData *_commData, const unsigned int _period);
@@ -83,6 +85,9 @@ public:
     bool   projectPoint(const string &type, const double u, const double v,
                         const Vector &plane, Vector &x);
     bool   triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x);
+    bool   projectPoints(const string &type, const Matrix &x, Matrix &px);
+    bool   projectPoints(const string &type, const Matrix &px, const Vector &z, Matrix &x);
+    bool   triangulatePoints(const Matrix &pxl, const Matrix &pxr, Matrix &x);
     Vector getAbsAngles(const Vector &x);
     Vector get3DPoint(const string &type, const Vector &ang);
     bool   getIntrinsicsMatrix(const string &type, Matrix &M);
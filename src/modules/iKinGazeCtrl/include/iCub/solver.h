@@ -96,8 +96,9 @@ protected:
     Matrix eyesJ;
     Vector gyro;
     Vector counterRotGain;
+    syncStats stats;
 
-    Vector getEyesCounterVelocity(const Matrix &eyesJ, const Vector &fp);
+    Vector getEyesCounterVelocity(const Matrix &eyesJ, const Vector &fp, const Vector &vHead);
 
 public:
     EyePinvRefGen(PolyDriver *_drvTorso, PolyDriver *_drvHead, exchangeData *_commData,
@@ -156,6 +157,8 @@ protected:
     double neckAngleUserTolerance;
     double Ts;
 
+    syncStats stats;
+
     Vector fbTorso;
     Vector fbHead;
     Vector neckPos;
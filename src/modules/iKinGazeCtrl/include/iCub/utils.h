@@ -83,27 +83,56 @@ public:
 };
 
 
-// This class handles the data exchange among components
+// This structure collects the whole state shared among
+// components. It is made of plain arrays so that it can be
+// copied around as a whole without any memory allocation.
+struct GazeState
+{
+    double xd[3];
+    double qd[6];
+    double x[3];
+    double x_stamp;
+    double q[6];
+    double torso[3];
+    double v[6];
+    double counterv[3];
+    double fpFrame[16];     // row-major
+};
+
+
+// This class handles the data exchange among components.
+//
+// Each component publishes its contribution to the state as
+// a whole once per cycle (begin_update()/end_update()) and
+// grabs a coherent snapshot of it in one go (get_state()).
+// The state is kept within a ring of slots managed as a
+// seqlock: writers are serialized and fill the slot following
+// the latest published one, whereas readers copy the latest
+// slot with no lock held, retrying only in the unlikely case
+// a writer recycled it meanwhile. The mutex guards just the
+// slots indexes and sequence numbers: it is held for constant
+// time and serves as memory barrier.
 class exchangeData
 {
 protected:
-    Mutex  mutex[8];
+    GazeState    slots[4];
+    unsigned int seq[4];
+    int          latest;
+    GazeState    pending;
+    Mutex        mutex;
+    Mutex        mutexWriter;
 
-    Vector xd,qd;
-    Vector x,q,torso;
-    Vector v,counterv;
-    Matrix S;
     bool   isCtrlActive;
     bool   canCtrlBeDisabled;
     bool   saccadeUnderway;
     double minAllowedVergence;
-    double x_stamp;
 
 public:
     exchangeData();
 
-    void    resize_v(const int sz, const double val);
-    void    resize_counterv(const int sz, const double val);
+    void       get_state(GazeState &state);
+    GazeState &begin_update();
+    void       end_update();
 
     void    set_xd(const Vector &_xd);
     void    set_qd(const Vector &_qd);
@@ -138,12 +167,71 @@ public:
     double         eyeTiltMax;
     double         head_version;
     bool           tweakOverwrite;
+    bool           syncStatsOn;
     ResourceFinder rf_cameras;
     ResourceFinder rf_tweak;
     string         tweakFile;
 };
 
 
+// This class measures the time spent per cycle by
+// a component in exchanging data with the others and
+// reports the statistics periodically.
+class syncStats
+{
+protected:
+    string name;
+    bool   enabled;
+    double t0;
+    double tCycle;
+    double tSum;
+    double tMax;
+    double tReport;
+    int    nCycles;
+
+public:
+    syncStats(const string &_name);
+
+    void setEnabled(const bool sw) { enabled=sw; }
+    void tic();
+    void toc();
+    void endCycle();
+};
+
+
+// helpers to move data between vectors and the state
+inline Vector stateToVector(const double *src, const int n)
+{
+    Vector dst(n);
+    for (int i=0; i<n; i++)
+        dst[i]=src[i];
+    return dst;
+}
+
+inline void vectorToState(const Vector &src, double *dst, const int n)
+{
+    int len=std::min(n,(int)src.length());
+    for (int i=0; i<len; i++)
+        dst[i]=src[i];
+}
+
+inline Matrix stateToMatrix(const double *src)
+{
+    Matrix dst(4,4);
+    for (int r=0; r<4; r++)
+        for (int c=0; c<4; c++)
+            dst(r,c)=src[(r<<2)+c];
+    return dst;
+}
+
+inline void matrixToState(const Matrix &src, double *dst)
+{
+    for (int r=0; r<4; r++)
+        for (int c=0; c<4; c++)
+            dst[(r<<2)+c]=src(r,c);
+}
+
+
 // this class defines gaze components such as
 // controller, localizer, solver ...
 class GazeComponent
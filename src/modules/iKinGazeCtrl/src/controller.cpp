@@ -29,7 +29,8 @@ Controller::Controller(PolyDriver *_drvTorso, PolyDriver *_drvHead, exchangeData
                        RateThread(_period), drvTorso(_drvTorso),           drvHead(_drvHead),
                        commData(_commData), neckPosCtrlOn(_neckPosCtrlOn), neckTime(_neckTime),
                        eyesTime(_eyesTime), minAbsVel(_minAbsVel),         period(_period),
-                       Ts(_period/1000.0),  printAccTime(0.0)
+                       Ts(_period/1000.0),  printAccTime(0.0),
+                       stats("Controller")
 {
     Robotable=(drvHead!=NULL);
 
@@ -337,6 +338,7 @@ bool Controller::threadInit()
     port_x.open((commData->localStemName+"/x:o").c_str());
     port_q.open((commData->localStemName+"/q:o").c_str());
     port_event.open((commData->localStemName+"/events:o").c_str());
+    stats.setEnabled(commData->syncStatsOn);
 
     printf("Starting Controller at %d ms\n",period);
     q_stamp=Time::now();
@@ -472,11 +474,17 @@ void Controller::run()
     }
     mutexCtrl.unlock();
     
-    // get data
-    double x_stamp;
-    Vector xd=commData->get_xd();
-    Vector x=commData->get_x(x_stamp);
-    Vector new_qd=commData->get_qd();
+    // get data: a coherent snapshot in one go
+    GazeState state;
+    stats.tic();
+    commData->get_state(state);
+    stats.toc();
+
+    double x_stamp=state.x_stamp;
+    Vector xd=stateToVector(state.xd,3);
+    Vector x=stateToVector(state.x,3);
+    Vector new_qd=stateToVector(state.qd,6);
+    Vector counterv=stateToVector(state.counterv,3);
 
     // read feedbacks
     q_stamp=Time::now();
@@ -577,10 +585,10 @@ void Controller::run()
         if (unplugCtrlEyes)
         {
             if (Time::now()-saccadeStartTime>=Ts)
-                vEyes=commData->get_counterv();
+                vEyes=counterv;
         }
         else
-            vEyes=mjCtrlEyes->computeCmd(eyesTime,qdEyes-fbEyes)+commData->get_counterv();
+            vEyes=mjCtrlEyes->computeCmd(eyesTime,qdEyes-fbEyes)+counterv;
     }
     else
     {
@@ -684,9 +692,17 @@ void Controller::run()
 
     // update joints angles
     fbHead=IntState->integrate(v);
-    commData->set_q(fbHead);
-    commData->set_torso(fbTorso);
-    commData->set_v(v);
+
+    // publish our contribution as a whole
+    stats.tic();
+    GazeState &update=commData->begin_update();
+    vectorToState(fbHead,update.q,6);
+    vectorToState(fbTorso,update.torso,3);
+    vectorToState(v,update.v,6);
+    commData->end_update();
+    stats.toc();
+
+    stats.endCycle();
 }
 
 
@@ -27,7 +27,8 @@
 
 /************************************************************************/
 Localizer::Localizer(exchangeData *_commData, const unsigned int _period) :
-                     RateThread(_period), commData(_commData), period(_period)
+                     RateThread(_period), commData(_commData), period(_period),
+                     stats("Localizer")
 {
     iCubHeadCenter eyeC(commData->head_version>1.0?"right_v2":"right");
     eyeL=new iCubEye(commData->head_version>1.0?"left_v2":"left");
@@ -132,6 +133,7 @@ bool Localizer::threadInit()
     port_stereo.open((commData->localStemName+"/stereo:i").c_str());
     port_anglesIn.open((commData->localStemName+"/angles:i").c_str());
     port_anglesOut.open((commData->localStemName+"/angles:o").c_str());
+    stats.setEnabled(commData->syncStatsOn);
 
     printf("Starting Localizer at %d ms\n",period);
     return true;
@@ -204,11 +206,15 @@ Vector Localizer::get3DPoint(const string &type, const Vector &ang)
     double ele=ang[1];
     double ver=ang[2];
 
+    // a coherent snapshot of joints and fixation point frame
+    GazeState state;
+    commData->get_state(state);
+
     Vector q(8,0.0);
     if (type=="rel")
     {
-        Vector torso=commData->get_torso();
-        Vector head=commData->get_q();
+        Vector torso=stateToVector(state.torso,3);
+        Vector head=stateToVector(state.q,6);
 
         q[0]=torso[0];
         q[1]=torso[1];
@@ -254,7 +260,7 @@ Vector Localizer::get3DPoint(const string &type, const Vector &ang)
     Vector fph, xd;
     if (type=="rel")
     {
-        Matrix frame=commData->get_fpFrame();
+        Matrix frame=stateToMatrix(state.fpFrame);
         fph=SE3inv(frame)*fp;       // get fp wrt relative head-centered frame
         xd=frame*(R*fph);           // apply rotation and retrieve fp wrt root frame
     }
@@ -285,8 +291,10 @@ bool Localizer::projectPoint(const string &type, const Vector &x, Vector &px)
 
     if (Prj)
     {
-        Vector torso=commData->get_torso();
-        Vector head=commData->get_q();
+        GazeState state;
+        commData->get_state(state);
+        Vector torso=stateToVector(state.torso,3);
+        Vector head=stateToVector(state.q,6);
 
         Vector q(8);
         q[0]=torso[0];
@@ -337,8 +345,10 @@ bool Localizer::projectPoint(const string &type, const double u, const double v,
 
     if (invPrj)
     {
-        Vector torso=commData->get_torso();
-        Vector head=commData->get_q();
+        GazeState state;
+        commData->get_state(state);
+        Vector torso=stateToVector(state.torso,3);
+        Vector head=stateToVector(state.q,6);
 
         Vector q(8);
         q[0]=torso[0];
@@ -441,8 +451,10 @@ bool Localizer::triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x
 
     if (PrjL && PrjR)
     {
-        Vector torso=commData->get_torso();
-        Vector head=commData->get_q();
+        GazeState state;
+        commData->get_state(state);
+        Vector torso=stateToVector(state.torso,3);
+        Vector head=stateToVector(state.q,6);
 
         Vector qL(8);
         qL[0]=torso[0];
@@ -496,6 +508,240 @@ bool Localizer::triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x
 }
 
 
+/************************************************************************/
+void Localizer::getEyesJoints(Vector &qL, Vector &qR)
+{
+    GazeState state;
+    commData->get_state(state);
+
+    qL.resize(8);
+    qL[0]=state.torso[0];
+    qL[1]=state.torso[1];
+    qL[2]=state.torso[2];
+    qL[3]=state.q[0];
+    qL[4]=state.q[1];
+    qL[5]=state.q[2];
+    qL[6]=state.q[3];
+    qL[7]=state.q[4]+state.q[5]/2.0;
+
+    qR=qL;
+    qR[7]-=state.q[5];
+}
+
+
+/************************************************************************/
+bool Localizer::projectPoints(const string &type, const Matrix &x, Matrix &px)
+{
+    if (x.cols()<3)
+    {
+        printf("Not enough values given for the points!\n");
+        return false;
+    }
+
+    bool isLeft=(type=="left");
+
+    Matrix  *Prj=(isLeft?PrjL:PrjR);
+    iCubEye *eye=(isLeft?eyeL:eyeR);
+
+    if (Prj)
+    {
+        Vector qL,qR;
+        getEyesJoints(qL,qR);
+
+        mutex.lock();
+        Matrix H=SE3inv(eye->getH(isLeft?qL:qR));
+        mutex.unlock();
+
+        // fuse the camera frame and the projection
+        // once for all the points
+        Matrix P=*Prj*H;
+        const double p00=P(0,0), p01=P(0,1), p02=P(0,2), p03=P(0,3);
+        const double p10=P(1,0), p11=P(1,1), p12=P(1,2), p13=P(1,3);
+        const double p20=P(2,0), p21=P(2,1), p22=P(2,2), p23=P(2,3);
+
+        int n=x.rows();
+        px.resize(n,2);
+        for (int i=0; i<n; i++)
+        {
+            const double *xi=x[i];
+            double *pxi=px[i];
+
+            double u=p00*xi[0]+p01*xi[1]+p02*xi[2]+p03;
+            double v=p10*xi[0]+p11*xi[1]+p12*xi[2]+p13;
+            double w=p20*xi[0]+p21*xi[1]+p22*xi[2]+p23;
+
+            pxi[0]=u/w;
+            pxi[1]=v/w;
+        }
+
+        return true;
+    }
+    else
+    {
+        printf("Unspecified projection matrix for %s camera!\n",type.c_str());
+        return false;
+    }
+}
+
+
+/************************************************************************/
+bool Localizer::projectPoints(const string &type, const Matrix &px, const Vector &z,
+                              Matrix &x)
+{
+    if ((px.cols()<2) || ((int)z.length()!=px.rows()))
+    {
+        printf("Not enough values given for the pixels!\n");
+        return false;
+    }
+
+    bool isLeft=(type=="left");
+
+    Matrix  *invPrj=(isLeft?invPrjL:invPrjR);
+    iCubEye *eye=(isLeft?eyeL:eyeR);
+
+    if (invPrj)
+    {
+        Vector qL,qR;
+        getEyesJoints(qL,qR);
+
+        mutex.lock();
+        Matrix H=eye->getH(isLeft?qL:qR);
+        mutex.unlock();
+
+        // x=R*invPrj*[z*u z*v z]'+t, where the camera frame
+        // is fused with the inverse projection once for all
+        Matrix B=H.submatrix(0,2,0,2)*invPrj->submatrix(0,2,0,2);
+        const double b00=B(0,0), b01=B(0,1), b02=B(0,2), t0=H(0,3);
+        const double b10=B(1,0), b11=B(1,1), b12=B(1,2), t1=H(1,3);
+        const double b20=B(2,0), b21=B(2,1), b22=B(2,2), t2=H(2,3);
+
+        int n=px.rows();
+        x.resize(n,3);
+        for (int i=0; i<n; i++)
+        {
+            const double *pxi=px[i];
+            double *xi=x[i];
+            double zi=z[i];
+
+            xi[0]=zi*(b00*pxi[0]+b01*pxi[1]+b02)+t0;
+            xi[1]=zi*(b10*pxi[0]+b11*pxi[1]+b12)+t1;
+            xi[2]=zi*(b20*pxi[0]+b21*pxi[1]+b22)+t2;
+        }
+
+        return true;
+    }
+    else
+    {
+        printf("Unspecified projection matrix for %s camera!\n",type.c_str());
+        return false;
+    }
+}
+
+
+/************************************************************************/
+bool Localizer::triangulatePoints(const Matrix &pxl, const Matrix &pxr, Matrix &x)
+{
+    if ((pxl.cols()<2) || (pxr.cols()<2) || (pxl.rows()!=pxr.rows()))
+    {
+        printf("Not enough values given for the pixels!\n");
+        return false;
+    }
+
+    if (PrjL && PrjR)
+    {
+        Vector qL,qR;
+        getEyesJoints(qL,qR);
+
+        mutex.lock();
+        Matrix HL=SE3inv(eyeL->getH(qL));
+        Matrix HR=SE3inv(eyeR->getH(qR));
+        mutex.unlock();
+
+        // as in triangulatePoint(), the rows of A=(Prj-tmp)*H are
+        // given by (Prj*H).row(i)-px[i]*H.row(2), hence we can
+        // fuse the matrices once for all the points
+        Matrix PL=*PrjL*HL;
+        Matrix PR=*PrjR*HR;
+
+        int n=pxl.rows();
+        x.resize(n,3);
+        for (int i=0; i<n; i++)
+        {
+            const double *pl=pxl[i];
+            const double *pr=pxr[i];
+
+            double A[4][4];
+            for (int c=0; c<4; c++)
+            {
+                A[0][c]=PL(0,c)-pl[0]*HL(2,c);
+                A[1][c]=PL(1,c)-pl[1]*HL(2,c);
+                A[2][c]=PR(0,c)-pr[0]*HR(2,c);
+                A[3][c]=PR(1,c)-pr[1]*HR(2,c);
+            }
+
+            // solve the least-squares problem A*x=b
+            // through the normal equations N*x=r
+            double N[3][3],r[3];
+            for (int j=0; j<3; j++)
+            {
+                r[j]=0.0;
+                for (int k=0; k<3; k++)
+                    N[j][k]=0.0;
+
+                for (int m=0; m<4; m++)
+                {
+                    r[j]-=A[m][j]*A[m][3];
+                    for (int k=0; k<3; k++)
+                        N[j][k]+=A[m][j]*A[m][k];
+                }
+            }
+
+            double c00=N[1][1]*N[2][2]-N[1][2]*N[2][1];
+            double c01=N[1][2]*N[2][0]-N[1][0]*N[2][2];
+            double c02=N[1][0]*N[2][1]-N[1][1]*N[2][0];
+            double det=N[0][0]*c00+N[0][1]*c01+N[0][2]*c02;
+
+            double *xi=x[i];
+            if (fabs(det)>1e-12*(N[0][0]*N[1][1]*N[2][2]))
+            {
+                double c11=N[0][0]*N[2][2]-N[0][2]*N[2][0];
+                double c12=N[0][1]*N[2][0]-N[0][0]*N[2][1];
+                double c22=N[0][0]*N[1][1]-N[0][1]*N[1][0];
+
+                // N is symmetric, and so is its adjugate
+                xi[0]=(c00*r[0]+c01*r[1]+c02*r[2])/det;
+                xi[1]=(c01*r[0]+c11*r[1]+c12*r[2])/det;
+                xi[2]=(c02*r[0]+c12*r[1]+c22*r[2])/det;
+            }
+            else
+            {
+                // ill-conditioned: resort to the pseudoinverse
+                Matrix _A(4,3);
+                Vector b(4);
+                for (int m=0; m<4; m++)
+                {
+                    for (int k=0; k<3; k++)
+                        _A(m,k)=A[m][k];
+                    b[m]=-A[m][3];
+                }
+
+                Vector _x=pinv(_A)*b;
+                xi[0]=_x[0];
+                xi[1]=_x[1];
+                xi[2]=_x[2];
+            }
+        }
+
+        return true;
+    }
+    else
+    {
+        printf("Unspecified projection matrix for at least one camera!\n");
+        return false;
+    }
+}
+
+
 /************************************************************************/
 void Localizer::handleMonocularInput()
 {
@@ -621,7 +867,9 @@ void Localizer::handleAnglesInput()
 void Localizer::handleAnglesOutput()
 {
     double x_stamp;
+    stats.tic();
     Vector x=commData->get_x(x_stamp);
+    stats.toc();
     txInfo_ang.update(x_stamp);
 
     if (port_anglesOut.getOutputCount()>0)
@@ -706,6 +954,7 @@ void Localizer::run()
     handleStereoInput();
     handleAnglesInput();
     handleAnglesOutput();
+    stats.endCycle();
 }
 
 
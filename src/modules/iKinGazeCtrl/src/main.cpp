@@ -201,6 +201,11 @@ Factors</a>.
   retrieved from file will be overwritten by those values
   contained in the tweak file. The \e switch is "on" by default.
  
+--sync_stats
+- When this option is specified, each component reports
+  periodically the time spent per cycle in exchanging data with
+  the others.
+ 
 \section portsa_sec Ports Accessed
  
 The ports the module is connected to: e.g. 
@@ -389,6 +394,16 @@ following ports:
     - [get] [3D] [ang] (<type> <azi> <ele> <ver>): transforms
       angular coordinates into cartesian coordinates. The
       options <type> can be ["abs"|"rel"].
+    - [get] [2Ds] (<type> <x1> <y1> <z1> ... <xN> <yN> <zN>):
+      batch version of [get] [2D]; all the points are projected
+      against the same kinematic snapshot and the pixels are
+      returned within one list as (<u1> <v1> ... <uN> <vN>).
+    - [get] [3Ds] [mono] (<type> <u1> <v1> <z1> ... <uN> <vN>
+      <zN>): batch version of [get] [3D] [mono]; the points are
+      returned within one list as (<x1> <y1> <z1> ...).
+    - [get] [3Ds] [stereo] (<ul1> <vl1> <ur1> <vr1> ... ): batch
+      version of [get] [3D] [stereo]; the points are returned
+      within one list as (<x1> <y1> <z1> ...).
     - [get] [ang] (<x> <y> <z>): transforms cartesian
       coordinates into absolute angular coordinates.
     - [get] [pid]: returns (enclosed in a list) a property-like
@@ -992,6 +1007,7 @@ public:
         commData.eyeTiltMax=rf.check("eyeTiltMax",Value(1e9)).asDouble();
         commData.head_version=rf.check("headV2")?2.0:1.0;
         commData.tweakOverwrite=(rf.check("tweakOverwrite",Value("on")).asString()=="on");
+        commData.syncStatsOn=rf.check("sync_stats");
 
         // minAbsVel is given in absolute form
         // hence it must be positive
@@ -1402,6 +1418,98 @@ public:
                                 }
                             }
                         }
+                        else if ((type==VOCAB3('2','D','s')) && (command.size()>2))
+                        {
+                            if (Bottle *bOpt=command.get(2).asList())
+                            {
+                                if ((bOpt->size()>1) && ((bOpt->size()-1)%3==0))
+                                {
+                                    string eye=bOpt->get(0).asString().c_str();
+                                    int n=(bOpt->size()-1)/3;
+                                    Matrix x(n,3);
+                                    for (int i=0; i<n; i++)
+                                        for (int j=0; j<3; j++)
+                                            x(i,j)=bOpt->get(1+3*i+j).asDouble();
+
+                                    Matrix px;
+                                    if (loc->projectPoints(eye,x,px))
+                                    {
+                                        reply.addVocab(ack);
+                                        Bottle &bPixels=reply.addList();
+                                        for (int i=0; i<px.rows(); i++)
+                                            for (int j=0; j<px.cols(); j++)
+                                                bPixels.addDouble(px(i,j));
+
+                                        return true;
+                                    }
+                                }
+                            }
+                        }
+                        else if ((type==VOCAB3('3','D','s')) && (command.size()>3))
+                        {
+                            int subType=command.get(2).asVocab();
+                            if (subType==VOCAB4('m','o','n','o'))
+                            {
+                                if (Bottle *bOpt=command.get(3).asList())
+                                {
+                                    if ((bOpt->size()>1) && ((bOpt->size()-1)%3==0))
+                                    {
+                                        string eye=bOpt->get(0).asString().c_str();
+                                        int n=(bOpt->size()-1)/3;
+                                        Matrix px(n,2);
+                                        Vector z(n);
+                                        for (int i=0; i<n; i++)
+                                        {
+                                            px(i,0)=bOpt->get(1+3*i).asDouble();
+                                            px(i,1)=bOpt->get(2+3*i).asDouble();
+                                            z[i]=bOpt->get(3+3*i).asDouble();
+                                        }
+
+                                        Matrix x;
+                                        if (loc->projectPoints(eye,px,z,x))
+                                        {
+                                            reply.addVocab(ack);
+                                            Bottle &bPoints=reply.addList();
+                                            for (int i=0; i<x.rows(); i++)
+                                                for (int j=0; j<x.cols(); j++)
+                                                    bPoints.addDouble(x(i,j));
+
+                                            return true;
+                                        }
+                                    }
+                                }
+                            }
+                            else if (subType==VOCAB4('s','t','e','r'))
+                            {
+                                if (Bottle *bOpt=command.get(3).asList())
+                                {
+                                    if ((bOpt->size()>0) && (bOpt->size()%4==0))
+                                    {
+                                        int n=bOpt->size()/4;
+                                        Matrix pxl(n,2),pxr(n,2);
+                                        for (int i=0; i<n; i++)
+                                        {
+                                            pxl(i,0)=bOpt->get(4*i).asDouble();
+                                            pxl(i,1)=bOpt->get(4*i+1).asDouble();
+                                            pxr(i,0)=bOpt->get(4*i+2).asDouble();
+                                            pxr(i,1)=bOpt->get(4*i+3).asDouble();
+                                        }
+
+                                        Matrix x;
+                                        if (loc->triangulatePoints(pxl,pxr,x))
+                                        {
+                                            reply.addVocab(ack);
+                                            Bottle &bPoints=reply.addList();
+                                            for (int i=0; i<x.rows(); i++)
+                                                for (int j=0; j<x.cols(); j++)
+                                                    bPoints.addDouble(x(i,j));
+
+                                            return true;
+                                        }
+                                    }
+                                }
+                            }
+                        }
                         else if ((type==VOCAB3('a','n','g')) && (command.size()>2))
                         {
                             if (Bottle *bOpt=command.get(2).asList())
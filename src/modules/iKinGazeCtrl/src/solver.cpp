@@ -32,7 +32,7 @@ EyePinvRefGen::EyePinvRefGen(PolyDriver *_drvTorso, PolyDriver *_drvHead,
                              RateThread(_period),     drvTorso(_drvTorso), drvHead(_drvHead),
                              commData(_commData),     ctrl(_ctrl),         eyesBoundVer(-1.0),
                              saccadesOn(_saccadesOn), period(_period),     Ts(_period/1000.0),
-                             counterRotGain(_counterRotGain)
+                             counterRotGain(_counterRotGain), stats("EyePinvRefGen")
 {
     Robotable=(drvHead!=NULL);
 
@@ -266,7 +266,8 @@ void EyePinvRefGen::setCounterRotGain(const Vector &gain)
 
 
 /************************************************************************/
-Vector EyePinvRefGen::getEyesCounterVelocity(const Matrix &eyesJ, const Vector &fp)
+Vector EyePinvRefGen::getEyesCounterVelocity(const Matrix &eyesJ, const Vector &fp,
+                                             const Vector &vHead)
 {
     // ********** implement VOR
     Vector q(imu->getDOF());
@@ -305,7 +306,7 @@ Vector EyePinvRefGen::getEyesCounterVelocity(const Matrix &eyesJ, const Vector &
     HN(2,3)=fp[2]-H(2,3);
 
     chainNeck->setHN(HN);
-    Vector ocr_fprelv=chainNeck->GeoJacobian()*commData->get_v().subVector(0,2);
+    Vector ocr_fprelv=chainNeck->GeoJacobian()*vHead.subVector(0,2);
     ocr_fprelv=ocr_fprelv.subVector(0,2);
     chainNeck->setHN(eye(4,4));
 
@@ -330,6 +331,7 @@ bool EyePinvRefGen::threadInit()
 
     saccadesRxTargets=0;
     saccadesClock=Time::now();
+    stats.setEnabled(commData->syncStatsOn);
 
     return true;
 }
@@ -348,6 +350,12 @@ void EyePinvRefGen::run()
 {
     if (genOn)
     {
+        // get data: a coherent snapshot in one go
+        GazeState state;
+        stats.tic();
+        commData->get_state(state);
+        stats.toc();
+
         double timeStamp;
         if (Robotable)
         {
@@ -359,7 +367,7 @@ void EyePinvRefGen::run()
         }
         else
         {
-            fbHead=commData->get_q();
+            fbHead=stateToVector(state.q,6);
             timeStamp=Time::now();
         }
 
@@ -435,9 +443,13 @@ void EyePinvRefGen::run()
                 // enforce joints bounds
                 ang[2]=std::min(std::max(lim(2,0),ang[2]),lim(2,1));
 
-                commData->set_qd(3,ang[0]);
-                commData->set_qd(4,ang[1]);
-                commData->set_qd(5,ang[2]);
+                stats.tic();
+                GazeState &update=commData->begin_update();
+                update.qd[3]=ang[0];
+                update.qd[4]=ang[1];
+                update.qd[5]=ang[2];
+                commData->end_update();
+                stats.toc();
 
                 Vector vel(3,SACCADES_VEL);
                 ctrl->doSaccade(ang,vel);
@@ -451,6 +463,7 @@ void EyePinvRefGen::run()
         chainEyeL->setAng(nJointsTorso+4,qd[1]+qd[2]/2.0); chainEyeR->setAng(nJointsTorso+4,qd[1]-qd[2]/2.0);
 
         // converge on target
+        Vector counterv(3,0.0);
         if (CartesianHelper::computeFixationPointData(*chainEyeL,*chainEyeR,fp,eyesJ))
         {
             Vector v=EYEPINVREFGEN_GAIN*(pinv(eyesJ)*(xd-fp));
@@ -461,9 +474,9 @@ void EyePinvRefGen::run()
 
             // compensate neck rotation at eyes level
             if ((eyesBoundVer>=0.0) || !CartesianHelper::computeFixationPointData(*chainEyeL,*chainEyeR,fp,eyesJ))
-                commData->set_counterv(zeros(3));
+                counterv=0.0;
             else
-                commData->set_counterv(getEyesCounterVelocity(eyesJ,fp));
+                counterv=getEyesCounterVelocity(eyesJ,fp,stateToVector(state.v,6));
             
             // reset eyes controller and integral upon saccades transition on=>off
             if (saccadeUnderWayOld && !commData->get_isSaccadeUnderway())
@@ -477,25 +490,32 @@ void EyePinvRefGen::run()
             }
 
             // update reference
-            qd=I->integrate(v+commData->get_counterv());
+            qd=I->integrate(v+counterv);
         }
-        else
-            commData->set_counterv(zeros(3));
 
-        // set a new target position
-        commData->set_xd(xd);
-        commData->set_x(fp,timeStamp);
-        commData->set_fpFrame(chainNeck->getH());
+        // set a new target position: publish
+        // our contribution as a whole
+        Matrix fpFrame=chainNeck->getH();
+        stats.tic();
+        GazeState &update=commData->begin_update();
+        vectorToState(counterv,update.counterv,3);
+        vectorToState(xd,update.xd,3);
+        vectorToState(fp,update.x,3);
+        update.x_stamp=timeStamp;
+        matrixToState(fpFrame,update.fpFrame);
         if (!commData->get_isSaccadeUnderway())
         {
-            commData->set_qd(3,qd[0]);
-            commData->set_qd(4,qd[1]);
-            commData->set_qd(5,qd[2]);
+            update.qd[3]=qd[0];
+            update.qd[4]=qd[1];
+            update.qd[5]=qd[2];
         }
+        commData->end_update();
+        stats.toc();
 
         // latch the saccades status
         saccadeUnderWayOld=commData->get_isSaccadeUnderway();
         saccadesRxTargets=port_xd->get_rx();
+        stats.endCycle();
     }
 }
 
@@ -536,7 +556,8 @@ Solver::Solver(PolyDriver *_drvTorso, PolyDriver *_drvHead, exchangeData *_commD
                const unsigned int _period) :
                RateThread(_period), drvTorso(_drvTorso),     drvHead(_drvHead),
                commData(_commData), eyesRefGen(_eyesRefGen), loc(_loc),
-               ctrl(_ctrl),         period(_period),         Ts(_period/1000.0)
+               ctrl(_ctrl),         period(_period),         Ts(_period/1000.0),
+               stats("Solver")
 {
     Robotable=(drvHead!=NULL);
 
@@ -879,14 +900,17 @@ bool Solver::threadInit()
     CartesianHelper::computeFixationPointData(*chainEyeL,*chainEyeR,fp,J);
 
     // init commData structure
-    commData->set_xd(fp);
-    commData->set_qd(fbHead);
-    commData->set_x(fp);
-    commData->set_q(fbHead);
-    commData->set_torso(fbTorso);
-    commData->resize_v(fbHead.length(),0.0);
-    commData->resize_counterv(3,0.0);
-    commData->set_fpFrame(chainNeck->getH());
+    GazeState &state=commData->begin_update();
+    vectorToState(fp,state.xd,3);
+    vectorToState(fbHead,state.qd,6);
+    vectorToState(fp,state.x,3);
+    vectorToState(fbHead,state.q,6);
+    vectorToState(fbTorso,state.torso,3);
+    vectorToState(Vector(6,0.0),state.v,6);
+    vectorToState(Vector(3,0.0),state.counterv,3);
+    matrixToState(chainNeck->getH(),state.fpFrame);
+    commData->end_update();
+    stats.setEnabled(commData->syncStatsOn);
 
     port_xd=new xdPort(fp,this);
     port_xd->useCallback();
@@ -921,7 +945,9 @@ void Solver::run()
     Vector xd=port_xd->get_xdDelayed();
 
     // update the target straightaway 
+    stats.tic();
     commData->set_xd(xd);
+    stats.toc();
 
     bool torsoChanged=false;
 
@@ -936,7 +962,11 @@ void Solver::run()
         torsoChanged=norm(fbTorso-fbTorsoOld)>NECKSOLVER_ACTIVATIONANGLE_JOINTS*CTRL_DEG2RAD;        
     }
     else
+    {
+        stats.tic();
         fbHead=commData->get_q();
+        stats.toc();
+    }
 
     bool headChanged=norm(fbHead-fbHeadOld)>NECKSOLVER_ACTIVATIONANGLE_JOINTS*CTRL_DEG2RAD;
 
@@ -995,14 +1025,19 @@ void Solver::run()
         neckPos=invNeck->solve(neckPos,xdUserTol,*pgDir);
 
         // update neck pitch,roll,yaw
-        commData->set_qd(0,neckPos[0]);
-        commData->set_qd(1,neckPos[1]);
-        commData->set_qd(2,neckPos[2]);
+        stats.tic();
+        GazeState &update=commData->begin_update();
+        update.qd[0]=neckPos[0];
+        update.qd[1]=neckPos[1];
+        update.qd[2]=neckPos[2];
+        commData->end_update();
+        stats.toc();
     }
 
     // latch quantities
     fbTorsoOld=fbTorso;
     fbHeadOld=fbHead;
+    stats.endCycle();
 
     mutex.unlock();
 }
@@ -16,19 +16,14 @@
  * Public License for more details
 */
 
+#include <string.h>
 #include <algorithm>
 
 #include <iCub/utils.h>
 #include <iCub/solver.h>
 
-#define MUTEX_XD            0
-#define MUTEX_QD            1
-#define MUTEX_X             2
-#define MUTEX_Q             3
-#define MUTEX_TORSO         4
-#define MUTEX_V             5
-#define MUTEX_COUNTERV      6
-#define MUTEX_FPFRAME       7
+#define EXCHANGEDATA_SLOTS      4
+#define SYNCSTATS_REPORTPERIOD  10.0    // [s]
 
 
 /************************************************************************/
@@ -139,6 +134,15 @@ void xdPort::run()
 /************************************************************************/
 exchangeData::exchangeData()
 {
+    memset(slots,0,sizeof(slots));
+    memset(seq,0,sizeof(seq));
+    memset(&pending,0,sizeof(pending));
+    latest=0;
+
+    // identity fixation point frame
+    for (int i=0; i<EXCHANGEDATA_SLOTS; i++)
+        slots[i].fpFrame[0]=slots[i].fpFrame[5]=slots[i].fpFrame[10]=slots[i].fpFrame[15]=1.0;
+
     isCtrlActive=false;
     canCtrlBeDisabled=true;
     saccadeUnderway=false;
@@ -150,216 +154,280 @@ exchangeData::exchangeData()
     eyeTiltMax=1e9;
     head_version=1.0;
     tweakOverwrite=true;
+    syncStatsOn=false;
     tweakFile="";
 }
 
 
 /************************************************************************/
-void exchangeData::resize_v(const int sz, const double val)
+void exchangeData::get_state(GazeState &state)
 {
-    mutex[MUTEX_V].lock();
-    v.resize(sz,val);
-    mutex[MUTEX_V].unlock();
+    bool coherent;
+    do
+    {
+        mutex.lock();
+        int i=latest;
+        unsigned int s=seq[i];
+        mutex.unlock();
+
+        state=slots[i];
+
+        // the slot has been recycled by a writer
+        // in the meanwhile: try again
+        mutex.lock();
+        coherent=(seq[i]==s);
+        mutex.unlock();
+    }
+    while (!coherent);
 }
 
 
 /************************************************************************/
-void exchangeData::resize_counterv(const int sz, const double val)
+GazeState &exchangeData::begin_update()
 {
-    mutex[MUTEX_COUNTERV].lock();
-    counterv.resize(sz,val);
-    mutex[MUTEX_COUNTERV].unlock();
+    mutexWriter.lock();
+
+    // writers are serialized, hence the latest slot
+    // cannot change while we are copying it
+    mutex.lock();
+    int i=latest;
+    mutex.unlock();
+
+    pending=slots[i];
+    return pending;
+}
+
+
+/************************************************************************/
+void exchangeData::end_update()
+{
+    mutex.lock();
+    int i=(latest+1)%EXCHANGEDATA_SLOTS;
+    seq[i]++;   // odd => slot under writing
+    mutex.unlock();
+
+    slots[i]=pending;
+
+    mutex.lock();
+    seq[i]++;
+    latest=i;
+    mutex.unlock();
+
+    mutexWriter.unlock();
 }
 
 
 /************************************************************************/
 void exchangeData::set_xd(const Vector &_xd)
 {
-    mutex[MUTEX_XD].lock();
-    xd=_xd;
-    mutex[MUTEX_XD].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_xd,state.xd,3);
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_qd(const Vector &_qd)
 {
-    mutex[MUTEX_QD].lock();
-    qd=_qd;
-    mutex[MUTEX_QD].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_qd,state.qd,6);
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_qd(const int i, const double val)
 {
-    mutex[MUTEX_QD].lock();
-    qd[i]=val;
-    mutex[MUTEX_QD].unlock();
+    GazeState &state=begin_update();
+    state.qd[i]=val;
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_x(const Vector &_x)
 {
-    mutex[MUTEX_X].lock();
-    x=_x;
-    mutex[MUTEX_X].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_x,state.x,3);
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_x(const Vector &_x, const double stamp)
 {
-    mutex[MUTEX_X].lock();
-    x=_x;
-    x_stamp=stamp;
-    mutex[MUTEX_X].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_x,state.x,3);
+    state.x_stamp=stamp;
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_q(const Vector &_q)
 {
-    mutex[MUTEX_Q].lock();
-    q=_q;
-    mutex[MUTEX_Q].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_q,state.q,6);
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_torso(const Vector &_torso)
 {
-    mutex[MUTEX_TORSO].lock();
-    torso=_torso;
-    mutex[MUTEX_TORSO].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_torso,state.torso,3);
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_v(const Vector &_v)
 {
-    mutex[MUTEX_V].lock();
-    v=_v;
-    mutex[MUTEX_V].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_v,state.v,6);
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_counterv(const Vector &_counterv)
 {
-    mutex[MUTEX_COUNTERV].lock();
-    counterv=_counterv;
-    mutex[MUTEX_COUNTERV].unlock();
+    GazeState &state=begin_update();
+    vectorToState(_counterv,state.counterv,3);
+    end_update();
 }
 
 
 /************************************************************************/
 void exchangeData::set_fpFrame(const Matrix &_S)
 {
-    mutex[MUTEX_FPFRAME].lock();
-    S=_S;
-    mutex[MUTEX_FPFRAME].unlock();
+    GazeState &state=begin_update();
+    matrixToState(_S,state.fpFrame);
+    end_update();
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_xd()
 {
-    mutex[MUTEX_XD].lock();
-    Vector _xd=xd;
-    mutex[MUTEX_XD].unlock();
-
-    return _xd;
+    GazeState state; get_state(state);
+    return stateToVector(state.xd,3);
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_qd()
 {
-    mutex[MUTEX_QD].lock();
-    Vector _qd=qd;
-    mutex[MUTEX_QD].unlock();
-
-    return _qd;
+    GazeState state; get_state(state);
+    return stateToVector(state.qd,6);
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_x()
 {
-    mutex[MUTEX_X].lock();
-    Vector _x=x;
-    mutex[MUTEX_X].unlock();
-
-    return _x;
+    GazeState state; get_state(state);
+    return stateToVector(state.x,3);
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_x(double &stamp)
 {
-    mutex[MUTEX_X].lock();
-    Vector _x=x;
-    stamp=x_stamp;
-    mutex[MUTEX_X].unlock();
-
-    return _x;
+    GazeState state; get_state(state);
+    stamp=state.x_stamp;
+    return stateToVector(state.x,3);
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_q()
 {
-    mutex[MUTEX_Q].lock();
-    Vector _q=q;
-    mutex[MUTEX_Q].unlock();
-
-    return _q;
+    GazeState state; get_state(state);
+    return stateToVector(state.q,6);
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_torso()
 {
-    mutex[MUTEX_TORSO].lock();
-    Vector _torso=torso;
-    mutex[MUTEX_TORSO].unlock();
-
-    return _torso;
+    GazeState state; get_state(state);
+    return stateToVector(state.torso,3);
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_v()
 {
-    mutex[MUTEX_V].lock();
-    Vector _v=v;
-    mutex[MUTEX_V].unlock();
-
-    return _v;
+    GazeState state; get_state(state);
+    return stateToVector(state.v,6);
 }
 
 
 /************************************************************************/
 Vector exchangeData::get_counterv()
 {
-    mutex[MUTEX_COUNTERV].lock();
-    Vector _counterv=counterv;
-    mutex[MUTEX_COUNTERV].unlock();
-
-    return _counterv;
+    GazeState state; get_state(state);
+    return stateToVector(state.counterv,3);
 }
 
 
 /************************************************************************/
 Matrix exchangeData::get_fpFrame()
 {
-    mutex[MUTEX_FPFRAME].lock();
-    Matrix _S=S;
-    mutex[MUTEX_FPFRAME].unlock();
+    GazeState state; get_state(state);
+    return stateToMatrix(state.fpFrame);
+}
+
+
+/************************************************************************/
+syncStats::syncStats(const string &_name) : name(_name)
+{
+    enabled=false;
+    t0=tCycle=tSum=tMax=0.0;
+    tReport=Time::now();
+    nCycles=0;
+}
+
 
-    return _S;
+/************************************************************************/
+void syncStats::tic()
+{
+    if (enabled)
+        t0=Time::now();
+}
+
+
+/************************************************************************/
+void syncStats::toc()
+{
+    if (enabled)
+        tCycle+=Time::now()-t0;
+}
+
+
+/************************************************************************/
+void syncStats::endCycle()
+{
+    if (!enabled)
+        return;
+
+    tSum+=tCycle;
+    tMax=std::max(tMax,tCycle);
+    tCycle=0.0;
+    nCycles++;
+
+    double t=Time::now();
+    if (t-tReport>=SYNCSTATS_REPORTPERIOD)
+    {
+        printf("%s: time spent in data exchange per cycle = %.1f [us] (mean), %.1f [us] (max) over %d cycles\n",
+               name.c_str(),1e6*tSum/nCycles,1e6*tMax,nCycles);
+
+        tSum=tMax=0.0;
+        nCycles=0;
+        tReport=t;
+    }
 }
 
 
@@ -85,6 +85,15 @@
  * - \c overlap \c 1.0     \n        
  *   specifies the relative overlap of each receptive field
  *
+ * - \c threads \c 1     \n        
+ *   specifies the number of threads sharing the rows of each transform
+ *
+ * - \c cache \c dir     \n        
+ *   specifies the directory of the lookup tables cache, where the tables
+ *   are stored once built and memory-mapped at the next start; an empty
+ *   string disables the cache (default: $ICUB_LOGPOLAR_CACHE if defined,
+ *   disabled otherwise); use a directory writable by its owner only
+ *
  * 
  * \section portsa_sec Ports Accessed
  * 
@@ -200,12 +209,15 @@ private:
     int *xSizeValue;
     int *ySizeValue;
     double *overlapValue;     
+    int *threadsValue;
+    std::string *cacheValue;
 
     iCub::logpolar::logpolarTransform trsf;
 
 public:
     LogPolarTransformThread(yarp::os::BufferedPort<yarp::sig::FlexImage > *imageIn,  yarp::os::BufferedPort<yarp::sig::ImageOf<yarp::sig::PixelRgb> > *imageOut, 
-                            int *direction, int *x, int *y, int *angles, int  *rings, double *overlap);
+                            int *direction, int *x, int *y, int *angles, int  *rings, double *overlap, int *threads,
+                            std::string *cache);
     bool threadInit();     
     void threadRelease();
     void run(); 
@@ -242,6 +254,8 @@ class LogPolarTransform : public yarp::os::RFModule
     int    xSize;                    // x samples
     int    ySize;                    // y samples
     double  overlap;                 // overlap of receptive fields
+    int    numberOfThreads;          // threads sharing the rows of the transform
+    std::string cacheDirectory;      // directory of the lookup tables cache
 
     /* class variables */
 
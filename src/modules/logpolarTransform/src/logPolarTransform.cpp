@@ -119,6 +119,18 @@ bool LogPolarTransform::configure(yarp::os::ResourceFinder &rf)
                            Value(1.0),
                            "Key value (int)").asDouble();
 
+   /* get the number of threads */
+
+   numberOfThreads       = rf.check("threads",
+                           Value(1),
+                           "Key value (int)").asInt();
+
+   /* get the directory of the lookup tables cache */
+
+   cacheDirectory        = rf.check("cache",
+                           Value(iCub::logpolar::logpolarTransform::defaultCacheDirectory().c_str()),
+                           "Key value (string)").asString().c_str();
+
 
    /* do all initialization here */
      
@@ -158,7 +170,8 @@ bool LogPolarTransform::configure(yarp::os::ResourceFinder &rf)
                                                          &direction, 
                                                          &xSize, &ySize,
                                                          &numberOfAngles, &numberOfRings, 
-                                                         &overlap);
+                                                         &overlap, &numberOfThreads,
+                                                         &cacheDirectory);
 
    /* now start the thread to do the work */
 
@@ -230,7 +243,8 @@ double LogPolarTransform::getPeriod()
 }
 
 LogPolarTransformThread::LogPolarTransformThread(BufferedPort<FlexImage> *imageIn, BufferedPort<ImageOf<PixelRgb> > *imageOut, 
-                                                 int *direction, int *x, int *y, int *angles, int *rings, double *overlap)
+                                                 int *direction, int *x, int *y, int *angles, int *rings, double *overlap, int *threads,
+                                                 string *cache)
 {
     imagePortIn        = imageIn;
     imagePortOut       = imageOut;
@@ -240,6 +254,8 @@ LogPolarTransformThread::LogPolarTransformThread(BufferedPort<FlexImage> *imageI
     anglesValue        = angles;
     ringsValue         = rings;
     overlapValue       = overlap;
+    threadsValue       = threads;
+    cacheValue         = cache;
     inputImage = 0;
 }
 
@@ -269,6 +285,8 @@ bool LogPolarTransformThread::threadInit()
     }
 
     cout << "||| initializing the logpolar mapping" << endl;
+    trsf.setNumThreads(*threadsValue);
+    trsf.setCacheDirectory(*cacheValue);
     if (!allocLookupTables(*directionValue, *ringsValue, *anglesValue, *xSizeValue, *ySizeValue, *overlapValue)) {
         cerr << "can't allocate lookup tables" << endl;
         return false;
@@ -132,6 +132,20 @@ YARP libraries and OpenCV
   The default value is -1 meaning that all threads equal to the
   number of available cores BUT ONE will be used.
  
+--numStripes \e stripes
+- The grid of nodes is split in \e stripes horizontal stripes 
+  whose optical flow is computed concurrently by a pool of worker
+  threads. The first stripe is processed by the main thread,
+  which builds the pyramid of the current image that is then
+  shared with the workers. The default value is 1, meaning that
+  no worker is created.
+ 
+--pyrReuse \e switch
+- If \e switch is "on" the pyramid of the current image is kept
+  and used as pyramid of the previous image in the next cycle,
+  thus avoiding rebuilding it at each frame. The default value
+  is "on".
+ 
 --verbosity 
 - Enable the dump of log messages.
  
@@ -167,11 +181,16 @@ None.
  
 - <i> /<stemName>/rpc </i> for RPC communication. 
  
+\note Outputs whose ports are not connected are neither 
+      rendered nor serialized; the blobs detection is skipped as
+      well if no one is listening to it.
+ 
 \section rpcProto_sec RPC protocol 
 The parameters <i> winSize, recogThres, adjNodesThres, 
 blobMinSizeThres, framesPersistence, cropSize, numThreads, 
-verbosity </i> can be changed/retrieved through the commands 
-set/get. Moreover the further switch \e inhibition can be 
+pyrReuse, verbosity </i> can be changed/retrieved through the 
+commands set/get. The parameter <i> numStripes </i> can be only 
+retrieved. Moreover the further switch \e inhibition can be 
 accessed in order to enable/disable the motion detection at 
 run-time. 
  
@@ -239,6 +258,84 @@ public:
 };
 
 
+/************************************************************************/
+class FlowStripe : public Thread
+{
+protected:
+    Semaphore go;
+    Semaphore done;
+
+    IplImage     *imgPrev;
+    IplImage     *imgCurr;
+    IplImage     *pyrPrev;
+    IplImage     *pyrCurr;
+    CvPoint2D32f *nodesPrev;
+    CvPoint2D32f *nodesCurr;
+    char         *featuresFound;
+    float        *featuresErrors;
+    int           nodesNum;
+    int           winSize;
+
+public:
+    /************************************************************************/
+    FlowStripe() : go(0), done(0) { }
+
+    /************************************************************************/
+    void post(IplImage *_imgPrev, IplImage *_imgCurr,
+              IplImage *_pyrPrev, IplImage *_pyrCurr,
+              CvPoint2D32f *_nodesPrev, CvPoint2D32f *_nodesCurr,
+              char *_featuresFound, float *_featuresErrors,
+              const int _nodesNum, const int _winSize)
+    {
+        imgPrev=_imgPrev;
+        imgCurr=_imgCurr;
+        pyrPrev=_pyrPrev;
+        pyrCurr=_pyrCurr;
+        nodesPrev=_nodesPrev;
+        nodesCurr=_nodesCurr;
+        featuresFound=_featuresFound;
+        featuresErrors=_featuresErrors;
+        nodesNum=_nodesNum;
+        winSize=_winSize;
+
+        go.post();
+    }
+
+    /************************************************************************/
+    void wait()
+    {
+        done.wait();
+    }
+
+    /************************************************************************/
+    void run()
+    {
+        while (!isStopping())
+        {
+            go.wait();
+            if (isStopping())
+                break;
+
+            // both pyramids have been already built by the main thread
+            if (nodesNum>0)
+                cvCalcOpticalFlowPyrLK(imgPrev,imgCurr,pyrPrev,pyrCurr,
+                                       nodesPrev,nodesCurr,nodesNum,
+                                       cvSize(winSize,winSize),5,featuresFound,featuresErrors,
+                                       cvTermCriteria(CV_TERMCRIT_ITER|CV_TERMCRIT_EPS,20,0.3),
+                                       CV_LKFLOW_PYR_A_READY|CV_LKFLOW_PYR_B_READY);
+
+            done.post();
+        }
+    }
+
+    /************************************************************************/
+    void onStop()
+    {
+        go.post();
+    }
+};
+
+
 /************************************************************************/
 class ProcessThread : public Thread
 {
@@ -257,6 +354,9 @@ protected:
     int blobMinSizeThres;
     int framesPersistence;
     int cropSize;
+    int numStripes;
+    bool pyrReuse;
+    bool pyrPrevReady;
     bool verbosity;
     bool inhibition;
     int nodesNum;
@@ -269,8 +369,9 @@ protected:
 
     ImageOf<PixelMono>  imgMonoIn;
     ImageOf<PixelMono>  imgMonoPrev;
-    ImageOf<PixelFloat> imgPyrPrev;
-    ImageOf<PixelFloat> imgPyrCurr;
+    ImageOf<PixelFloat> imgPyr[2];
+    ImageOf<PixelFloat> *pImgPyrPrev;
+    ImageOf<PixelFloat> *pImgPyrCurr;
 
     CvPoint2D32f        *nodesPrev;
     CvPoint2D32f        *nodesCurr;
@@ -280,6 +381,7 @@ protected:
 
     set<int>             activeNodesIndexSet;
     deque<Blob>          blobSortedList;
+    vector<FlowStripe*>  stripes;
 
     BufferedPort<ImageOf<PixelBgr> >  inPort;
     BufferedPort<ImageOf<PixelBgr> >  outPort;
@@ -304,6 +406,47 @@ protected:
         featuresErrors=NULL;
     }
 
+    /************************************************************************/
+    void computeOpticalFlow()
+    {
+        IplImage *imgPrev=(IplImage*)imgMonoPrev.getIplImage();
+        IplImage *imgCurr=(IplImage*)imgMonoIn.getIplImage();
+        IplImage *pyrPrev=(IplImage*)pImgPyrPrev->getIplImage();
+        IplImage *pyrCurr=(IplImage*)pImgPyrCurr->getIplImage();
+
+        int stripeSize=nodesNum/numStripes;
+        int firstSize=nodesNum-stripeSize*(int)stripes.size();
+
+        // the first stripe is in charge of building the pyramid
+        // of the current image (and of the previous one if not
+        // available from the last cycle)
+        cvCalcOpticalFlowPyrLK(imgPrev,imgCurr,pyrPrev,pyrCurr,
+                               nodesPrev,nodesCurr,firstSize,
+                               cvSize(winSize,winSize),5,featuresFound,featuresErrors,
+                               cvTermCriteria(CV_TERMCRIT_ITER|CV_TERMCRIT_EPS,20,0.3),
+                               (pyrReuse&&pyrPrevReady)?CV_LKFLOW_PYR_A_READY:0);
+
+        // the remaining stripes reuse the pyramids
+        for (size_t i=0; i<stripes.size(); i++)
+        {
+            int offs=firstSize+(int)i*stripeSize;
+            stripes[i]->post(imgPrev,imgCurr,pyrPrev,pyrCurr,
+                             nodesPrev+offs,nodesCurr+offs,
+                             featuresFound+offs,featuresErrors+offs,
+                             stripeSize,winSize);
+        }
+
+        for (size_t i=0; i<stripes.size(); i++)
+            stripes[i]->wait();
+
+        // the current pyramid becomes the previous one
+        if (pyrReuse)
+        {
+            std::swap(pImgPyrPrev,pImgPyrCurr);
+            pyrPrevReady=true;
+        }
+    }
+
 #ifdef _MOTIONCUT_MULTITHREADING_OPENMP
     /************************************************************************/
     int setNumThreads(const int n)
@@ -344,6 +487,8 @@ public:
         adjNodesThres=rf.check("adjNodesThres",Value(4)).asInt();
         blobMinSizeThres=rf.check("blobMinSizeThres",Value(10)).asInt();
         framesPersistence=rf.check("framesPersistence",Value(3)).asInt();        
+        numStripes=rf.check("numStripes",Value(1)).asInt();
+        pyrReuse=rf.check("pyrReuse",Value("on")).asString()=="on";
         verbosity=rf.check("verbosity");
 
         cropSize=0;
@@ -360,6 +505,7 @@ public:
         // thresholding
         coverXratio=std::min(coverXratio,1.0);
         coverYratio=std::min(coverYratio,1.0);
+        numStripes=std::max(numStripes,1);
 
         // if the OpenCV version supports OpenMP multi-threading,
         // set the maximum number of threads available to OpenCV
@@ -372,6 +518,18 @@ public:
         nodesPersistence=NULL;
         featuresFound=NULL;
         featuresErrors=NULL;
+
+        pImgPyrPrev=&imgPyr[0];
+        pImgPyrCurr=&imgPyr[1];
+        pyrPrevReady=false;
+
+        // launch the workers pool
+        for (int i=1; i<numStripes; i++)
+        {
+            FlowStripe *stripe=new FlowStripe;
+            stripe->start();
+            stripes.push_back(stripe);
+        }
         
         inPort.open(("/"+name+"/img:i").c_str());
         outPort.open(("/"+name+"/img:o").c_str());
@@ -407,6 +565,8 @@ public:
                 printf("cropSize          = %d\n",cropSize);
             else
                 printf("cropSize          = auto\n");
+            printf("numStripes        = %d\n",numStripes);
+            printf("pyrReuse          = %s\n",pyrReuse?"on":"off");
             
         #ifdef _MOTIONCUT_MULTITHREADING_OPENMP
             printf("numThreads        = %d\n",numThreads);
@@ -448,8 +608,9 @@ public:
                 imgMonoIn.resize(*pImgBgrIn);
                 imgMonoPrev.resize(*pImgBgrIn);
 
-                imgPyrPrev.resize(pImgBgrIn->width()+8,pImgBgrIn->height()/3);
-                imgPyrCurr.resize(pImgBgrIn->width()+8,pImgBgrIn->height()/3);
+                imgPyr[0].resize(pImgBgrIn->width()+8,pImgBgrIn->height()/3);
+                imgPyr[1].resize(pImgBgrIn->width()+8,pImgBgrIn->height()/3);
+                pyrPrevReady=false;
 
                 // dispose previously allocated memory
                 disposeMem();
@@ -494,14 +655,31 @@ public:
             // convert the input image to gray-scale
             cvCvtColor(pImgBgrIn->getIplImage(),imgMonoIn.getIplImage(),CV_BGR2GRAY);
 
+            // render and serialize only what is listened to
+            bool doOut=outPort.getOutputCount()>0;
+            bool doOpt=optPort.getOutputCount()>0;
+            bool doNodes=nodesPort.getOutputCount()>0;
+            bool doBlobs=doOut || (blobsPort.getOutputCount()>0) ||
+                         (cropPort.getOutputCount()>0);
+
             // copy input image into output image
-            ImageOf<PixelBgr> &imgBgrOut=outPort.prepare();
-            imgBgrOut=*pImgBgrIn;
+            IplImage *pIplOut=NULL;
+            if (doOut)
+            {
+                ImageOf<PixelBgr> &imgBgrOut=outPort.prepare();
+                imgBgrOut=*pImgBgrIn;
+                pIplOut=(IplImage*)imgBgrOut.getIplImage();
+            }
 
             // get optFlow image
-            ImageOf<PixelMono> &imgMonoOpt=optPort.prepare();
-            imgMonoOpt.resize(imgBgrOut);
-            imgMonoOpt.zero();
+            IplImage *pIplOpt=NULL;
+            if (doOpt)
+            {
+                ImageOf<PixelMono> &imgMonoOpt=optPort.prepare();
+                imgMonoOpt.resize(*pImgBgrIn);
+                imgMonoOpt.zero();
+                pIplOpt=(IplImage*)imgMonoOpt.getIplImage();
+            }
 
             // declare output bottles
             Bottle nodesBottle;
@@ -517,11 +695,7 @@ public:
 
             // compute optical flow
             latch_t=Time::now();
-            cvCalcOpticalFlowPyrLK(imgMonoPrev.getIplImage(),imgMonoIn.getIplImage(),
-                                   imgPyrPrev.getIplImage(),imgPyrCurr.getIplImage(),
-                                   nodesPrev,nodesCurr,nodesNum,
-                                   cvSize(winSize,winSize),5,featuresFound,featuresErrors,
-                                   cvTermCriteria(CV_TERMCRIT_ITER|CV_TERMCRIT_EPS,20,0.3),0);
+            computeOpticalFlow();
             dt0=Time::now()-latch_t;
 
             // assign status to the grid nodes
@@ -535,22 +709,29 @@ public:
                 // handle the node persistence
                 if (!inhibition && (nodesPersistence[i]!=0))
                 {
-                    cvCircle(imgBgrOut.getIplImage(),node,1,NODE_ON,2);
-                    cvCircle(imgMonoOpt.getIplImage(),node,1,cvScalar(255),2);
+                    if (doOut)
+                        cvCircle(pIplOut,node,1,NODE_ON,2);
 
-                    Bottle &nodeBottle=nodesBottle.addList();
-                    nodeBottle.addInt((int)nodesPrev[i].x);
-                    nodeBottle.addInt((int)nodesPrev[i].y);
+                    if (doOpt)
+                        cvCircle(pIplOpt,node,1,cvScalar(255),2);
+
+                    if (doNodes)
+                    {
+                        Bottle &nodeBottle=nodesBottle.addList();
+                        nodeBottle.addInt((int)nodesPrev[i].x);
+                        nodeBottle.addInt((int)nodesPrev[i].y);
+                    }
 
                     // update the active nodes set
-                    activeNodesIndexSet.insert(i);
+                    if (doBlobs)
+                        activeNodesIndexSet.insert(i);
 
                     nodesPersistence[i]--;
 
                     persistentNode=true;
                 }
-                else
-                    cvCircle(imgBgrOut.getIplImage(),node,1,NODE_OFF,1);
+                else if (doOut)
+                    cvCircle(pIplOut,node,1,NODE_OFF,1);
 
                 // do not consider the border nodes and skip if inhibition is on
                 int row=i%nodesX;
@@ -576,15 +757,22 @@ public:
                         // update only if the node was not persistent
                         if (!persistentNode)
                         {
-                            cvCircle(imgBgrOut.getIplImage(),node,1,NODE_ON,2);
-                            cvCircle(imgMonoOpt.getIplImage(),node,1,cvScalar(255),2);
+                            if (doOut)
+                                cvCircle(pIplOut,node,1,NODE_ON,2);
+
+                            if (doOpt)
+                                cvCircle(pIplOpt,node,1,cvScalar(255),2);
 
-                            Bottle &nodeBottle=nodesBottle.addList();
-                            nodeBottle.addInt((int)nodesPrev[i].x);
-                            nodeBottle.addInt((int)nodesPrev[i].y);
+                            if (doNodes)
+                            {
+                                Bottle &nodeBottle=nodesBottle.addList();
+                                nodeBottle.addInt((int)nodesPrev[i].x);
+                                nodeBottle.addInt((int)nodesPrev[i].y);
+                            }
 
                             // update the active nodes set
-                            activeNodesIndexSet.insert(i);
+                            if (doBlobs)
+                                activeNodesIndexSet.insert(i);
                         }
                     }
                 }
@@ -609,26 +797,23 @@ public:
                 blobBottle.addInt(centroid.y);
                 blobBottle.addInt(blob.size);
 
-                cvCircle(imgBgrOut.getIplImage(),centroid,4,cvScalar(blueLev,0,redLev),3);
+                if (doOut)
+                    cvCircle(pIplOut,centroid,4,cvScalar(blueLev,0,redLev),3);
             }
             dt2=Time::now()-latch_t;
 
             // send out images, propagating the time-stamp
-            if (outPort.getOutputCount()>0)
+            if (doOut)
             {
                 outPort.setEnvelope(stamp);
                 outPort.write();
             }
-            else
-                outPort.unprepare();
 
-            if (optPort.getOutputCount()>0)
+            if (doOpt)
             {
                 optPort.setEnvelope(stamp);
                 optPort.write();
             }
-            else
-                optPort.unprepare();
 
             // send out data bottles, propagating the time-stamp
             if ((nodesPort.getOutputCount()>0) && (nodesBottle.size()>1))
@@ -688,6 +873,13 @@ public:
     /************************************************************************/
     void threadRelease()
     {
+        for (size_t i=0; i<stripes.size(); i++)
+        {
+            stripes[i]->stop();
+            delete stripes[i];
+        }
+        stripes.clear();
+
         disposeMem();
 
         inPort.close();
@@ -825,6 +1017,12 @@ public:
                     reply.addString("OpenMP multi-threading not supported");
                 #endif
                 }
+                else if (subcmd=="pyrReuse")
+                {
+                    pyrReuse=req.get(2).asString()=="on";
+                    pyrPrevReady=false;
+                    reply.addString("ack");
+                }
                 else if (subcmd=="verbosity")
                 {
                     verbosity=req.get(2).asString()=="on";
@@ -868,6 +1066,10 @@ public:
                 #else
                     reply.addString("OpenMP multi-threading not supported");
                 #endif
+                else if (subcmd=="numStripes")
+                    reply.addInt(numStripes);
+                else if (subcmd=="pyrReuse")
+                    reply.addString(pyrReuse?"on":"off");
                 else if (subcmd=="verbosity")
                     reply.addString(verbosity?"on":"off");
                 else if (subcmd=="inhibition")
@@ -984,6 +1186,8 @@ int main(int argc, char *argv[])
     #ifdef _MOTIONCUT_MULTITHREADING_OPENMP
         printf("\t--numThreads        <int>\n");
     #endif
+        printf("\t--numStripes        <int>\n");
+        printf("\t--pyrReuse          \"on\" or \"off\"\n");
         printf("\t--verbosity           -\n");
         printf("\n");
         
@@ -0,0 +1,136 @@
+/* 
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+/**
+ * Client-side helper to mirror the content of an 
+ * objectsPropertiesCollector from its broadcast stream. 
+ *  
+ * It is self-contained and header-only so that it can be 
+ * dropped into any module: feed every Bottle read from 
+ * /<moduleName>/broadcast:o to update(). Both the full 
+ * broadcast ("sync", "async") and the delta mode ("snapshot", 
+ * "delta") are understood; in delta mode a message out of 
+ * sequence invalidates the mirror until the next snapshot. 
+ *  
+ * \code 
+ * DataBaseMirror mirror;
+ * while (Bottle *msg=port.read())
+ *     if (mirror.update(*msg))
+ *         useItems(mirror.getItems());
+ * \endcode 
+ */
+
+#ifndef __DATABASEMIRROR_H__
+#define __DATABASEMIRROR_H__
+
+#include <string>
+#include <map>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Property.h>
+
+
+/************************************************************************/
+class DataBaseMirror
+{
+protected:
+    std::map<int,yarp::os::Property> items;
+    int  revision;
+    bool synced;
+
+    /************************************************************************/
+    bool putItem(yarp::os::Bottle *item)
+    {
+        if (item==NULL)
+            return false;
+
+        yarp::os::Bottle *idList=item->get(0).asList();
+        if (idList==NULL)
+            return false;
+
+        if ((idList->size()!=2) || (idList->get(0).asString()!="id"))
+            return false;
+
+        yarp::os::Property &prop=items[idList->get(1).asInt()];
+        prop.clear();
+        prop.fromString(item->tail().toString().c_str());
+        return true;
+    }
+
+public:
+    /************************************************************************/
+    DataBaseMirror() : revision(-1), synced(false) { }
+
+    /************************************************************************/
+    bool update(const yarp::os::Bottle &msg)
+    {
+        if (msg.size()==0)
+            return false;
+
+        std::string type=msg.get(0).asString().c_str();
+        if (type=="delta")
+        {
+            // the delta refers to the content at revision prevRev
+            if (!synced || (msg.size()<5) || (msg.get(2).asInt()!=revision))
+            {
+                synced=false;
+                return false;
+            }
+
+            if (yarp::os::Bottle *changed=msg.get(3).asList())
+                for (int i=0; i<changed->size(); i++)
+                    putItem(changed->get(i).asList());
+
+            if (yarp::os::Bottle *removed=msg.get(4).asList())
+                for (int i=0; i<removed->size(); i++)
+                    items.erase(removed->get(i).asInt());
+
+            revision=msg.get(1).asInt();
+        }
+        else if ((type=="snapshot") || (type=="sync") || (type=="async"))
+        {
+            // whole content; the revision is conveyed only by snapshots
+            items.clear();
+            for (int i=(type=="snapshot"?2:1); i<msg.size(); i++)
+                putItem(msg.get(i).asList());
+
+            revision=(type=="snapshot"?msg.get(1).asInt():-1);
+        }
+        else
+            return false;
+
+        synced=true;
+        return true;
+    }
+
+    /************************************************************************/
+    bool isSynced() const { return synced; }
+
+    /************************************************************************/
+    int getRevision() const { return revision; }
+
+    /************************************************************************/
+    const std::map<int,yarp::os::Property> &getItems() const { return items; }
+
+    /************************************************************************/
+    void clear()
+    {
+        items.clear();
+        revision=-1;
+        synced=false;
+    }
+};
+
+#endif
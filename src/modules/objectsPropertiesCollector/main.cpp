@@ -143,6 +143,27 @@ optional.
 <i>Action</i>: ask the database to enable/disable the broadcast 
 toward a yarp port whenever a change in the content occurs. 
  
+<b>delta broadcast</b> \n 
+<i>Format</i>: [delta] [on]/[off] \n 
+<i>Reply</i>: [nack]; [ack] \n 
+<i>Action</i>: ask the database to broadcast (both in 
+synchronous and asynchronous mode) only the changes occurred 
+since the previous message instead of the whole content. \n 
+Each message carries the database revision, which grows at 
+every change: \n 
+"delta" <rev> <prevRev> (((id <num>) ("prop0" <val0>) ...) ...) 
+(<num0> <num1> ...) \n 
+lists the items added or modified and the ids of the items 
+removed since the message tagged with revision <prevRev>. \n 
+"snapshot" <rev> ((id <num>) ("prop0" <val0>) ...) ... \n 
+conveys the whole content instead; it is sent periodically (see 
+\e --snapshot_period), whenever a new listener connects and 
+whenever the content is replaced as a whole. A receiver that 
+misses a message, i.e. whose revision differs from <prevRev>, 
+shall discard the deltas until the next snapshot; the helper 
+class \e DataBaseMirror contained in dataBaseMirror.h does 
+this job. 
+ 
 <b>ask</b> \n
 <i>Format</i>: [ask] (("prop0" "<" <val0>) || ("prop1" ">=" 
 <val1>) ...) \n 
@@ -188,6 +209,21 @@ to (cond1)&&(cond2) || (cond1)&&(cond3).
 - If this option is given then the content of database is not 
   saved at shutdown.
  
+--journal 
+- Enable the journaled storage: in place of rewriting the whole 
+  \e dbFileName at saving time, every change is appended to the 
+  binary log \e dbFileName.journal, which is periodically 
+  compacted into the binary snapshot \e dbFileName.snapshot 
+  (when it exceeds the size given by \e --journal_size, every 15 
+  minutes and at shutdown). At startup the snapshot is loaded 
+  and the log replayed; if neither exists, \e dbFileName is 
+  loaded instead. Files are kept within the home context path. 
+  The life timers are stored only within the snapshots. 
+ 
+--journal_size <MB> 
+- The size in MB above which the journal gets compacted. If not 
+  specified, 16 MB are assumed. 
+ 
 --verbose 
 - Enable some verbosity. 
  
@@ -198,9 +234,39 @@ to (cond1)&&(cond2) || (cond1)&&(cond3).
 --async_bc 
 - Broadcast the database content whenever a change occurs. 
  
+--delta_bc 
+- Broadcast only the changes instead of the whole content (see 
+  the [delta] command); a snapshot is sent whenever a new 
+  listener connects. 
+ 
+--snapshot_period <T> 
+- In delta mode, a snapshot of the whole content is broadcast at
+  least each \e T seconds. If not specified, a period of 5.0 
+  seconds is assumed. 
+ 
 --stats 
 - Enable statistics printouts.
  
+--index "(<prop0> <prop1> ...)" 
+- Maintain secondary indexes over the given properties, which 
+  are then used to speed up the [ask] requests: an index keeps
+  the set of items owning the property along with the items
+  sorted by value, so that equality, range ("<", "<=", ">", 
+  ">=") and existence conditions can be answered without 
+  scanning the whole database. For each block of conditions 
+  joined by "&&", the condition selecting the fewest items 
+  drives the search; blocks without indexed conditions trigger 
+  the usual full scan. Replies are not affected by the indexes. 
+ 
+--benchmark <N> 
+- Populate a private database with \e N synthetic items (10000 
+  if \e N is not given), measure the latency of a set of [ask] 
+  requests with and without the indexes specified through 
+  \e --index (by default "(entity x y name)") and quit; the 
+  number of repetitions per request can be given with 
+  \e --repetitions (100 by default). The YARP network is not 
+  required. 
+ 
 \section portsa_sec Ports Accessed
 None.
 
@@ -214,7 +280,9 @@ None.
  
 - \e /<moduleName>/modify:i the port used to modify the database
   content complying with the data format implemented for the
-  broadcast port.
+  broadcast port. Connecting the broadcast port of a database to
+  the modify port of another one makes the latter mirror the
+  former, also in delta mode.
  
 \section in_files_sec Input Data Files
 None.
@@ -255,9 +323,12 @@ reply: [ack] (id (1))
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <map>
+#include <set>
 #include <deque>
 
 #include <yarp/os/all.h>
@@ -277,6 +348,7 @@ using namespace yarp::os;
 #define CMD_ASK                         VOCAB3('a','s','k')
 #define CMD_SYNC                        VOCAB4('s','y','n','c')
 #define CMD_ASYNC                       VOCAB4('a','s','y','n')
+#define CMD_DELTA                       VOCAB4('d','e','l','t')
                                         
 #define REP_ACK                         VOCAB3('a','c','k')
 #define REP_NACK                        VOCAB4('n','a','c','k')
@@ -292,6 +364,15 @@ using namespace yarp::os;
 #define BCTAG_EMPTY                     ("empty")
 #define BCTAG_SYNC                      ("sync")
 #define BCTAG_ASYNC                     ("async")
+#define BCTAG_SNAPSHOT                  ("snapshot")
+#define BCTAG_DELTA                     ("delta")
+
+#define JOURNAL_MAGIC                   ("OPCJRN01")
+#define SNAPSHOT_MAGIC                  ("OPCSNP01")
+#define JOURNAL_MAGIC_LEN               8
+#define JOURNAL_PUT                     ('P')
+#define JOURNAL_DEL                     ('D')
+#define JOURNAL_CLEAR                   ('C')
 
 
 namespace relationalOperators
@@ -415,8 +496,27 @@ protected:
         Value val;
     };
 
+    /************************************************************************/
+    struct Index
+    {
+        std::set<int>                owners;  // items owning the property
+        map<int,std::set<int> >      intVals;
+        map<double,std::set<int> >   doubleVals;
+        map<string,std::set<int> >   stringVals;
+
+        void clear()
+        {
+            owners.clear();
+            intVals.clear();
+            doubleVals.clear();
+            stringVals.clear();
+        }
+    };
+
     ResourceFinder *rf;
     map<int,Item> itemsMap;
+    map<string,Index> indexes;
+    bool useIndexes;
     Mutex mutex;
     int  idCnt;
     bool initialized;
@@ -426,6 +526,26 @@ protected:
     BufferedPort<Bottle> *pBroadcastPort;
     bool asyncBroadcast;
 
+    // change feed
+    bool deltaBroadcast;
+    bool forceSnapshot;
+    int listeners;
+    double snapshotPeriod;
+    double lastSnapshot;
+    int revision;
+    int publishedRevision;
+    int modifyRevision;
+    std::set<int> changedIds;
+    std::set<int> removedIds;
+
+    // journaled storage
+    bool journaled;
+    FILE *journal;
+    long journalSize;
+    long journalMaxSize;
+    string journalPath;
+    string snapshotPath;
+
     /************************************************************************/
     int printMessage(const char *format, ...)
     {
@@ -449,15 +569,457 @@ protected:
             delete it->second.prop;
 
         itemsMap.clear();
+
+        for (map<string,Index>::iterator it=indexes.begin(); it!=indexes.end(); it++)
+            it->second.clear();
+
+        // the whole content is replaced: the receivers need a snapshot
+        changedIds.clear();
+        removedIds.clear();
+        forceSnapshot=true;
+        revision++;
+
+        journalRecord(JOURNAL_CLEAR,-1);
     }
 
     /************************************************************************/
     void eraseItem(map<int,Item>::iterator &it)
     {
+        markRemoved(it->first);
+        indexItem(it->first,it->second.prop,false);
         delete it->second.prop;
         itemsMap.erase(it);
     }
 
+    /************************************************************************/
+    void markChanged(const int id, const bool persist=true)
+    {
+        if (deltaBroadcast)
+        {
+            changedIds.insert(id);
+            removedIds.erase(id);
+        }
+        revision++;
+
+        if (persist)
+            journalRecord(JOURNAL_PUT,id);
+    }
+
+    /************************************************************************/
+    void markRemoved(const int id)
+    {
+        if (deltaBroadcast)
+        {
+            changedIds.erase(id);
+            removedIds.insert(id);
+        }
+        revision++;
+
+        journalRecord(JOURNAL_DEL,id);
+    }
+
+    /************************************************************************/
+    static void appendUInt(string &buf, const unsigned int val)
+    {
+        // little-endian, regardless of the host
+        buf+=(char)(val&0xff);
+        buf+=(char)((val>>8)&0xff);
+        buf+=(char)((val>>16)&0xff);
+        buf+=(char)((val>>24)&0xff);
+    }
+
+    /************************************************************************/
+    static unsigned int readUInt(const unsigned char *buf)
+    {
+        return (unsigned int)buf[0]|((unsigned int)buf[1]<<8)|
+               ((unsigned int)buf[2]<<16)|((unsigned int)buf[3]<<24);
+    }
+
+    /************************************************************************/
+    static unsigned int checksum(const char *buf, const size_t len)
+    {
+        // FNV-1a
+        unsigned int hash=2166136261U;
+        for (size_t i=0; i<len; i++)
+        {
+            hash^=(unsigned char)buf[i];
+            hash*=16777619U;
+        }
+        return hash;
+    }
+
+    /************************************************************************/
+    void appendRecord(string &buf, const char op, const int id)
+    {
+        // record: [length][checksum] followed by [op][id][properties],
+        // where the properties are the item content in bottle binary form
+        string body;
+        body+=op;
+        appendUInt(body,(unsigned int)id);
+
+        if (op==JOURNAL_PUT)
+        {
+            map<int,Item>::iterator it=itemsMap.find(id);
+            if (it==itemsMap.end())
+                return;
+
+            Bottle content;
+            content.read(*it->second.prop);
+            size_t len;
+            const char *bin=content.toBinary(&len);
+            body.append(bin,len);
+        }
+
+        appendUInt(buf,(unsigned int)body.size());
+        appendUInt(buf,checksum(body.c_str(),body.size()));
+        buf+=body;
+    }
+
+    /************************************************************************/
+    void journalRecord(const char op, const int id)
+    {
+        if (journal==NULL)
+            return;
+
+        string buf;
+        appendRecord(buf,op,id);
+        if (fwrite(buf.c_str(),1,buf.size(),journal)!=buf.size())
+            printMessage("error while writing the journal!\n");
+
+        fflush(journal);
+        journalSize+=(long)buf.size();
+    }
+
+    /************************************************************************/
+    void applyRecord(const char op, const int id, const char *payload, const size_t len)
+    {
+        if (op==JOURNAL_PUT)
+        {
+            Bottle content;
+            content.fromBinary(payload,(int)len);
+
+            Property *item=new Property;
+            for (int i=0; i<content.size(); i++)
+                if (Bottle *pair=content.get(i).asList())
+                    if (pair->size()>=2)
+                        item->put(pair->get(0).asString().c_str(),pair->get(1));
+
+            map<int,Item>::iterator it=itemsMap.find(id);
+            if (it!=itemsMap.end())
+            {
+                indexItem(id,it->second.prop,false);
+                delete it->second.prop;
+            }
+
+            itemsMap[id].prop=item;
+            indexItem(id,item,true);
+
+            if (idCnt<=id)
+                idCnt=id+1;
+        }
+        else if (op==JOURNAL_DEL)
+        {
+            map<int,Item>::iterator it=itemsMap.find(id);
+            if (it!=itemsMap.end())
+                eraseItem(it);
+        }
+        else if (op==JOURNAL_CLEAR)
+            clear();
+    }
+
+    /************************************************************************/
+    int replay(const string &path, const char *magic)
+    {
+        // return the number of records applied or -1 if the file is missing;
+        // the replay stops at the first incomplete or corrupted record
+        FILE *fin=fopen(path.c_str(),"rb");
+        if (fin==NULL)
+            return -1;
+
+        char header[JOURNAL_MAGIC_LEN];
+        if ((fread(header,1,JOURNAL_MAGIC_LEN,fin)!=JOURNAL_MAGIC_LEN) ||
+            (memcmp(header,magic,JOURNAL_MAGIC_LEN)!=0))
+        {
+            printMessage("%s is not valid!\n",path.c_str());
+            fclose(fin);
+            return 0;
+        }
+
+        int cnt=0;
+        vector<char> body;
+        unsigned char prefix[8];
+        while (fread(prefix,1,8,fin)==8)
+        {
+            unsigned int len=readUInt(prefix);
+            if ((len<5) || (len>(1U<<30)))
+                break;
+
+            body.resize(len);
+            if ((fread(&body[0],1,len,fin)!=len) || (checksum(&body[0],len)!=readUInt(prefix+4)))
+            {
+                printMessage("%s truncated after %d records\n",path.c_str(),cnt);
+                break;
+            }
+
+            int id=(int)readUInt((unsigned char*)&body[1]);
+            applyRecord(body[0],id,&body[5],len-5);
+            cnt++;
+        }
+
+        fclose(fin);
+        return cnt;
+    }
+
+    /************************************************************************/
+    void openJournal()
+    {
+        journal=fopen(journalPath.c_str(),"ab");
+        if (journal==NULL)
+        {
+            printMessage("unable to open %s!\n",journalPath.c_str());
+            return;
+        }
+
+        fseek(journal,0,SEEK_END);
+        journalSize=ftell(journal);
+        if (journalSize==0)
+        {
+            fwrite(JOURNAL_MAGIC,1,JOURNAL_MAGIC_LEN,journal);
+            fflush(journal);
+            journalSize=JOURNAL_MAGIC_LEN;
+        }
+    }
+
+    /************************************************************************/
+    void closeJournal()
+    {
+        if (journal!=NULL)
+        {
+            fclose(journal);
+            journal=NULL;
+        }
+    }
+
+    /************************************************************************/
+    static bool fileExists(const string &path)
+    {
+        if (FILE *f=fopen(path.c_str(),"rb"))
+        {
+            fclose(f);
+            return true;
+        }
+        else
+            return false;
+    }
+
+    /************************************************************************/
+    static bool replaceFile(const string &src, const string &dst)
+    {
+    #ifdef WIN32
+        ::remove(dst.c_str());
+    #endif
+        return (rename(src.c_str(),dst.c_str())==0);
+    }
+
+    /************************************************************************/
+    void appendItem(Bottle &bottle, map<int,Item>::iterator &it)
+    {
+        Bottle &item=bottle.addList();
+        Bottle &idList=item.addList();
+        idList.addString(PROP_ID);
+        idList.addInt(it->first);
+        item.read(*it->second.prop);
+    }
+
+    /************************************************************************/
+    bool putItem(Bottle *item)
+    {
+        // item is in the format ((id <num>) (prop0 <val0>) ...)
+        if (item==NULL)
+            return false;
+
+        Bottle *idList=item->get(0).asList();
+        if (idList==NULL)
+            return false;
+
+        if ((idList->size()!=2) || (idList->get(0).asString()!=PROP_ID))
+            return false;
+
+        int id=idList->get(1).asInt();
+        map<int,Item>::iterator it=itemsMap.find(id);
+        if (it!=itemsMap.end())
+        {
+            indexItem(id,it->second.prop,false);
+            delete it->second.prop;
+        }
+
+        itemsMap[id].prop=new Property(item->tail().toString().c_str());
+        indexItem(id,itemsMap[id].prop,true);
+        markChanged(id);
+
+        if (idCnt<=id)
+            idCnt=id+1;
+
+        return true;
+    }
+
+    /************************************************************************/
+    template<typename T>
+    void indexValue(map<T,std::set<int> > &vals, const T &key, const int id,
+                    const bool insert)
+    {
+        if (insert)
+            vals[key].insert(id);
+        else
+        {
+            typename map<T,std::set<int> >::iterator it=vals.find(key);
+            if (it!=vals.end())
+            {
+                it->second.erase(id);
+                if (it->second.empty())
+                    vals.erase(it);
+            }
+        }
+    }
+
+    /************************************************************************/
+    void indexItem(const int id, Property *item, const bool insert)
+    {
+        for (map<string,Index>::iterator it=indexes.begin(); it!=indexes.end(); it++)
+        {
+            if (!item->check(it->first.c_str()))
+                continue;
+
+            Index &index=it->second;
+            Value &val=item->find(it->first.c_str());
+
+            if (insert)
+                index.owners.insert(id);
+            else
+                index.owners.erase(id);
+
+            // keep the same type classification of the relational operators;
+            // NaN values never satisfy an indexed condition, thus skip them
+            if (val.isDouble())
+            {
+                double d=val.asDouble();
+                if (d==d)
+                    indexValue(index.doubleVals,d,id,insert);
+            }
+            else if (val.isInt())
+                indexValue(index.intVals,val.asInt(),id,insert);
+            else if (val.isString())
+                indexValue(index.stringVals,string(val.asString().c_str()),id,insert);
+        }
+    }
+
+    /************************************************************************/
+    template<typename T>
+    void rangeLookup(map<T,std::set<int> > &vals, const T &key, bool (*compare)(Value&,Value&),
+                     std::set<int> *ids, size_t &count)
+    {
+        typename map<T,std::set<int> >::iterator first=vals.begin();
+        typename map<T,std::set<int> >::iterator last=vals.end();
+
+        if (compare==&relationalOperators::equal)
+        {
+            first=vals.find(key);
+            if (first!=vals.end())
+            {
+                last=first;
+                last++;
+            }
+        }
+        else if (compare==&relationalOperators::greater)
+            first=vals.upper_bound(key);
+        else if (compare==&relationalOperators::greaterEqual)
+            first=vals.lower_bound(key);
+        else if (compare==&relationalOperators::lower)
+            last=vals.lower_bound(key);
+        else if (compare==&relationalOperators::lowerEqual)
+            last=vals.upper_bound(key);
+
+        for (typename map<T,std::set<int> >::iterator it=first; it!=last; it++)
+        {
+            count+=it->second.size();
+            if (ids!=NULL)
+                ids->insert(it->second.begin(),it->second.end());
+        }
+    }
+
+    /************************************************************************/
+    bool indexLookup(Condition &cond, std::set<int> *ids, size_t &count)
+    {
+        // return false if the condition cannot be served by an index;
+        // otherwise, count the items satisfying it and collect their ids
+        map<string,Index>::iterator it=indexes.find(cond.prop);
+        if (it==indexes.end())
+            return false;
+
+        Index &index=it->second;
+        count=0;
+
+        if (cond.compare==&relationalOperators::alwaysTrue)
+        {
+            count=index.owners.size();
+            if (ids!=NULL)
+                ids->insert(index.owners.begin(),index.owners.end());
+        }
+        else if (cond.compare==&relationalOperators::notEqual)
+            return false;
+        else if (cond.val.isDouble())
+            rangeLookup(index.doubleVals,cond.val.asDouble(),cond.compare,ids,count);
+        else if (cond.val.isInt())
+            rangeLookup(index.intVals,cond.val.asInt(),cond.compare,ids,count);
+        else if (cond.val.isString() && (cond.compare==&relationalOperators::equal))
+            rangeLookup(index.stringVals,string(cond.val.asString().c_str()),cond.compare,ids,count);
+
+        // any other combination never holds true: no candidates
+        return true;
+    }
+
+    /************************************************************************/
+    bool planQuery(deque<Condition> &condList, deque<string> &opList,
+                   std::set<int> &candidates)
+    {
+        // the conditions are blocks of "&&" joined by "||": for each
+        // block pick the most selective indexed condition, whose items
+        // are a superset of those satisfying the block
+        unsigned int i=0;
+        while (i<condList.size())
+        {
+            int best=-1;
+            size_t bestCount=0;
+
+            unsigned int j;
+            for (j=i; j<condList.size(); j++)
+            {
+                size_t count;
+                if (indexLookup(condList[j],NULL,count))
+                {
+                    if ((best<0) || (count<bestCount))
+                    {
+                        best=j;
+                        bestCount=count;
+                    }
+                }
+
+                if ((j>=opList.size()) || (opList[j]=="||"))
+                    break;
+            }
+
+            // a block with no indexed conditions requires the full scan
+            if (best<0)
+                return false;
+
+            size_t count;
+            indexLookup(condList[best],&candidates,count);
+            i=j+1;
+        }
+
+        return true;
+    }
+
     /************************************************************************/
     void write(FILE *stream)
     {
@@ -525,8 +1087,22 @@ public:
     /************************************************************************/
     DataBase() : RateThread(1000)
     {
+        rf=NULL;
+        journaled=false;
+        journal=NULL;
+        journalSize=0;
+        journalMaxSize=0;
         pBroadcastPort=NULL;
         asyncBroadcast=false;
+        deltaBroadcast=false;
+        forceSnapshot=true;
+        listeners=0;
+        snapshotPeriod=5.0;
+        lastSnapshot=0.0;
+        revision=0;
+        publishedRevision=0;
+        modifyRevision=-1;
+        useIndexes=true;
         initialized=false;
         nosave=false;
         verbose=false;
@@ -540,6 +1116,7 @@ public:
             stop();
 
         save();
+        closeJournal();
         clear();
     }
 
@@ -555,8 +1132,31 @@ public:
         }
 
         nosave=rf.check("nosave");
+
+        if (Bottle *indexList=rf.find("index").asList())
+            setIndexes(*indexList);
+
+        journaled=!nosave && rf.check("journal");
+        if (journaled)
+        {
+            string dbFileName=rf.getHomeContextPath().c_str();
+            dbFileName+="/";
+            dbFileName+=rf.find("db").asString().c_str();
+            journalPath=dbFileName+".journal";
+            snapshotPath=dbFileName+".snapshot";
+            journalMaxSize=(long)(1024.0*1024.0*rf.check("journal_size",Value(16.0)).asDouble());
+        }
+
         if (!rf.check("empty"))
-            load();
+        {
+            if (!journaled || !loadJournal())
+                load();
+        }
+
+        // start from a fresh snapshot, which also gets rid of
+        // any corrupted tail of the journal
+        if (journaled)
+            compact();
 
         dump();
         initialized=true;
@@ -569,6 +1169,46 @@ public:
         }
 
         asyncBroadcast=rf.check("async_bc");
+        deltaBroadcast=rf.check("delta_bc");
+        snapshotPeriod=rf.check("snapshot_period",Value(5.0)).asDouble();
+    }
+
+    /************************************************************************/
+    void setDeltaBroadcast(const bool sw)
+    {
+        mutex.lock();
+        deltaBroadcast=sw;
+        forceSnapshot=true;
+        mutex.unlock();
+    }
+
+    /************************************************************************/
+    bool isDeltaBroadcast() const
+    {
+        return deltaBroadcast;
+    }
+
+    /************************************************************************/
+    void setIndexes(const Bottle &props)
+    {
+        mutex.lock();
+        indexes.clear();
+        for (int i=0; i<props.size(); i++)
+            indexes[props.get(i).asString().c_str()];
+
+        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+            indexItem(it->first,it->second.prop,true);
+
+        printMessage("indexing %d properties\n",(int)indexes.size());
+        mutex.unlock();
+    }
+
+    /************************************************************************/
+    void enableIndexes(const bool sw)
+    {
+        mutex.lock();
+        useIndexes=sw;
+        mutex.unlock();
     }
 
     /************************************************************************/
@@ -628,6 +1268,7 @@ public:
 
             int id=b2->get(1).asInt();
             itemsMap[id].prop=new Property(b3->toString().c_str());
+            indexItem(id,itemsMap[id].prop,true);
 
             if (idCnt<=id)
                 idCnt=id+1;
@@ -637,11 +1278,97 @@ public:
         mutex.unlock();
     }
 
+    /************************************************************************/
+    bool loadJournal()
+    {
+        string oldJournalPath=journalPath+".old";
+        if (!fileExists(snapshotPath) && !fileExists(oldJournalPath) &&
+            !fileExists(journalPath))
+            return false;
+
+        printMessage("loading database from %s ...\n",snapshotPath.c_str());
+
+        mutex.lock();
+        clear();
+        idCnt=0;
+
+        // the records are whole items, hence replaying a journal already
+        // folded into the snapshot (interrupted compaction) is harmless
+        int nSnapshot=replay(snapshotPath,SNAPSHOT_MAGIC);
+        int nOld=replay(oldJournalPath,JOURNAL_MAGIC);
+        int nJournal=replay(journalPath,JOURNAL_MAGIC);
+
+        printMessage("database loaded: %d items from snapshot, %d records from journal\n",
+                     nSnapshot>0?nSnapshot:0,(nOld>0?nOld:0)+(nJournal>0?nJournal:0));
+        mutex.unlock();
+        return true;
+    }
+
+    /************************************************************************/
+    bool compact()
+    {
+        if (!journaled)
+            return false;
+
+        // take the snapshot within the lock, write it outside
+        mutex.lock();
+        string buf(SNAPSHOT_MAGIC,JOURNAL_MAGIC_LEN);
+        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+            appendRecord(buf,JOURNAL_PUT,it->first);
+
+        // start a new journal; the previous one is removed once the
+        // snapshot is safely stored. If a former compaction failed,
+        // keep on appending to the current journal instead
+        string oldJournalPath=journalPath+".old";
+        if (!fileExists(oldJournalPath))
+        {
+            closeJournal();
+            replaceFile(journalPath,oldJournalPath);
+        }
+
+        if (journal==NULL)
+            openJournal();
+        mutex.unlock();
+
+        printMessage("compacting database in %s ...\n",snapshotPath.c_str());
+
+        string tmpPath=snapshotPath+".tmp";
+        bool ok=false;
+        if (FILE *fout=fopen(tmpPath.c_str(),"wb"))
+        {
+            ok=(fwrite(buf.c_str(),1,buf.size(),fout)==buf.size());
+            ok&=(fclose(fout)==0);
+            ok=ok && replaceFile(tmpPath,snapshotPath);
+        }
+
+        if (ok)
+        {
+            ::remove(oldJournalPath.c_str());
+            printMessage("database compacted\n");
+        }
+        else
+            printMessage("error while compacting the database!\n");
+
+        return ok;
+    }
+
+    /************************************************************************/
+    bool needsCompaction()
+    {
+        return (journaled && (journalSize>journalMaxSize));
+    }
+
     /************************************************************************/
     void save()
     {
-        if (nosave)
+        if (nosave || (rf==NULL))
+            return;
+
+        if (journaled)
+        {
+            compact();
             return;
+        }
 
         mutex.lock();
         string dbFileName=rf->getHomeContextPath().c_str();
@@ -675,28 +1402,91 @@ public:
     {
         if (pBroadcastPort!=NULL)
         {
-            if (pBroadcastPort->getOutputCount()>0)
+            mutex.lock();
+
+            // whoever connected since the last call starts from a snapshot
+            int count=pBroadcastPort->getOutputCount();
+            if (count>listeners)
+                forceSnapshot=true;
+            listeners=count;
+
+            if (count>0)
             {
-                mutex.lock();
-                Bottle &bottle=pBroadcastPort->prepare();
-                bottle.clear();
-
-                bottle.addString(type.c_str());
-                if (itemsMap.empty())
-                    bottle.addString(BCTAG_EMPTY);
-                else for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+                if (deltaBroadcast)
+                    broadcastDelta();
+                else
                 {
-                    Bottle &item=bottle.addList();
-                    Bottle &idList=item.addList();
-                    idList.addString(PROP_ID);
-                    idList.addInt(it->first);
-                    item.read(*it->second.prop);
+                    Bottle &bottle=pBroadcastPort->prepare();
+                    bottle.clear();
+
+                    bottle.addString(type.c_str());
+                    if (itemsMap.empty())
+                        bottle.addString(BCTAG_EMPTY);
+                    else for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+                        appendItem(bottle,it);
+
+                    pBroadcastPort->write();
                 }
+            }
+            else if (deltaBroadcast)
+            {
+                // nobody is listening: no need to keep the changes
+                changedIds.clear();
+                removedIds.clear();
+                forceSnapshot=true;
+            }
 
-                pBroadcastPort->write();
-                mutex.unlock();
+            mutex.unlock();
+        }
+    }
+
+    /************************************************************************/
+    void broadcastDelta()
+    {
+        double t=Time::now();
+        if (forceSnapshot || (t-lastSnapshot>=snapshotPeriod))
+        {
+            Bottle &bottle=pBroadcastPort->prepare();
+            bottle.clear();
+
+            bottle.addString(BCTAG_SNAPSHOT);
+            bottle.addInt(revision);
+            for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+                appendItem(bottle,it);
+
+            pBroadcastPort->write();
+            lastSnapshot=t;
+            forceSnapshot=false;
+        }
+        else if (!changedIds.empty() || !removedIds.empty())
+        {
+            Bottle &bottle=pBroadcastPort->prepare();
+            bottle.clear();
+
+            bottle.addString(BCTAG_DELTA);
+            bottle.addInt(revision);
+            bottle.addInt(publishedRevision);
+
+            Bottle &changed=bottle.addList();
+            for (std::set<int>::iterator id=changedIds.begin(); id!=changedIds.end(); id++)
+            {
+                map<int,Item>::iterator it=itemsMap.find(*id);
+                if (it!=itemsMap.end())
+                    appendItem(changed,it);
             }
+
+            Bottle &removed=bottle.addList();
+            for (std::set<int>::iterator id=removedIds.begin(); id!=removedIds.end(); id++)
+                removed.addInt(*id);
+
+            pBroadcastPort->write();
         }
+        else
+            return;
+
+        changedIds.clear();
+        removedIds.clear();
+        publishedRevision=revision;
     }
 
     /************************************************************************/
@@ -715,6 +1505,8 @@ public:
         Property *item=new Property(content->toString().c_str());
         itemsMap[idCnt].prop=item;
         itemsMap[idCnt].lastUpdate=Time::now();
+        indexItem(idCnt,item,true);
+        markChanged(idCnt);
 
         printMessage("added item %s\n",item->toString().c_str());
         mutex.unlock();
@@ -758,9 +1550,12 @@ public:
             Bottle *propSet=content->find(PROP_SET).asList();
             if (propSet!=NULL)
             {
+                indexItem(it->first,it->second.prop,false);
                 for (int i=0; i<propSet->size(); i++)
                     it->second.prop->unput(propSet->get(i).asString().c_str());
 
+                indexItem(it->first,it->second.prop,true);
+                markChanged(it->first);
                 it->second.lastUpdate=Time::now();
             }
             else
@@ -850,6 +1645,7 @@ public:
 
                 printMessage("%s\n",content->toString().c_str());
 
+                indexItem(id,pProp,false);
                 for (int i=0; i<content->size(); i++)
                 {
                     if (Bottle *option=content->get(i).asList())
@@ -876,6 +1672,8 @@ public:
                     }
                 }
 
+                indexItem(id,pProp,true);
+                markChanged(id);
                 it->second.lastUpdate=Time::now();
                 mutex.unlock();
                 return true;
@@ -1151,8 +1949,20 @@ public:
 
         response.clear();
 
+        // restrict the search to the candidates provided by the indexes
+        std::set<int> candidates;
+        if (useIndexes && planQuery(condList,opList,candidates))
+        {
+            for (std::set<int>::iterator id=candidates.begin(); id!=candidates.end(); id++)
+            {
+                map<int,Item>::iterator it=itemsMap.find(*id);
+                if (it!=itemsMap.end())
+                    if (recursiveCheck(it->second.prop,condList,opList))
+                        response.addInt(it->first);
+            }
+        }
         // apply the conditions to each item
-        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        else for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
         {
             // do recursion and keep only the item that
             // satisfies the whole list of conditions
@@ -1186,14 +1996,18 @@ public:
                 }
                 else
                 {
+                    indexItem(it->first,pProp,false);
                     pProp->unput(PROP_LIFETIMER);
                     pProp->put(PROP_LIFETIMER,lifeTimer);
+                    indexItem(it->first,pProp,true);
+                    markChanged(it->first,false);
                 }
             }
         }
         mutex.unlock();
 
-        if (asyncBroadcast && erased)
+        // in delta mode, keep on sending the periodic snapshots
+        if (asyncBroadcast && (erased || deltaBroadcast))
             broadcast(BCTAG_ASYNC);
     }
 
@@ -1457,6 +2271,32 @@ public:
                 break;
             }
 
+            //-----------------
+            case CMD_DELTA:
+            {
+                if (command.size()<2)
+                {
+                    reply.addVocab(REP_NACK);
+                    break;
+                }
+
+                int opt=command.get(1).asVocab();
+                if (opt==Vocab::encode("on"))
+                {
+                    setDeltaBroadcast(true);
+                    reply.addVocab(REP_ACK);
+                }
+                else if (opt==Vocab::encode("off"))
+                {
+                    setDeltaBroadcast(false);
+                    reply.addVocab(REP_ACK);
+                }
+                else
+                    reply.addVocab(REP_NACK);
+
+                break;
+            }
+
             //-----------------
             case CMD_ASK:
             {
@@ -1490,6 +2330,65 @@ public:
         }
     }
 
+    /************************************************************************/
+    void benchmark(const int nItems, const int nReps)
+    {
+        // populate the database with synthetic items
+        Random::seed(0);
+        for (int i=0; i<nItems; i++)
+        {
+            ostringstream name, entity;
+            name<<"item_"<<i;
+            entity<<"entity_"<<(i%10);
+
+            Bottle content;
+            Bottle &b1=content.addList();
+            b1.addString("name"); b1.addString(name.str().c_str());
+            Bottle &b2=content.addList();
+            b2.addString("entity"); b2.addString(i%4?entity.str().c_str():"object");
+            Bottle &b3=content.addList();
+            b3.addString("x"); b3.addDouble(Random::uniform(-1.0,1.0));
+            Bottle &b4=content.addList();
+            b4.addString("y"); b4.addInt(Random::uniform(0,999));
+            Bottle &b5=content.addList();
+            b5.addString("position_2d_left");
+            Bottle &pos=b5.addList();
+            for (int j=0; j<4; j++)
+                pos.addInt(Random::uniform(0,319));
+
+            if (add(&content))
+                idCnt++;
+        }
+
+        const char *queries[]={"((entity == object) && (x < -0.9))",
+                               "((y >= 100) && (y < 110))",
+                               "((name == item_42))",
+                               "((x > 0.99) || (entity == entity_7) && (y <= 10))",
+                               "((position_2d_left) && (x >= 0.0))",
+                               "((y != 500))"};
+
+        fprintf(stdout,"%d items, %d repetitions per request\n",(int)itemsMap.size(),nReps);
+        for (size_t i=0; i<sizeof(queries)/sizeof(queries[0]); i++)
+        {
+            Bottle content(queries[i]);
+            Bottle response[2];
+            double latency[2];
+
+            for (int k=0; k<2; k++)
+            {
+                enableIndexes(k==1);
+                double t0=Time::now();
+                for (int j=0; j<nReps; j++)
+                    ask(&content,response[k]);
+                latency[k]=1e3*(Time::now()-t0)/nReps;
+            }
+
+            fprintf(stdout,"%s: %d items found; %g [ms/request] scanning, %g [ms/request] indexed%s\n",
+                    queries[i],response[1].size(),latency[0],latency[1],
+                    response[0].toString()==response[1].toString()?"":" (MISMATCH!)");
+        }
+    }
+
     /************************************************************************/
     bool modify(const Bottle &content)
     {
@@ -1497,35 +2396,52 @@ public:
             return false;
 
         string type=content.get(0).asString().c_str();
-        if ((type!=BCTAG_EMPTY) && (type!=BCTAG_SYNC) && (type!=BCTAG_ASYNC))
+        if ((type!=BCTAG_EMPTY) && (type!=BCTAG_SYNC) && (type!=BCTAG_ASYNC) &&
+            (type!=BCTAG_SNAPSHOT) && (type!=BCTAG_DELTA))
             return false;
 
         mutex.lock();
-        clear();
-
-        if (type!=BCTAG_EMPTY)
+        if (type==BCTAG_DELTA)
         {
-            idCnt=0;
-            for (int i=1; i<content.size(); i++)
+            // apply the delta only if it follows the last message received,
+            // otherwise wait for the next snapshot
+            if ((content.size()<5) || (modifyRevision<0) ||
+                (content.get(2).asInt()!=modifyRevision))
             {
-                if (Bottle *item=content.get(i).asList())
+                printMessage("delta out of sequence, waiting for a snapshot\n");
+                modifyRevision=-1;
+                mutex.unlock();
+                return false;
+            }
+
+            if (Bottle *changed=content.get(3).asList())
+                for (int i=0; i<changed->size(); i++)
+                    putItem(changed->get(i).asList());
+
+            if (Bottle *removed=content.get(4).asList())
+            {
+                for (int i=0; i<removed->size(); i++)
                 {
-                    if (Bottle *idList=item->get(0).asList())
-                    {
-                        if (idList->size()==2)
-                        {
-                            if (idList->get(0).asString()==PROP_ID)
-                            {
-                                int id=idList->get(1).asInt();
-                                itemsMap[id].prop=new Property(item->tail().toString().c_str());
-
-                                if (idCnt<=id)
-                                    idCnt=id+1;
-                            }
-                        }
-                    }
+                    map<int,Item>::iterator it=itemsMap.find(removed->get(i).asInt());
+                    if (it!=itemsMap.end())
+                        eraseItem(it);
                 }
             }
+
+            modifyRevision=content.get(1).asInt();
+        }
+        else
+        {
+            clear();
+
+            if (type!=BCTAG_EMPTY)
+            {
+                idCnt=0;
+                for (int i=(type==BCTAG_SNAPSHOT?2:1); i<content.size(); i++)
+                    putItem(content.get(i).asList());
+            }
+
+            modifyRevision=(type==BCTAG_SNAPSHOT?content.get(1).asInt():-1);
         }
 
         mutex.unlock();
@@ -1683,6 +2599,8 @@ public:
             dataBase.save();
             cnt=0;
         }
+        else if (dataBase.needsCompaction())
+            dataBase.compact();
 
         if (stats)
         {
@@ -1726,15 +2644,36 @@ int main(int argc, char *argv[])
         fprintf(stdout,"\t--context  <context>: context to search for database file (default: objectsPropertiesCollector)\n");
         fprintf(stdout,"\t--empty             : start an empty database\n");
         fprintf(stdout,"\t--nosave            : prevent from saving the content of database at shutdown\n");
+        fprintf(stdout,"\t--journal           : store the database as a binary journal of changes plus snapshots\n");
+        fprintf(stdout,"\t--journal_size  <MB>: compact the journal when it exceeds the given size (default: 16)\n");
         fprintf(stdout,"\t--verbose           : enable some verbosity\n");
         fprintf(stdout,"\t--sync_bc        <T>: broadcast the database content each T seconds\n");
         fprintf(stdout,"\t--async_bc          : broadcast the database content whenever a change occurs\n");
+        fprintf(stdout,"\t--delta_bc          : broadcast only the changes, with a snapshot periodically and to every new listener\n");
+        fprintf(stdout,"\t--snapshot_period <T>: in delta mode, broadcast a snapshot at least each T seconds (default: 5.0)\n");
         fprintf(stdout,"\t--stats             : enable statistics printouts\n");
+        fprintf(stdout,"\t--index  \"(<p0> ...)\": maintain indexes over the given properties to speed up queries\n");
+        fprintf(stdout,"\t--benchmark      <N>: measure the queries latency over N synthetic items and quit\n");
         fprintf(stdout,"\n");
 
         return 0;
     }
 
+    if (rf.check("benchmark"))
+    {
+        Bottle defaultIndexes("entity x y name");
+        Bottle *indexes=rf.find("index").asList();
+
+        int nItems=rf.find("benchmark").asInt();
+        if (nItems<=0)
+            nItems=10000;
+
+        DataBase dataBase;
+        dataBase.setIndexes(indexes!=NULL?*indexes:defaultIndexes);
+        dataBase.benchmark(nItems,rf.check("repetitions",Value(100)).asInt());
+        return 0;
+    }
+
     Network yarp;
     if (!yarp.checkNetwork())
     {
@@ -31,6 +31,7 @@
 #endif
 
 #include <iCub/pf3dTrackerSupport.hpp>
+#include <iCub/pf3dTrackerLikelihood.hpp>
 
 //for tracking in the iCub: 1000 particles and an stDev of 80 work well with slow movements of the ball. the localization is quite stable. the shape model has a 20% difference wrt the real radius.
 //#define _nParticles 5000
@@ -116,12 +117,15 @@ double _attentionOutputDecrease;
 CvRNG rngState; //something needed by the random number generator
 bool _doneInitializing;
 
-Lut*   _lut;
+const Lut* _lut;
+LutCache _lutCache;
 CvMat* _A;
 int _nParticles;
 float _accelStDev;
 float _inside_outside_difference_weight;
 int _colorTransfPolicy;
+int _likelihoodThreads; //0 means the particles are evaluated one by one, otherwise the batch engine is used with this many threads.
+PF3DLikelihoodEngine* _likelihoodEngine;
 
 //float _modelHistogram[YBins][UBins][VBins]; //data
 CvMatND* _modelHistogramMat; //OpenCV Matrix
@@ -0,0 +1,121 @@
+/**
+* Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+* CopyPolicy: Released under the terms of the GNU GPL v2.0.
+*/
+
+//Batch likelihood evaluation for the particles of PF3DTracker.
+//
+//The particles are evaluated in blocks: the shape model is kept as three
+//contiguous arrays (X, Y and Z of every model point), each hypothesis is
+//obtained with a single rototranslation followed by the perspective
+//projection, written as plain loops over contiguous arrays. The blocks are
+//spread over a pool of threads; every thread owns its scratch memory,
+//therefore the result does not depend on the number of threads.
+
+#ifndef _PF3DTRACKERLIKELIHOOD_
+#define _PF3DTRACKERLIKELIHOOD_
+
+#include <vector>
+
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
+
+#ifdef _CH_
+#pragma package <opencv>
+#endif
+#ifndef _EiC
+#include "cv.h"
+#endif
+
+#include <iCub/pf3dTrackerSupport.hpp>
+
+
+class PF3DLikelihoodEngine;
+
+
+//memory used by one thread while evaluating its particles.
+struct PF3DLikelihoodScratch
+{
+    std::vector<float> u;
+    std::vector<float> v;
+    std::vector<float> innerHistogram;
+    std::vector<float> outerHistogram;
+};
+
+
+//worker thread evaluating a contiguous range of particles.
+class PF3DLikelihoodWorker : public yarp::os::Thread
+{
+private:
+    PF3DLikelihoodEngine *_engine;
+    PF3DLikelihoodScratch _scratch;
+    yarp::os::Semaphore _go;
+    yarp::os::Semaphore _done;
+    int _first;
+    int _last;
+
+public:
+    PF3DLikelihoodWorker(PF3DLikelihoodEngine *engine);
+
+    void post(int first, int last);
+    void wait();
+
+    virtual void run();
+    virtual void onStop();
+};
+
+
+class PF3DLikelihoodEngine
+{
+private:
+    //shape model, as structure of arrays.
+    int _nPoints;    //number of inner points (the outer ones follow).
+    std::vector<float> _modelX;
+    std::vector<float> _modelY;
+    std::vector<float> _modelZ;
+
+    //square root of the template histogram, flattened.
+    int _nBins;
+    int _binStepY;
+    int _binStepU;
+    std::vector<float> _sqrtTemplate;
+
+    float _insideOutside;
+    float _fx, _fy, _cx, _cy;
+    const Lut *_lut;
+
+    //data of the current evaluation.
+    const float *_x;
+    const float *_y;
+    const float *_z;
+    float *_likelihood;
+    IplImage *_image;
+    bool _fromRgb;
+
+    PF3DLikelihoodScratch _scratch;
+    std::vector<PF3DLikelihoodWorker*> _workers;
+
+    void evaluateRange(int first, int last, PF3DLikelihoodScratch &scratch);
+
+    friend class PF3DLikelihoodWorker;
+
+public:
+    //model3dPointsMat: the shape model, [3 x 2*nPoints], inner points first.
+    //modelHistogramMat: the colour template, [YBins x UBins x VBins].
+    //lut: the rgb->yuv-bins look up table, used by evaluate() when fromRgb is true.
+    //nThreads: the overall number of threads, including the caller.
+    PF3DLikelihoodEngine(CvMat *model3dPointsMat, CvMatND *modelHistogramMat, float insideOutside, const Lut *lut, int nThreads);
+    ~PF3DLikelihoodEngine();
+
+    void setCamera(float fx, float fy, float cx, float cy);
+
+    int getNumThreads() const { return (int)_workers.size()+1; }
+
+    //evaluate the likelihood of all the particles, which are the columns
+    //of the [7 x nParticles] matrix: the first three rows are read, the
+    //likelihood is written on the seventh one.
+    //image is either the yuv-bins image or the rgb image, according to fromRgb.
+    void evaluate(CvMat *particles, IplImage *image, bool fromRgb);
+};
+
+#endif /* _PF3DTRACKERLIKELIHOOD_ */
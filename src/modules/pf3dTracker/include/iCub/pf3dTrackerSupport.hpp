@@ -22,11 +22,48 @@
 #include "highgui.h"
 #endif
 
-struct Lut
+//the look up table maps every rgb triplet (at index r*65536+g*256+b) to its
+//yuv bins, packed in one byte: Y in the two most significant bits, then U and V.
+typedef unsigned char Lut;
+
+#define LUT_SIZE (256*256*256)
+
+//bump this whenever rgbToYuvBin() changes, so that stale cache files are rebuilt.
+#define LUT_VERSION 1
+
+inline int lutY(Lut lut) { return lut>>6;    }
+inline int lutU(Lut lut) { return (lut>>3)&7; }
+inline int lutV(Lut lut) { return lut&7;      }
+
+//look up table stored on disk and memory-mapped read-only, so that it is
+//computed only once and shared among all the trackers running on the machine.
+class LutCache
 {
-  int y;
-  int u;
-  int v;
+private:
+    std::string _fileName;
+    Lut  *_heapLut;    //used when the cache is not available.
+    void *_mapAddress;
+    size_t _mapSize;
+#ifdef WIN32
+    void *_fileHandle;
+    void *_mapHandle;
+#endif
+
+    bool write();
+    bool map();
+
+public:
+    LutCache();
+    ~LutCache();
+
+    //look for the cache file in the given directory, create it if missing
+    //or stale, and return the table. if the directory is empty or the cache
+    //cannot be used, the table is computed in memory.
+    const Lut *open(const std::string &dir);
+    void close();
+
+    bool isMapped() const { return _mapAddress!=NULL; }
+    const std::string &getFileName() const { return _fileName; }
 };
 
 int printMatrix(float *matrix, int matrixColumns, int matrixRows);
@@ -35,7 +72,7 @@ void rgbToYuvBin(int &R, int &G, int &B, int &YBin, int &UBin, int &VBin);
 
 void rgbToYuvBinImage(IplImage *image,IplImage *yuvBinsImage);
 
-void rgbToYuvBinImageLut(IplImage *image,IplImage *yuvBinsImage, Lut *lut);
+void rgbToYuvBinImageLut(IplImage *image,IplImage *yuvBinsImage, const Lut *lut);
 
 void setPixel(int u, int v, int r, int g, int b, IplImage *image);
 
@@ -128,15 +128,8 @@ bool PF3DTracker::open(Searchable& config)
 
     quit=false;
     _saveImagesWithOpencv=false;
+    _likelihoodEngine=NULL;
 
-    _lut = new Lut[256*256*256];
-    //create the look up table lut
-    //this shouldn't be done every time
-    //TOBEDONE: write the lut on a file and read it back.
-    fillLut(_lut);
-
-    srand((unsigned int)time(0)); //make sure random numbers are really random.
-    rngState = cvRNG(rand());
 
     //allocate some memory and initialize some data structures for colour histograms.
     int dimensions;
@@ -281,6 +274,35 @@ bool PF3DTracker::open(Searchable& config)
         quit=true; //stop the execution, after checking all the parameters.
     }
 
+    //the look up table is computed once and then mapped from the cache file, if a directory is given.
+    string lutCacheDir = botConfig.check("lutCacheDir",
+                                    Value(""),
+                                    "Directory of the colour look up table cache file (string)").asString().c_str();
+    _lut = _lutCache.open(lutCacheDir);
+    if(_lutCache.isMapped())
+    {
+        cout<<"Using the colour look up table cached in "<<_lutCache.getFileName()<<endl;
+    }
+
+    _likelihoodThreads = botConfig.check("likelihoodThreads",
+                                    Value("0"),
+                                    "Number of threads evaluating the likelihood, 0 for the particle-by-particle evaluation (int)").asInt();
+    if(_likelihoodThreads<0)
+    {
+        _likelihoodThreads=0;
+    }
+
+    //a fixed seed makes the whole tracking reproducible, given the same image sequence.
+    if(botConfig.check("randomSeed"))
+    {
+        srand((unsigned int)botConfig.find("randomSeed").asInt());
+    }
+    else
+    {
+        srand((unsigned int)time(0)); //make sure random numbers are really random.
+    }
+    rngState = cvRNG(rand());
+
     _inside_outside_difference_weight = (float)botConfig.check("insideOutsideDiffWeight",
                                     Value("1.5"),
                                     "Inside-outside difference weight in the likelihood function (double)").asDouble();
@@ -671,6 +693,14 @@ bool PF3DTracker::open(Searchable& config)
 
 
 
+    //the colour transformation policy has been validated above, both the
+    //likelihood engine and the particle-by-particle evaluation rely on it.
+    if(_likelihoodThreads>0 && !quit)
+    {
+        _likelihoodEngine=new PF3DLikelihoodEngine(_model3dPointsMat,_modelHistogramMat,_inside_outside_difference_weight,_lut,_likelihoodThreads);
+        _likelihoodEngine->setCamera(_perspectiveFx,_perspectiveFy,_perspectiveCx,_perspectiveCy);
+    }
+
     _framesNotTracking=0;
     _frameCounter=1;
     _attentionOutput=0;
@@ -712,6 +742,12 @@ bool PF3DTracker::close()
     _outputParticlePort.close();
     _outputAttentionPort.close();
 
+    delete _likelihoodEngine;
+    _likelihoodEngine=NULL;
+
+    _lutCache.close();
+    _lut=NULL;
+
     cvReleaseMat(&_A);
     cvReleaseMat(&_particles);
     cvReleaseMat(&_newParticles);
@@ -767,33 +803,51 @@ bool PF3DTracker::updateModule()
         float sumLikelihood=0.0;
         float maxLikelihood=0.0;
         int   maxIndex=-1;
-        for(count=0;count< _nParticles;count++)
+        if(_likelihoodEngine!=NULL)
         {
+            //all the particles at once, the likelihood goes straight into the seventh row.
             if(_colorTransfPolicy==0)
             {
-                  evaluateHypothesisPerspective(_model3dPointsMat,(float)cvmGet(_particles,0,count),(float)cvmGet(_particles,1,count),(float)cvmGet(_particles,2,count),_modelHistogramMat,_transformedImage,_perspectiveFx,_perspectiveFy, _perspectiveCx,_perspectiveCy,_inside_outside_difference_weight,likelihood);
+                _likelihoodEngine->evaluate(_particles,_transformedImage,false);
             }
-            else
+            else //policy 1, any other value is rejected in open().
             {
-                if(_colorTransfPolicy==1)
+                _likelihoodEngine->evaluate(_particles,_rawImage,true);
+            }
+
+            float *weights=(float*)(_particles->data.ptr + _particles->step*6);
+            for(count=0;count< _nParticles;count++)
+            {
+                sumLikelihood+=weights[count];
+                if(weights[count]>maxLikelihood)
                 {
-                  //TEST
-                  //cout<<"count= "<<count<<endl;
-                  evaluateHypothesisPerspectiveFromRgbImage(_model3dPointsMat,(float)cvmGet(_particles,0,count),(float)cvmGet(_particles,1,count),(float)cvmGet(_particles,2,count),_modelHistogramMat,_rawImage,_perspectiveFx,_perspectiveFy, _perspectiveCx,_perspectiveCy,_inside_outside_difference_weight,likelihood);
+                    maxLikelihood=weights[count];
+                    maxIndex=count;
                 }
-                else
+            }
+        }
+        else
+        {
+            for(count=0;count< _nParticles;count++)
+            {
+                if(_colorTransfPolicy==0)
                 {
-                    cout<<"Wrong ID for color transformation policy:"<<_colorTransfPolicy<<". Quitting.\n";
-                    return false;
+                      evaluateHypothesisPerspective(_model3dPointsMat,(float)cvmGet(_particles,0,count),(float)cvmGet(_particles,1,count),(float)cvmGet(_particles,2,count),_modelHistogramMat,_transformedImage,_perspectiveFx,_perspectiveFy, _perspectiveCx,_perspectiveCy,_inside_outside_difference_weight,likelihood);
+                }
+                else //policy 1, any other value is rejected in open().
+                {
+                      //TEST
+                      //cout<<"count= "<<count<<endl;
+                      evaluateHypothesisPerspectiveFromRgbImage(_model3dPointsMat,(float)cvmGet(_particles,0,count),(float)cvmGet(_particles,1,count),(float)cvmGet(_particles,2,count),_modelHistogramMat,_rawImage,_perspectiveFx,_perspectiveFy, _perspectiveCx,_perspectiveCy,_inside_outside_difference_weight,likelihood);
                 }
-            }
     
-            cvmSet(_particles,6,count,likelihood);
-            sumLikelihood+=likelihood;
-            if(likelihood>maxLikelihood)
-            {
-                maxLikelihood=likelihood;
-                maxIndex=count;
+                cvmSet(_particles,6,count,likelihood);
+                sumLikelihood+=likelihood;
+                if(likelihood>maxLikelihood)
+                {
+                    maxLikelihood=likelihood;
+                    maxIndex=count;
+                }
             }
         }
     
@@ -2185,7 +2239,7 @@ bool PF3DTracker::computeHistogramFromRgbImage(CvMat* uv, IplImage *image,  CvMa
             b=(((uchar*)(image->imageData + image->widthStep*v))[u*3+2]);
             index=r*65536+g*256+b;
             //increase the bin counter
-            *((float*)(innerHistogramMat->data.ptr + _lut[index].y*innerHistogramMat->dim[0].step + _lut[index].u*innerHistogramMat->dim[1].step + _lut[index].v*innerHistogramMat->dim[2].step)) +=1;
+            *((float*)(innerHistogramMat->data.ptr + lutY(_lut[index])*innerHistogramMat->dim[0].step + lutU(_lut[index])*innerHistogramMat->dim[1].step + lutV(_lut[index])*innerHistogramMat->dim[2].step)) +=1;
             //used to be: innerHistogram[_lut[index].y][_lut[index].u][_lut[index].v]+=1; //increment the correct bin counter.
             usedInnerPoints+=1;
         }
@@ -2217,7 +2271,7 @@ bool PF3DTracker::computeHistogramFromRgbImage(CvMat* uv, IplImage *image,  CvMa
             b=(((uchar*)(image->imageData + image->widthStep*v))[u*3+2]);
             index=r*65536+g*256+b;
             //increase the bin counter
-            *((float*)(outerHistogramMat->data.ptr + _lut[index].y*outerHistogramMat->dim[0].step + _lut[index].u*outerHistogramMat->dim[1].step + _lut[index].v*outerHistogramMat->dim[2].step)) +=1;
+            *((float*)(outerHistogramMat->data.ptr + lutY(_lut[index])*outerHistogramMat->dim[0].step + lutU(_lut[index])*outerHistogramMat->dim[1].step + lutV(_lut[index])*outerHistogramMat->dim[2].step)) +=1;
             //used to be: outerHistogram[_lut[index].y][_lut[index].u][_lut[index].v]+=1; //increment the correct bin counter.
             usedOuterPoints+=1;
         }
@@ -0,0 +1,280 @@
+/**
+*
+* Batch likelihood evaluation of the 3d position tracker implementing the particle filter.
+* See \ref icub_pf3dtracker \endref
+*
+* Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+*
+* CopyPolicy: Released under the terms of the GNU GPL v2.0.
+*
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <iCub/pf3dTrackerLikelihood.hpp>
+
+using namespace std;
+using namespace yarp::os;
+
+
+
+PF3DLikelihoodWorker::PF3DLikelihoodWorker(PF3DLikelihoodEngine *engine) : _engine(engine), _go(0), _done(0)
+{
+    _scratch=engine->_scratch;
+    _first=_last=0;
+}
+
+
+
+void PF3DLikelihoodWorker::post(int first, int last)
+{
+    _first=first;
+    _last=last;
+    _go.post();
+}
+
+
+
+void PF3DLikelihoodWorker::wait()
+{
+    _done.wait();
+}
+
+
+
+void PF3DLikelihoodWorker::run()
+{
+    while(!isStopping())
+    {
+        _go.wait();
+        if(isStopping())
+            break;
+
+        _engine->evaluateRange(_first,_last,_scratch);
+        _done.post();
+    }
+}
+
+
+
+void PF3DLikelihoodWorker::onStop()
+{
+    _go.post();
+}
+
+
+
+PF3DLikelihoodEngine::PF3DLikelihoodEngine(CvMat *model3dPointsMat, CvMatND *modelHistogramMat, float insideOutside, const Lut *lut, int nThreads)
+{
+    int count, a, b, c;
+
+    //copy the shape model into contiguous arrays.
+    _nPoints=model3dPointsMat->cols/2;
+    _modelX.resize(2*_nPoints);
+    _modelY.resize(2*_nPoints);
+    _modelZ.resize(2*_nPoints);
+    for(count=0;count<2*_nPoints;count++)
+    {
+        _modelX[count]=((float*)(model3dPointsMat->data.ptr + model3dPointsMat->step*0))[count];
+        _modelY[count]=((float*)(model3dPointsMat->data.ptr + model3dPointsMat->step*1))[count];
+        _modelZ[count]=((float*)(model3dPointsMat->data.ptr + model3dPointsMat->step*2))[count];
+    }
+
+    //flatten the template histogram, storing its square root once and for all.
+    int YBinsNum=modelHistogramMat->dim[0].size;
+    int UBinsNum=modelHistogramMat->dim[1].size;
+    int VBinsNum=modelHistogramMat->dim[2].size;
+    _binStepU=VBinsNum;
+    _binStepY=UBinsNum*VBinsNum;
+    _nBins=YBinsNum*_binStepY;
+    _sqrtTemplate.resize(_nBins);
+    for(a=0;a<YBinsNum;a++)
+        for(b=0;b<UBinsNum;b++)
+            for(c=0;c<VBinsNum;c++)
+                _sqrtTemplate[a*_binStepY+b*_binStepU+c]=sqrt(*((float*)(modelHistogramMat->data.ptr + a*modelHistogramMat->dim[0].step + b*modelHistogramMat->dim[1].step + c*modelHistogramMat->dim[2].step)));
+
+    _insideOutside=insideOutside;
+    _lut=lut;
+    _fx=_fy=1.0F;
+    _cx=_cy=0.0F;
+
+    _x=_y=_z=NULL;
+    _likelihood=NULL;
+    _image=NULL;
+    _fromRgb=false;
+
+    _scratch.u.resize(2*_nPoints);
+    _scratch.v.resize(2*_nPoints);
+    _scratch.innerHistogram.resize(_nBins);
+    _scratch.outerHistogram.resize(_nBins);
+
+    //the caller thread takes care of the first range of particles.
+    for(count=1;count<nThreads;count++)
+    {
+        PF3DLikelihoodWorker *worker=new PF3DLikelihoodWorker(this);
+        worker->start();
+        _workers.push_back(worker);
+    }
+}
+
+
+
+PF3DLikelihoodEngine::~PF3DLikelihoodEngine()
+{
+    for(size_t count=0;count<_workers.size();count++)
+    {
+        _workers[count]->stop();
+        delete _workers[count];
+    }
+}
+
+
+
+void PF3DLikelihoodEngine::setCamera(float fx, float fy, float cx, float cy)
+{
+    _fx=fx;
+    _fy=fy;
+    _cx=cx;
+    _cy=cy;
+}
+
+
+
+void PF3DLikelihoodEngine::evaluate(CvMat *particles, IplImage *image, bool fromRgb)
+{
+    int nParticles=particles->cols;
+
+    _x=(float*)(particles->data.ptr + particles->step*0);
+    _y=(float*)(particles->data.ptr + particles->step*1);
+    _z=(float*)(particles->data.ptr + particles->step*2);
+    _likelihood=(float*)(particles->data.ptr + particles->step*6);
+    _image=image;
+    _fromRgb=fromRgb;
+
+    //split the particles in as many contiguous ranges as the threads.
+    int nThreads=getNumThreads();
+    int rangeSize=nParticles/nThreads;
+    int firstSize=nParticles-rangeSize*(int)_workers.size();
+
+    for(size_t count=0;count<_workers.size();count++)
+    {
+        int first=firstSize+(int)count*rangeSize;
+        _workers[count]->post(first,first+rangeSize);
+    }
+
+    evaluateRange(0,firstSize,_scratch);
+
+    for(size_t count=0;count<_workers.size();count++)
+        _workers[count]->wait();
+}
+
+
+
+void PF3DLikelihoodEngine::evaluateRange(int first, int last, PF3DLikelihoodScratch &scratch)
+{
+    const float *modelX=&_modelX[0];
+    const float *modelY=&_modelY[0];
+    const float *modelZ=&_modelZ[0];
+    const float *sqrtTemplate=&_sqrtTemplate[0];
+    float *u=&scratch.u[0];
+    float *v=&scratch.v[0];
+    float *innerHistogram=&scratch.innerHistogram[0];
+    float *outerHistogram=&scratch.outerHistogram[0];
+
+    int nPoints2=2*_nPoints;
+    int width=_image->width;
+    int height=_image->height;
+    int count, particle;
+
+    for(particle=first;particle<last;particle++)
+    {
+        float x=_x[particle];
+        float y=_y[particle];
+        float z=_z[particle];
+
+        //**************************************************
+        //ROTOTRANSLATE AND PROJECT THE 3D POINTS IN ONE GO.
+        //**************************************************
+        //same transformation as place3dPointsPerspective(): Rz*(Ry*p+[floorDistance 0 z]'),
+        //which boils down to (Rz*Ry)*p+[x y z]'.
+        float floorDistance=sqrt(x*x+y*y);
+        float distance=sqrt(x*x+y*y+z*z);
+        float cosAlpha=floorDistance/distance;
+        float sinAlpha=-z/distance;
+        float cosBeta=x/floorDistance;
+        float sinBeta=y/floorDistance;
+
+        float r00=cosBeta*cosAlpha,  r01=-sinBeta, r02=cosBeta*sinAlpha;
+        float r10=sinBeta*cosAlpha,  r11= cosBeta, r12=sinBeta*sinAlpha;
+        float r20=-sinAlpha,                       r22=cosAlpha;
+
+        for(count=0;count<nPoints2;count++)
+        {
+            float X=r00*modelX[count]+r01*modelY[count]+r02*modelZ[count]+x;
+            float Y=r10*modelX[count]+r11*modelY[count]+r12*modelZ[count]+y;
+            float Z=r20*modelX[count]                  +r22*modelZ[count]+z;
+            u[count]=_fx*X/Z+_cx;
+            v[count]=_fy*Y/Z+_cy;
+        }
+
+        //***************************************
+        //ACCUMULATE THE INNER AND OUTER HISTOGRAMS
+        //***************************************
+        float usedInnerPoints=0.0F;
+        float usedOuterPoints=0.0F;
+        fill(innerHistogram,innerHistogram+_nBins,0.0F);
+        fill(outerHistogram,outerHistogram+_nBins,0.0F);
+
+        for(count=0;count<nPoints2;count++)
+        {
+            int iu=(int)u[count]; //truncating, as computeHistogram() does.
+            int iv=(int)v[count];
+            if((iv<height)&&(iv>=0)&&(iu<width)&&(iu>=0))
+            {
+                uchar *pixel=(uchar*)(_image->imageData + _image->widthStep*iv) + iu*3;
+                int bin;
+                if(_fromRgb)
+                {
+                    Lut lut=_lut[pixel[0]*65536+pixel[1]*256+pixel[2]];
+                    bin=lutY(lut)*_binStepY+lutU(lut)*_binStepU+lutV(lut);
+                }
+                else
+                    bin=pixel[0]*_binStepY+pixel[1]*_binStepU+pixel[2];
+
+                if(count<_nPoints)
+                {
+                    innerHistogram[bin]+=1.0F;
+                    usedInnerPoints+=1.0F;
+                }
+                else
+                {
+                    outerHistogram[bin]+=1.0F;
+                    usedOuterPoints+=1.0F;
+                }
+            }
+        }
+
+        //********************************************
+        //COMPUTE THE LIKELIHOOD (see calculateLikelihood)
+        //********************************************
+        float innerScale=(usedInnerPoints>0.0F)?1.0F/usedInnerPoints:0.0F;
+        float outerScale=(usedOuterPoints>0.0F)?1.0F/usedOuterPoints:0.0F;
+        float similarity=0.0F;
+        float difference=0.0F;
+        for(count=0;count<_nBins;count++)
+        {
+            similarity+=sqrt(innerHistogram[count])*sqrtTemplate[count];
+            difference+=sqrt(outerHistogram[count]*innerHistogram[count]);
+        }
+
+        float likelihood=similarity*sqrt(innerScale)-_insideOutside*difference*sqrt(innerScale*outerScale);
+        likelihood=(likelihood+_insideOutside)/(1+_insideOutside);
+        likelihood=exp(20*likelihood); //no need to divide: the normalization happens later.
+
+        //make hypotheses with pixels outside the image less likely.
+        float innerRatio=usedInnerPoints/_nPoints;
+        float outerRatio=usedOuterPoints/_nPoints;
+        _likelihood[particle]=likelihood*innerRatio*innerRatio*outerRatio*outerRatio;
+    }
+}
@@ -50,6 +50,11 @@ an example, with comments:
  #insideOutsideDiffWeight    inside-outside difference weight for the likelihood function
  colorTransfPolicy           1
  #colorTransfPolicy          [0=transform the whole image | 1=only transform the pixels you need]
+ likelihoodThreads           4
+ #likelihoodThreads          [0=evaluate the particles one by one | N=evaluate them in batch, using N threads] default 0.
+ #randomSeed                 fixes the seed of the random number generators, making the tracking reproducible. not set by default.
+ #lutCacheDir                directory of the file caching the colour look up table, shared by all the trackers of the machine.
+ #                           not set by default, which keeps the table in memory; the directory should be writable by its owner only.
  
  
  #########################
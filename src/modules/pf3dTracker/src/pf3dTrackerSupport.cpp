@@ -13,8 +13,49 @@
 
 #include <iCub/pf3dTrackerSupport.hpp>
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef WIN32
+    #include <windows.h>
+    #include <process.h>
+    #include <io.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #define getpid _getpid
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
 using namespace std;
 
+//header of the cache file, the table follows.
+struct LutFileHeader
+{
+    char magic[8];
+    int  version;
+    int  yBins;
+    int  uBins;
+    int  vBins;
+    int  size;
+    int  reserved;
+};
+
+static void fillLutFileHeader(LutFileHeader &header)
+{
+    memset(&header,0,sizeof(header));
+    strncpy(header.magic,"PF3DLUT",sizeof(header.magic));
+    header.version=LUT_VERSION;
+    header.yBins=4;
+    header.uBins=8;
+    header.vBins=8;
+    header.size=LUT_SIZE;
+}
+
 std::string itos(int i)  // convert int to string
 {
     std::stringstream s;
@@ -113,13 +154,191 @@ void fillLut(Lut *lut)
             {
                 rgbToYuvBin(r,g,b, y,u,v);
                 index=r*65536+g*256+b;
-                lut[index].y=y;
-                lut[index].u=u;
-                lut[index].v=v;
+                lut[index]=(Lut)((y<<6)|(u<<3)|v);
             }
 }
 
-void rgbToYuvBinImageLut(IplImage *image,IplImage *transformedImage, Lut *lut)
+LutCache::LutCache()
+{
+    _heapLut=NULL;
+    _mapAddress=NULL;
+    _mapSize=0;
+#ifdef WIN32
+    _fileHandle=NULL;
+    _mapHandle=NULL;
+#endif
+}
+
+LutCache::~LutCache()
+{
+    close();
+}
+
+const Lut *LutCache::open(const std::string &dir)
+{
+    close();
+
+    //the cache is used only on request: a shared directory such as /tmp
+    //would let anybody else plant the table.
+    if(!dir.empty())
+    {
+        //the name carries the key of the table.
+        _fileName=dir+"/pf3dTrackerLut_v"+itos(LUT_VERSION)+"_Y4U8V8.bin";
+
+        if(map())
+            return (const Lut*)((char*)_mapAddress+sizeof(LutFileHeader));
+
+        if(write() && map())
+            return (const Lut*)((char*)_mapAddress+sizeof(LutFileHeader));
+
+        std::cout<<"LutCache::open - unable to use the cache file "<<_fileName<<", the look up table is kept in memory.\n";
+    }
+    else
+        _fileName.clear();
+
+    _heapLut=new Lut[LUT_SIZE];
+    fillLut(_heapLut);
+    return _heapLut;
+}
+
+bool LutCache::write()
+{
+    //write to a private file first and rename it afterwards, so that
+    //other trackers never get to see a partially written table.
+    //an existing file is never followed nor reused, it might not be ours.
+    string tmpFileName=_fileName+"."+itos((int)getpid())+".tmp";
+#ifdef WIN32
+    int fd=_open(tmpFileName.c_str(),_O_CREAT|_O_EXCL|_O_WRONLY|_O_BINARY,_S_IREAD|_S_IWRITE);
+    FILE *fout=(fd>=0)?_fdopen(fd,"wb"):NULL;
+#else
+    int fd=::open(tmpFileName.c_str(),O_CREAT|O_EXCL|O_WRONLY,0600);
+    FILE *fout=(fd>=0)?fdopen(fd,"wb"):NULL;
+#endif
+    if(fout==NULL)
+    {
+        if(fd>=0)
+        {
+        #ifdef WIN32
+            _close(fd);
+        #else
+            ::close(fd);
+        #endif
+            remove(tmpFileName.c_str());
+        }
+        return false;
+    }
+
+    Lut *lut=new Lut[LUT_SIZE];
+    fillLut(lut);
+
+    LutFileHeader header;
+    fillLutFileHeader(header);
+    bool ok=(fwrite(&header,sizeof(header),1,fout)==1) &&
+            (fwrite(lut,sizeof(Lut),LUT_SIZE,fout)==LUT_SIZE);
+    ok&=(fclose(fout)==0);
+    delete[] lut;
+
+    if(ok)
+    {
+        //on failure, somebody else may have just created the very same file.
+        if(rename(tmpFileName.c_str(),_fileName.c_str())!=0)
+            remove(tmpFileName.c_str());
+    }
+    else
+        remove(tmpFileName.c_str());
+
+    return ok;
+}
+
+bool LutCache::map()
+{
+    size_t size=sizeof(LutFileHeader)+LUT_SIZE*sizeof(Lut);
+    void *address=NULL;
+
+#ifdef WIN32
+    HANDLE fileHandle=CreateFileA(_fileName.c_str(),GENERIC_READ,FILE_SHARE_READ|FILE_SHARE_DELETE,
+                                  NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+    if(fileHandle==INVALID_HANDLE_VALUE)
+        return false;
+
+    if(GetFileSize(fileHandle,NULL)!=size)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mapHandle=CreateFileMappingA(fileHandle,NULL,PAGE_READONLY,0,0,NULL);
+    if(mapHandle!=NULL)
+        address=MapViewOfFile(mapHandle,FILE_MAP_READ,0,0,0);
+
+    if(address==NULL)
+    {
+        if(mapHandle!=NULL)
+            CloseHandle(mapHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    _fileHandle=fileHandle;
+    _mapHandle=mapHandle;
+#else
+    int fd=::open(_fileName.c_str(),O_RDONLY);
+    if(fd<0)
+        return false;
+
+    //the table is trusted as it is: only a regular file of ours, that
+    //nobody else can write, is good.
+    struct stat info;
+    if((fstat(fd,&info)!=0) || !S_ISREG(info.st_mode) || (info.st_uid!=geteuid()) ||
+       ((info.st_mode&(S_IWGRP|S_IWOTH))!=0) || ((size_t)info.st_size!=size))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    address=mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0);
+    ::close(fd);    //the mapping stays valid.
+    if(address==MAP_FAILED)
+        return false;
+#endif
+
+    _mapAddress=address;
+    _mapSize=size;
+
+    //check that the file holds the table we expect.
+    LutFileHeader header;
+    fillLutFileHeader(header);
+    if(memcmp(_mapAddress,&header,sizeof(header))!=0)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void LutCache::close()
+{
+    if(_mapAddress!=NULL)
+    {
+    #ifdef WIN32
+        UnmapViewOfFile(_mapAddress);
+        CloseHandle((HANDLE)_mapHandle);
+        CloseHandle((HANDLE)_fileHandle);
+        _mapHandle=NULL;
+        _fileHandle=NULL;
+    #else
+        munmap(_mapAddress,_mapSize);
+    #endif
+        _mapAddress=NULL;
+        _mapSize=0;
+    }
+
+    delete[] _heapLut;
+    _heapLut=NULL;
+}
+
+void rgbToYuvBinImageLut(IplImage *image,IplImage *transformedImage, const Lut *lut)
 {
     int a1,a2,r,g,b;
     int index;
@@ -131,15 +350,15 @@ void rgbToYuvBinImageLut(IplImage *image,IplImage *transformedImage, Lut *lut)
         g=(((uchar*)(image->imageData + image->widthStep*a2))[a1*3+1]);
         b=(((uchar*)(image->imageData + image->widthStep*a2))[a1*3+2]);
         index=r*65536+g*256+b;
-        (((uchar*)(transformedImage->imageData + transformedImage->widthStep*a2))[a1*3+0])=lut[index].y;
-        (((uchar*)(transformedImage->imageData + transformedImage->widthStep*a2))[a1*3+1])=lut[index].u;
-        (((uchar*)(transformedImage->imageData + transformedImage->widthStep*a2))[a1*3+2])=lut[index].v;
+        (((uchar*)(transformedImage->imageData + transformedImage->widthStep*a2))[a1*3+0])=lutY(lut[index]);
+        (((uchar*)(transformedImage->imageData + transformedImage->widthStep*a2))[a1*3+1])=lutU(lut[index]);
+        (((uchar*)(transformedImage->imageData + transformedImage->widthStep*a2))[a1*3+2])=lutV(lut[index]);
         //rgbToYuvBin(r,g,b, yuvBinsImage[a1][a2][0], yuvBinsImage[a1][a2][1], yuvBinsImage[a1][a2][2]);
     }
 
 }
 
-void rgbToYuvBinLut(int &R, int &G, int &B, int &YBin, int &UBin, int &VBin, Lut *lut)
+void rgbToYuvBinLut(int &R, int &G, int &B, int &YBin, int &UBin, int &VBin, const Lut *lut)
 {
     //I copied the transformation from the wikipedia. WARNING ??? !!!
     float Y, U, V;
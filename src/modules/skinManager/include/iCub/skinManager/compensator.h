@@ -39,6 +39,7 @@
 #include "iCub/skinDynLib/skinContact.h"
 #include "iCub/skinDynLib/skinContactList.h"
 #include "iCub/skinDynLib/rpcSkinManager.h"
+#include "iCub/skinDynLib/skinFrame.h"
 
 using namespace std;
 using namespace yarp::os; 
@@ -55,6 +56,7 @@ class Compensator
 private:
 	/* class constants */
     static const int MAX_READ_ERROR = 100;      // max number of read errors before suspending the compensator
+    static const int MAX_KEY_FRAME_LOST = 3;    // key frames missed in a row before the compact input counts as silent
 	static const int MAX_SKIN = 255;            // max value you can read from the skin sensors
     static const int MIN_TOUCH_THR = 1;         // min value assigned to the touch thresholds (i.e. the 95% percentile)
 	static const double BIN_TOUCH;              // output value of the binarization filter when touch is detected
@@ -120,10 +122,18 @@ private:
     BufferedPort<Vector> inputPort;
     Stamp timestamp;    // timestamp of last data read from inputPort
 
+    // compact input: raw frames streamed only when they change (see skinFrame)
+    bool compactInput;                          // if true read the compact frames instead of the vectors
+    BufferedPort<skinFrame> frameInputPort;     // port receiving the full frames and the deltas
+    skinFrame inputFrame;                       // readings rebuilt from the received frames
+    double lastKeyFrameTime;                    // time the last full frame was received
+    double keyFramePeriod;                      // measured period of the full frames (0 until known)
+
 	
 	/* class private methods */	    
     bool init(string name, string robotName, string outputPortName, string inputPortName);
     bool readInputData(Vector& skin_values);
+    bool readInputFrame(Vector& skin_values);
     void sendInfoMsg(string msg);
     void computeNeighbors();
 	void updateNeighbors(unsigned int taxelId);
@@ -132,7 +142,7 @@ private:
 public:
 	Compensator(string name, string robotName, string outputPortName, string inputPortName, BufferedPort<Bottle>* _infoPort,
                          double _compensationGain, double _contactCompensationGain, int addThreshold, float _minBaseline, bool _zeroUpRawData, 
-                         bool _binarization, bool _smoothFilter, float _smoothFactor, unsigned int _linkId = 0);
+                         bool _binarization, bool _smoothFilter, float _smoothFactor, unsigned int _linkId = 0, bool _compactInput = false);
     ~Compensator();
 	    
 	void calibrationInit();
@@ -103,6 +103,9 @@ The following key-value pairs can be specified as command-line parameters by pre
     \t- y(t) = (1-alpha)*x(t) + alpha*y(t-1)
  - \c smoothFactor \c [0.5] \n
    alpha value of the smoothing filter, in [0, 1] where 0 is no smoothing at all and 1 is the max smoothing possible.
+ - \c compactInput \c [not active]\n
+   if specified the raw tactile data are read from the port "<inputPort>/compact:o", on which the skin wrapper streams
+   only the changed triangles (see skinFrame in skinDynLib); if that port is not available the input port is used.
 .
 An optional section called SKIN_EVENTS may be specified in the configuration file.
 These are the parameters of this section:
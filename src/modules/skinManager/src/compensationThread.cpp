@@ -92,6 +92,9 @@ bool CompensationThread::threadInit()
 		return false;
 	}
 	
+    // read the compact frames streamed by the skin wrappers instead of the vectors
+    bool compactInput = rf->check("compactInput");
+
     compensators.resize(portNum);
     compWorking.resize(portNum);
     compEnable.resize(portNum, true);
@@ -106,7 +109,7 @@ bool CompensationThread::threadInit()
         name<< moduleName<< i;
 		compensators[i] = new Compensator(name.str(), robotName, outputPortName, inputPortName, &infoPort,
                          compensationGain, contactCompensationGain, ADD_THRESHOLD, minBaseline, zeroUpRawData, binarization, 
-                         smoothFilter, smoothFactor);
+                         smoothFilter, smoothFactor, 0, compactInput);
         SKIN_DIM += compensators[i]->getNumTaxels();
 	}
 
@@ -35,12 +35,13 @@ const double Compensator::BIN_NO_TOUCH  = 0.0;
 
 Compensator::Compensator(string _name, string _robotName, string outputPortName, string inputPortName, BufferedPort<Bottle>* _infoPort, 
                          double _compensationGain, double _contactCompensationGain, int addThreshold, float _minBaseline, bool _zeroUpRawData, 
-                         bool _binarization, bool _smoothFilter, float _smoothFactor, unsigned int _linkNum)
+                         bool _binarization, bool _smoothFilter, float _smoothFactor, unsigned int _linkNum, bool _compactInput)
 									   : 
 										compensationGain(_compensationGain), contactCompensationGain(_contactCompensationGain),
                                             addThreshold(addThreshold), infoPort(_infoPort),
                                             minBaseline(_minBaseline), binarization(_binarization), smoothFilter(_smoothFilter), 
-                                            smoothFactor(_smoothFactor), robotName(_robotName), name(_name), linkNum(_linkNum)
+                                            smoothFactor(_smoothFactor), robotName(_robotName), name(_name), linkNum(_linkNum),
+                                            compactInput(_compactInput)
 {
     this->zeroUpRawData = _zeroUpRawData;
     _isWorking = init(_name, _robotName, outputPortName, inputPortName);
@@ -54,6 +55,8 @@ Compensator::~Compensator(){
 
     compensatedTactileDataPort.interrupt();
     compensatedTactileDataPort.close();
+    frameInputPort.interrupt();
+    frameInputPort.close();
 }
 
 bool Compensator::init(string name, string robotName, string outputPortName, string inputPortName){
@@ -96,7 +99,23 @@ bool Compensator::init(string name, string robotName, string outputPortName, str
         sendInfoMsg(msg.str());
 	    return false;
     }
-    if( !Network::connect(inputPortName.c_str(), localPortName.str().c_str()))
+
+    // the compact frames are streamed by the skin wrapper on <inputPort>/compact:o;
+    // every delta matters, hence the port must not drop any message
+    if(compactInput)
+    {
+        string framePortName = localPortName.str()+"_compact";
+        string remoteFramePortName = inputPortName+"/compact:o";
+        frameInputPort.setStrict();
+        if(!frameInputPort.open(framePortName.c_str()) || 
+           !Network::connect(remoteFramePortName.c_str(), framePortName.c_str()))
+        {
+            frameInputPort.close();
+            compactInput = false;
+            sendInfoMsg("Compact frames not available on "+remoteFramePortName+", reading the full vectors.");
+        }
+    }
+    if(!compactInput && !Network::connect(inputPortName.c_str(), localPortName.str().c_str()))
     {
         stringstream msg;
         msg<< "Problems trying to connect ports %s and %s."<< inputPortName.c_str()<< localPortName.str().c_str();
@@ -119,6 +138,8 @@ bool Compensator::init(string name, string robotName, string outputPortName, str
         skinDim = tactileSensor->getChannels();
 	}
     readErrorCounter = 0;
+    lastKeyFrameTime = 0.0;
+    keyFramePeriod = 0.0;
     rawData.resize(skinDim);
     baselines.resize(skinDim);
     touchThresholds.resize(skinDim);
@@ -275,6 +296,9 @@ void Compensator::calibrationFinish(){
 }
 
 bool Compensator::readInputData(Vector& skin_values){
+    if(compactInput)
+        return readInputFrame(skin_values);
+
     Vector *tmp=0;
     if((tmp=inputPort.read(false))==0){
         readErrorCounter++;
@@ -336,6 +360,52 @@ bool Compensator::readInputData(Vector& skin_values){
     return true;*/
 }
 
+bool Compensator::readInputFrame(Vector& skin_values){
+    // apply all the frames received since the last reading, in order
+    skinFrame *f=0;
+    while(frameInputPort.getPendingReads()>0 && (f=frameInputPort.read(false))!=0){
+        frameInputPort.getEnvelope(timestamp);
+        inputFrame.apply(*f);
+        if(f->isFull()){
+            double now = Time::now();
+            if(lastKeyFrameTime>0.0)
+                keyFramePeriod = max(keyFramePeriod, now-lastKeyFrameTime);
+            lastKeyFrameTime = now;
+        }
+    }
+
+    // unchanged readings are not streamed, so a quiet skin sends nothing
+    // but a full frame every key frame period: it is an error only if
+    // the frames cannot be applied or even the full frames stopped arriving
+    bool silent = keyFramePeriod>0.0 &&
+                  Time::now()-lastKeyFrameTime > MAX_KEY_FRAME_LOST*keyFramePeriod;
+    if(!inputFrame.isSynchronized() || silent){
+        readErrorCounter++;
+        if(readErrorCounter>MAX_READ_ERROR){
+            _isWorking = false;
+            sendInfoMsg("Too many errors in a row. Stopping the compensator.");
+        }
+        if(!inputFrame.isSynchronized())
+            return false;
+    }
+    else
+        readErrorCounter = 0;
+
+    if(inputFrame.size() != (int)skinDim){
+        readErrorCounter++;
+        sendInfoMsg("Unexpected size of the input frame (raw tactile data): "+toString(inputFrame.size()));
+        if(readErrorCounter>MAX_READ_ERROR){
+            _isWorking = false;
+            sendInfoMsg("Too many errors in a row. Stopping the compensator.");
+        }
+        return false;
+    }
+
+    // the readings are still the last ones if nothing arrived
+    inputFrame.toVector(skin_values);
+    return true;
+}
+
 bool Compensator::readRawAndWriteCompensatedData(){    
     if(!readInputData(rawData))
         return false;
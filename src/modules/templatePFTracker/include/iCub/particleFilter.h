@@ -40,6 +40,8 @@
 #include <iostream>
 #include <iomanip>
 #include <deque>
+#include <vector>
+#include <algorithm>
 
 #include <cv.h>
 #include <highgui.h>
@@ -85,6 +87,26 @@ typedef struct TemplateStruct
 int particle_cmp( const void* p1, const void* p2 );
 
 
+class PARTICLEThread;
+
+/* worker evaluating the likelihood of a contiguous range of particles */
+class PARTICLEWorker : public yarp::os::Thread 
+{
+private:
+    PARTICLEThread      *owner;
+    yarp::os::Semaphore go, done;
+    int first, last;
+
+public:
+    PARTICLEWorker(PARTICLEThread *owner);
+
+    void post(int first, int last);
+    void wait();
+    void run();
+    void onStop();
+};
+
+
 class PARTICLEThread : public yarp::os::Thread 
 {
 public:
@@ -172,6 +194,17 @@ private:
 	histogram** ref_histos;
 	particle* particles, * new_particles;    
 
+    /* integral histogram of the current frame: for each (row,col) corner
+       the count of each bin over the rectangle [0,row)x[0,col) */
+    bool useIntegral;
+    int numThreads;
+    std::vector<int> integral;
+    int integralBins;
+    int integralRowStep;
+    std::vector<PARTICLEWorker*> workers;
+
+    friend class PARTICLEWorker;
+
     void free_histos( histogram** histo, int n );
     void free_regions( CvRect** regions, int n);
 
@@ -181,6 +214,9 @@ private:
 	particle* init_distribution( CvRect* regions, histogram** histos, int n, int p);
 	IplImage* bgr2hsv( IplImage* bgr );
 	float likelihood( IplImage* img, int r, int c, int w, int h, histogram* ref_histo );
+    float likelihood_integral( int r, int c, int w, int h, histogram* ref_histo );
+    void compute_integral_histogram( IplImage* hsv );
+    void evaluate_particles( int first, int last );
 	void normalize_weights( particle* particles, int n );
 	float histo_dist_sq( histogram* h1, histogram* h2 );
 	int histo_bin( float h, float s, float v );
@@ -188,7 +224,7 @@ private:
 	void setpix32f(IplImage* img, int r, int c, float val);
 	int get_regions( IplImage* frame, CvRect** regions );
     int get_regionsImage( IplImage* frame, CvRect** regions );
-	particle* resample( particle* particles, int n );
+	void resample( particle* particles, particle* _new_particles, int n );
 	void display_particle( IplImage* img, const particle &p, CvScalar color, yarp::sig::Vector& target );
     void display_particleBlob( IplImage* img, const particle &p, yarp::sig::Vector& target );
     void trace_template( IplImage* img, const particle &p );
@@ -206,6 +242,7 @@ public:
     void threadRelease();
     void run(); 
     void setName(std::string module);
+    void setLikelihoodOptions(bool useIntegral, int numThreads);
     void setTemplate(yarp::sig::ImageOf<yarp::sig::PixelRgb> *tpl);
     void pushTarget(yarp::sig::Vector &target, yarp::os::Stamp &stamp);
     float getAverage();
@@ -230,6 +267,8 @@ private:
 
     yarp::sig::ImageOf<yarp::sig::PixelRgb> *tpl;
     std::string moduleName;
+    bool useIntegral;
+    int numThreads;
     
 
 public:
@@ -238,6 +277,7 @@ public:
     bool            shouldSend;
 
     void setName(std::string module);
+    void setLikelihoodOptions(bool useIntegral, int numThreads);
     bool threadInit();     
     void threadRelease();
     void run(); 
@@ -42,6 +42,16 @@ The following key-value pairs can be specified as command-line parameters by pre
 - \c name \c templatePFTracker \n   
   specifies the name of the module (used to form the stem of module port names)  
 
+- \c integralHistogram \c off \n   
+  if on, an integral histogram is computed once per frame so that the histogram
+  of each particle is obtained in O(bins) instead of scanning its region; it
+  keeps one counter per bin for every pixel of the frame (about 135 MB for each
+  eye at 640x480), hence it pays off only with many particles
+
+- \c numThreads \c 1 \n   
+  specifies the number of threads evaluating the particles of each eye;
+  used only with the integral histogram
+
 <b>Configuration File Parameters </b>
 
 The following key-value pairs can be specified as parameters in the configuration file 
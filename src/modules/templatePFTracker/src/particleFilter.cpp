@@ -38,6 +38,42 @@ int particle_cmp( const void* p1, const void* p2 )
     return 0;
 }
 /**********************************************************/
+PARTICLEWorker::PARTICLEWorker(PARTICLEThread *owner) : go(0), done(0)
+{
+    this->owner = owner;
+    first = last = 0;
+}
+/**********************************************************/
+void PARTICLEWorker::post(int first, int last)
+{
+    this->first = first;
+    this->last = last;
+    go.post();
+}
+/**********************************************************/
+void PARTICLEWorker::wait()
+{
+    done.wait();
+}
+/**********************************************************/
+void PARTICLEWorker::run()
+{
+    while (!isStopping())
+    {
+        go.wait();
+        if (isStopping())
+            break;
+
+        owner->evaluate_particles( first, last );
+        done.post();
+    }
+}
+/**********************************************************/
+void PARTICLEWorker::onStop()
+{
+    go.post();
+}
+/**********************************************************/
 
 PARTICLEThread::~PARTICLEThread() 
 {
@@ -49,6 +85,8 @@ PARTICLEThread::~PARTICLEThread()
     free_histos ( ref_histos, num_objects);  
     if(particles != NULL)
         free ( particles);
+    if(new_particles != NULL)
+        free ( new_particles);
 
     if (temp)
     {
@@ -77,12 +115,22 @@ PARTICLEThread::PARTICLEThread()
     ref_histos = NULL;
     tpl = NULL;
     total = 0;
+    useIntegral = false;
+    numThreads = 1;
+    integralBins = NH*NS + NV;
+    integralRowStep = 0;
 }
 /**********************************************************/
 void PARTICLEThread::setName(string module) 
 {
     this->moduleName = module;
 }
+/**********************************************************/
+void PARTICLEThread::setLikelihoodOptions(bool useIntegral, int numThreads) 
+{
+    this->useIntegral = useIntegral;
+    this->numThreads = MAX( 1, numThreads );
+}
 
 /**********************************************************/
 bool PARTICLEThread::threadInit() 
@@ -104,6 +152,17 @@ bool PARTICLEThread::threadInit()
     updateNeeded=false;
     bestTempl.templ=NULL;
     bestTempl.w=0.0;
+
+    // the region extraction of the plain likelihood is not thread-safe
+    if (useIntegral)
+    {
+        for (int t = 1; t < numThreads; t++)
+        {
+            PARTICLEWorker *worker = new PARTICLEWorker( this );
+            worker->start();
+            workers.push_back( worker );
+        }
+    }
     return true;
 }
 /**********************************************************/
@@ -203,6 +262,13 @@ void PARTICLEThread::threadRelease()
     imageOut.close();
     imageOutBlob.close();
 
+    for (size_t t = 0; t < workers.size(); t++)
+    {
+        workers[t]->stop();
+        delete workers[t];
+    }
+    workers.clear();
+
     templateMutex.wait();
     while(tempList.size())
     {
@@ -251,22 +317,35 @@ void PARTICLEThread::runAll(IplImage *img)
     }
     else
     {
-        // perform prediction and measurement for each particle
+        // perform prediction for each particle; the random
+        // generator is drawn sequentially to keep it reproducible
         for( j = 0; j < num_particles; j++ ) 
-        {
             particles[j] = transition( particles[j], w, h, rng );
-            s = particles[j].s;
-            particles[j].w = likelihood( img_hsv, cvRound(particles[j].y),
-            cvRound( particles[j].x ),
-            cvRound( particles[j].width * s ),
-            cvRound( particles[j].height * s ),
-            particles[j].histo );
-        }
+
+        // perform measurement, splitting particles among workers
+        if (useIntegral)
+            compute_integral_histogram( img_hsv );
+
+        int chunk = num_particles / (int)(workers.size() + 1);
+        int first = num_particles - chunk * (int)workers.size();
+        for (size_t t = 0; t < workers.size(); t++)
+            workers[t]->post( first + (int)t * chunk, first + (int)(t + 1) * chunk );
+
+        evaluate_particles( 0, first );
+
+        for (size_t t = 0; t < workers.size(); t++)
+            workers[t]->wait();
+
         // normalize weights and resample a set of unweighted particles
+        // into the spare buffer, which then swaps with the current one
         normalize_weights( particles, num_particles );
-        new_particles = resample( particles, num_particles );
-        free( particles );
+        if (new_particles == NULL)
+            new_particles = (particle* ) malloc( num_particles * sizeof( particle ) );
+
+        resample( particles, new_particles, num_particles );
+        particle* tmp_particles = particles;
         particles = new_particles;
+        new_particles = tmp_particles;
     }
     qsort( particles, num_particles, sizeof( PARTICLEThread::particle ), &particle_cmp );
 
@@ -551,6 +630,83 @@ float PARTICLEThread::likelihood( IplImage* img, int r, int c, int w, int h, his
     return exp( -LAMBDA * d_sq );
 }
 /**********************************************************/
+void PARTICLEThread::evaluate_particles( int first, int last )
+{
+    for( int n = first; n < last; n++ ) 
+    {
+        particle &p = particles[n];
+        int r = cvRound( p.y );
+        int c = cvRound( p.x );
+        int pw = cvRound( p.width * p.s );
+        int ph = cvRound( p.height * p.s );
+
+        if (useIntegral)
+            p.w = likelihood_integral( r, c, pw, ph, p.histo );
+        else
+            p.w = likelihood( img_hsv, r, c, pw, ph, p.histo );
+    }
+}
+/**********************************************************/
+void PARTICLEThread::compute_integral_histogram( IplImage* hsv )
+{
+    int nb = integralBins;
+    integralRowStep = ( hsv->width + 1 ) * nb;
+    integral.resize( ( hsv->height + 1 ) * integralRowStep );
+
+    // the first row and column of the integral are zero
+    memset( &integral[0], 0, integralRowStep * sizeof(int) );
+
+    vector<int> rowCount( nb );
+    for( int r = 0; r < hsv->height; r++ )
+    {
+        const float* pix = (const float*)( hsv->imageData + hsv->widthStep * r );
+        const int* above = &integral[r * integralRowStep];
+        int* cur = &integral[( r + 1 ) * integralRowStep];
+
+        memset( cur, 0, nb * sizeof(int) );
+        std::fill( rowCount.begin(), rowCount.end(), 0 );
+
+        for( int c = 0; c < hsv->width; c++ )
+        {
+            rowCount[histo_bin( pix[3*c], pix[3*c+1], pix[3*c+2] )]++;
+
+            const int* up = above + ( c + 1 ) * nb;
+            int* dst = cur + ( c + 1 ) * nb;
+            for( int b = 0; b < nb; b++ )
+                dst[b] = up[b] + rowCount[b];
+        }
+    }
+}
+/**********************************************************/
+float PARTICLEThread::likelihood_integral( int r, int c, int w, int h, histogram* ref_histo )
+{
+    // same region as likelihood(), clipped to the image as the ROI does
+    int imgW = integralRowStep / integralBins - 1;
+    int imgH = (int)integral.size() / integralRowStep - 1;
+    int x0 = MAX( 0, c - w / 2 );
+    int y0 = MAX( 0, r - h / 2 );
+    int x1 = MIN( imgW, c - w / 2 + w );
+    int y1 = MIN( imgH, r - h / 2 + h );
+    if( ( x1 <= x0 ) || ( y1 <= y0 ) )
+        return exp( -LAMBDA * 1.0f );
+
+    int nb = integralBins;
+    const int* tl = &integral[y0 * integralRowStep + x0 * nb];
+    const int* tr = &integral[y0 * integralRowStep + x1 * nb];
+    const int* bl = &integral[y1 * integralRowStep + x0 * nb];
+    const int* br = &integral[y1 * integralRowStep + x1 * nb];
+
+    // region histogram in O(bins), normalized by the region area
+    float inv_area = 1.0f / (float)( ( x1 - x0 ) * ( y1 - y0 ) );
+    const float* ref = ref_histo->histo;
+    float sum = 0;
+    for( int b = 0; b < nb; b++ )
+        sum += sqrt( (float)( br[b] - bl[b] - tr[b] + tl[b] ) * inv_area * ref[b] );
+
+    float d_sq = ( sum < 1.0f ) ? sqrt( 1.0f - sum ) : 0.0f;
+    return exp( -LAMBDA * d_sq );
+}
+/**********************************************************/
 float PARTICLEThread::histo_dist_sq( histogram* h1, histogram* h2 ) 
 {
     float* hist1, * hist2;
@@ -587,14 +743,11 @@ void PARTICLEThread::normalize_weights( particle* particles, int n )
         particles[i].w /= sum;
 }
 /**********************************************************/
-PARTICLEThread::particle* PARTICLEThread::resample( particle* particles, int n ) 
+void PARTICLEThread::resample( particle* particles, particle* _new_particles, int n ) 
 {
-    particle* _new_particles;
     int i, j, np, k = 0;
 
-    //new_particles = (particle* )malloc( sizeof( particle ) );
     qsort( particles, n, sizeof( particle ), &particle_cmp );
-    _new_particles = (particle* ) malloc( n * sizeof( particle ) );
 
     for( i = 0; i < n; i++ ) 
     {
@@ -610,7 +763,7 @@ PARTICLEThread::particle* PARTICLEThread::resample( particle* particles, int n )
         _new_particles[k++] = particles[0];
 
     exit:
-    return _new_particles;
+    return;
 }
 /**********************************************************/
 void PARTICLEThread::display_particle( IplImage* img, const PARTICLEThread::particle &p, CvScalar color, Vector& target ) 
@@ -751,6 +904,8 @@ TemplateStruct PARTICLEThread::getBestTemplate()
 PARTICLEManager::PARTICLEManager() : RateThread(20) 
 {
     tpl = NULL;
+    useIntegral = false;
+    numThreads = 1;
 }
 /**********************************************************/
 PARTICLEManager::~PARTICLEManager() { }
@@ -760,6 +915,12 @@ void PARTICLEManager::setName(string module)
     this->moduleName = module;
 }
 /**********************************************************/
+void PARTICLEManager::setLikelihoodOptions(bool useIntegral, int numThreads) 
+{
+    this->useIntegral = useIntegral;
+    this->numThreads = numThreads;
+}
+/**********************************************************/
 bool PARTICLEManager::threadInit() 
 {
     //create all ports
@@ -778,6 +939,9 @@ bool PARTICLEManager::threadInit()
     particleThreadLeft->setName((moduleName + "/left").c_str());
     particleThreadRight->setName((moduleName + "/right").c_str());
 
+    particleThreadLeft->setLikelihoodOptions(useIntegral, numThreads);
+    particleThreadRight->setLikelihoodOptions(useIntegral, numThreads);
+
     shouldSend = false;
     particleThreadLeft->start();
     particleThreadRight->start();
@@ -909,6 +1073,14 @@ bool PARTICLEModule::configure(yarp::os::ResourceFinder &rf)
 
     /*pass the name of the module in order to create ports*/
     particleManager->setName(moduleName);    
+
+    bool useIntegral = rf.check("integralHistogram", 
+                           Value("off"), 
+                           "likelihood through integral histograms (on/off)").asString()=="on";
+    int numThreads   = rf.check("numThreads", 
+                           Value(1), 
+                           "threads evaluating the particles of each eye (int)").asInt();
+    particleManager->setLikelihoodOptions(useIntegral, numThreads);
     /* now start the thread to do the work */
     particleManager->start();
     
@@ -62,6 +62,25 @@
  *  [RENDER]
  *  objects off
  *  cover on
+ *
+ * The following options can be given on the command line:
+ * - --headless : run without window and without rendering; the
+ *   physics, the control boards, touch and inertial data are
+ *   available as usual, the camera ports stay silent.
+ * - --clock <mode> : select how the ODE steps are paced; the modes
+ *   are "realtime" (default) to track the wall clock, "free" to step
+ *   as fast as the CPU allows and "external" to step only upon
+ *   request through the [clock step <n>] command on the world port.
+ * - --profile : print every 1000 steps the average time spent in the
+ *   broad phase and in the narrow phase of the collision detection and
+ *   in the solver, together with the number of tested pairs and contacts.
+ *
+ * The solver is chosen in ode_params.ini: "solver quickstep" selects
+ * dWorldQuickStep with "quickStepIterations" iterations in place of
+ * dWorldStep.
+ * The [COLLISION] group of the same file selects the broad phase of the
+ * spaces ("simple", "hash" or "sap") and whether the pairs that can never
+ * touch are filtered out.
  * 
  * \section portsa_sec Ports Accessed
  * No ports are accessed nor needed by the iCub simulator
@@ -102,7 +121,13 @@
  * - /icubSim/cam/right/logpolar : streams out the data from the left camera (log polar format 252x152 ) 
  * - /icubSim/cam : streams out the data from the global view
  *
- * - /icubSim/world : port to manipulate the environment
+ * - /icubSim/world : port to manipulate the environment; it also
+ *   accepts [clock time], returning the simulated time, and
+ *   [clock step <n>], which performs n steps in "external" clock
+ *   mode and replies with [ok] and the simulated time once they
+ *   are done
+ * - /icubSim/clock : streams out the simulated time at each step as
+ *   (seconds nanoseconds)
  * - /icubSim/touch : streams out a sequence the touch sensors for both hands
  * - /icubSim/inertial : streams out a sequence of inertial data taken from the head
  * - /icubSim/texture : port to receive texture data to place on an object (e.g. data from a webcam etc...)
@@ -22,11 +22,33 @@
 
 OdeInit *OdeInit::_odeinit = NULL;
 
+dSpaceID OdeInit::createSpace(const yarp::os::ConstString &type, dSpaceID parent)
+{
+    if (type=="sap")
+        return dSweepAndPruneSpaceCreate(parent, dSAP_AXES_XZY); // y is the vertical axis
+    else if (type=="simple")
+        return dSimpleSpaceCreate(parent);
+    else
+        return dHashSpaceCreate(parent);
+}
+
+void OdeInit::setCollisionCategory(dGeomID geom, unsigned long category, unsigned long collide)
+{
+    if (!collisionFilters)
+        return;
+
+    dGeomSetCategoryBits(geom, category);
+    dGeomSetCollideBits(geom, collide);
+}
+
 OdeInit::OdeInit(RobotConfig *config) : mutex(1), robot_config(config)
 {
     //create the world parameters
+    OdeParams odeParameters = config->getOdeParameters();
+    collisionFilters = odeParameters.collisionFilters;
+
     world = dWorldCreate();
-    space = dHashSpaceCreate (0);
+    space = createSpace(odeParameters.rootSpace, 0);
     contactgroup = dJointGroupCreate (0);
     verbose = false;
     
@@ -43,12 +65,28 @@ OdeInit::OdeInit(RobotConfig *config) : mutex(1), robot_config(config)
     // problems due to contacts being repeatedly made and broken. 
     dWorldSetContactSurfaceLayer(world, config->getContactSurfaceLayer());
 
+    // number of iterations of dWorldQuickStep, when that solver is selected
+    if (odeParameters.worldQuickStep)
+        dWorldSetQuickStepNumIterations(world, odeParameters.worldQuickStepIterations);
+
     ground = dCreatePlane (space,0, 1, 0, 0);
+    setCollisionCategory(ground, COLLIDE_CAT_GROUND, COLLIDE_CAT_ROBOT | COLLIDE_CAT_OBJECTS);
     //feedback = new dJointFeedback;
     //feedback1 = new dJointFeedback;
     //feedback_mat = new dJointFeedback;
     _iCub = new ICubSim(world, space, 0,0,0, *robot_config);
     _wrld = new worldSim(world, space, 0,0,0, *robot_config);
+
+    // the ground and the static parts of the scene never need to be
+    // tested against each other
+    setCollisionCategory((dGeomID)_iCub->iCub, COLLIDE_CAT_ROBOT, COLLIDE_CAT_ALL);
+    setCollisionCategory((dGeomID)_wrld->boxObj, COLLIDE_CAT_OBJECTS, COLLIDE_CAT_ALL);
+    if (_iCub->actScreen == "on")
+        setCollisionCategory(_iCub->screenGeom, COLLIDE_CAT_STATIC, COLLIDE_CAT_ROBOT | COLLIDE_CAT_OBJECTS);
+    if (_wrld->actWorld == "on") {
+        for (int i=0; i<5; i++)
+            setCollisionCategory(_wrld->tableGeom[i], COLLIDE_CAT_STATIC, COLLIDE_CAT_ROBOT | COLLIDE_CAT_OBJECTS);
+    }
     _controls = new iCubSimulationControl*[MAX_PART];
     
     // initialize at NULL
@@ -44,6 +44,14 @@ using namespace yarp::dev;
 
 class ICubSim;
 
+// collision categories: two geoms are tested only if the category of
+// one of them is within the collide bits of the other
+#define COLLIDE_CAT_GROUND      0x0001
+#define COLLIDE_CAT_ROBOT       0x0002
+#define COLLIDE_CAT_OBJECTS     0x0004
+#define COLLIDE_CAT_STATIC      0x0008
+#define COLLIDE_CAT_ALL         (~0UL)
+
 /**
  *
  * ODE state information.
@@ -66,6 +74,7 @@ public:
     bool stop;
     bool sync;
     bool verbose;
+    bool collisionFilters;
     string name;
     iCubSimulationControl **_controls;
 
@@ -83,6 +92,17 @@ public:
     static OdeInit& init(RobotConfig *config);
     void sendHomePos();
 
+    /**
+     * Create a collision space of the given type ("simple", "hash" or
+     * "sap") within the parent space (0 for a top-level one).
+     */
+    static dSpaceID createSpace(const yarp::os::ConstString &type, dSpaceID parent);
+
+    /**
+     * Assign category and collide bits to a geom, if filters are on.
+     */
+    void setCollisionCategory(dGeomID geom, unsigned long category, unsigned long collide);
+
     static OdeInit& get();
 
     static void destroy();
@@ -1374,7 +1374,7 @@ void ICubSim::init( dWorldID world, dSpaceID space, dReal X, dReal Y, dReal Z, R
     OdeParams odeParameters = config.getOdeParameters();
         
     //init
-    iCub = dSimpleSpaceCreate(space);
+    iCub = OdeInit::createSpace(odeParameters.robotSpace, space);
     dSpaceSetCleanup(iCub,0);
 
     initCovers(finder);
@@ -38,6 +38,25 @@ static double dstep = 10.0/1000.0;     // step size in ODE's dWorldStep in secon
 static bool glrun;  // draw gl
 static bool simrun; // run simulator thread
 
+// clock driving the ODE steps
+#define SIM_CLOCK_REALTIME  0   // steps paced against the CPU clock
+#define SIM_CLOCK_FREE      1   // steps back to back, as fast as the CPU allows
+#define SIM_CLOCK_EXTERNAL  2   // steps requested through stepSimulation()
+static int clock_mode = SIM_CLOCK_REALTIME;
+static bool headless = false;   // no window and no rendering at all
+static bool quick_step = false; // dWorldQuickStep in place of dWorldStep
+static double sim_time = 0.0;   // simulated time in seconds
+static Semaphore step_go(0), step_done(0);
+// set by the ODE thread on leaving the lock-step loop, under step_mutex,
+// so that no request is posted once nobody is going to serve it
+static Semaphore step_mutex(1);
+static bool step_stopped = false;
+
+// per-step profile of the collision handling and of the solver
+static bool profile = false;
+static double prof_broad = 0.0, prof_narrow = 0.0, prof_solve = 0.0;
+static long prof_pairs = 0, prof_contacts = 0, prof_steps = 0;
+
 static int stop = 0;
 static int v = 0;
 
@@ -322,6 +341,12 @@ void OdeSdlSimulation::nearCallback (void *data, dGeomID o1, dGeomID o2) {
     dBodyID b2 = dGeomGetBody(o2);
     if (b1 && b2 && dAreConnectedExcluding (b1,b2,dJointTypeContact)) return;
 
+    // two static geoms cannot exchange any force
+    if (odeinit.collisionFilters && !b1 && !b2) return;
+
+    double t0 = profile ? Time::now() : 0.0;
+    prof_pairs++;
+
     dContact contact[MAX_CONTACTS];   // up to MAX_CONTACTS contacts per box-box
     for (i=0; i<MAX_CONTACTS; i++) {
         contact[i].surface.mode = dContactSlip1| dContactSlip2| dContactBounce | dContactSoftCFM;
@@ -352,7 +377,11 @@ void OdeSdlSimulation::nearCallback (void *data, dGeomID o1, dGeomID o2) {
             }
             //fprintf(stdout,"colllliiiissssiiiiooon: %d %d\n", dGeomGetClass (o1), dGeomGetClass (o2));
         }
+        prof_contacts += numc;
     }
+
+    if (profile)
+        prof_narrow += Time::now()-t0;
 }
 /*static void nearCallback (void *data, dGeomID o1, dGeomID o2){
   assert(o1);
@@ -788,12 +817,37 @@ void OdeSdlSimulation::retreiveInertialData(Bottle& inertialReport) {
 }
 
 int OdeSdlSimulation::thread_ode(void *unused) {
+    simrun = true;
+
+    // free running: no pacing at all
+    if (clock_mode==SIM_CLOCK_FREE) {
+        while (simrun)
+            ODE_process(1, (void*)1);
+        return(0);
+    }
+
+    // lock-step: one step per request
+    if (clock_mode==SIM_CLOCK_EXTERNAL) {
+        while (true) {
+            step_go.wait();
+            if (!simrun) {
+                step_mutex.wait();
+                step_stopped = true;
+                step_mutex.post();
+                step_done.post();
+                break;
+            }
+            ODE_process(1, (void*)1);
+            step_done.post();
+        }
+        return(0);
+    }
+
     //SLD_AddTimer freezes the system if delay is too short. Instead use a while loop that waits if there was time left after the computation of ODE_process
     double cpms = 1e3 / CLOCKS_PER_SEC;
     long lastOdeProcess = (long) (clock()*cpms);
     double avg_ode_step_length = 0.0;
     long count = 0;
-    simrun = true;
     double timeCache = ode_step_length;
     long lastTimeCacheUpdate = (long) (clock()*cpms);
     double alpha = 0.99;
@@ -848,8 +902,22 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
 
     odeinit.mutex.wait();
     nFeedbackStructs=0;
+    double t0 = profile ? Time::now() : 0.0;
+    double narrow0 = prof_narrow;
     dSpaceCollide(odeinit.space,0,&nearCallback);
-    dWorldStep(odeinit.world, dstep);
+    double t1 = profile ? Time::now() : 0.0;
+    if (quick_step)
+        dWorldQuickStep(odeinit.world, dstep);
+    else
+        dWorldStep(odeinit.world, dstep);
+    if (profile) {
+        // the broad phase is what the collision took apart from the narrow one
+        prof_broad += (t1-t0)-(prof_narrow-narrow0);
+        prof_solve += Time::now()-t1;
+        prof_steps++;
+    }
+    sim_time += dstep;
+    double now = sim_time;
     // do 1 TIMESTEP in controllers (ok to run at same rate as ODE: 1 iteration takes about 300 times less computation time than dWorldStep)
     for (int ipart = 0; ipart<MAX_PART; ipart++) {
         if (odeinit._controls[ipart] != NULL) {
@@ -887,6 +955,12 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
     robot_streamer->checkTorques();
 
     odeinit._iCub->setJointControlAction();
+
+    if (robot_streamer->shouldSendClock())
+        robot_streamer->sendClock(now);
+
+    if (profile && (prof_steps>=1000))
+        printProfile();
     
     //finishTimeODE = clock() ;
     //SPS();
@@ -926,15 +1000,65 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
   }
 */
 
+void OdeSdlSimulation::printProfile() {
+    double n = (double)prof_steps;
+    printf("Step profile over %ld steps [ms]: broad %.3f, narrow %.3f, solve %.3f; pairs %.1f, contacts %.1f\n",
+           prof_steps, 1e3*prof_broad/n, 1e3*prof_narrow/n, 1e3*prof_solve/n,
+           prof_pairs/n, prof_contacts/n);
+    prof_broad = prof_narrow = prof_solve = 0.0;
+    prof_pairs = prof_contacts = prof_steps = 0;
+}
+
 void OdeSdlSimulation::sighandler(int sig) {
     OdeInit& odeinit = OdeInit::get();
     odeinit.stop = true;
     cout << "\nCAUGHT Ctrl-c" << endl;
 }
 
+void OdeSdlSimulation::simLoopHeadless() {
+    OdeInit& odeinit = OdeInit::get();
+
+    SDL_Init(SDL_INIT_TIMER);
+    dAllocateODEDataForThread(dAllocateMaskAll);
+
+    SDL_Thread *ode_thread = SDL_CreateThread(thread_ode, NULL);
+    if ( ode_thread == NULL ) {
+        fprintf(stderr, "Unable to create thread: %s\n", SDL_GetError());
+        return;
+    }
+
+    odeinit.stop = false;
+
+    yarp::os::signal(yarp::os::YARP_SIGINT, sighandler);
+    yarp::os::signal(yarp::os::YARP_SIGTERM, sighandler);
+
+    glrun = false;
+    odeinit._wrld->WAITLOADING = false;
+    odeinit._wrld->static_model = false;
+
+    if (odeinit._iCub->actStartHomePos == "on")
+        odeinit.sendHomePos();
+
+    while(!odeinit.stop) {
+        // without a GL context there are no textures to load
+        odeinit._wrld->WAITLOADING = false;
+        odeinit._wrld->static_model = false;
+        SDL_Delay(100);
+    }
+    printf("\n\nStopping ODE thread...\n");
+    simrun = false;
+    step_go.post();
+    SDL_WaitThread( ode_thread, NULL );
+}
+
 void OdeSdlSimulation::simLoop(int h,int w) {
     OdeInit& odeinit = OdeInit::get();
 
+    if (headless) {
+        simLoopHeadless();
+        return;
+    }
+
     SDL_Init(SDL_INIT_TIMER | SDL_GL_ACCELERATED_VISUAL);
     SDL_SetVideoMode(h,w,32,SDL_OPENGL | SDL_RESIZABLE);// | SDL_SWSURFACE| SDL_ANYFORMAT); // on init 
 
@@ -1013,6 +1137,7 @@ void OdeSdlSimulation::simLoop(int h,int w) {
     //Stop the thread
     //SDL_KillThread( thread );
     simrun = false;
+    step_go.post();
     //SDL_WaitThread( thread, NULL );
     SDL_WaitThread( ode_thread, NULL );
     //SDL_Quit();
@@ -1106,6 +1231,25 @@ void OdeSdlSimulation::init(RobotStreamer *streamer,
 
     ode_step_length = config->getWorldTimestep();
     dstep = ode_step_length*1e-3;
+    quick_step = config->getOdeParameters().worldQuickStep;
+
+    // --headless runs without window and rendering (no camera images);
+    // --clock realtime|free|external selects how the ODE steps are paced;
+    // --profile prints the time spent in collision and solver
+    ResourceFinder &finder = config->getFinder();
+    headless = finder.check("headless");
+    profile = finder.check("profile");
+    ConstString clockMode = finder.check("clock",Value("realtime")).asString();
+    if (clockMode=="free")
+        clock_mode = SIM_CLOCK_FREE;
+    else if (clockMode=="external")
+        clock_mode = SIM_CLOCK_EXTERNAL;
+    else
+        clock_mode = SIM_CLOCK_REALTIME;
+    sim_time = 0.0;
+
+    printf("Simulation: %s, clock %s, solver %s\n", headless ? "headless" : "windowed",
+           clockMode.c_str(), quick_step ? "dWorldQuickStep" : "dWorldStep");
 
     video = new VideoTexture;
     string moduleName = odeinit.getName();
@@ -1173,6 +1317,34 @@ bool OdeSdlSimulation::checkSync(bool reset) {
 }
 
 
+bool OdeSdlSimulation::stepSimulation(int steps) {
+    if (clock_mode!=SIM_CLOCK_EXTERNAL)
+        return false;
+
+    for (int i=0; i<steps; i++) {
+        // a request posted before the ODE thread stops is always answered
+        step_mutex.wait();
+        if (!simrun || step_stopped) {
+            step_mutex.post();
+            return false;
+        }
+        step_go.post();
+        step_mutex.post();
+        step_done.wait();
+    }
+    return true;
+}
+
+
+double OdeSdlSimulation::getSimulationTime() {
+    OdeInit& odeinit = OdeInit::get();
+    odeinit.mutex.wait();
+    double t = sim_time;
+    odeinit.mutex.post();
+    return t;
+}
+
+
 bool OdeSdlSimulation::getTrqData(Bottle data) {
     OdeInit& odeinit = OdeInit::get();
     for (int s=0; s<data.size(); s++){
@@ -19,7 +19,7 @@
 */
 /**
  * \file iCub_Sim.h
- * \brief This class controls the simulation speed using dWorldstep for "exact" calculations, the collisions between objects/spaces and the rendering functions. It also deals with separating the physics calsulations from the rendering 
+ * \brief This class controls the simulation speed using dWorldstep for "exact" calculations (or dWorldQuickStep when selected), the collisions between objects/spaces and the rendering functions. It also deals with separating the physics calsulations from the rendering 
  * \author Vadim Tikhanoff, Paul Fitzpatrick
  * \date 2007
  * \note Release under GNU GPL v2.0
@@ -110,6 +110,10 @@ public:
 
     virtual bool getTrqData(Bottle data);
 
+    virtual bool stepSimulation(int steps);
+
+    virtual double getSimulationTime();
+
 private:
     static void draw();
 
@@ -147,6 +151,11 @@ private:
 
     static void sighandler(int sig);
 
+    static void printProfile();
+
+    // simulation loop without window, used with --headless
+    static void simLoopHeadless();
+
     //////////////////////////////
     //////////////////////////////
     //////////////////////////////
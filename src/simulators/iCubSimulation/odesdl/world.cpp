@@ -214,7 +214,7 @@ void worldSim::init( dWorldID world, dSpaceID space, dReal X, dReal Y, dReal Z,
     /*
     * objects in the same space do not collide...see collision function in ICub_sim
     */
-    boxObj = dSimpleSpaceCreate(space);
+    boxObj = OdeInit::createSpace(config.getOdeParameters().objectsSpace, space);
     dSpaceSetCleanup(boxObj,0);
 
     //tempBody = dBodyCreate (world);
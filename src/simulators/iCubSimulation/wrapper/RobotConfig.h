@@ -41,6 +41,8 @@ public:
     double jointCFM;
     double worldCFM; 
     int    worldTimestep;
+    bool   worldQuickStep;
+    int    worldQuickStepIterations;
     double stopERP;   
     double worldERP;
     double maxContactCorrectingVel;
@@ -48,6 +50,10 @@ public:
     double motorMaxTorque;
     double motorDryFriction;
     double jointStopBouncyness;
+    yarp::os::ConstString rootSpace;
+    yarp::os::ConstString robotSpace;
+    yarp::os::ConstString objectsSpace;
+    bool   collisionFilters;
 };
 
 class RobotConfig {
@@ -34,6 +34,10 @@ public:
     virtual void sendInertial(yarp::os::Bottle& report) = 0;
     virtual bool shouldSendInertial() = 0;
     virtual void checkTorques() = 0;
+
+    virtual void sendClock(double time) = 0;
+
+    virtual bool shouldSendClock() = 0;
 };
 
 #endif
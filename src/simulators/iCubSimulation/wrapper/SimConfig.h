@@ -145,10 +145,13 @@ private:
         Bottle &bParamWorld     = bParams.findGroup("WORLD");
         Bottle &bParamContacts  = bParams.findGroup("CONTACTS");
         Bottle &bParamJoints    = bParams.findGroup("JOINTS");
+        Bottle &bParamCollision = bParams.findGroup("COLLISION");
 
         p.worldTimestep   = bParamWorld.check("timestep", Value(10)).asInt();
         p.worldCFM        = bParamWorld.check("worldCFM", Value(0.00001)).asDouble();
         p.worldERP        = bParamWorld.check("worldERP", Value(0.2)).asDouble();
+        p.worldQuickStep  = (bParamWorld.check("solver", Value("step")).asString()=="quickstep");
+        p.worldQuickStepIterations = bParamWorld.check("quickStepIterations", Value(20)).asInt();
         
         p.maxContactCorrectingVel = bParamContacts.check("maxContactCorrectingVel", Value(1e6)).asDouble();
         p.contactSurfaceLayer     = bParamContacts.check("contactSurfaceLayer", Value(0.0)).asDouble();
@@ -161,6 +164,11 @@ private:
         p.motorDryFriction    = bParamJoints.check("motorDryFriction", Value(0.1)).asDouble();
         p.jointStopBouncyness = bParamJoints.check("jointStopBouncyness", Value(0.1)).asDouble();
 
+        p.rootSpace        = bParamCollision.check("rootSpace", Value("hash")).asString();
+        p.robotSpace       = bParamCollision.check("robotSpace", Value("simple")).asString();
+        p.objectsSpace     = bParamCollision.check("objectsSpace", Value("simple")).asString();
+        p.collisionFilters = (bParamCollision.check("filters", Value("on")).asString()=="on");
+
         odeParamRead = true;
     }
 };
@@ -73,6 +73,26 @@ public:
     virtual bool checkSync(bool reset = false) = 0;
 
     virtual bool getTrqData(yarp::os::Bottle data) = 0;
+
+    /**
+     *
+     * Advance the simulation by the given number of steps and return
+     * once they are done. Only meaningful when the clock is driven
+     * externally; simulations without such a clock return false.
+     *
+     */
+    virtual bool stepSimulation(int steps) {
+        return false;
+    }
+
+    /**
+     *
+     * Time elapsed within the simulation, in seconds.
+     *
+     */
+    virtual double getSimulationTime() {
+        return 0.0;
+    }
 };
 
 #endif
@@ -25,6 +25,7 @@
 #include <yarp/os/Network.h>
 #include <yarp/os/Os.h>
 #include <yarp/os/Time.h>
+#include <yarp/os/Vocab.h>
 #include <yarp/sig/Vector.h>
 #include <yarp/sig/Image.h>
 #include <yarp/dev/Drivers.h>
@@ -105,6 +106,21 @@ bool SimulatorModule::shouldSendInertial(){
     return inertialPort.getOutputCount()>0;
 }
 
+// the simulated time goes out as (seconds nanoseconds), the same layout
+// used by network clocks, so that clients can run in lock-step with us
+void SimulatorModule::sendClock(double time){
+    int sec = (int)time;
+    Bottle &b = clockPort.prepare();
+    b.clear();
+    b.addInt(sec);
+    b.addInt((int)((time-sec)*1e9+0.5));
+    clockPort.write();
+}
+
+bool SimulatorModule::shouldSendClock(){
+    return clockPort.getOutputCount()>0;
+}
+
 void SimulatorModule::sendVision() {
     displayStep(0);
 }
@@ -143,6 +159,7 @@ bool SimulatorModule::closeModule() {
     tactileLeftPort.close();
     tactileRightPort.close();
     inertialPort.close();
+    clockPort.close();
     cmdPort.close();
 
     trqLeftLegPort.close();
@@ -209,6 +226,8 @@ bool SimulatorModule::respond(const Bottle &command, Bottle &reply) {
         printf("\tright\n");
         printf("\twide\n");
         printf("\tworld\n");
+        printf("\tclock time\n");
+        printf("\tclock step <n>\n");
         reply.fromString("world etc");
         done = true;
     } else if (cmd=="left") {
@@ -229,6 +248,25 @@ bool SimulatorModule::respond(const Bottle &command, Bottle &reply) {
         done = true;
     } else if (cmd=="world"){
         return world_manager.respond(command,reply);
+    } else if (cmd=="clock") {
+        ConstString subcmd = command.get(1).asString();
+        if (subcmd=="time") {
+            reply.addDouble(sim->getSimulationTime());
+        } else if (subcmd=="step") {
+            // blocks until the steps are done: this is what keeps
+            // an external driver in lock-step with the simulator
+            int steps = (command.size()>2) ? command.get(2).asInt() : 1;
+            if (steps<1) steps = 1;
+            if (sim->stepSimulation(steps)) {
+                reply.addVocab(VOCAB2('o','k'));
+                reply.addDouble(sim->getSimulationTime());
+            } else {
+                reply.addVocab(VOCAB4('f','a','i','l'));
+            }
+        } else {
+            reply.addVocab(VOCAB4('f','a','i','l'));
+        }
+        done = true;
     }
     return ok;
 }
@@ -374,12 +412,14 @@ bool SimulatorModule::open() {
     string torqueLeftArm = moduleName +"/joint_vsens/right_arm:i";
     
     string inertial = moduleName + "/inertial";
+    string clockName = moduleName + "/clock";
     cmdPort.open( world.c_str() );
     tactileLeftPort.open( tactileLeft.c_str() );
     tactileLeftPortrpc.open( tactileLeftrpc.c_str() );
     tactileRightPort.open( tactileRight.c_str() );
     tactileRightPortrpc.open( tactileRightrpc.c_str() );
     inertialPort.open( inertial.c_str() );
+    clockPort.open( clockName.c_str() );
 
     trqLeftLegPort.open( torqueLeftLeg.c_str() );
     trqRightLegPort.open( torqueRightLeg.c_str() );
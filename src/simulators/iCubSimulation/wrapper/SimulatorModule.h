@@ -69,6 +69,9 @@ public:
     virtual void sendInertial(yarp::os::Bottle& report);
     virtual bool shouldSendInertial();
 
+    virtual void sendClock(double time);
+    virtual bool shouldSendClock();
+
 private:
 
 #ifndef OMIT_LOGPOLAR
@@ -107,6 +110,7 @@ private:
 #endif
     yarp::os::Port cmdPort;
     yarp::os::BufferedPort<yarp::os::Bottle> tactileLeftPort, tactileRightPort, tactilePort, inertialPort;
+    yarp::os::BufferedPort<yarp::os::Bottle> clockPort;
     yarp::os::BufferedPort<yarp::os::Bottle> trqLeftLegPort, trqRightLegPort, trqLeftArmPort, trqRightArmPort, trqTorsoPort;
     yarp::os::Port tactileLeftPortrpc, tactileRightPortrpc;
 
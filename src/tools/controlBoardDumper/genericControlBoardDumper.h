@@ -18,6 +18,9 @@
  * Public License for more details
 */
 
+#ifndef __GENERICCONTROLBOARDDUMPER_H__
+#define __GENERICCONTROLBOARDDUMPER_H__
+
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <iCub/DebugInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
@@ -146,3 +149,4 @@ public:
   IDebugInterface *idbg;
 };
 
+#endif
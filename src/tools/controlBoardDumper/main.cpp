@@ -80,6 +80,8 @@
  *
  * logToFile                     //if present, this options creates a log file for each data port
  *
+ * sampler                       //if present, all the data are read by a single thread (see below)
+ *
  * \endcode
  * 
  * If no such file can be found, the application is started
@@ -122,6 +124,20 @@
  *
  * \endcode
 
+ * With the option --sampler all the data of the board are read in one pass
+ * per cycle by a single thread and published as a single record on the port
+ * /controlBoardDumper/part/sampler, so that they share the same time stamp:
+ * the record is a vector with the requested joints of the first data, then
+ * the ones of the second data, and so on, in the order of dataToDump.
+ * With logToFile the records are saved in binary form to the file
+ * _controlBoardDumper_part_sampler.bin, whose first line of text describes
+ * the layout of the records.
+ * \code
+ *
+ * controlBoardDumper --robot icub --part left_leg --rate 1 --joints "(0 1 2 3 4 5)" --dataToDumpAll --sampler --logToFile
+ *
+ * \endcode
+ *
  * \section portsa_sec Ports Accessed
  * For each part initalized (e.g. right_arm):
  * <ul>
@@ -134,6 +150,7 @@
  * For each part initalized (e.g. right_arm):
  * <ul>
  * <li> /robot/controlBoardDumper/part/data e.g. /icub/controlBoardDumper/right_arm/getEncoders
+ * <li> /controlBoardDumper/part/sampler, with the option --sampler
  * </ul>
  *
  * \author Francesco Nori
@@ -150,6 +167,7 @@
 #include <yarp/os/Module.h>
 
 #include "dumperThread.h"
+#include "samplerThread.h"
 
 YARP_DECLARE_DEVICES(icubmod)
 
@@ -312,6 +330,7 @@ private:
     int nData;
 
     boardDumperThread *myDumper;
+    boardSamplerThread *mySampler;
 
     //time stamp
     IPreciselyTimed *istmp;
@@ -341,6 +360,9 @@ private:
 public:
     DumpModule() 
     { 
+        myDumper=0;
+        mySampler=0;
+        nData=0;
         istmp=0;
         ienc=0;
         ipid=0;
@@ -349,6 +371,218 @@ public:
         idbg=0;
     }
 
+    // initialize the getter of the given data, NULL if the interface is not available;
+    // ok is false if the module cannot go on
+    GetData *initGetter(const ConstString &data, bool &ok)
+    {
+        if (data == "getEncoders")
+            if (ddBoard.view(ienc))
+                {
+                    fprintf(stderr, "Initializing a getEncs thread\n");
+                    myGetEncs.setInterface(ienc);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getEncoders::The time stamp initalization interfaces was successfull! \n");
+                        myGetEncs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                    return &myGetEncs;
+                }
+   
+        if (data == "getEncoderSpeeds")
+            if (ddBoard.view(ienc))
+                {
+                    fprintf(stderr, "Initializing a getSpeeds thread\n");
+                    myGetSpeeds.setInterface(ienc);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getEncodersSpeed::The time stamp initalization interfaces was successfull! \n");
+                        myGetSpeeds.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                    return &myGetSpeeds;
+                }
+        if (data == "getEncoderAccelerations")
+            if (ddBoard.view(ienc))
+                {
+                    fprintf(stderr, "Initializing a getAccs thread\n");
+                    myGetAccs.setInterface(ienc);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getEncoderAccelerations::The time stamp initalization interfaces was successfull! \n");
+                        myGetAccs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                    return &myGetAccs;
+                }
+        if (data == "getPidReferences")
+            if (ddBoard.view(ipid))
+                {
+                    fprintf(stderr, "Initializing a getErrs thread\n");
+                    myGetPidRefs.setInterface(ipid);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getPidReferences::The time stamp initalization interfaces was successfull! \n");
+                        myGetPidRefs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                    return &myGetPidRefs;
+                }
+        if (data == "getPositionErrors")
+            if (ddBoard.view(ipid))
+                {
+                    fprintf(stderr, "Initializing a getErrs thread\n");
+                    myGetPosErrs.setInterface(ipid);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getPositionErrors::The time stamp initalization interfaces was successfull! \n");
+                        myGetPosErrs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                    return &myGetPosErrs;
+                }
+        if (data == "getOutputs")
+            if (ddBoard.view(ipid))
+                {
+                    fprintf(stderr, "Initializing a getOuts thread\n");
+                    myGetOuts.setInterface(ipid);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getOutputs::The time stamp initalization interfaces was successfull! \n");
+                        myGetOuts.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                    return &myGetOuts;
+                }
+        if (data == "getCurrents")
+            if (ddBoard.view(iamp))
+                {
+                    fprintf(stderr, "Initializing a getCurrs thread\n");
+                    myGetCurrs.setInterface(iamp);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getCurrents::The time stamp initalization interfaces was successfull! \n");
+                        myGetCurrs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                       
+                    return &myGetCurrs;
+                }
+        if (data == "getTorques")
+            if (ddBoard.view(itrq))
+                {
+                    fprintf(stderr, "Initializing a getTorques thread\n");
+                    myGetTrqs.setInterface(itrq);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getTorques::The time stamp initalization interfaces was successfull! \n");
+                        myGetTrqs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                       
+                    return &myGetTrqs;
+                }
+        if (data == "getTorqueErrors")
+            if (ddBoard.view(itrq))
+                {
+                    fprintf(stderr, "Initializing a getTorqueErrors thread\n");
+                    myGetTrqErrs.setInterface(itrq);
+                    if (ddBoard.view(istmp))
+                    {
+                        fprintf(stderr, "getTorqueErrors::The time stamp initalization interfaces was successfull! \n");
+                        myGetTrqErrs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                       
+                    return &myGetTrqErrs;
+                }
+        if (data == "getRotorPositions")
+            {
+                if (idbg==0 && ddDebug.isValid()) ddDebug.view(idbg);
+                if (idbg!=0)
+                {
+                    fprintf(stderr, "Initializing a getRotorPosition thread\n");
+                    myGetRotorPoss.setInterface(idbg);
+                    if (ddDebug.view(istmp))
+                    {
+                        fprintf(stderr, "getRotorPositions::The time stamp initalization interfaces was successfull! \n");
+                        myGetRotorPoss.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                       
+                    return &myGetRotorPoss;
+                }
+                else
+                {
+                    printf("Debug Interface not available.  Here are the known devices:\n");
+                    printf("%s", Drivers::factory().toString().c_str());
+                    ok = false;
+                    return 0;
+                }
+            }
+        if (data == "getRotorSpeeds")
+            {
+                if (idbg==0 && ddDebug.isValid()) ddDebug.view(idbg);
+                if (idbg!=0)
+                {
+                    fprintf(stderr, "Initializing a getRotorSpeed thread\n");
+                    myGetRotorVels.setInterface(idbg);
+                    if (ddDebug.view(istmp))
+                    {
+                        fprintf(stderr, "getRotorSpeeds::The time stamp initalization interfaces was successfull! \n");
+                        myGetRotorVels.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                       
+                    return &myGetRotorVels;
+                }
+                else
+                {
+                    printf("Debug Interface not available.  Here are the known devices:\n");
+                    printf("%s", Drivers::factory().toString().c_str());
+                    ok = false;
+                    return 0;
+                }
+            }
+        if (data == "getRotorAccelerations")
+            {
+                if (idbg==0 && ddDebug.isValid()) ddDebug.view(idbg);
+                if (idbg!=0)
+                {
+                    fprintf(stderr, "Initializing a getRotorAcceleration thread\n");
+                    myGetRotorAccs.setInterface(idbg);
+                    if (ddDebug.view(istmp))
+                    {
+                        fprintf(stderr, "getRotorAccelerations::The time stamp initalization interfaces was successfull! \n");
+                        myGetRotorAccs.setStamp(istmp);
+                    }
+                    else
+                        fprintf(stderr, "Problems getting the time stamp interfaces \n");
+                       
+                    return &myGetRotorAccs;
+                }
+                else
+                {
+                    printf("Debug Interface not available.  Here are the known devices:\n");
+                    printf("%s", Drivers::factory().toString().c_str());
+                    ok = false;
+                    return 0;
+                }
+            }
+        return 0;
+    }
+
     virtual bool open(Searchable &s)
     {
 
@@ -452,239 +686,51 @@ public:
         //boardDumperThread *myDumper = new boardDumperThread(&dd, rate, portPrefix, dataToDump[0]);
         //myDumper->setThetaMap(thetaMap, nJoints);
 
+        if (options.check("sampler"))
+        {
+            // one thread reading all the data in one pass per cycle
+            int nAxes = 0;
+            IEncoders *iaxes = 0;
+            if (ddBoard.view(iaxes))
+                iaxes->getAxes(&nAxes);
+            fprintf(stderr, "Initializing a sampler thread for %d axes\n", nAxes);
+            mySampler = new boardSamplerThread;
+            mySampler->setDevice(rate, portPrefix, nAxes, logToFile);
+            mySampler->setThetaMap(thetaMap, nJoints);
+            for (int i = 0; i < nData; i++)
+            {
+                bool ok = true;
+                GetData *getter = initGetter(dataToDump[i], ok);
+                if (!ok)
+                {
+                    Network::fini();
+                    return false;
+                }
+                if (getter)
+                    mySampler->addGetter(getter, dataToDump[i]);
+            }
+            Time::delay(1);
+            mySampler->start();
+            return true;
+        }
+
         myDumper = new boardDumperThread[nData];
 
         for (int i = 0; i < nData; i++)
             {
-                if (dataToDump[i] == "getEncoders")
-                    if (ddBoard.view(ienc))
-                        {
-                            fprintf(stderr, "Initializing a getEncs thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetEncs.setInterface(ienc);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getEncoders::The time stamp initalization interfaces was successfull! \n");
-                                myGetEncs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                            myDumper[i].setGetter(&myGetEncs);
-                        }
-   
-                if (dataToDump[i] == "getEncoderSpeeds")
-                    if (ddBoard.view(ienc))
-                        {
-                            fprintf(stderr, "Initializing a getSpeeds thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetSpeeds.setInterface(ienc);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getEncodersSpeed::The time stamp initalization interfaces was successfull! \n");
-                                myGetSpeeds.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                            myDumper[i].setGetter(&myGetSpeeds);
-                        }
-                if (dataToDump[i] == "getEncoderAccelerations")
-                    if (ddBoard.view(ienc))
-                        {
-                            fprintf(stderr, "Initializing a getAccs thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetAccs.setInterface(ienc);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getEncoderAccelerations::The time stamp initalization interfaces was successfull! \n");
-                                myGetAccs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                            myDumper[i].setGetter(&myGetAccs);
-                        }
-                if (dataToDump[i] == "getPidReferences")
-                    if (ddBoard.view(ipid))
-                        {
-                            fprintf(stderr, "Initializing a getErrs thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetPidRefs.setInterface(ipid);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getPidReferences::The time stamp initalization interfaces was successfull! \n");
-                                myGetPidRefs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                            myDumper[i].setGetter(&myGetPidRefs);
-                        }
-                if (dataToDump[i] == "getPositionErrors")
-                    if (ddBoard.view(ipid))
-                        {
-                            fprintf(stderr, "Initializing a getErrs thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetPosErrs.setInterface(ipid);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getPositionErrors::The time stamp initalization interfaces was successfull! \n");
-                                myGetPosErrs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                            myDumper[i].setGetter(&myGetPosErrs);
-                        }
-                if (dataToDump[i] == "getOutputs")
-                    if (ddBoard.view(ipid))
-                        {
-                            fprintf(stderr, "Initializing a getOuts thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetOuts.setInterface(ipid);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getOutputs::The time stamp initalization interfaces was successfull! \n");
-                                myGetOuts.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                            myDumper[i].setGetter(&myGetOuts);
-                        }
-                if (dataToDump[i] == "getCurrents")
-                    if (ddBoard.view(iamp))
-                        {
-                            fprintf(stderr, "Initializing a getCurrs thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetCurrs.setInterface(iamp);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getCurrents::The time stamp initalization interfaces was successfull! \n");
-                                myGetCurrs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                               
-                            myDumper[i].setGetter(&myGetCurrs);
-                        }
-                if (dataToDump[i] == "getTorques")
-                    if (ddBoard.view(itrq))
-                        {
-                            fprintf(stderr, "Initializing a getTorques thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetTrqs.setInterface(itrq);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getTorques::The time stamp initalization interfaces was successfull! \n");
-                                myGetTrqs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                               
-                            myDumper[i].setGetter(&myGetTrqs);
-                        }
-                if (dataToDump[i] == "getTorqueErrors")
-                    if (ddBoard.view(itrq))
-                        {
-                            fprintf(stderr, "Initializing a getTorqueErrors thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetTrqErrs.setInterface(itrq);
-                            if (ddBoard.view(istmp))
-                            {
-                                fprintf(stderr, "getTorqueErrors::The time stamp initalization interfaces was successfull! \n");
-                                myGetTrqErrs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                               
-                            myDumper[i].setGetter(&myGetTrqErrs);
-                        }
-                if (dataToDump[i] == "getRotorPositions")
-                    {
-                        if (idbg==0 && ddDebug.isValid()) ddDebug.view(idbg);
-                        if (idbg!=0)
-                        {
-                            fprintf(stderr, "Initializing a getRotorPosition thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetRotorPoss.setInterface(idbg);
-                            if (ddDebug.view(istmp))
-                            {
-                                fprintf(stderr, "getRotorPositions::The time stamp initalization interfaces was successfull! \n");
-                                myGetRotorPoss.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                               
-                            myDumper[i].setGetter(&myGetRotorPoss);
-                        }
-                        else
-                        {
-                            printf("Debug Interface not available.  Here are the known devices:\n");
-                            printf("%s", Drivers::factory().toString().c_str());
-                            Network::fini();
-                            return false;
-                        }
-                    }
-                if (dataToDump[i] == "getRotorSpeeds")
-                    {
-                        if (idbg==0 && ddDebug.isValid()) ddDebug.view(idbg);
-                        if (idbg!=0)
-                        {
-                            fprintf(stderr, "Initializing a getRotorSpeed thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetRotorVels.setInterface(idbg);
-                            if (ddDebug.view(istmp))
-                            {
-                                fprintf(stderr, "getRotorSpeeds::The time stamp initalization interfaces was successfull! \n");
-                                myGetRotorVels.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                               
-                            myDumper[i].setGetter(&myGetRotorVels);
-                        }
-                        else
-                        {
-                            printf("Debug Interface not available.  Here are the known devices:\n");
-                            printf("%s", Drivers::factory().toString().c_str());
-                            Network::fini();
-                            return false;
-                        }
-                    }
-                if (dataToDump[i] == "getRotorAccelerations")
-                    {
-                        if (idbg==0 && ddDebug.isValid()) ddDebug.view(idbg);
-                        if (idbg!=0)
-                        {
-                            fprintf(stderr, "Initializing a getRotorAcceleration thread\n");
-                            myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
-                            myDumper[i].setThetaMap(thetaMap, nJoints);
-                            myGetRotorAccs.setInterface(idbg);
-                            if (ddDebug.view(istmp))
-                            {
-                                fprintf(stderr, "getRotorAccelerations::The time stamp initalization interfaces was successfull! \n");
-                                myGetRotorAccs.setStamp(istmp);
-                            }
-                            else
-                                fprintf(stderr, "Problems getting the time stamp interfaces \n");
-                               
-                            myDumper[i].setGetter(&myGetRotorAccs);
-                        }
-                        else
-                        {
-                            printf("Debug Interface not available.  Here are the known devices:\n");
-                            printf("%s", Drivers::factory().toString().c_str());
-                            Network::fini();
-                            return false;
-                        }
-                    }
+                bool ok = true;
+                GetData *getter = initGetter(dataToDump[i], ok);
+                if (!ok)
+                {
+                    Network::fini();
+                    return false;
+                }
+                if (getter)
+                {
+                    myDumper[i].setDevice(&ddBoard, &ddDebug, rate, portPrefix, dataToDump[i], logToFile);
+                    myDumper[i].setThetaMap(thetaMap, nJoints);
+                    myDumper[i].setGetter(getter);
+                }
             }
         Time::delay(1);
         for (int i = 0; i < nData; i++)
@@ -696,12 +742,24 @@ public:
     virtual bool close()
     {
 
-        fprintf(stderr, "Stopping dumper class\n");
-        for(int i = 0; i < nData; i++)
-            myDumper[i].stop();
+        if (mySampler)
+        {
+            fprintf(stderr, "Stopping sampler class\n");
+            mySampler->stop();
+            delete mySampler;
+            mySampler = 0;
+        }
 
-        fprintf(stderr, "Deleting dumper class\n");
-        delete[] myDumper;
+        if (myDumper)
+        {
+            fprintf(stderr, "Stopping dumper class\n");
+            for(int i = 0; i < nData; i++)
+                myDumper[i].stop();
+
+            fprintf(stderr, "Deleting dumper class\n");
+            delete[] myDumper;
+            myDumper = 0;
+        }
 
         //finally close the dd of the remote control board
         fprintf(stderr, "Closing the device driver\n");
@@ -778,6 +836,8 @@ int main(int argc, char *argv[])
         printf (" getRotorSpeeds          (hi-res rotor velocity, if available)\n");
         printf (" getRotorAccelerations   (hi-res rotor acceleration, if available)\n");
         printf ("\n2) controlBoardDumper --robot icub --part left_arm --rate 10  --joints \"(0 1 2)\" --dataToDumpAll\n");
+        printf ("\nAdd --sampler to read all the data in one pass per cycle and send them on a single port\n");
+        printf ("(/controlBoardDumper/<part>/sampler), with --logToFile they are saved in binary form\n");
 
         return 0;
     }
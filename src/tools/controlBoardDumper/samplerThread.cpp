@@ -0,0 +1,151 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/* 
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+#include "samplerThread.h"
+
+#include <string.h>
+
+// the log file is written in chunks of this size
+#define LOG_BUFFER_SIZE     (1<<20)
+
+boardSamplerThread::boardSamplerThread():RateThread(500)
+{
+    logFile   = 0;
+    logToFile = false;
+    logBuffer = 0;
+    numberOfJoints = 0;
+}
+
+boardSamplerThread::~boardSamplerThread()
+{
+}
+
+void boardSamplerThread::setDevice(int rate, ConstString portPrefix, int nAxes, bool logOnDisk)
+{
+    numberOfJoints = nAxes;
+    data.resize(numberOfJoints);
+
+    portName = portPrefix + "sampler";
+    port.open(portName.c_str());
+
+    logToFile = logOnDisk;
+    this->setRate(rate);
+}
+
+void boardSamplerThread::setThetaMap(int *map, int n)
+{
+    fprintf(stderr, "Setting the map dimension %d \n", n);
+    dataMap.assign(map, map+n);
+}
+
+void boardSamplerThread::addGetter(GetData *g, ConstString dataToDump)
+{
+    getters.push_back(g);
+    names.push_back(dataToDump.c_str());
+}
+
+bool boardSamplerThread::threadInit()
+{
+    // discard the joints out of range once for all
+    std::vector<int> validMap;
+    for (size_t i=0; i<dataMap.size(); i++)
+    {
+        if (dataMap[i]>=0 && dataMap[i]<numberOfJoints)
+            validMap.push_back(dataMap[i]);
+        else
+            fprintf(stderr, "boardSamplerThread::warning. Joint %d does not exist, skipping it \n", dataMap[i]);
+    }
+    dataMap = validMap;
+    record.resize(getters.size()*dataMap.size());
+
+    if (logToFile)
+    {
+        std::string fileName = portName;
+        for (size_t i=0; i<fileName.size(); i++)
+            if (fileName[i]=='/') fileName[i]='_';
+        fileName += ".bin";
+
+        logFile = fopen(fileName.c_str(),"wb");
+        if (logFile == 0)
+        {
+            printf ("error opening logfile: %s\n",fileName.c_str());
+        }
+        else
+        {
+            printf ("logfile opened: %s\n",fileName.c_str());
+            logBuffer = new char [LOG_BUFFER_SIZE];
+            setvbuf(logFile, logBuffer, _IOFBF, LOG_BUFFER_SIZE);
+
+            fprintf(logFile, "controlBoardDumper sampler joints (");
+            for (size_t i=0; i<dataMap.size(); i++)
+                fprintf(logFile, i ? " %d" : "%d", dataMap[i]);
+            fprintf(logFile, ") data (");
+            for (size_t i=0; i<names.size(); i++)
+                fprintf(logFile, i ? " %s" : "%s", names[i].c_str());
+            fprintf(logFile, ") record (int32 counter, float64 time, float64 values[%d][%d])\n",
+                    (int)names.size(), (int)dataMap.size());
+        }
+    }
+    return true;
+}
+
+void boardSamplerThread::threadRelease()
+{
+    fprintf(stderr, "Closing ports \n");
+    port.close();
+
+    if (logFile)
+    {
+        fprintf(stderr, "Closing logFile \n");
+        fclose (logFile);
+        logFile = 0;
+    }
+    delete [] logBuffer;
+    logBuffer = 0;
+}
+
+void boardSamplerThread::run()
+{
+    if (getters.empty() || numberOfJoints<=0)
+        return;
+
+    // all the data are read in a row, the time stamp is the one of the
+    // first data providing a valid stamp
+    bool stamped = false;
+    double *out = record.data();
+    for (size_t k=0; k<getters.size(); k++)
+    {
+        getters[k]->getData(&data[0]);
+        if (!stamped && getters[k]->getStamp(stmp) && stmp.isValid())
+            stamped = true;
+        for (size_t i=0; i<dataMap.size(); i++)
+            *out++ = data[dataMap[i]];
+    }
+    if (!stamped)
+        stmp.update();
+
+    port.setEnvelope(stmp);
+    port.write(record);
+
+    if (logFile)
+    {
+        int    count = stmp.getCount();
+        double time  = stmp.getTime();
+        fwrite(&count, sizeof(count), 1, logFile);
+        fwrite(&time,  sizeof(time),  1, logFile);
+        fwrite(record.data(), sizeof(double), record.size(), logFile);
+    }
+}
@@ -0,0 +1,78 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/* 
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#ifndef __SAMPLERTHREAD_H__
+#define __SAMPLERTHREAD_H__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/RateThread.h>
+#include <yarp/sig/Vector.h>
+
+#include "genericControlBoardDumper.h"
+
+/*
+ * Reads all the requested data of a board in one pass per cycle and
+ * publishes them as a single record, so that all the quantities share
+ * the same time stamp.
+ *
+ * The record sent on the port is a yarp::sig::Vector of nData*nJoints
+ * doubles (the joints of the first data, then the joints of the second
+ * one, ...), with the time stamp in the envelope.
+ *
+ * If logged on disk the file starts with one line of text describing
+ * the layout, followed by the records in binary form (native byte order):
+ *   int32   counter
+ *   float64 time
+ *   float64 values[nData][nJoints]
+ */
+class boardSamplerThread: public RateThread
+{
+public:
+  boardSamplerThread();
+  ~boardSamplerThread();
+  void setDevice(int rate, ConstString portPrefix, int nAxes, bool logOnDisk);
+  void setThetaMap(int *, int);
+  void addGetter(GetData *, ConstString dataToDump);
+  bool threadInit();
+  void threadRelease();
+  void run();
+
+private:
+  std::vector<GetData*> getters;
+  std::vector<std::string> names;
+
+  std::string portName;
+  Port port;
+  FILE  *logFile;
+  bool   logToFile;
+  char  *logBuffer;
+  Stamp  stmp;
+
+  int numberOfJoints;
+  std::vector<double> data;         // all the joints of one data
+
+  std::vector<int> dataMap;         // the joints to be dumped
+  yarp::sig::Vector record;
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include <yarp/os/Property.h>
 #include <yarp/sig/all.h>
 
+#include <iCub/optimization/algorithms.h>
 #include <iCub/optimization/matrixTransformation.h>
 #include <iCub/learningMachine/IMachineLearner.h>
 
@@ -43,6 +44,8 @@ protected:
         bool extrapolation;
         yarp::sig::Matrix R;
         yarp::sig::Vector radii;
+        // grows along with the points, to warm start the computation
+        iCub::optimization::MinVolumeEllipsoid mvee;
         SpatialCompetence() : extrapolation(true), scale(1.0)
         {
             A=yarp::math::eye(3,3);
@@ -54,6 +57,7 @@ protected:
 
     virtual bool computeSpatialTransformation();
     virtual bool computeSpatialCompetence(const std::deque<yarp::sig::Vector> &points);
+    double evalSpatialCompetence(const yarp::sig::Vector &point) const;
     void copySuperClassData(const Calibrator &src);
 
 public:
@@ -67,6 +71,8 @@ public:
     virtual bool calibrate(double &error)=0;
     virtual bool retrieve(const yarp::sig::Vector &in, yarp::sig::Vector &out)=0;
     virtual double getSpatialCompetence(const yarp::sig::Vector &point);
+    virtual bool getSpatialCompetence(const std::deque<yarp::sig::Vector> &points, yarp::sig::Vector &competence);
+    virtual bool setSpatialCompetenceThreads(const int n) { return spatialCompetence.mvee.setNumThreads(n); }
     virtual bool toProperty(yarp::os::Property &info) const;
     virtual bool fromProperty(const yarp::os::Property &info);
     virtual ~Calibrator() { }
@@ -126,6 +132,7 @@ public:
     virtual Calibrator *operator[](const size_t i);
     virtual LocallyWeightedExperts &operator<<(Calibrator &c);
     virtual bool retrieve(const yarp::sig::Vector &in, yarp::sig::Vector &out);
+    virtual bool retrieve(const std::deque<yarp::sig::Vector> &in, std::deque<yarp::sig::Vector> &out);
     virtual void clear();
     virtual ~LocallyWeightedExperts();
 };
@@ -85,6 +85,7 @@ protected:
     double max_dist;
     double block_eyes;
     double exploration_wait;
+    int    competence_threads;
     int    roi_side;
     int    nEncs;
     int    test;
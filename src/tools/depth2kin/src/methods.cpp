@@ -66,7 +66,16 @@ bool Calibrator::computeSpatialTransformation()
 /************************************************************************/
 bool Calibrator::computeSpatialCompetence(const deque<Vector> &points)
 {
-    if (minVolumeEllipsoid(points,0.001,spatialCompetence.A,spatialCompetence.c))
+    // points are only appended between two calls,
+    // hence the ellipsoid is fed with the new ones
+    MinVolumeEllipsoid &mvee=spatialCompetence.mvee;
+    if (points.size()<mvee.size())
+        mvee.clear();
+
+    for (size_t i=mvee.size(); i<points.size(); i++)
+        mvee.addPoint(points[i].subVector(0,2));
+
+    if (mvee.compute(spatialCompetence.A,spatialCompetence.c))
         if (computeSpatialTransformation())
             return true;
 
@@ -85,20 +94,29 @@ void Calibrator::copySuperClassData(const Calibrator &src)
 
 
 /************************************************************************/
-double Calibrator::getSpatialCompetence(const Vector &point)
+double Calibrator::evalSpatialCompetence(const Vector &point) const
 {
-    if (point.length()<3)
-        return 0.0;
+    // scalar operations only, as it is called for any retrieved point
+    const SpatialCompetence &sc=spatialCompetence;
+    const Matrix &A=sc.A;
+    const Matrix &R=sc.R;
+
+    double x[3];
+    for (int i=0; i<3; i++)
+        x[i]=(point[i]-sc.c[i])/sc.scale;
 
-    Vector x=(point.subVector(0,2)-spatialCompetence.c)/spatialCompetence.scale;
-    if (dot(x,spatialCompetence.A*x)<=1.0)
+    double xAx=0.0;
+    for (int r=0; r<3; r++)
+        xAx+=x[r]*(A(r,0)*x[0]+A(r,1)*x[1]+A(r,2)*x[2]);
+
+    if (xAx<=1.0)
         return 1.0;
-    else if (spatialCompetence.extrapolation)
+    else if (sc.extrapolation)
     {
         // getting cartesian coordinates wrt (A,c) frame
-        x.push_back(1.0);
-        x=spatialCompetence.R*x;
-        x.pop_back();
+        double y[3];
+        for (int r=0; r<3; r++)
+            y[r]=R(r,0)*x[0]+R(r,1)*x[1]+R(r,2)*x[2]+R(r,3);
 
         // distance approximated as ||x-xp||,
         // where xp is the projection of x over
@@ -106,24 +124,56 @@ double Calibrator::getSpatialCompetence(const Vector &point)
         // x with the origin
 
         // switch to spherical coordinates
-        double cos_theta=x[2]/norm(x);
+        double cos_theta=y[2]/sqrt(y[0]*y[0]+y[1]*y[1]+y[2]*y[2]);
         double theta=acos(cos_theta);
-        double phi=atan2(x[1],x[0]);
+        double phi=atan2(y[1],y[0]);
 
-        Vector xp(3);
         double cos_phi=cos(phi);
-        xp[0]=spatialCompetence.radii[0]*cos_theta*cos_phi;
-        xp[1]=spatialCompetence.radii[1]*sin(theta)*cos_phi;
-        xp[2]=spatialCompetence.radii[2]*sin(phi);
+        double dx=y[0]-sc.radii[0]*cos_theta*cos_phi;
+        double dy=y[1]-sc.radii[1]*sin(theta)*cos_phi;
+        double dz=y[2]-sc.radii[2]*sin(phi);
 
-        double d=norm(x-xp);
-        return exp(-40.0*d*d);  // competence(0.2 [m])=0.2
+        double d2=dx*dx+dy*dy+dz*dz;
+        return exp(-40.0*d2);   // competence(0.2 [m])=0.2
     }
     else
         return 0.0;
 }
 
 
+/************************************************************************/
+double Calibrator::getSpatialCompetence(const Vector &point)
+{
+    if (point.length()<3)
+        return 0.0;
+
+    return evalSpatialCompetence(point);
+}
+
+
+/************************************************************************/
+bool Calibrator::getSpatialCompetence(const deque<Vector> &points,
+                                      Vector &competence)
+{
+    if (competence.length()!=points.size())
+        competence.resize(points.size());
+
+    bool ret=true;
+    for (size_t i=0; i<points.size(); i++)
+    {
+        if (points[i].length()>=3)
+            competence[i]=evalSpatialCompetence(points[i]);
+        else
+        {
+            competence[i]=0.0;
+            ret=false;
+        }
+    }
+
+    return ret;
+}
+
+
 /************************************************************************/
 bool Calibrator::toProperty(Property &info) const
 {
@@ -241,7 +291,8 @@ bool MatrixCalibrator::clearPoints()
 {
     impl->clearPoints();
     in.clear();
-    out.clear();    
+    out.clear();
+    spatialCompetence.mvee.clear();
     return true;
 }
 
@@ -395,6 +446,7 @@ bool LSSVMCalibrator::clearPoints()
     impl->reset();
     in.clear();
     out.clear();
+    spatialCompetence.mvee.clear();
     return true;
 }
 
@@ -568,6 +620,64 @@ bool LocallyWeightedExperts::retrieve(const Vector &in, Vector &out)
 }
 
 
+/************************************************************************/
+bool LocallyWeightedExperts::retrieve(const deque<Vector> &in, deque<Vector> &out)
+{
+    out.clear();
+    for (size_t n=0; n<in.size(); n++)
+        if (in[n].length()<3)
+            return false;
+
+    size_t N=in.size();
+    Vector outExperts(3*N,0.0);
+    Vector outExtrapolators(3*N,0.0);
+    Vector sumExperts(N,0.0);
+    Vector sumExtrapolators(N,0.0);
+    Vector competence,pred,_in(3);
+
+    // collect information over available models,
+    // querying the competence for the whole batch
+    for (size_t i=0; i<models.size(); i++)
+    {
+        models[i]->getSpatialCompetence(in,competence);
+        for (size_t n=0; n<N; n++)
+        {
+            if (competence[n]>0.0)
+            {
+                for (int j=0; j<3; j++)
+                    _in[j]=in[n][j];
+
+                models[i]->retrieve(_in,pred);
+                for (int j=0; j<3; j++)
+                {
+                    outExtrapolators[3*n+j]+=competence[n]*pred[j];
+                    if (competence[n]>=1.0)
+                        outExperts[3*n+j]+=competence[n]*pred[j];
+                }
+
+                sumExtrapolators[n]+=competence[n];
+                if (competence[n]>=1.0)
+                    sumExperts[n]+=competence[n];
+            }
+        }
+    }
+
+    // consider experts first, then extrapolators;
+    // stop at the first point for which no models are found
+    for (size_t n=0; n<N; n++)
+    {
+        if (sumExperts[n]!=0.0)
+            out.push_back(outExperts.subVector(3*n,3*n+2)/sumExperts[n]);
+        else if (sumExtrapolators[n]!=0.0)
+            out.push_back(outExtrapolators.subVector(3*n,3*n+2)/sumExtrapolators[n]);
+        else
+            return false;
+    }
+
+    return true;
+}
+
+
 /************************************************************************/
 void LocallyWeightedExperts::clear()
 {
@@ -883,6 +883,7 @@ bool CalibModule::configure(ResourceFinder &rf)
     roi_side=abs(rf.check("roi_side",Value(100)).asInt());
     block_eyes=fabs(rf.check("block_eyes",Value(5.0)).asDouble());
     exploration_wait=fabs(rf.check("exploration_wait",Value(0.5)).asDouble());
+    competence_threads=std::max(1,rf.check("competence_threads",Value(1)).asInt());
 
     motorExplorationAsyncStop=false;
     motorExplorationState=motorExplorationStateIdle;
@@ -902,6 +903,7 @@ bool CalibModule::configure(ResourceFinder &rf)
     
     load();
     calibrator=factory(type);
+    calibrator->setSpatialCompetenceThreads(competence_threads);
 
     Vector min(6),max(6);
     min[0]=-0.005;             max[0]=0.005;
@@ -1241,26 +1243,37 @@ bool CalibModule::log(const string &type)
     bool useExperts=(type=="experts");
     if (fout.is_open())
     {
-        size_t i;
-        for (i=0; i<p_depth.size(); i++)
+        deque<Vector> x;
+        if (useExperts)
+            ret=experts->retrieve(p_depth,x);
+        else
         {
-            Vector x;
-            if (!(useExperts?experts->retrieve(p_depth[i],x):
-                             calibrator->retrieve(p_depth[i],x)))
-                break;
+            ret=true;
+            for (size_t i=0; i<p_depth.size(); i++)
+            {
+                Vector xi;
+                if (!calibrator->retrieve(p_depth[i],xi))
+                {
+                    ret=false;
+                    break;
+                }
+                x.push_back(xi);
+            }
+        }
 
+        for (size_t i=0; i<x.size(); i++)
+        {
             fout<<p_depth[i].toString(3,3).c_str();
             fout<<" ";
             fout<<p_kin[i].toString(3,3).c_str();
             fout<<" ";
-            fout<<x.toString(3,3).c_str();
+            fout<<x[i].toString(3,3).c_str();
             fout<<" ";
-            fout<<norm(p_kin[i]-x);
+            fout<<norm(p_kin[i]-x[i]);
             fout<<endl;
         }
 
         fout.close();
-        ret=(i>=p_depth.size());
     }
 
     mutex.unlock();
@@ -1385,6 +1398,7 @@ bool CalibModule::setCalibrationType(const string &type, const string &extrapola
     {
         delete calibrator;
         calibrator=factory(type);
+        calibrator->setSpatialCompetenceThreads(competence_threads);
         (extrapolation=="auto")?calibrator->setExtrapolation(type!="lssvm"):
                                 calibrator->setExtrapolation(extrapolation=="true");
 
@@ -20,81 +20,249 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <algorithm>
 #include <stdio.h>
 #include <yarp/os/Semaphore.h>
 
 //private classes
+struct stored_entry
+{
+    message_entry body;
+    int           source;       // index in logger_thread::sources
+};
+
+// the sequence numbers of the messages in memory, from the oldest one
+typedef std::deque<unsigned long> seq_index;
+
 class logger_thread : public Thread
 {
     public:
     yarp::os::Semaphore mutex;
-    std::list<log_entry> log_list;
     Port logger_port;
     std::string portName;
-    
+
+    // ring buffer: the message with sequence number n is stored in
+    // ring[n%ring.size()], the ones in memory are [first_seq, next_seq)
+    std::vector<stored_entry> ring;
+    unsigned long first_seq;
+    unsigned long next_seq;
+
+    // the senders, and the messages in memory of each port, process and pid
+    std::vector<log_source>          sources;
+    std::map<std::string, int>       source_ids;
+    std::map<std::string, seq_index> by_port;
+    std::map<std::string, seq_index> by_process;
+    std::map<std::string, seq_index> by_pid;
+
+    // optional copy of the messages on disk
+    FILE*       log_file;
+    std::string log_file_name;
+    long        log_file_size;
+    long        log_file_max_size;
+    int         log_file_max_num;
+
     public:
+    logger_thread(std::string name, int capacity);
+    ~logger_thread();
     void run();
+    void onStop();
+
+    void append(const std::string& header, const message_entry& body);
+    void save(const std::string& header, const message_entry& body);
+    void rotate();
+
+    const stored_entry& at(unsigned long seq) const { return ring[seq%ring.size()]; }
+    void get(const seq_index& index, double t0, double t1, std::list<message_entry>& messages);
+    void get(const std::map<std::string, seq_index>& indexes, const std::string& key, 
+             double t0, double t1, std::list<message_entry>& messages);
+};
+
+// orders the sequence numbers by the reception time of their messages
+class entry_time_less
+{
+    const logger_thread* t;
+    public:
+    entry_time_less(const logger_thread* _t) : t(_t) {}
+    bool operator()(unsigned long seq, double time) const { return t->at(seq).body.time<time; }
 };
 
-void log_entry::clear()
+logger_thread::logger_thread(std::string name, int capacity)
 {
-    entry_list.clear();
+    portName  = name;
+    ring.resize(capacity>0 ? capacity : 1);
+    first_seq = 0;
+    next_seq  = 0;
+    log_file  = 0;
+    log_file_size     = 0;
+    log_file_max_size = 0;
+    log_file_max_num  = 0;
 }
 
-void log_entry::append(message_entry entry)
+logger_thread::~logger_thread()
 {
-    entry_list.push_back(entry);
+    if (log_file)
+    {
+        fclose(log_file);
+        log_file = 0;
+    }
 }
 
-void logger_thread::run()
+void logger_thread::onStop()
 {
-    while (1)
+    // unblock the pending read
+    logger_port.interrupt();
+}
+
+void logger_thread::append(const std::string& header, const message_entry& body)
+{
+    int id;
+    std::map<std::string, int>::iterator s = source_ids.find(header);
+    if (s != source_ids.end())
     {
-        yarp::os::Time::delay(0.1);
-        this->mutex.wait();
+        id = s->second;
+    }
+    else
+    {
+        log_source source;
+        std::istringstream iss(header);
+        std::string token;
+        getline(iss, token, '/');
+        getline(iss, token, '/');
+        getline(iss, token, '/'); source.port = token;
+        getline(iss, token, '/'); source.process_name = token;
+        getline(iss, token, '/'); source.process_pid = token.empty() ? token : token.erase(token.size()-1);
+        id = sources.size();
+        sources.push_back(source);
+        source_ids[header] = id;
+    }
+
+    // the oldest message is the first one of all its indexes
+    if (next_seq-first_seq == ring.size())
+    {
+        const log_source& old = sources[at(first_seq).source];
+        by_port[old.port].pop_front();
+        by_process[old.process_name].pop_front();
+        by_pid[old.process_pid].pop_front();
+        first_seq++;
+    }
+
+    stored_entry& e = ring[next_seq%ring.size()];
+    e.body   = body;
+    e.source = id;
+    const log_source& src = sources[id];
+    by_port[src.port].push_back(next_seq);
+    by_process[src.process_name].push_back(next_seq);
+    by_pid[src.process_pid].push_back(next_seq);
+    next_seq++;
+}
+
+void logger_thread::rotate()
+{
+    fclose(log_file);
+    for (int i=log_file_max_num-1; i>0; i--)
+    {
+        std::ostringstream from, to;
+        from << log_file_name << "." << i;
+        to   << log_file_name << "." << i+1;
+        ::rename(from.str().c_str(), to.str().c_str());
+    }
+    if (log_file_max_num>0)
+    {
+        std::string to = log_file_name + ".1";
+        ::rename(log_file_name.c_str(), to.c_str());
+    }
+    log_file = fopen(log_file_name.c_str(), "w");
+    log_file_size = 0;
+    if (log_file==0)
+        fprintf(stderr, "Unable to open the log file %s, messages will not be saved anymore\n", log_file_name.c_str());
+}
 
+void logger_thread::save(const std::string& header, const message_entry& body)
+{
+    int n = fprintf(log_file, "%s %s %s\n", body.timestamp.c_str(), header.c_str(), body.messeges.c_str());
+    if (n>0)
+        log_file_size += n;
+    if (log_file_max_size>0 && log_file_size>=log_file_max_size)
+        rotate();
+}
+
+void logger_thread::run()
+{
+    // the messages are read as soon as they arrive, and the lock is taken
+    // only to store them, so that the queries never delay the reading
+    while (!isStopping())
+    {
         Bottle b;
-        logger_port.read(b);
+        if (!logger_port.read(b))
+            continue;
         if (b.size()!=2) 
         {
             fprintf (stderr, "unkwnon log format!\n");
             continue;
         }
 
-        std::string header = b.get(0).asString();
+        std::string header = b.get(0).asString().c_str();
         message_entry body;
-        body.messeges = b.get(1).asString();
-        body.timestamp = "";
-
-        log_entry entry;
-        std::istringstream iss(header);
-        std::string token;
-        getline(iss, token, '/');
-        getline(iss, token, '/');
-        getline(iss, token, '/'); entry.port = token;
-        getline(iss, token, '/'); entry.process_name = token;
-        getline(iss, token, '/'); entry.process_pid = token.erase(token.size()-1);
-        
-        std::list<log_entry>::iterator it;
-        for (it = log_list.begin(); it != log_list.end(); it++)
-        {
-            if (it->process_pid==entry.process_pid)
-            {
-                it->append(body);
-                break;
-            }
-        }
-        if (it == log_list.end())
-        {
-            entry.append(body);
-            log_list.push_back(entry);
-        }
+        body.messeges = b.get(1).asString().c_str();
+        body.time = yarp::os::Time::now();
+        char stamp[32];
+        sprintf(stamp, "%.3f", body.time);
+        body.timestamp = stamp;
 
+        this->mutex.wait();
+        append(header, body);
         this->mutex.post();
+
+        if (log_file)
+            save(header, body);
     }
 }
 
+void logger_thread::get(const seq_index& index, double t0, double t1, std::list<message_entry>& messages)
+{
+    seq_index::const_iterator it = std::lower_bound(index.begin(), index.end(), t0, entry_time_less(this));
+    for (; it != index.end() && at(*it).body.time<=t1; it++)
+        messages.push_back(at(*it).body);
+}
+
+void logger_thread::get(const std::map<std::string, seq_index>& indexes, const std::string& key, 
+                        double t0, double t1, std::list<message_entry>& messages)
+{
+    messages.clear();
+    mutex.wait();
+    std::map<std::string, seq_index>::const_iterator it = indexes.find(key);
+    if (it != indexes.end())
+        get(it->second, t0, t1, messages);
+    mutex.post();
+}
+
 //public methods
+bool logger::set_log_file(std::string fileName, long maxSize, int maxFiles)
+{
+    if (log_updater->isRunning())
+    {
+        fprintf(stderr,"The log file must be set before starting the logger\n");
+        return false;
+    }
+    if (log_updater->log_file)
+        fclose(log_updater->log_file);
+    log_updater->log_file = fopen(fileName.c_str(), "a");
+    if (log_updater->log_file==0)
+    {
+        fprintf(stderr,"Unable to open the log file %s\n", fileName.c_str());
+        return false;
+    }
+    fseek(log_updater->log_file, 0, SEEK_END);
+    log_updater->log_file_size     = ftell(log_updater->log_file);
+    log_updater->log_file_name     = fileName;
+    log_updater->log_file_max_size = maxSize;
+    log_updater->log_file_max_num  = maxFiles;
+    return true;
+}
+
 bool logger::start()
 {
     if (log_updater->logger_port.open(log_updater->portName.c_str())==true)
@@ -115,12 +283,13 @@ void logger::stop()
 {
     log_updater->stop();
     log_updater->logger_port.close();
+    if (log_updater->log_file)
+        fflush(log_updater->log_file);
 }
 
-logger::logger(std::string portName)
+logger::logger(std::string portName, int capacity)
 {
-    log_updater=new logger_thread();
-    log_updater->portName = portName;
+    log_updater=new logger_thread(portName, capacity);
 }
 
 logger::~logger()
@@ -134,45 +303,66 @@ logger::~logger()
 
 void logger::get_messages_by_port    (std::string  port,  std::list<message_entry>& messages)
 {
+    log_updater->get(log_updater->by_port, port, -1e300, 1e300, messages);
+}
+
+void logger::get_messages_by_process (std::string  process,  std::list<message_entry>& messages)
+{
+    log_updater->get(log_updater->by_process, process, -1e300, 1e300, messages);
+}
+
+void logger::get_messages_by_pid     (std::string pid, std::list<message_entry>& messages)
+{
+    log_updater->get(log_updater->by_pid, pid, -1e300, 1e300, messages);
+}
+
+void logger::get_messages_by_port    (std::string  port, double t0, double t1, std::list<message_entry>& messages)
+{
+    log_updater->get(log_updater->by_port, port, t0, t1, messages);
+}
+
+void logger::get_messages_by_process (std::string  process, double t0, double t1, std::list<message_entry>& messages)
+{
+    log_updater->get(log_updater->by_process, process, t0, t1, messages);
+}
+
+void logger::get_messages_by_pid     (std::string pid, double t0, double t1, std::list<message_entry>& messages)
+{
+    log_updater->get(log_updater->by_pid, pid, t0, t1, messages);
+}
+
+void logger::get_messages            (double t0, double t1, std::list<message_entry>& messages)
+{
+    messages.clear();
     log_updater->mutex.wait();
-    std::list<log_entry>::iterator it;
-    for (it = log_updater->log_list.begin(); it != log_updater->log_list.end(); it++)
+    // the ring itself is ordered by reception time
+    unsigned long lo = log_updater->first_seq;
+    unsigned long hi = log_updater->next_seq;
+    while (lo<hi)
     {
-        if (it->port == port)
-        {
-            messages = (it->entry_list);
-            break;
-        }
+        unsigned long mid = lo+(hi-lo)/2;
+        if (log_updater->at(mid).body.time<t0)
+            lo = mid+1;
+        else
+            hi = mid;
     }
+    for (; lo<log_updater->next_seq && log_updater->at(lo).body.time<=t1; lo++)
+        messages.push_back(log_updater->at(lo).body);
     log_updater->mutex.post();
 }
 
-void logger::get_messages_by_process (std::string  process,  std::list<message_entry>& messages)
+int logger::get_num_messages()
 {
     log_updater->mutex.wait();
-    std::list<log_entry>::iterator it;
-    for (it = log_updater->log_list.begin(); it != log_updater->log_list.end(); it++)
-    {
-        if (it->process_name == process)
-        {
-            messages = (it->entry_list);
-            break;
-        }
-    }
+    int n = (int)(log_updater->next_seq-log_updater->first_seq);
     log_updater->mutex.post();
+    return n;
 }
 
-void logger::get_messages_by_pid     (std::string pid, std::list<message_entry>& messages)
+int logger::get_num_discarded_messages()
 {
     log_updater->mutex.wait();
-    std::list<log_entry>::iterator it;
-    for (it = log_updater->log_list.begin(); it != log_updater->log_list.end(); it++)
-    {
-        if (it->process_pid == pid)
-        {
-            messages = (it->entry_list);
-            break;
-        }
-    }
+    int n = (int)log_updater->first_seq;
     log_updater->mutex.post();
+    return n;
 }
@@ -33,19 +33,15 @@ struct message_entry
 {
     std::string messeges;
     std::string timestamp;
+    double      time;           // reception time, used by the time range queries
 };
 
-class log_entry
+// the sender of a log message
+struct log_source
 {
-    public:
-    std::list<message_entry> entry_list;
-
-    public:
     std::string  port;
     std::string  process_name;
     std::string  process_pid;
-    void clear();
-    void append(message_entry entry);
 };
 
 class logger_thread;
@@ -56,13 +52,36 @@ class logger
     logger_thread* log_updater;
 
     public:
-    logger(std::string portName);
+    /**
+    * @param portName the port receiving the log messages
+    * @param capacity the maximum number of messages kept in memory: when it is
+    * reached, every new message replaces the oldest one
+    */
+    logger(std::string portName, int capacity=10000);
     ~logger();
+
+    /**
+    * Save all the received messages to a text file, which is renamed to
+    * fileName.1 (and the older ones to fileName.2, ...) when it grows beyond
+    * maxSize bytes; at most maxFiles old files are kept.
+    * It must be called before start().
+    */
+    bool set_log_file(std::string fileName, long maxSize=10000000, int maxFiles=5);
+
     bool start();
     void stop();
 
+    // all the messages still in memory, from the oldest one
     void get_messages_by_port    (std::string  port,    std::list<message_entry>& messages);
     void get_messages_by_process (std::string  process, std::list<message_entry>& messages);
     void get_messages_by_pid     (std::string  pid,     std::list<message_entry>& messages);
-    
+
+    // the messages received in the time interval [t0, t1] (see yarp::os::Time::now())
+    void get_messages_by_port    (std::string  port,    double t0, double t1, std::list<message_entry>& messages);
+    void get_messages_by_process (std::string  process, double t0, double t1, std::list<message_entry>& messages);
+    void get_messages_by_pid     (std::string  pid,     double t0, double t1, std::list<message_entry>& messages);
+    void get_messages            (double t0, double t1, std::list<message_entry>& messages);
+
+    int  get_num_messages();            // the messages in memory
+    int  get_num_discarded_messages();  // the messages replaced by newer ones
 };
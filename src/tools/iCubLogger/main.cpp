@@ -21,6 +21,7 @@
 #include <yarp/os/Bottle.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/Vocab.h>
+#include <yarp/os/Property.h>
 
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
@@ -58,9 +59,26 @@ int main(int argc, char *argv[])
     */
     Network::init();
 	Time::turboBoost();
-    
-    logger l("/logger");
-    l.start();
+
+    // --capacity: messages kept in memory
+    // --log_file: if given, all the messages are also saved to this file,
+    // rotated when it reaches --log_file_size bytes keeping --log_file_num old files
+    Property options;
+    options.fromCommand(argc, argv);
+    int capacity = options.check("capacity",Value(10000)).asInt();
+
+    logger l("/logger", capacity);
+    if (options.check("log_file"))
+    {
+        l.set_log_file(options.find("log_file").asString().c_str(),
+                       options.check("log_file_size",Value(10000000)).asInt(),
+                       options.check("log_file_num",Value(5)).asInt());
+    }
+    if (!l.start())
+    {
+        Network::fini();
+        return 1;
+    }
 
     while(1)
     {
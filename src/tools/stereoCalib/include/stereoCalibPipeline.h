@@ -0,0 +1,134 @@
+#ifndef __STEREOCALIB_PIPELINE_H__
+#define __STEREOCALIB_PIPELINE_H__
+
+#include <deque>
+#include <vector>
+#include <yarp/sig/Image.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
+#include <cv.h>
+
+
+// a stereo pair together with the corners found on it
+struct stereoView
+{
+    yarp::sig::ImageOf<yarp::sig::PixelRgb> left;
+    yarp::sig::ImageOf<yarp::sig::PixelRgb> right;
+    std::vector<cv::Point2f> cornersL;
+    std::vector<cv::Point2f> cornersR;
+    double stamp;
+};
+
+
+// finds the chessboard on one eye, so that the two
+// eyes of a pair are processed concurrently
+class chessboardDetector : public yarp::os::Thread
+{
+private:
+    yarp::os::Semaphore go;
+    yarp::os::Semaphore done;
+
+    cv::Size boardSize;
+    double coarseScale;
+
+    cv::Mat image;
+    std::vector<cv::Point2f> *corners;
+    bool found;
+
+public:
+    chessboardDetector(const cv::Size &boardSize, double coarseScale);
+
+    // the board is searched for on the image downscaled by coarseScale
+    // and only if found the corners are refined at full resolution
+    static bool detect(const cv::Mat &image, const cv::Size &boardSize,
+                       double coarseScale, std::vector<cv::Point2f> &corners);
+
+    // image and corners must be left untouched until wait() returns
+    void post(const cv::Mat &image, std::vector<cv::Point2f> &corners);
+    bool wait();
+
+    void run();
+    void onStop();
+};
+
+
+// reruns the calibration on the views collected so far,
+// giving an early feedback on the quality of the data
+class stereoCalibRefiner : public yarp::os::Thread
+{
+private:
+    yarp::os::Semaphore go;
+    yarp::os::Semaphore mutex;
+    bool busy;
+
+    cv::Size boardSize;
+    float squareSize;
+    cv::Size imageSize;
+    std::vector<std::vector<cv::Point2f> > imagePoints[2];
+
+public:
+    stereoCalibRefiner(const cv::Size &boardSize, float squareSize);
+
+    // returns false if the previous calibration is still running
+    bool post(const std::vector<std::vector<cv::Point2f> > imagePoints[2],
+              const cv::Size &imageSize);
+
+    void run();
+    void onStop();
+};
+
+
+// takes the stereo pairs queued by the acquisition thread, looks for
+// the chessboard on both eyes concurrently and hands back the pairs
+// where the board has been found
+class stereoCalibPipeline : public yarp::os::Thread
+{
+private:
+    yarp::os::Semaphore mutex;
+    yarp::os::Semaphore pending;
+
+    std::deque<stereoView*> input;
+    std::deque<stereoView*> output;
+    size_t queueLength;
+    double minViewInterval;
+    double lastStamp;
+    bool accepted;
+    int dropped;
+    // incremented by clear(), so that a view under detection
+    // when the collection is cleared is discarded afterwards
+    unsigned int generation;
+
+    chessboardDetector detectorL;
+    chessboardDetector detectorR;
+
+    stereoCalibRefiner refiner;
+    int refineEvery;
+    std::vector<std::vector<cv::Point2f> > imagePoints[2];
+
+    void flush();
+
+public:
+    stereoCalibPipeline(const cv::Size &boardSize, float squareSize,
+                        double coarseScale, int queueLength,
+                        double minViewInterval, int refineEvery);
+
+    // the pair is copied; if the queue is full the oldest pair is dropped
+    void push(const yarp::sig::ImageOf<yarp::sig::PixelRgb> &left,
+              const yarp::sig::ImageOf<yarp::sig::PixelRgb> &right,
+              double stamp);
+
+    // the caller takes the ownership of the returned view
+    stereoView *pop();
+
+    // discards the queued pairs and the collected views
+    void clear();
+    int getDropped();
+
+    bool threadInit();
+    void run();
+    void onStop();
+    void threadRelease();
+    ~stereoCalibPipeline();
+};
+
+#endif
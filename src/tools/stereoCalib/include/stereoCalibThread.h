@@ -14,6 +14,8 @@
 #include <iCub/iKin/iKinFwd.h>
 #include <iCub/ctrl/math.h>
 
+#include "stereoCalibPipeline.h"
+
 
 using namespace cv;
 using namespace yarp::sig;
@@ -46,6 +48,8 @@ private:
 
     int numOfPairs;
     bool stereo;
+    bool pipelined;
+    stereoCalibPipeline *pipeline;
     Mat Kleft;
     Mat Kright;
     
@@ -99,14 +103,19 @@ private:
     void monoCalibration(const vector<string>& imageList, int boardWidth, int boardHeight, Mat &K, Mat &Dist);
     void stereoCalibration(const vector<string>& imagelist, int boardWidth, int boardHeight,float sqsizee);
     void saveCalibration(const string& extrinsicFilePath, const string& intrinsicFilePath);
-    void calcChessboardCorners(Size boardSize, float squareSize, vector<Point3f>& corners);
+    static void calcChessboardCorners(Size boardSize, float squareSize, vector<Point3f>& corners);
     bool updateIntrinsics( int width, int height, double fx, double fy,double cx, double cy, double k1, double k2, double p1, double p2, const string& groupname);
     bool updateExtrinsics(Mat Rot, Mat Tr, const string& groupname);
     void saveImage(const char * imageDir, IplImage* left, int num);
+    void saveCalibrationResults(int width, int height);
     void stereoCalibRun();
+    void stereoCalibRunPipelined();
     void monoCalibRun();
 
 public:
+    static double monoCalibration(const vector<vector<Point2f> > &imagePoints, Size boardSize, Size imageSize, Mat &K, Mat &Dist);
+    static double stereoCalibration(const vector<vector<Point2f> > imagePoints[2], Size boardSize, float squareSize, Size imageSize,
+                                    Mat &KL, Mat &DL, Mat &KR, Mat &DR, Mat &R, Mat &T);
 
 
     stereoCalibThread(ResourceFinder &rf, Port* commPort, const char *imageDir);
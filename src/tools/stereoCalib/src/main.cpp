@@ -44,6 +44,7 @@ boardHeight H
 boardSize S
 numberOfImages N
 MonoCalib value
+pipeline value
 \endcode
 
 This is the ONLY group used by the module. Other groups in your config file will be discarded. See below for the parameter description. Calibration results will be saved in the specified context (default is: $ICUB_ROOT/main/app/cameraCalibration/conf/outputCalib.ini). You should replace your old calibration file (e.g. icubEyes.ini) with this new one.
@@ -69,6 +70,21 @@ YARP libraries and OpenCV
 --MonoCalib \e Val 
 - The parameter \e Val identifies if the module has to run the stereo calibration (Val=0) or the mono calibration (Val=1). For the mono calibration connect only the camera that you want to calibrate.
 
+--pipeline \e Val 
+- If \e Val is 1, the stereo pairs are queued and the chessboard is searched for on both the eyes concurrently by worker threads, so that the acquisition never stops (default 0). The corners found on the pairs are used directly for the calibration, without processing the saved images again.
+
+--coarseScale \e Scale 
+- In pipeline mode, the chessboard is first searched for on the images downscaled by \e Scale and only if found the corners are refined at full resolution (default 0.5). Use 1.0 to disable the coarse search.
+
+--queueLength \e Len 
+- In pipeline mode, the maximum number of pairs waiting for the detection; when the queue is full the oldest pair is dropped (default 4).
+
+--minViewInterval \e Time 
+- In pipeline mode, the minimum time in seconds between two pairs used for the calibration, to leave time to move the chessboard (default 2.0).
+
+--refineEvery \e Num 
+- In pipeline mode, the calibration is run in background on the pairs collected so far every \e Num new pairs, to give a feedback on the quality of the data (default 5). Use 0 to disable it.
+
 \section portsc_sec Ports Created
 - <i> /stereoCalib/cam/left:i </i> accepts the incoming images from the left eye. 
 - <i> /stereoCalib/cam/right:i </i> accepts the incoming images from the right eye. 
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+#include "stereoCalibThread.h"
+#include "stereoCalibPipeline.h"
+
+
+chessboardDetector::chessboardDetector(const cv::Size &boardSize, double coarseScale) :
+                                       go(0), done(0), boardSize(boardSize),
+                                       coarseScale(coarseScale), corners(NULL), found(false)
+{
+}
+
+bool chessboardDetector::detect(const cv::Mat &image, const cv::Size &boardSize,
+                                double coarseScale, std::vector<cv::Point2f> &corners)
+{
+    cv::Mat gray;
+    cv::cvtColor(image,gray,CV_RGB2GRAY);
+    int flags=CV_CALIB_CB_ADAPTIVE_THRESH | CV_CALIB_CB_NORMALIZE_IMAGE | CV_CALIB_CB_FAST_CHECK;
+    int win=3;
+
+    // the cheap search on the small image rejects most of the frames
+    if ((coarseScale>0.0) && (coarseScale<1.0))
+    {
+        cv::Mat coarse;
+        cv::resize(gray,coarse,cv::Size(),coarseScale,coarseScale,cv::INTER_AREA);
+        if (!cv::findChessboardCorners(coarse,boardSize,corners,flags))
+            return false;
+
+        // bring the corners back to full resolution, the window
+        // has to cover the error due to the downscaling
+        for (size_t i=0; i<corners.size(); i++)
+        {
+            corners[i].x=(float)((corners[i].x+0.5)/coarseScale-0.5);
+            corners[i].y=(float)((corners[i].y+0.5)/coarseScale-0.5);
+        }
+        win=std::max(win,(int)ceil(2.0/coarseScale));
+    }
+    else if (!cv::findChessboardCorners(gray,boardSize,corners,flags))
+        return false;
+
+    cv::cornerSubPix(gray,corners,cv::Size(win,win),cv::Size(-1,-1),
+                     cv::TermCriteria(CV_TERMCRIT_EPS+CV_TERMCRIT_ITER,30,0.01));
+    return true;
+}
+
+void chessboardDetector::post(const cv::Mat &image, std::vector<cv::Point2f> &corners)
+{
+    this->image=image;
+    this->corners=&corners;
+    go.post();
+}
+
+bool chessboardDetector::wait()
+{
+    done.wait();
+    return found;
+}
+
+void chessboardDetector::run()
+{
+    while (true)
+    {
+        go.wait();
+        if (isStopping())
+            break;
+
+        found=detect(image,boardSize,coarseScale,*corners);
+        done.post();
+    }
+}
+
+void chessboardDetector::onStop()
+{
+    go.post();
+}
+
+
+stereoCalibRefiner::stereoCalibRefiner(const cv::Size &boardSize, float squareSize) :
+                                       go(0), mutex(1), busy(false),
+                                       boardSize(boardSize), squareSize(squareSize)
+{
+}
+
+bool stereoCalibRefiner::post(const std::vector<std::vector<cv::Point2f> > imagePoints[2],
+                              const cv::Size &imageSize)
+{
+    mutex.wait();
+    bool ret=!busy;
+    if (ret)
+    {
+        this->imagePoints[0]=imagePoints[0];
+        this->imagePoints[1]=imagePoints[1];
+        this->imageSize=imageSize;
+        busy=true;
+        go.post();
+    }
+    mutex.post();
+
+    return ret;
+}
+
+void stereoCalibRefiner::run()
+{
+    while (true)
+    {
+        go.wait();
+        if (isStopping())
+            break;
+
+        fprintf(stdout,"Refining the calibration on %d pairs... \n",(int)imagePoints[0].size());
+
+        cv::Mat KL,DL,KR,DR,R,T;
+        stereoCalibThread::monoCalibration(imagePoints[0],boardSize,imageSize,KL,DL);
+        stereoCalibThread::monoCalibration(imagePoints[1],boardSize,imageSize,KR,DR);
+        stereoCalibThread::stereoCalibration(imagePoints,boardSize,squareSize,imageSize,KL,DL,KR,DR,R,T);
+
+        mutex.wait();
+        busy=false;
+        mutex.post();
+    }
+}
+
+void stereoCalibRefiner::onStop()
+{
+    go.post();
+}
+
+
+stereoCalibPipeline::stereoCalibPipeline(const cv::Size &boardSize, float squareSize,
+                                         double coarseScale, int queueLength,
+                                         double minViewInterval, int refineEvery) :
+                                         mutex(1), pending(0),
+                                         queueLength(std::max(queueLength,1)),
+                                         minViewInterval(minViewInterval),
+                                         lastStamp(0.0), accepted(false), dropped(0),
+                                         generation(0),
+                                         detectorL(boardSize,coarseScale),
+                                         detectorR(boardSize,coarseScale),
+                                         refiner(boardSize,squareSize),
+                                         refineEvery(refineEvery)
+{
+}
+
+void stereoCalibPipeline::push(const yarp::sig::ImageOf<yarp::sig::PixelRgb> &left,
+                               const yarp::sig::ImageOf<yarp::sig::PixelRgb> &right,
+                               double stamp)
+{
+    stereoView *view=new stereoView;
+    view->left=left;
+    view->right=right;
+    view->stamp=stamp;
+
+    mutex.wait();
+    input.push_back(view);
+    if (input.size()>queueLength)
+    {
+        delete input.front();
+        input.pop_front();
+        dropped++;
+    }
+    else
+        pending.post();
+    mutex.post();
+}
+
+stereoView *stereoCalibPipeline::pop()
+{
+    stereoView *view=NULL;
+
+    mutex.wait();
+    if (!output.empty())
+    {
+        view=output.front();
+        output.pop_front();
+    }
+    mutex.post();
+
+    return view;
+}
+
+void stereoCalibPipeline::flush()
+{
+    for (size_t i=0; i<input.size(); i++)
+        delete input[i];
+    for (size_t i=0; i<output.size(); i++)
+        delete output[i];
+
+    input.clear();
+    output.clear();
+    imagePoints[0].clear();
+    imagePoints[1].clear();
+    accepted=false;
+}
+
+void stereoCalibPipeline::clear()
+{
+    mutex.wait();
+    flush();
+    generation++;
+    mutex.post();
+}
+
+int stereoCalibPipeline::getDropped()
+{
+    mutex.wait();
+    int ret=dropped;
+    mutex.post();
+
+    return ret;
+}
+
+bool stereoCalibPipeline::threadInit()
+{
+    return (detectorL.start() && detectorR.start() && refiner.start());
+}
+
+void stereoCalibPipeline::run()
+{
+    while (true)
+    {
+        pending.wait();
+        if (isStopping())
+            break;
+
+        mutex.wait();
+        if (input.empty())
+        {
+            // pairs discarded by clear()
+            mutex.post();
+            continue;
+        }
+
+        stereoView *view=input.front();
+        input.pop_front();
+        unsigned int viewGeneration=generation;
+
+        // leave time to move the board before taking a new view
+        bool skip=accepted && (view->stamp-lastStamp<minViewInterval);
+        mutex.post();
+
+        if (skip)
+        {
+            delete view;
+            continue;
+        }
+
+        cv::Mat left((IplImage*)view->left.getIplImage());
+        cv::Mat right((IplImage*)view->right.getIplImage());
+
+        detectorL.post(left,view->cornersL);
+        detectorR.post(right,view->cornersR);
+        bool foundL=detectorL.wait();
+        bool foundR=detectorR.wait();
+
+        if (foundL && foundR)
+        {
+            mutex.wait();
+            if (viewGeneration!=generation)
+            {
+                // taken before a clear(), it belongs to the old views
+                mutex.post();
+                delete view;
+                continue;
+            }
+
+            lastStamp=view->stamp;
+            accepted=true;
+            imagePoints[0].push_back(view->cornersL);
+            imagePoints[1].push_back(view->cornersR);
+            output.push_back(view);
+
+            if ((refineEvery>0) && ((int)imagePoints[0].size()%refineEvery==0))
+                refiner.post(imagePoints,left.size());
+            mutex.post();
+        }
+        else
+            delete view;
+    }
+}
+
+void stereoCalibPipeline::onStop()
+{
+    pending.post();
+}
+
+void stereoCalibPipeline::threadRelease()
+{
+    detectorL.stop();
+    detectorR.stop();
+    refiner.stop();
+}
+
+stereoCalibPipeline::~stereoCalibPipeline()
+{
+    flush();
+}
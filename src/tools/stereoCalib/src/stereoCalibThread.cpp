@@ -29,6 +29,16 @@ stereoCalibThread::stereoCalibThread(ResourceFinder &rf, Port* commPort, const c
     this->currentPathDir=rf.getHomeContextPath().c_str();
     int tmp=stereoCalibOpts.check("MonoCalib", Value(0)).asInt();
     this->stereo= tmp?false:true;
+
+    // detect the chessboard on worker threads while acquiring
+    this->pipelined=stereoCalibOpts.check("pipeline", Value(0)).asInt()!=0;
+    this->pipeline=NULL;
+    if(this->stereo && this->pipelined)
+        this->pipeline=new stereoCalibPipeline(Size(this->boardWidth,this->boardHeight),this->squareSize,
+                                               stereoCalibOpts.check("coarseScale", Value(0.5)).asDouble(),
+                                               stereoCalibOpts.check("queueLength", Value(4)).asInt(),
+                                               stereoCalibOpts.check("minViewInterval", Value(2.0)).asDouble(),
+                                               stereoCalibOpts.check("refineEvery", Value(5)).asInt());
     this->camCalibFile=rf.getHomeContextPath().c_str();
 
 
@@ -143,6 +153,11 @@ bool stereoCalibThread::threadInit()
     qR[7]=head_angles[4]+(0.5-(RIGHT))*head_angles[5];
     qR=CTRL_DEG2RAD*qR;
 
+    if(pipeline!=NULL && !pipeline->start()) {
+        cout<<"Unable to start the detection pipeline"<<endl;
+        return false;
+    }
+
    return true;
 }
 void stereoCalibThread::run(){
@@ -150,7 +165,10 @@ void stereoCalibThread::run(){
     if(stereo)
     {
         fprintf(stdout, "Running Stereo Calibration Mode... \n");
-        stereoCalibRun();
+        if(pipeline!=NULL)
+            stereoCalibRunPipelined();
+        else
+            stereoCalibRun();
     }
     else
     {
@@ -242,16 +260,7 @@ void stereoCalibThread::stereoCalibRun()
 
                     stereoCalibration(imageListLR, this->boardWidth,this->boardHeight,this->squareSize);
 
-                    fprintf(stdout," Saving Calibration Results... \n");
-                    updateIntrinsics(imgL->width,imgL->height,Kright.at<double>(0,0),Kright.at<double>(1,1),Kright.at<double>(0,2),Kright.at<double>(1,2),DistR.at<double>(0,0),DistR.at<double>(0,1),DistR.at<double>(0,2),DistR.at<double>(0,3),"CAMERA_CALIBRATION_RIGHT");
-                    updateIntrinsics(imgL->width,imgL->height,Kleft.at<double>(0,0),Kleft.at<double>(1,1),Kleft.at<double>(0,2),Kleft.at<double>(1,2),DistL.at<double>(0,0),DistL.at<double>(0,1),DistL.at<double>(0,2),DistL.at<double>(0,3),"CAMERA_CALIBRATION_LEFT");
-
-                    Mat Rot=Mat::eye(3,3,CV_64FC1);
-                    Mat Tr=Mat::zeros(3,1,CV_64FC1);
-
-                    updateExtrinsics(this->R,this->T,"STEREO_DISPARITY");
-
-                    fprintf(stdout, "Calibration Results Saved in %s \n", camCalibFile.c_str());
+                    saveCalibrationResults(imgL->width,imgL->height);
 
                     startCalibration=0;
                     count=1;
@@ -283,6 +292,132 @@ void stereoCalibThread::stereoCalibRun()
 
 
 
+ void stereoCalibThread::stereoCalibRunPipelined()
+{
+    Stamp TSLeft;
+    Stamp TSRight;
+
+    bool initL=false;
+    bool initR=false;
+
+    int count=1;
+    Size boardSize, imageSize;
+    boardSize.width=this->boardWidth;
+    boardSize.height=this->boardHeight;
+
+    std::vector<std::vector<Point2f> > imagePoints[2];
+
+    imageL=new ImageOf<PixelRgb>;
+    imageR=new ImageOf<PixelRgb>;
+
+    // the acquisition never waits for the detection: the pairs are
+    // queued to the pipeline and the detected views are collected
+    // at the next cycles
+    while (!isStopping()) {
+        ImageOf<PixelRgb> *tmpL = imagePortInLeft.read(false);
+        ImageOf<PixelRgb> *tmpR = imagePortInRight.read(false);
+
+        if(tmpL!=NULL)
+        {
+            *imageL=*tmpL;
+            imagePortInLeft.getEnvelope(TSLeft);
+            initL=true;
+        }
+        if(tmpR!=NULL)
+        {
+            *imageR=*tmpR;
+            imagePortInRight.getEnvelope(TSRight);
+            initR=true;
+        }
+
+        if(!(initL && initR && checkTS(TSLeft.getTime(),TSRight.getTime()))) {
+            Time::delay(0.005);
+            continue;
+        }
+
+        stereoView *view=NULL;
+
+        mutex->wait();
+        if(startCalibration>0) {
+            pipeline->push(*imageL,*imageR,Time::now());
+
+            view=pipeline->pop();
+            if(view!=NULL) {
+                imgL=(IplImage*)view->left.getIplImage();
+                imgR=(IplImage*)view->right.getIplImage();
+                imageSize=Size(imgL->width,imgL->height);
+
+                string pathImg=imageDir;
+                preparePath(pathImg.c_str(), pathL,pathR,count);
+                string iml(pathL);
+                string imr(pathR);
+
+                cvCvtColor(imgL,imgL,CV_RGB2BGR);
+                cvCvtColor(imgR,imgR,CV_RGB2BGR);
+                saveStereoImage(pathImg.c_str(),imgL,imgR,count);
+                cvCvtColor(imgL,imgL,CV_BGR2RGB);
+                cvCvtColor(imgR,imgR,CV_BGR2RGB);
+
+                imageListR.push_back(imr);
+                imageListL.push_back(iml);
+                imageListLR.push_back(iml);
+                imageListLR.push_back(imr);
+                imagePoints[0].push_back(view->cornersL);
+                imagePoints[1].push_back(view->cornersR);
+
+                Mat Left(imgL);
+                Mat Right(imgR);
+                drawChessboardCorners(Left, boardSize, Mat(view->cornersL), true);
+                drawChessboardCorners(Right, boardSize, Mat(view->cornersR), true);
+                count++;
+            }
+
+            if(count>numOfPairs) {
+                // the corners are already available, no need
+                // to look for them again on the saved images
+                fprintf(stdout," Running Left Camera Calibration... \n");
+                monoCalibration(imagePoints[0],boardSize,imageSize,this->Kleft,this->DistL);
+
+                fprintf(stdout," Running Right Camera Calibration... \n");
+                monoCalibration(imagePoints[1],boardSize,imageSize,this->Kright,this->DistR);
+
+                stereoCalibration(imagePoints,boardSize,this->squareSize,imageSize,
+                                  this->Kleft,this->DistL,this->Kright,this->DistR,this->R,this->T);
+
+                saveCalibrationResults(imageSize.width,imageSize.height);
+
+                startCalibration=0;
+                count=1;
+                imageListR.clear();
+                imageListL.clear();
+                imageListLR.clear();
+                imagePoints[0].clear();
+                imagePoints[1].clear();
+                pipeline->clear();
+            }
+        }
+        mutex->post();
+
+        // show the views with the corners as soon as they are detected
+        ImageOf<PixelRgb>& outimL=outPortLeft.prepare();
+        outimL=(view!=NULL)?view->left:*imageL;
+        outPortLeft.write();
+
+        ImageOf<PixelRgb>& outimR=outPortRight.prepare();
+        outimR=(view!=NULL)?view->right:*imageR;
+        outPortRight.write();
+
+        delete view;
+        initL=initR=false;
+    }
+
+    fprintf(stdout, "%d pairs dropped by the detection pipeline \n", pipeline->getDropped());
+
+    delete imageL;
+    delete imageR;
+ }
+
+
  void stereoCalibThread::monoCalibRun()
 {
 
@@ -390,6 +525,12 @@ void stereoCalibThread::threadRelease()
     delete mutex;
     delete gazeCtrl;
 
+    if (pipeline!=NULL)
+    {
+        pipeline->stop();
+        delete pipeline;
+    }
+
 
     if (polyHead.isValid())
         polyHead.close();
@@ -409,6 +550,8 @@ void stereoCalibThread::onStop() {
 }
 void stereoCalibThread::startCalib() {
     mutex->wait();
+    if(pipeline!=NULL)
+        pipeline->clear();
     startCalibration=1;
     mutex->post();
   }
@@ -434,6 +577,17 @@ void stereoCalibThread::printMatrix(Mat &matrix) {
 }
 
 
+void stereoCalibThread::saveCalibrationResults(int width, int height) {
+    fprintf(stdout," Saving Calibration Results... \n");
+    updateIntrinsics(width,height,Kright.at<double>(0,0),Kright.at<double>(1,1),Kright.at<double>(0,2),Kright.at<double>(1,2),DistR.at<double>(0,0),DistR.at<double>(0,1),DistR.at<double>(0,2),DistR.at<double>(0,3),"CAMERA_CALIBRATION_RIGHT");
+    updateIntrinsics(width,height,Kleft.at<double>(0,0),Kleft.at<double>(1,1),Kleft.at<double>(0,2),Kleft.at<double>(1,2),DistL.at<double>(0,0),DistL.at<double>(0,1),DistL.at<double>(0,2),DistL.at<double>(0,3),"CAMERA_CALIBRATION_LEFT");
+
+    updateExtrinsics(this->R,this->T,"STEREO_DISPARITY");
+
+    fprintf(stdout, "Calibration Results Saved in %s \n", camCalibFile.c_str());
+}
+
+
 bool stereoCalibThread::checkTS(double TSLeft, double TSRight, double th) {
     double diff=fabs(TSLeft-TSRight);
     if(diff <th)
@@ -634,11 +788,8 @@ void stereoCalibThread::monoCalibration(const vector<string>& imageList, int boa
     Size boardSize, imageSize;
     boardSize.width=boardWidth;
     boardSize.height=boardHeight;
-    int flags=0;
     int i;
 
-    float squareSize = 1.f, aspectRatio = 1.f;
-
       Mat view, viewGray;
 
     for(i = 0; i<(int)imageList.size();i++)
@@ -659,6 +810,16 @@ void stereoCalibThread::monoCalibration(const vector<string>& imageList, int boa
          }
 
     }
+
+    monoCalibration(imagePoints,boardSize,imageSize,K,Dist);
+}
+
+
+double stereoCalibThread::monoCalibration(const vector<vector<Point2f> > &imagePoints, Size boardSize, Size imageSize, Mat &K, Mat &Dist)
+{
+    int flags=0;
+    float squareSize = 1.f, aspectRatio = 1.f;
+
     std::vector<Mat> rvecs, tvecs;
     std::vector<float> reprojErrs;
     double totalAvgErr = 0;
@@ -677,6 +838,7 @@ void stereoCalibThread::monoCalibration(const vector<string>& imageList, int boa
     double rms = calibrateCamera(objectPoints, imagePoints, imageSize, K,
                     Dist, rvecs, tvecs,CV_CALIB_FIX_K3);
     printf("RMS error reported by calibrateCamera: %g\n", rms);
+    return rms;
 }
 
 
@@ -695,7 +857,6 @@ void stereoCalibThread::stereoCalibration(const vector<string>& imagelist, int b
     // ARRAY AND VECTOR STORAGE:
     
     std::vector<std::vector<Point2f> > imagePoints[2];
-    std::vector<std::vector<Point3f> > objectPoints;
     Size imageSize;
     
     int i, j, k, nimages = (int)imagelist.size()/2;
@@ -760,6 +921,17 @@ void stereoCalibThread::stereoCalibration(const vector<string>& imagelist, int b
     
     imagePoints[0].resize(nimages);
     imagePoints[1].resize(nimages);
+
+    stereoCalibration(imagePoints,boardSize,this->squareSize,imageSize,
+                      this->Kleft,this->DistL,this->Kright,this->DistR,this->R,this->T);
+}
+
+
+double stereoCalibThread::stereoCalibration(const vector<vector<Point2f> > imagePoints[2], Size boardSize, float squareSize, Size imageSize,
+                                            Mat &KL, Mat &DL, Mat &KR, Mat &DR, Mat &R, Mat &T)
+{
+    std::vector<std::vector<Point3f> > objectPoints;
+    int i, j, k, nimages = (int)imagePoints[0].size();
     objectPoints.resize(nimages);
     
     for( i = 0; i < nimages; i++ )
@@ -773,13 +945,14 @@ void stereoCalibThread::stereoCalibration(const vector<string>& imagelist, int b
     
     Mat cameraMatrix[2], distCoeffs[2];
     Mat E, F;
+    double rms;
     
-    if(this->Kleft.empty() || this->Kright.empty())
+    if(KL.empty() || KR.empty())
     {
-        double rms = stereoCalibrate(objectPoints, imagePoints[0], imagePoints[1],
-                        this->Kleft, this->DistL,
-                        this->Kright, this->DistR,
-                        imageSize, this->R, this->T, E, F,
+        rms = stereoCalibrate(objectPoints, imagePoints[0], imagePoints[1],
+                        KL, DL,
+                        KR, DR,
+                        imageSize, R, T, E, F,
                         TermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 100, 1e-5),
                         CV_CALIB_FIX_ASPECT_RATIO +
                         CV_CALIB_ZERO_TANGENT_DIST +
@@ -788,45 +961,45 @@ void stereoCalibThread::stereoCalibration(const vector<string>& imagelist, int b
         fprintf(stdout,"done with RMS error= %f\n",rms);
     } else
     {
-        double rms = stereoCalibrate(objectPoints, imagePoints[0], imagePoints[1],
-                this->Kleft, this->DistL,
-                this->Kright, this->DistR,
-                imageSize, this->R, this->T, E, F,
+        rms = stereoCalibrate(objectPoints, imagePoints[0], imagePoints[1],
+                KL, DL,
+                KR, DR,
+                imageSize, R, T, E, F,
                 TermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 100, 1e-5),CV_CALIB_FIX_ASPECT_RATIO + CV_CALIB_FIX_INTRINSIC + CV_CALIB_FIX_K3);
         fprintf(stdout,"done with RMS error= %f\n",rms);
     }
 // CALIBRATION QUALITY CHECK
-    cameraMatrix[0] = this->Kleft;
-    cameraMatrix[1] = this->Kright;
-    distCoeffs[0]=this->DistL;
-    distCoeffs[1]=this->DistR;
-    Mat R, T;
-    T=this->T;
-    R=this->R;
+    cameraMatrix[0] = KL;
+    cameraMatrix[1] = KR;
+    distCoeffs[0]=DL;
+    distCoeffs[1]=DR;
     double err = 0;
     int npoints = 0;
     std::vector<Vec3f> lines[2];
     for( i = 0; i < nimages; i++ )
     {
         int npt = (int)imagePoints[0][i].size();
-        Mat imgpt[2];
+        // undistort a copy, the corners may be reused by the caller
+        std::vector<Point2f> undist[2];
         for( k = 0; k < 2; k++ )
         {
-            imgpt[k] = Mat(imagePoints[k][i]);
-            undistortPoints(imgpt[k], imgpt[k], cameraMatrix[k], distCoeffs[k], Mat(), cameraMatrix[k]);
-            computeCorrespondEpilines(imgpt[k], k+1, F, lines[k]);
+            undist[k] = imagePoints[k][i];
+            Mat imgpt(undist[k]);
+            undistortPoints(imgpt, imgpt, cameraMatrix[k], distCoeffs[k], Mat(), cameraMatrix[k]);
+            computeCorrespondEpilines(imgpt, k+1, F, lines[k]);
         }
         for( j = 0; j < npt; j++ )
         {
-            double errij = fabs(imagePoints[0][i][j].x*lines[1][j][0] +
-                                imagePoints[0][i][j].y*lines[1][j][1] + lines[1][j][2]) +
-                           fabs(imagePoints[1][i][j].x*lines[0][j][0] +
-                                imagePoints[1][i][j].y*lines[0][j][1] + lines[0][j][2]);
+            double errij = fabs(undist[0][j].x*lines[1][j][0] +
+                                undist[0][j].y*lines[1][j][1] + lines[1][j][2]) +
+                           fabs(undist[1][j].x*lines[0][j][0] +
+                                undist[1][j].y*lines[0][j][1] + lines[0][j][2]);
             err += errij;
         }
         npoints += npt;
     }
     fprintf(stdout,"average reprojection err = %f\n",err/npoints);
+    return rms;
 }
 
 